@@ -39,6 +39,9 @@ extern "C" {
 #define XMP_FORMAT_8BIT		(1 << 0) /* Mix to 8-bit instead of 16 */
 #define XMP_FORMAT_UNSIGNED	(1 << 1) /* Mix to unsigned samples */
 #define XMP_FORMAT_MONO		(1 << 2) /* Mix to mono instead of stereo */
+#define XMP_FORMAT_FLOAT	(1 << 3) /* Mix to 32-bit float samples */
+#define XMP_FORMAT_32BIT	(1 << 4) /* Mix to 32-bit integer samples */
+#define XMP_FORMAT_24BIT	(1 << 5) /* Mix to 24-bit samples in 32 bits */
 
 /* mixer paramters for xmp_set_player() */
 #define XMP_PLAYER_AMP		0	/* Amplification factor */
@@ -46,6 +49,12 @@ extern "C" {
 #define XMP_PLAYER_INTERP	2	/* Interpolation type */
 #define XMP_PLAYER_DSP		3	/* DSP effect flags */
 #define XMP_PLAYER_FLAGS	4	/* Player flags */
+#define XMP_PLAYER_SNAPSHOT	5	/* Seek snapshot interval in ms */
+#define XMP_PLAYER_SMPCTL	6	/* Sample control flags */
+#define XMP_PLAYER_PATCTL	7	/* Pattern control flags */
+#define XMP_PLAYER_ASYNC	8	/* Queue control calls for the player */
+#define XMP_PLAYER_SCANCTL	9	/* Module scan control flags */
+#define XMP_PLAYER_VOICES	10	/* Maximum number of mixer voices */
 
 /* interpolation types */
 #define XMP_INTERP_NEAREST	0	/* Nearest neighbor */
@@ -61,11 +70,24 @@ extern "C" {
 #define XMP_FLAGS_FX9BUG	(1 << 1) /* Emulate FX9 bug */
 #define XMP_FLAGS_FIXLOOP	(1 << 2) /* Emulate sample loop bug */
 
+/* sample control flags */
+#define XMP_SMPCTL_MAP		(1 << 0) /* Map raw samples from file */
+#define XMP_SMPCTL_SKIP		(1 << 1) /* Don't load sample data */
+#define XMP_SMPCTL_LAZY		(1 << 2) /* Load samples when first played */
+
+/* pattern control flags */
+#define XMP_PATCTL_COMPACT	(1 << 0) /* Merge identical tracks */
+#define XMP_PATCTL_INDEX	(1 << 1) /* Index channels with events */
+
+/* scan control flags */
+#define XMP_SCANCTL_BACKGROUND	(1 << 0) /* Scan sequences while playing */
+
 /* limits */
 #define XMP_MAX_KEYS		121	/* Number of valid keys */
 #define XMP_MAX_ENV_POINTS	32	/* Max number of envelope points */
 #define XMP_MAX_MOD_LENGTH	256	/* Max number of patterns in module */
 #define XMP_MAX_CHANNELS	64	/* Max number of channels in module */
+#define XMP_MAX_SEQUENCES	16	/* Max number of sequences in module */
 #define XMP_MAX_SRATE		48000	/* max sampling rate (Hz) */
 #define XMP_MIN_BPM		20	/* min BPM */
 /* frame rate = (50 * bpm / 125) Hz */
@@ -80,6 +102,7 @@ extern "C" {
 #define XMP_ERROR_DEPACK	5	/* Error depacking file */
 #define XMP_ERROR_SYSTEM	6	/* System error */
 #define XMP_ERROR_INVALID	7	/* Invalid parameter */
+#define XMP_ERROR_STATE		8	/* Invalid player state */
 
 struct xmp_channel {
 	int pan;			/* Channel pan (0x80 is center) */
@@ -232,6 +255,17 @@ struct xmp_module_info {
 	struct xmp_sequence *seq_data;	/* Pointer to sequence data */
 };
 
+struct xmp_probe {			/* Module in a batch probe */
+	char *path;			/* Module file, or NULL */
+	void *mem;			/* Module data if path is NULL */
+	long size;			/* Size of module data */
+	int error;			/* 0 or negative error code */
+	struct xmp_test_info info;	/* Module name and type */
+	unsigned char md5[16];		/* MD5 message digest */
+	int num_sequences;		/* Number of valid sequences */
+	struct xmp_sequence seq_data[XMP_MAX_SEQUENCES];
+};
+
 struct xmp_frame_info {			/* Current frame information */
 	int pos;			/* Current position */
 	int pattern;			/* Current pattern */
@@ -276,28 +310,39 @@ EXPORT xmp_context xmp_create_context  (void);
 EXPORT void        xmp_free_context    (xmp_context);
 EXPORT int         xmp_test_module     (char *, struct xmp_test_info *);
 EXPORT int         xmp_test_modulef    (FILE *, struct xmp_test_info *);
+EXPORT int         xmp_test_module_from_memory (void *, long, struct xmp_test_info *);
 EXPORT int         xmp_load_module     (xmp_context, char *);
 EXPORT int         xmp_load_modulef    (xmp_context, FILE *, char *, size_t size);
+EXPORT int         xmp_load_module_from_memory (xmp_context, void *, long);
 EXPORT void        xmp_scan_module     (xmp_context);
 EXPORT void        xmp_release_module  (xmp_context);
+EXPORT int         xmp_share_module    (xmp_context, xmp_context);
 EXPORT int         xmp_start_player    (xmp_context, int, int);
 EXPORT int         xmp_play_frame      (xmp_context);
+EXPORT int         xmp_play_buffer     (xmp_context, void *, int, int);
+EXPORT int         xmp_skip_frames     (xmp_context, int);
+EXPORT int         xmp_render_module   (xmp_context, int, int,
+                                        void (*)(void *, int, void *), void *);
 EXPORT void        xmp_get_frame_info  (xmp_context, struct xmp_frame_info *);
 EXPORT void        xmp_end_player      (xmp_context);
-EXPORT void        xmp_inject_event    (xmp_context, int, struct xmp_event *);
+/* Queued calls return -XMP_ERROR_STATE when the control queue is full */
+EXPORT int         xmp_inject_event    (xmp_context, int, struct xmp_event *);
+EXPORT int         xmp_inject_event_at (xmp_context, int, struct xmp_event *, int);
 EXPORT void        xmp_get_module_info (xmp_context, struct xmp_module_info *);
+EXPORT int         xmp_probe_modules   (struct xmp_probe *, int, int, int);
 EXPORT char      **xmp_get_format_list (void);
 EXPORT int         xmp_next_position   (xmp_context);
 EXPORT int         xmp_prev_position   (xmp_context);
 EXPORT int         xmp_set_position    (xmp_context, int);
-EXPORT void        xmp_stop_module     (xmp_context);
-EXPORT void        xmp_restart_module  (xmp_context);
+EXPORT int         xmp_stop_module     (xmp_context);
+EXPORT int         xmp_restart_module  (xmp_context);
 EXPORT int         xmp_seek_time       (xmp_context, int);
 EXPORT int         xmp_channel_mute    (xmp_context, int, int);
 EXPORT int         xmp_channel_vol     (xmp_context, int, int);
 EXPORT int         xmp_set_player      (xmp_context, int, int);
 EXPORT int         xmp_get_player      (xmp_context, int);
 EXPORT int         xmp_set_instrument_path (xmp_context, char *);
+EXPORT int         xmp_set_allocator   (xmp_context, void *(*)(size_t, void *), void (*)(void *, void *), void *);
 
 #ifdef __cplusplus
 }
@@ -1009,7 +1009,7 @@ if hasattr(_libs['xmp'], 'xmp_end_player'):
 if hasattr(_libs['xmp'], 'xmp_inject_event'):
     xmp_inject_event = _libs['xmp'].xmp_inject_event
     xmp_inject_event.argtypes = [xmp_context, c_int, POINTER(struct_xmp_event)]
-    xmp_inject_event.restype = None
+    xmp_inject_event.restype = c_int
 
 if hasattr(_libs['xmp'], 'xmp_get_module_info'):
     xmp_get_module_info = _libs['xmp'].xmp_get_module_info
@@ -1039,12 +1039,12 @@ if hasattr(_libs['xmp'], 'xmp_set_position'):
 if hasattr(_libs['xmp'], 'xmp_stop_module'):
     xmp_stop_module = _libs['xmp'].xmp_stop_module
     xmp_stop_module.argtypes = [xmp_context]
-    xmp_stop_module.restype = None
+    xmp_stop_module.restype = c_int
 
 if hasattr(_libs['xmp'], 'xmp_restart_module'):
     xmp_restart_module = _libs['xmp'].xmp_restart_module
     xmp_restart_module.argtypes = [xmp_context]
-    xmp_restart_module.restype = None
+    xmp_restart_module.restype = c_int
 
 if hasattr(_libs['xmp'], 'xmp_seek_time'):
     xmp_seek_time = _libs['xmp'].xmp_seek_time
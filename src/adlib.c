@@ -12,21 +12,9 @@
 #include "synth.h"
 #include "fmopl.h"
 
-/* Use the old GPL-compatible version */
-#define USE_OLD_FMOPL
-
+/* Each context has its own chip, so modules can be played concurrently */
 struct adlib {
-#ifdef USE_OLD_FMOPL
-	FM_OPL *ym3812;
-#define YM3812ResetChip(which)	OPLResetChip(a->ym3812)
-#define YM3812Write(which,addr,val)	OPLWrite(a->ym3812, addr, val)
-#define YM3812Read(which,addr)	OPLRead(a->ym3812, addr)
-#define YM3812Init(num,clock,rate) \
-		((((struct adlib *)(SYNTH_CHIP(ctx)))->ym3812 = OPLCreate(OPL_TYPE_IO, clock, rate)) != NULL)
-#define YM3812Shutdown()	OPLDestroy(a->ym3812)
-#define YM3812UpdateOne(which,tmp_bk,count,vl,vr,stereo) \
-		YM3812UpdateOne(a->ym3812, tmp_bk, count, vl, vr, stereo)
-#endif
+	FM_OPL *opl;
 
 #define NUM_SYNTH_CHANNEL 9
 	int voc2ch[NUM_SYNTH_CHANNEL];
@@ -136,8 +124,8 @@ static inline int opl_write(struct adlib *a, int addr, int val)
 	DELAY(35);
 	return 0;
 #else
-	YM3812Write(0, 0, addr);
-	return YM3812Write(0, 1, val);
+	OPLWrite(a->opl, 0, addr);
+	return OPLWrite(a->opl, 1, val);
 #endif
 }
 
@@ -152,12 +140,12 @@ static inline uint8 opl_read(struct adlib *a, int addr)
 	DELAY(35);
 	return x;
 #else
-	YM3812Write(0, 0, addr);
-	return YM3812Read(0, 1);
+	OPLWrite(a->opl, 0, addr);
+	return OPLRead(a->opl, 1);
 #endif
 }
 
-static struct adlib *adlib_new()
+static struct adlib *adlib_new(int freq)
 {
 	struct adlib *a;
 	int i;
@@ -166,6 +154,12 @@ static struct adlib *adlib_new()
 	if (a == NULL)
 		return NULL;
 
+	a->opl = OPLCreate(OPL_TYPE_IO, 3579545, freq);
+	if (a->opl == NULL) {
+		free(a);
+		return NULL;
+	}
+
 	for (i = 0; i < NUM_SYNTH_CHANNEL; i++) {
 		a->voc2ch[i] = -1;
 	}
@@ -175,6 +169,7 @@ static struct adlib *adlib_new()
 
 static void adlib_destroy(struct adlib *a)
 {
+	OPLDestroy(a->opl);
 	free(a);
 }
 
@@ -295,16 +290,15 @@ static void synth_seteffect(struct context_data *ctx, int c, int type, int val)
 
 static int synth_init(struct context_data *ctx, int freq)
 {
-	SYNTH_CHIP(ctx) = adlib_new();
+	SYNTH_CHIP(ctx) = adlib_new(freq);
 	if (SYNTH_CHIP(ctx) == NULL)
 		return -1;
 
 #ifdef DEBUG_ADLIB
 	ioperm(0x388, 2, 1);
 #endif
-	synth_chreset(ctx);
 
-	return YM3812Init(1, 3579545, freq);
+	return 0;
 }
 
 static int synth_reset(struct context_data *ctx)
@@ -318,7 +312,7 @@ static int synth_reset(struct context_data *ctx)
 		opl_write(a, ym3812, 0xb0 + i, 0);
 	}
 #else
-	YM3812ResetChip(0);
+	OPLResetChip(a->opl);
 #endif
 	synth_chreset(ctx);
 
@@ -330,9 +324,8 @@ static int synth_deinit(struct context_data *ctx)
 	struct adlib *a = SYNTH_CHIP(ctx);
 
 	synth_reset(ctx);
-	YM3812Shutdown();
-
 	adlib_destroy(a);
+	SYNTH_CHIP(ctx) = NULL;
 
 	return 0;
 }
@@ -344,7 +337,7 @@ static void synth_mixer(struct context_data *ctx, int32 *tmp_bk, int count, int
 	if (!tmp_bk)
 		return;
 
-	YM3812UpdateOne(0, tmp_bk, count, vl, vr, stereo);
+	YM3812UpdateOne(a->opl, tmp_bk, count, vl, vr, stereo);
 }
 
 
@@ -0,0 +1,173 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2012 Claudio Matsuoka and Hipolito Carraro Jr
+ *
+ * This file is part of the Extended Module Player and is distributed
+ * under the terms of the GNU Lesser General Public License. See COPYING.LIB
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "arena.h"
+
+#define ARENA_ALIGN	16
+#define ARENA_BLOCK	(64 * 1024)
+#define ALIGN(x)	(((x) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+struct arena_block {
+	struct arena_block *next;
+	size_t size;			/* usable bytes after the header */
+	size_t used;
+};
+
+/* Each allocation is preceded by its size, so it can be reallocated */
+struct arena_header {
+	size_t size;
+};
+
+#define BLOCK_HEADER	ALIGN(sizeof (struct arena_block))
+#define ALLOC_HEADER	ALIGN(sizeof (struct arena_header))
+
+#define BLOCK_DATA(b)	((char *)(b) + BLOCK_HEADER)
+#define HEADER(p)	((struct arena_header *)((char *)(p) - ALLOC_HEADER))
+
+
+static struct arena_block *new_block(struct arena *a, size_t size)
+{
+	struct arena_block *b;
+
+	if (size > SIZE_MAX - BLOCK_HEADER)
+		return NULL;
+
+	if (a->alloc != NULL) {
+		b = a->alloc(BLOCK_HEADER + size, a->arg);
+	} else {
+		b = malloc(BLOCK_HEADER + size);
+	}
+
+	if (b == NULL)
+		return NULL;
+
+	b->size = size;
+	b->used = 0;
+
+	return b;
+}
+
+void *arena_malloc(struct arena *a, size_t size)
+{
+	struct arena_block *b = a->block;
+	struct arena_header *h;
+	size_t len;
+
+	if (size > SIZE_MAX / 2)
+		return NULL;
+
+	len = ALLOC_HEADER + ALIGN(size);
+
+	if (b == NULL || b->size - b->used < len) {
+		if (len > ARENA_BLOCK / 4) {
+			/* Large allocations get a block of their own, and
+			 * the current block stays in use for small ones
+			 */
+			if ((b = new_block(a, len)) == NULL)
+				return NULL;
+			if (a->block != NULL) {
+				b->next = a->block->next;
+				a->block->next = b;
+			} else {
+				b->next = NULL;
+				a->block = b;
+			}
+		} else {
+			if ((b = new_block(a, ARENA_BLOCK)) == NULL)
+				return NULL;
+			b->next = a->block;
+			a->block = b;
+		}
+	}
+
+	h = (struct arena_header *)(BLOCK_DATA(b) + b->used);
+	h->size = size;
+	b->used += len;
+
+	return (char *)h + ALLOC_HEADER;
+}
+
+void *arena_calloc(struct arena *a, size_t nmemb, size_t size)
+{
+	void *p;
+
+	if (size != 0 && nmemb > SIZE_MAX / size)
+		return NULL;
+
+	if ((p = arena_malloc(a, nmemb * size)) != NULL)
+		memset(p, 0, nmemb * size);
+
+	return p;
+}
+
+void *arena_realloc(struct arena *a, void *ptr, size_t size)
+{
+	struct arena_block *b = a->block;
+	struct arena_header *h;
+	size_t old;
+	char *end;
+	void *p;
+
+	if (ptr == NULL)
+		return arena_malloc(a, size);
+
+	h = HEADER(ptr);
+	old = h->size;
+
+	if (size <= old) {
+		h->size = size;
+		return ptr;
+	}
+
+	/* Grow in place if this is the last allocation of the block */
+	end = (char *)ptr + ALIGN(old);
+	if (b != NULL && end == BLOCK_DATA(b) + b->used &&
+			size <= SIZE_MAX / 2 &&
+			ALIGN(size) - ALIGN(old) <= b->size - b->used) {
+		b->used += ALIGN(size) - ALIGN(old);
+		h->size = size;
+		return ptr;
+	}
+
+	if ((p = arena_malloc(a, size)) == NULL)
+		return NULL;
+
+	memcpy(p, ptr, old);
+
+	return p;
+}
+
+char *arena_strdup(struct arena *a, const char *s)
+{
+	size_t len = strlen(s) + 1;
+	char *p;
+
+	if ((p = arena_malloc(a, len)) != NULL)
+		memcpy(p, s, len);
+
+	return p;
+}
+
+void arena_release(struct arena *a)
+{
+	struct arena_block *b, *next;
+
+	for (b = a->block; b != NULL; b = next) {
+		next = b->next;
+		if (a->free != NULL) {
+			a->free(b, a->arg);
+		} else {
+			free(b);
+		}
+	}
+
+	a->block = NULL;
+}
@@ -0,0 +1,28 @@
+#ifndef XMP_ARENA_H
+#define XMP_ARENA_H
+
+#include <stddef.h>
+
+/* Region allocator for module data. Memory is taken from large blocks
+ * and is only returned when the whole arena is released, so loading a
+ * module doesn't need thousands of malloc calls and releasing it is a
+ * walk over a handful of blocks. Blocks come from malloc() or from the
+ * allocator installed with xmp_set_allocator().
+ */
+
+struct arena_block;
+
+struct arena {
+	struct arena_block *block;	/* current block, then older ones */
+	void *(*alloc)(size_t, void *);	/* user block allocator, or NULL */
+	void (*free)(void *, void *);
+	void *arg;
+};
+
+void	*arena_malloc	(struct arena *, size_t);
+void	*arena_calloc	(struct arena *, size_t, size_t);
+void	*arena_realloc	(struct arena *, void *, size_t);
+char	*arena_strdup	(struct arena *, const char *);
+void	arena_release	(struct arena *);
+
+#endif /* XMP_ARENA_H */
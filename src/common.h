@@ -25,6 +25,7 @@
 
 #include <stdio.h>
 #include "xmp.h"
+#include "arena.h"
 
 /* AmigaOS fixes by Chris Young <cdyoung@ntlworld.com>, Nov 25, 2007
  */
@@ -71,6 +72,9 @@ typedef signed long long int64;
 #define TRACK_NUM(a,c)	m->mod.xxp[a]->index[c]
 #define EVENT(a,c,r)	m->mod.xxt[TRACK_NUM((a),(c))]->event[r]
 
+/* Tracks of a pattern from the index built after loading */
+#define PATTERN_TRACKS(a)	(m->trk_index + (a) * m->mod.chn)
+
 #ifdef _MSC_VER
 #define D_CRIT "  Error: "
 #define D_WARN "Warning: "
@@ -159,7 +163,9 @@ void __inline CLIB_DECL D_(const char *text, ...) { do {} while (0); }
 #define DEFAULT_TIME_FACTOR	10.0
 #define MED_TIME_FACTOR		2.64
 
-#define MAX_SEQUENCES		16
+#define MAX_SEQUENCES		XMP_MAX_SEQUENCES
+#define MAX_TIMED_EVENTS	64
+#define MAX_VOICES		1024
 
 struct ord_data {
 	int speed;
@@ -173,6 +179,11 @@ struct ord_data {
 
 /* Context */
 
+struct module_ref;
+struct control_queue;
+struct scan_job;
+struct instrument_envelopes;
+
 struct module_data {
 	struct xmp_module mod;
 
@@ -180,6 +191,7 @@ struct module_data {
 	char *basename;			/* file basename */
 	char *filename;			/* Module file name */
 	char *comment;			/* Comments, if any */
+	const char *format;		/* Format loader name */
 	uint8 md5[16];			/* MD5 message digest */
 	int size;			/* File size */
 	double rrate;			/* Replay rate */
@@ -208,6 +220,25 @@ struct module_data {
 
 	const struct synth_info *synth;
 	void *synth_chip;
+
+	int smpctl;			/* sample control flags */
+	struct hio_handle *map;		/* file mapping shared by samples */
+	int nodata;			/* loaded without sample data */
+	struct lazy_sample *lazy;	/* samples left in the file, or NULL */
+	int lazy_num;			/* number of lazy sample entries */
+
+	int patctl;			/* pattern control flags */
+	struct xmp_track **trk_index;	/* tracks by pattern and channel */
+	int *row_index;			/* first row of each pattern */
+	uint64 *row_events;		/* channels with events in each row */
+	struct instrument_envelopes *xxe; /* compiled instrument envelopes */
+
+	struct arena arena;		/* module data allocations */
+	struct arena track_arena;	/* track data, unless compacted */
+	struct module_ref *ref;		/* shared module data, or NULL */
+
+	int scanctl;			/* scan control flags */
+	struct scan_job *scan_job;	/* background scan, or NULL */
 };
 
 
@@ -268,16 +299,54 @@ struct player_data {
 		int maxvoc;		/* Number of sound card voices */
 		int chnvoc;		/* Number of voices per channel */
 		int age;		/* Voice age control (?) */
+		int voices;		/* Number of voices set by the user */
 	
 		struct virt_channel {
 			int count;
 			int map;
+			int first;	/* First voice with this root */
 		} *virt_channel;
 	
 		struct mixer_voice *voice_array;
+		int *free_voice;	/* Stack of free voices */
+		int num_free;
 	} virt;
 
 	struct xmp_event inject_event[XMP_MAX_CHANNELS];
+
+	struct {			/* Events injected at a sample offset */
+		int num;
+		struct timed_event {
+			int chn;
+			int offset;	/* Samples from the next frame start */
+			struct xmp_event event;
+		} ev[MAX_TIMED_EVENTS];	/* Sorted by offset */
+	} timed;
+
+	struct {			/* xmp_play_buffer() state */
+		int consumed;		/* Bytes of the frame already copied */
+		int in_size;		/* Size of the frame in the buffer */
+		int skip;		/* Samples to skip in the next frame */
+	} buffer_data;
+
+	struct {			/* Seek index */
+		int interval;		/* Snapshot interval in ms, 0 if off */
+		int sequence;		/* Sequence covered by the index */
+		int num;		/* Number of snapshots */
+
+		struct seek_point {
+			double time;	/* Replay time in ms */
+			int size;	/* Serialized snapshot size */
+			uint8 *data;	/* Serialized snapshot */
+		} *point;
+	} seek;
+
+	struct {			/* Samples changed by invert loop */
+		struct xmp_sample *xxs;	/* Private sample list, or NULL */
+		struct xmp_sample *orig;	/* Module sample list */
+	} invloop;
+
+	struct control_queue *queue;	/* Async control commands, or NULL */
 };
 
 struct mixer_data {
@@ -294,6 +363,7 @@ struct mixer_data {
 	int dtright;		/* anticlick control, right channel */
 	int dtleft;		/* anticlick control, left channel */
 	int pbase;		/* period base */
+	int simd;		/* SIMD mixer level */
 };
 
 #include "list.h"
@@ -312,6 +382,13 @@ int	exclude_match		(char *);
 int	scan_module		(struct context_data *, int, int);
 int	scan_sequences		(struct context_data *);
 int	get_sequence		(struct context_data *, int);
+int	scan_start		(struct context_data *);
+void	scan_wait		(struct context_data *);
+void	scan_poll		(struct context_data *);
+void	control_drain		(struct context_data *);
+void	control_sync		(struct context_data *);
+int	queue_timed_event	(struct context_data *, int, struct xmp_event *,
+				 int);
 
 int8	read8s			(FILE *);
 uint8	read8			(FILE *);
@@ -18,10 +18,84 @@
 #include "format.h"
 #include "virtual.h"
 #include "mixer.h"
+#include "snapshot.h"
 
 const char *xmp_version = XMP_VERSION;
 const unsigned int xmp_vercode = XMP_VERCODE;
 
+/* Control queue. With XMP_PLAYER_ASYNC set, calls that change playback
+ * are queued by the control thread and applied by the player thread at
+ * the start of the next frame. There's a single producer and a single
+ * consumer, so the indices are the only shared data and no locks are
+ * needed. The control thread keeps its own copy of the player settings
+ * to answer queries without reading player state.
+ */
+
+#define QUEUE_SIZE	256		/* must be a power of two */
+
+#define CMD_MUTE	0
+#define CMD_VOL		1
+#define CMD_POSITION	2
+#define CMD_NEXT	3
+#define CMD_PREV	4
+#define CMD_STOP	5
+#define CMD_RESTART	6
+#define CMD_SEEK	7
+#define CMD_PLAYER	8
+#define CMD_INJECT	9
+#define CMD_INJECT_AT	10
+
+#if defined(__GNUC__)
+#define LOAD_ACQUIRE(x)		__atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(x,v)	__atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#else
+#define LOAD_ACQUIRE(x)		(*(volatile unsigned int *)&(x))
+#define STORE_RELEASE(x,v)	(*(volatile unsigned int *)&(x) = (v))
+#endif
+
+struct control_cmd {
+	int type;
+	int arg1;
+	int arg2;
+	struct xmp_event event;
+};
+
+struct control_queue {
+	unsigned int head;		/* next command written by control */
+	unsigned int tail;		/* next command read by player */
+	struct control_cmd cmd[QUEUE_SIZE];
+
+	/* Settings as seen by the control thread */
+	char channel_mute[XMP_MAX_CHANNELS];
+	int channel_vol[XMP_MAX_CHANNELS];
+	int amplify;
+	int mix;
+	int interp;
+	int dsp;
+	int flags;
+};
+
+static int queue_cmd(struct control_queue *q, int type, int arg1, int arg2,
+		     struct xmp_event *e)
+{
+	struct control_cmd *cmd;
+	unsigned int head = q->head;
+
+	if (head - LOAD_ACQUIRE(q->tail) >= QUEUE_SIZE)
+		return -1;
+
+	cmd = &q->cmd[head & (QUEUE_SIZE - 1)];
+	cmd->type = type;
+	cmd->arg1 = arg1;
+	cmd->arg2 = arg2;
+	if (e != NULL)
+		memcpy(&cmd->event, e, sizeof(struct xmp_event));
+
+	STORE_RELEASE(q->head, head + 1);
+
+	return 0;
+}
+
 xmp_context xmp_create_context()
 {
 	struct context_data *ctx;
@@ -36,6 +110,10 @@ xmp_context xmp_create_context()
 
 void xmp_free_context(xmp_context opaque)
 {
+	struct context_data *ctx = (struct context_data *)opaque;
+
+	scan_wait(ctx);
+	free(ctx->p.queue);
 	free(opaque);
 }
 
@@ -47,6 +125,9 @@ static void set_position(struct context_data *ctx, int pos, int dir)
 	struct flow_control *f = &p->flow;
 	int seq, start;
 
+	/* Positions are checked against the scanned sequences */
+	scan_wait(ctx);
+
 	/* If dir is 0, we can jump to a different sequence */
 	if (dir == 0) {
 		seq = get_sequence(ctx, pos);
@@ -93,20 +174,49 @@ static void set_position(struct context_data *ctx, int pos, int dir)
 	}
 }
 
-int xmp_next_position(xmp_context opaque)
+static void seek_time(struct context_data *ctx, int time)
+{
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+	int i, t;
+
+	scan_wait(ctx);
+
+	/* Exact seek if we have snapshots for this sequence */
+	if (snapshot_seek(ctx, time) == 0) {
+		return;
+	}
+
+	for (i = m->mod.len - 1; i >= 0; i--) {
+		int pat = m->mod.xxo[i];
+		if (pat >= m->mod.pat) {
+			continue;
+		}
+		if (get_sequence(ctx, i) != p->sequence) {
+			continue;
+		}
+		t = m->xxo_info[i].time;
+		if (time >= t) {
+			set_position(ctx, i, 1);
+			break;
+		}
+	}
+	if (i < 0) {
+		set_position(ctx, 0, 0);
+	}
+}
+
+static void next_position(struct context_data *ctx)
 {
-	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
 
 	if (p->pos < m->mod.len)
 		set_position(ctx, p->pos + 1, 1);
-	return p->pos;
 }
 
-int xmp_prev_position(xmp_context opaque)
+static void prev_position(struct context_data *ctx)
 {
-	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
 
@@ -115,6 +225,40 @@ int xmp_prev_position(xmp_context opaque)
 	} else if (p->pos > m->seq_data[p->sequence].entry_point) {
 		set_position(ctx, p->pos - 1, -1);
 	}
+}
+
+/* Position changes are queued without waiting for the player, and return
+ * 0 instead of the new position
+ */
+static int queue_position(struct context_data *ctx, int type, int arg)
+{
+	if (queue_cmd(ctx->p.queue, type, arg, 0, NULL) < 0)
+		return -XMP_ERROR_STATE;
+
+	return 0;
+}
+
+int xmp_next_position(xmp_context opaque)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+
+	if (p->queue != NULL)
+		return queue_position(ctx, CMD_NEXT, 0);
+
+	next_position(ctx);
+	return p->pos;
+}
+
+int xmp_prev_position(xmp_context opaque)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+
+	if (p->queue != NULL)
+		return queue_position(ctx, CMD_PREV, 0);
+
+	prev_position(ctx);
 	return p->pos;
 }
 
@@ -123,71 +267,86 @@ int xmp_set_position(xmp_context opaque, int pos)
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
 
+	if (p->queue != NULL)
+		return queue_position(ctx, CMD_POSITION, pos);
+
 	set_position(ctx, pos, 0);
 
 	return p->pos;
 }
 
-void xmp_stop_module(xmp_context opaque)
+int xmp_stop_module(xmp_context opaque)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
 
+	if (p->queue != NULL)
+		return queue_position(ctx, CMD_STOP, 0);
+
 	p->pos = -2;
+
+	return 0;
 }
 
-void xmp_restart_module(xmp_context opaque)
+int xmp_restart_module(xmp_context opaque)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
 
+	if (p->queue != NULL)
+		return queue_position(ctx, CMD_RESTART, 0);
+
 	p->pos = -1;
+
+	return 0;
 }
 
 int xmp_seek_time(xmp_context opaque, int time)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
-	struct module_data *m = &ctx->m;
-	int i, t;
 
-	for (i = m->mod.len - 1; i >= 0; i--) {
-		int pat = m->mod.xxo[i];
-		if (pat >= m->mod.pat) {
-			continue;
-		}
-		if (get_sequence(ctx, i) != p->sequence) {
-			continue;
-		}
-		t = m->xxo_info[i].time;
-		if (time >= t) {
-			set_position(ctx, i, 1);
-			break;
-		}
-	}
-	if (i < 0) {
-		xmp_set_position(opaque, 0);
-	}
+	if (p->queue != NULL)
+		return queue_position(ctx, CMD_SEEK, time);
+
+	seek_time(ctx, time);
 
 	return p->pos < 0 ? 0 : p->pos;
 }
 
+static int channel_mute(char *mute, int chn, int status)
+{
+	int ret = mute[chn];
+
+	if (status >= 2) {
+		mute[chn] = !mute[chn];
+	} else if (status >= 0) {
+		mute[chn] = status;
+	}
+
+	return ret;
+}
+
 int xmp_channel_mute(xmp_context opaque, int chn, int status)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
+	struct control_queue *q = p->queue;
 	int ret;
 
 	if (chn < 0 || chn >= XMP_MAX_CHANNELS) {
 		return -XMP_ERROR_INVALID;
 	}
-	
-	ret = p->channel_mute[chn];
 
-	if (status >= 2) {
-		p->channel_mute[chn] = !p->channel_mute[chn];
-	} else if (status >= 0) {
-		p->channel_mute[chn] = status;
+	if (q == NULL)
+		return channel_mute(p->channel_mute, chn, status);
+
+	ret = channel_mute(q->channel_mute, chn, status);
+	if (status >= 0) {
+		if (queue_cmd(q, CMD_MUTE, chn, q->channel_mute[chn], NULL) < 0) {
+			q->channel_mute[chn] = ret;
+			return -XMP_ERROR_STATE;
+		}
 	}
 
 	return ret;
@@ -197,12 +356,23 @@ int xmp_channel_vol(xmp_context opaque, int chn, int vol)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
+	struct control_queue *q = p->queue;
 	int ret;
 
 	if (chn < 0 || chn >= XMP_MAX_CHANNELS) {
 		return -XMP_ERROR_INVALID;
 	}
-	
+
+	if (q != NULL) {
+		ret = q->channel_vol[chn];
+		if (vol >= 0 && vol <= 100) {
+			if (queue_cmd(q, CMD_VOL, chn, vol, NULL) < 0)
+				return -XMP_ERROR_STATE;
+			q->channel_vol[chn] = vol;
+		}
+		return ret;
+	}
+
 	ret = p->channel_vol[chn];
 
 	if (vol >= 0 && vol <= 100) {
@@ -212,40 +382,145 @@ int xmp_channel_vol(xmp_context opaque, int chn, int vol)
 	return ret;
 }
 
-int xmp_set_player(xmp_context opaque, int parm, int val)
+/* Copy the player settings to the control thread and drop pending
+ * commands. Only called when the player thread isn't running.
+ */
+void control_sync(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	struct control_queue *q = p->queue;
+
+	if (q == NULL)
+		return;
+
+	q->head = q->tail = 0;
+	memcpy(q->channel_mute, p->channel_mute, XMP_MAX_CHANNELS);
+	memcpy(q->channel_vol, p->channel_vol, sizeof(q->channel_vol));
+	q->amplify = s->amplify;
+	q->mix = s->mix;
+	q->interp = s->interp;
+	q->dsp = s->dsp;
+	q->flags = p->flags;
+}
+
+static int set_async(struct context_data *ctx, int val)
+{
+	struct player_data *p = &ctx->p;
+
+	/* Can't switch modes while another thread may be playing */
+	if (p->xc_data != NULL)
+		return -XMP_ERROR_INVALID;
+
+	if (!val) {
+		free(p->queue);
+		p->queue = NULL;
+		return 0;
+	}
+
+	if (p->queue == NULL) {
+		p->queue = calloc(1, sizeof(struct control_queue));
+		if (p->queue == NULL)
+			return -XMP_ERROR_SYSTEM;
+	}
+
+	control_sync(ctx);
+
+	return 0;
+}
+
+/* Check a mixer or player setting and return where it's stored */
+static int *player_parm(struct context_data *ctx, int parm, int val)
 {
-	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
 	struct mixer_data *s = &ctx->s;
-	int ret = -XMP_ERROR_INVALID;
 
 	switch (parm) {
 	case XMP_PLAYER_AMP:
-		if (val >= 0 && val <= 3) {
-			s->amplify = val;
-			ret = 0;
-		}
+		if (val >= 0 && val <= 3)
+			return &s->amplify;
 		break;
 	case XMP_PLAYER_MIX:
-		if (val >= -100 && val <= 100) {
-			s->mix = val;
-			ret = 0;
-		}
+		if (val >= -100 && val <= 100)
+			return &s->mix;
 		break;
 	case XMP_PLAYER_INTERP:
-		if (val >= XMP_INTERP_NEAREST && val <= XMP_INTERP_SPLINE) {
-			s->interp = val;
+		if (val >= XMP_INTERP_NEAREST && val <= XMP_INTERP_SPLINE)
+			return &s->interp;
+		break;
+	case XMP_PLAYER_DSP:
+		return &s->dsp;
+	case XMP_PLAYER_FLAGS:
+		return &p->flags;
+	}
+
+	return NULL;
+}
+
+static int *queue_parm(struct control_queue *q, int parm)
+{
+	switch (parm) {
+	case XMP_PLAYER_AMP:
+		return &q->amplify;
+	case XMP_PLAYER_MIX:
+		return &q->mix;
+	case XMP_PLAYER_INTERP:
+		return &q->interp;
+	case XMP_PLAYER_DSP:
+		return &q->dsp;
+	case XMP_PLAYER_FLAGS:
+		return &q->flags;
+	}
+
+	return NULL;
+}
+
+int xmp_set_player(xmp_context opaque, int parm, int val)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+	struct control_queue *q = p->queue;
+	int ret = -XMP_ERROR_INVALID;
+	int *v;
+
+	if ((v = player_parm(ctx, parm, val)) != NULL) {
+		if (q != NULL) {
+			if (queue_cmd(q, CMD_PLAYER, parm, val, NULL) < 0)
+				return -XMP_ERROR_STATE;
+			v = queue_parm(q, parm);
+		}
+		*v = val;
+		return 0;
+	}
+
+	switch (parm) {
+	case XMP_PLAYER_SNAPSHOT:
+		if (val >= 0) {
+			p->seek.interval = val;
 			ret = 0;
 		}
 		break;
-	case XMP_PLAYER_DSP:
-		s->dsp = val;
+	case XMP_PLAYER_SMPCTL:
+		ctx->m.smpctl = val;
 		ret = 0;
 		break;
-	case XMP_PLAYER_FLAGS:
-		p->flags = val;
+	case XMP_PLAYER_PATCTL:
+		ctx->m.patctl = val;
+		ret = 0;
+		break;
+	case XMP_PLAYER_SCANCTL:
+		ctx->m.scanctl = val;
 		ret = 0;
 		break;
+	case XMP_PLAYER_VOICES:
+		if (val >= 0 && val <= MAX_VOICES) {
+			p->virt.voices = val;
+			ret = 0;
+		}
+		break;
+	case XMP_PLAYER_ASYNC:
+		ret = set_async(ctx, val);
+		break;
 	}
 
 	return ret;
@@ -258,6 +533,9 @@ int xmp_get_player(xmp_context opaque, int parm)
 	struct mixer_data *s = &ctx->s;
 	int ret = -XMP_ERROR_INVALID;
 
+	if (p->queue != NULL && queue_parm(p->queue, parm) != NULL)
+		return *queue_parm(p->queue, parm);
+
 	switch (parm) {
 	case XMP_PLAYER_AMP:
 		ret = s->amplify;
@@ -274,23 +552,130 @@ int xmp_get_player(xmp_context opaque, int parm)
 	case XMP_PLAYER_FLAGS:
 		ret = p->flags;
 		break;
+	case XMP_PLAYER_SNAPSHOT:
+		ret = p->seek.interval;
+		break;
+	case XMP_PLAYER_SMPCTL:
+		ret = ctx->m.smpctl;
+		break;
+	case XMP_PLAYER_PATCTL:
+		ret = ctx->m.patctl;
+		break;
+	case XMP_PLAYER_SCANCTL:
+		ret = ctx->m.scanctl;
+		break;
+	case XMP_PLAYER_VOICES:
+		ret = p->virt.voices > 0 ? p->virt.voices : SMIX_NUMVOC;
+		break;
+	case XMP_PLAYER_ASYNC:
+		ret = p->queue != NULL;
+		break;
 	}
 
 	return ret;
 }
 
+/* Apply queued commands, called by the player thread before each frame */
+void control_drain(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	struct control_queue *q = p->queue;
+	struct control_cmd *cmd;
+	unsigned int tail, head;
+
+	if (q == NULL)
+		return;
+
+	tail = q->tail;
+	head = LOAD_ACQUIRE(q->head);
+
+	for (; tail != head; tail++) {
+		cmd = &q->cmd[tail & (QUEUE_SIZE - 1)];
+
+		switch (cmd->type) {
+		case CMD_MUTE:
+			p->channel_mute[cmd->arg1] = cmd->arg2;
+			break;
+		case CMD_VOL:
+			p->channel_vol[cmd->arg1] = cmd->arg2;
+			break;
+		case CMD_POSITION:
+			set_position(ctx, cmd->arg1, 0);
+			break;
+		case CMD_NEXT:
+			next_position(ctx);
+			break;
+		case CMD_PREV:
+			prev_position(ctx);
+			break;
+		case CMD_STOP:
+			p->pos = -2;
+			break;
+		case CMD_RESTART:
+			p->pos = -1;
+			break;
+		case CMD_SEEK:
+			seek_time(ctx, cmd->arg1);
+			break;
+		case CMD_PLAYER:
+			*player_parm(ctx, cmd->arg1, cmd->arg2) = cmd->arg2;
+			break;
+		case CMD_INJECT:
+			memcpy(&p->inject_event[cmd->arg1], &cmd->event,
+						sizeof(struct xmp_event));
+			p->inject_event[cmd->arg1]._flag = 1;
+			break;
+		case CMD_INJECT_AT:
+			queue_timed_event(ctx, cmd->arg1, &cmd->event,
+								cmd->arg2);
+			break;
+		}
+	}
+
+	STORE_RELEASE(q->tail, tail);
+}
+
 char **xmp_get_format_list()
 {
 	return format_list();
 }
 
-void xmp_inject_event(xmp_context opaque, int channel, struct xmp_event *e)
+int xmp_inject_event(xmp_context opaque, int channel, struct xmp_event *e)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
 
+	if (p->queue != NULL) {
+		if (queue_cmd(p->queue, CMD_INJECT, channel, 0, e) < 0)
+			return -XMP_ERROR_STATE;
+		return 0;
+	}
+
 	memcpy(&p->inject_event[channel], e, sizeof(struct xmp_event));
 	p->inject_event[channel]._flag = 1;
+
+	return 0;
+}
+
+int xmp_inject_event_at(xmp_context opaque, int channel, struct xmp_event *e,
+			int offset)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+
+	if (channel < 0 || channel >= XMP_MAX_CHANNELS || offset < 0)
+		return -XMP_ERROR_INVALID;
+
+	if (p->queue != NULL) {
+		if (queue_cmd(p->queue, CMD_INJECT_AT, channel, offset, e) < 0)
+			return -XMP_ERROR_STATE;
+		return 0;
+	}
+
+	if (queue_timed_event(ctx, channel, e, offset) < 0)
+		return -XMP_ERROR_STATE;
+
+	return 0;
 }
 
 int xmp_set_instrument_path(xmp_context opaque, char *path)
@@ -308,3 +693,23 @@ int xmp_set_instrument_path(xmp_context opaque, char *path)
 
 	return 0;
 }
+
+int xmp_set_allocator(xmp_context opaque, void *(*alloc)(size_t, void *),
+		      void (*dealloc)(void *, void *), void *arg)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct module_data *m = &ctx->m;
+
+	/* Blocks in use must be returned to the allocator they came from */
+	if (m->arena.block != NULL || m->track_arena.block != NULL)
+		return -XMP_ERROR_INVALID;
+
+	if ((alloc == NULL) != (dealloc == NULL))
+		return -XMP_ERROR_INVALID;
+
+	m->arena.alloc = m->track_arena.alloc = alloc;
+	m->arena.free = m->track_arena.free = dealloc;
+	m->arena.arg = m->track_arena.arg = arg;
+
+	return 0;
+}
@@ -0,0 +1,67 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2013 Claudio Matsuoka and Hipolito Carraro Jr
+ *
+ * This file is part of the Extended Module Player and is distributed
+ * under the terms of the GNU Lesser General Public License. See COPYING.LIB
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include "depacker.h"
+
+extern const struct depacker gzip_depacker;
+extern const struct depacker compress_depacker;
+
+const struct depacker *const depacker_list[] = {
+	&gzip_depacker,
+	&compress_depacker,
+	NULL
+};
+
+/* Make room for at least n more bytes in the output buffer */
+int depack_grow(struct depack_buffer *b, long n)
+{
+	uint8 *data;
+	long alloc;
+
+	if (n > DEPACK_MAX_SIZE - b->size)
+		return -1;
+
+	if (b->size + n <= b->alloc)
+		return 0;
+
+	alloc = b->alloc > 0 ? b->alloc : 65536;
+	while (alloc < b->size + n) {
+		alloc *= 2;
+	}
+	if (alloc > DEPACK_MAX_SIZE)
+		alloc = DEPACK_MAX_SIZE;
+
+	if ((data = realloc(b->data, alloc)) == NULL)
+		return -1;
+
+	b->data = data;
+	b->alloc = alloc;
+
+	return 0;
+}
+
+/* CRC-32 as used by gzip and zip, four bits at a time */
+uint32 depack_crc32(uint32 crc, const uint8 *buf, long len)
+{
+	static const uint32 table[16] = {
+		0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+		0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+		0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+		0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+	};
+
+	crc = ~crc;
+	while (len--) {
+		crc ^= *buf++;
+		crc = (crc >> 4) ^ table[crc & 0x0f];
+		crc = (crc >> 4) ^ table[crc & 0x0f];
+	}
+
+	return ~crc;
+}
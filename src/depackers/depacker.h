@@ -0,0 +1,37 @@
+#ifndef XMP_DEPACKER_H
+#define XMP_DEPACKER_H
+
+#include "common.h"
+
+/* Depackers decompress a whole file held in memory into a new buffer,
+ * without temporary files or external programs. The test function gets
+ * the first bytes of the file, at least DEPACK_HEADER_SIZE if the file
+ * is that large.
+ */
+
+#define DEPACK_HEADER_SIZE	16
+
+/* Depacked files larger than this are refused, so that a small packed
+ * file can't make us allocate an unbounded amount of memory
+ */
+#define DEPACK_MAX_SIZE		(128L << 20)
+
+struct depack_buffer {
+	uint8 *data;
+	long size;		/* bytes written */
+	long alloc;		/* bytes allocated */
+};
+
+struct depacker {
+	const char *name;
+	int (*const test)(const uint8 *, long);
+	int (*const depack)(const uint8 *, long, struct depack_buffer *);
+};
+
+extern const struct depacker *const depacker_list[];
+
+int	depack_grow	(struct depack_buffer *, long);
+int	inflate_mem	(const uint8 *, long, long *, struct depack_buffer *);
+uint32	depack_crc32	(uint32, const uint8 *, long);
+
+#endif
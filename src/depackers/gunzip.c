@@ -0,0 +1,81 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2013 Claudio Matsuoka and Hipolito Carraro Jr
+ *
+ * This file is part of the Extended Module Player and is distributed
+ * under the terms of the GNU Lesser General Public License. See COPYING.LIB
+ * for more information.
+ */
+
+#include "depacker.h"
+
+/* gzip file format (RFC 1952) */
+
+#define FHCRC		0x02
+#define FEXTRA		0x04
+#define FNAME		0x08
+#define FCOMMENT	0x10
+
+static int test_gzip(const uint8 *b, long size)
+{
+	return size >= 10 && b[0] == 31 && b[1] == 139 && b[2] == 8;
+}
+
+/* Skip a zero-terminated string */
+static long skip_string(const uint8 *in, long size, long pos)
+{
+	while (pos < size && in[pos] != 0)
+		pos++;
+
+	return pos + 1;
+}
+
+static int depack_gzip(const uint8 *in, long size, struct depack_buffer *out)
+{
+	long pos = 0, len, start;
+	uint32 crc, isize;
+	int flags;
+
+	/* Concatenated members are depacked as a single file */
+	while (pos < size && test_gzip(in + pos, size - pos)) {
+		flags = in[pos + 3];
+		pos += 10;
+
+		if (flags & FEXTRA) {
+			if (pos + 2 > size)
+				return -1;
+			pos += 2 + readmem16l((uint8 *)in + pos);
+		}
+		if (flags & FNAME)
+			pos = skip_string(in, size, pos);
+		if (flags & FCOMMENT)
+			pos = skip_string(in, size, pos);
+		if (flags & FHCRC)
+			pos += 2;
+		if (pos >= size)
+			return -1;
+
+		start = out->size;
+		if (inflate_mem(in + pos, size - pos, &len, out) < 0)
+			return -1;
+		pos += len;
+
+		if (pos + 8 > size)
+			return -1;
+		crc = readmem32l((uint8 *)in + pos);
+		isize = readmem32l((uint8 *)in + pos + 4);
+		pos += 8;
+
+		if (crc != depack_crc32(0, out->data + start, out->size - start))
+			return -1;
+		if (isize != (uint32)(out->size - start))
+			return -1;
+	}
+
+	return 0;
+}
+
+const struct depacker gzip_depacker = {
+	"gzip",
+	test_gzip,
+	depack_gzip
+};
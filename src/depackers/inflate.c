@@ -0,0 +1,325 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2013 Claudio Matsuoka and Hipolito Carraro Jr
+ *
+ * This file is part of the Extended Module Player and is distributed
+ * under the terms of the GNU Lesser General Public License. See COPYING.LIB
+ * for more information.
+ */
+
+#include <string.h>
+#include "depacker.h"
+
+/* Decoder for raw deflate streams (RFC 1951). Huffman codes are decoded
+ * bit by bit using the canonical code counts, which is compact and fast
+ * enough for module sized files.
+ */
+
+#define MAX_BITS	15
+#define MAX_LCODES	286
+#define MAX_DCODES	30
+#define FIX_LCODES	288
+
+struct inflate_state {
+	const uint8 *in;
+	long inlen;
+	long inpos;
+	uint32 bitbuf;
+	int bitcnt;
+	int err;
+	struct depack_buffer *out;
+};
+
+struct huffman {
+	short count[MAX_BITS + 1];
+	short symbol[FIX_LCODES];
+};
+
+static const short len_base[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const short len_extra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const short dist_base[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+	8193, 12289, 16385, 24577
+};
+
+static const short dist_extra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static int get_bits(struct inflate_state *s, int n)
+{
+	uint32 val = s->bitbuf;
+
+	while (s->bitcnt < n) {
+		if (s->inpos >= s->inlen) {
+			s->err = 1;
+			return 0;
+		}
+		val |= (uint32)s->in[s->inpos++] << s->bitcnt;
+		s->bitcnt += 8;
+	}
+
+	s->bitbuf = val >> n;
+	s->bitcnt -= n;
+
+	return val & ((1U << n) - 1);
+}
+
+/* Build the decoding table from the code lengths. Incomplete codes are
+ * accepted, as a single distance code is valid.
+ */
+static int build(struct huffman *h, const uint8 *length, int n)
+{
+	short offs[MAX_BITS + 1];
+	int i, left;
+
+	memset(h->count, 0, sizeof (h->count));
+	for (i = 0; i < n; i++) {
+		h->count[length[i]]++;
+	}
+
+	left = 1;
+	for (i = 1; i <= MAX_BITS; i++) {
+		left <<= 1;
+		left -= h->count[i];
+		if (left < 0)
+			return -1;	/* over-subscribed */
+	}
+
+	offs[1] = 0;
+	for (i = 1; i < MAX_BITS; i++) {
+		offs[i + 1] = offs[i] + h->count[i];
+	}
+
+	for (i = 0; i < n; i++) {
+		if (length[i] != 0)
+			h->symbol[offs[length[i]]++] = i;
+	}
+
+	return 0;
+}
+
+static int decode(struct inflate_state *s, struct huffman *h)
+{
+	int code = 0, first = 0, index = 0;
+	int len, count;
+
+	for (len = 1; len <= MAX_BITS; len++) {
+		code |= get_bits(s, 1);
+		if (s->err)
+			return -1;
+		count = h->count[len];
+		if (code - first < count)
+			return h->symbol[index + (code - first)];
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+
+	return -1;
+}
+
+static int stored(struct inflate_state *s)
+{
+	struct depack_buffer *out = s->out;
+	long len;
+
+	/* Discard the remaining bits of the current byte */
+	s->bitbuf = 0;
+	s->bitcnt = 0;
+
+	if (s->inpos + 4 > s->inlen)
+		return -1;
+
+	len = s->in[s->inpos] | (s->in[s->inpos + 1] << 8);
+	if ((s->in[s->inpos + 2] ^ 0xff) != (len & 0xff) ||
+	    (s->in[s->inpos + 3] ^ 0xff) != (len >> 8))
+		return -1;
+	s->inpos += 4;
+
+	if (s->inpos + len > s->inlen || depack_grow(out, len) < 0)
+		return -1;
+
+	memcpy(out->data + out->size, s->in + s->inpos, len);
+	out->size += len;
+	s->inpos += len;
+
+	return 0;
+}
+
+static int codes(struct inflate_state *s, struct huffman *lencode,
+		 struct huffman *distcode)
+{
+	struct depack_buffer *out = s->out;
+	int sym, len, i;
+	long dist;
+
+	for (;;) {
+		if ((sym = decode(s, lencode)) < 0)
+			return -1;
+
+		if (sym < 256) {
+			if (depack_grow(out, 1) < 0)
+				return -1;
+			out->data[out->size++] = sym;
+		} else if (sym == 256) {
+			return 0;
+		} else {
+			sym -= 257;
+			if (sym >= 29)
+				return -1;
+			len = len_base[sym] + get_bits(s, len_extra[sym]);
+
+			if ((sym = decode(s, distcode)) < 0 || sym >= 30)
+				return -1;
+			dist = dist_base[sym] + get_bits(s, dist_extra[sym]);
+			if (s->err || dist > out->size)
+				return -1;
+
+			if (depack_grow(out, len) < 0)
+				return -1;
+
+			/* Copies may overlap, byte by byte */
+			for (i = 0; i < len; i++) {
+				out->data[out->size] = out->data[out->size - dist];
+				out->size++;
+			}
+		}
+	}
+}
+
+static int fixed(struct inflate_state *s)
+{
+	struct huffman lencode, distcode;
+	uint8 length[FIX_LCODES];
+	int i;
+
+	for (i = 0; i < 144; i++)
+		length[i] = 8;
+	for (; i < 256; i++)
+		length[i] = 9;
+	for (; i < 280; i++)
+		length[i] = 7;
+	for (; i < FIX_LCODES; i++)
+		length[i] = 8;
+	build(&lencode, length, FIX_LCODES);
+
+	for (i = 0; i < MAX_DCODES; i++)
+		length[i] = 5;
+	build(&distcode, length, MAX_DCODES);
+
+	return codes(s, &lencode, &distcode);
+}
+
+static int dynamic(struct inflate_state *s)
+{
+	static const uint8 order[19] = {
+		16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+	};
+	struct huffman lencode, distcode;
+	uint8 length[MAX_LCODES + MAX_DCODES];
+	int nlen, ndist, ncode;
+	int i, sym, len, rep;
+
+	nlen = get_bits(s, 5) + 257;
+	ndist = get_bits(s, 5) + 1;
+	ncode = get_bits(s, 4) + 4;
+	if (s->err || nlen > MAX_LCODES || ndist > MAX_DCODES)
+		return -1;
+
+	for (i = 0; i < 19; i++) {
+		length[order[i]] = i < ncode ? get_bits(s, 3) : 0;
+	}
+	if (s->err || build(&lencode, length, 19) < 0)
+		return -1;
+
+	for (i = 0; i < nlen + ndist; ) {
+		if ((sym = decode(s, &lencode)) < 0)
+			return -1;
+
+		if (sym < 16) {
+			length[i++] = sym;
+			continue;
+		}
+
+		len = 0;
+		if (sym == 16) {
+			if (i == 0)
+				return -1;
+			len = length[i - 1];
+			rep = 3 + get_bits(s, 2);
+		} else if (sym == 17) {
+			rep = 3 + get_bits(s, 3);
+		} else {
+			rep = 11 + get_bits(s, 7);
+		}
+
+		if (s->err || i + rep > nlen + ndist)
+			return -1;
+		while (rep--) {
+			length[i++] = len;
+		}
+	}
+
+	if (length[256] == 0)
+		return -1;	/* no end of block code */
+
+	if (build(&lencode, length, nlen) < 0)
+		return -1;
+	if (build(&distcode, length + nlen, ndist) < 0)
+		return -1;
+
+	return codes(s, &lencode, &distcode);
+}
+
+/* Decompress a raw deflate stream, appending to the output buffer. The
+ * number of input bytes used is returned in inlen.
+ */
+int inflate_mem(const uint8 *in, long size, long *inlen,
+		struct depack_buffer *out)
+{
+	struct inflate_state s;
+	int last, type, ret;
+
+	memset(&s, 0, sizeof (s));
+	s.in = in;
+	s.inlen = size;
+	s.out = out;
+
+	do {
+		last = get_bits(&s, 1);
+		type = get_bits(&s, 2);
+		if (s.err)
+			return -1;
+
+		switch (type) {
+		case 0:
+			ret = stored(&s);
+			break;
+		case 1:
+			ret = fixed(&s);
+			break;
+		case 2:
+			ret = dynamic(&s);
+			break;
+		default:
+			ret = -1;
+		}
+
+		if (ret < 0 || s.err)
+			return -1;
+	} while (!last);
+
+	*inlen = s.inpos;
+
+	return 0;
+}
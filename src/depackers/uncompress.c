@@ -0,0 +1,152 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2013 Claudio Matsuoka and Hipolito Carraro Jr
+ *
+ * This file is part of the Extended Module Player and is distributed
+ * under the terms of the GNU Lesser General Public License. See COPYING.LIB
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include "depacker.h"
+
+/* Unix compress (.Z) LZW decoder. Codes are written in groups of eight,
+ * and when the code size changes or the table is cleared the rest of the
+ * current group is padding, as in the original compress.
+ */
+
+#define INIT_BITS	9
+#define MAX_BITS	16
+#define BLOCK_MODE	0x80
+#define BIT_MASK	0x1f
+#define CLEAR		256
+#define FIRST		257
+
+struct lzw_table {
+	uint16 prefix[1 << MAX_BITS];
+	uint8 suffix[1 << MAX_BITS];
+	uint8 stack[1 << MAX_BITS];
+};
+
+static int test_compress(const uint8 *b, long size)
+{
+	return size >= 3 && b[0] == 31 && b[1] == 157;
+}
+
+static int depack_compress(const uint8 *in, long size,
+			   struct depack_buffer *out)
+{
+	struct lzw_table *t;
+	int maxbits, block_mode, n_bits, maxcode, maxmaxcode;
+	int code, oldcode, incode, finchar, free_ent, count;
+	long pos, end, sp;
+	int i, ret = -1;
+
+	maxbits = in[2] & BIT_MASK;
+	block_mode = in[2] & BLOCK_MODE;
+	if (maxbits < INIT_BITS || maxbits > MAX_BITS)
+		return -1;
+
+	if ((t = malloc(sizeof (struct lzw_table))) == NULL)
+		return -1;
+
+	for (i = 0; i < 256; i++) {
+		t->prefix[i] = 0;
+		t->suffix[i] = i;
+	}
+
+	maxmaxcode = 1 << maxbits;
+	n_bits = INIT_BITS;
+	maxcode = (1 << n_bits) - 1;
+	free_ent = block_mode ? FIRST : 256;
+	oldcode = -1;
+	finchar = 0;
+	count = 0;
+	pos = 3 << 3;
+	end = size << 3;
+
+	while (pos + n_bits <= end) {
+		if (free_ent > maxcode) {
+			/* Skip the rest of the group */
+			pos += ((8 - count % 8) % 8) * n_bits;
+			count = 0;
+			n_bits++;
+			maxcode = n_bits == maxbits ?
+					maxmaxcode : (1 << n_bits) - 1;
+			continue;
+		}
+
+		i = pos >> 3;
+		code = in[i];
+		if (i + 1 < size)
+			code |= in[i + 1] << 8;
+		if (i + 2 < size)
+			code |= in[i + 2] << 16;
+		code = (code >> (pos & 7)) & ((1 << n_bits) - 1);
+		pos += n_bits;
+		count++;
+
+		if (oldcode == -1) {
+			if (code >= 256)
+				goto err;
+			if (depack_grow(out, 1) < 0)
+				goto err;
+			out->data[out->size++] = finchar = oldcode = code;
+			continue;
+		}
+
+		if (code == CLEAR && block_mode) {
+			pos += ((8 - count % 8) % 8) * n_bits;
+			count = 0;
+			free_ent = FIRST - 1;
+			n_bits = INIT_BITS;
+			maxcode = (1 << n_bits) - 1;
+			continue;
+		}
+
+		incode = code;
+		sp = 1 << MAX_BITS;
+
+		if (code >= free_ent) {
+			if (code > free_ent)
+				goto err;
+			t->stack[--sp] = finchar;
+			code = oldcode;
+		}
+
+		while (code >= 256) {
+			if (sp <= 0)
+				goto err;
+			t->stack[--sp] = t->suffix[code];
+			code = t->prefix[code];
+		}
+		if (sp <= 0)
+			goto err;
+		t->stack[--sp] = finchar = t->suffix[code];
+
+		if (depack_grow(out, (1 << MAX_BITS) - sp) < 0)
+			goto err;
+		while (sp < (1 << MAX_BITS)) {
+			out->data[out->size++] = t->stack[sp++];
+		}
+
+		if (free_ent < maxmaxcode) {
+			t->prefix[free_ent] = oldcode;
+			t->suffix[free_ent] = finchar;
+			free_ent++;
+		}
+
+		oldcode = incode;
+	}
+
+	ret = 0;
+
+    err:
+	free(t);
+	return ret;
+}
+
+const struct depacker compress_depacker = {
+	"compress",
+	test_compress,
+	depack_compress
+};
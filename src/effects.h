@@ -117,4 +117,7 @@
 #define FX_SYNTH_E	0xfe
 #define FX_SYNTH_F	0xff
 
+#define IS_TONEPORTA(x) ((x) == FX_TONEPORTA || (x) == FX_TONE_VSLIDE \
+		|| (x) == FX_PER_TPORTA)
+
 #endif /* XMP_EFFECTS_H */
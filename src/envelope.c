@@ -3,86 +3,175 @@
 
 /* Envelope */
 
-int get_envelope(struct xmp_envelope *env, int x, int def)
+static int valid_point(int n, int npt)
+{
+	return n >= 0 && n < npt;
+}
+
+static int compile_envelope(struct module_data *m, struct envelope_table *t,
+			    struct xmp_envelope *env)
 {
-	int x1, x2, y1, y2;
 	int16 *data = env->data;
-	int index;
+	int i, npt;
 
-	if (~env->flg & XMP_ENVELOPE_ON)
-		return def;
+	t->flg = env->flg;
+	t->npt = npt = env->npt;
 
-	if (env->npt <= 0)
-		return 64;
+	if (~env->flg & XMP_ENVELOPE_ON || npt <= 0)
+		return 0;
 
-	index = (env->npt - 1) * 2;
+	if (npt > XMP_MAX_ENV_POINTS)
+		t->npt = npt = XMP_MAX_ENV_POINTS;
 
-	x1 = data[index];		/* last node */
-	if (x >= x1 || index == 0) { 
-		return data[index + 1];
+	t->last_x = data[(npt - 1) * 2];
+	t->last_y = data[(npt - 1) * 2 + 1];
+
+	if (valid_point(env->lps, npt) && valid_point(env->lpe, npt)) {
+		t->has_loop = env->flg & XMP_ENVELOPE_LOOP;
+		t->lps_x = data[env->lps << 1];
+		t->lpe_x = data[env->lpe << 1];
 	}
 
-	do {
-		index -= 2;
-		x1 = data[index];
-	} while (index > 0 && x1 > x);
+	/* Sustain points may be past the last node, as in the original
+	 * player, as long as they are inside the node array
+	 */
+	if (valid_point(env->sus, XMP_MAX_ENV_POINTS) &&
+	    valid_point(env->sue, XMP_MAX_ENV_POINTS)) {
+		t->has_sus = env->flg & XMP_ENVELOPE_SUS;
+		t->sus_x = data[env->sus << 1];
+		t->sue_x = data[env->sue << 1];
+	}
+	t->sus_lpe = env->sus == env->lpe;
 
-	/* interpolate */
-	y1 = data[index + 1];
-	x2 = data[index + 2];
+	if (npt < 2)
+		return 0;
 
-	if (env->flg & XMP_ENVELOPE_LOOP && index == (env->lpe << 1)) {
-		index = (env->lps - 1) * 2;
-	}
+	t->seg = arena_malloc(&m->arena,
+			sizeof (struct envelope_segment) * (npt - 1));
+	if (t->seg == NULL)
+		return -1;
+
+	t->sorted = 1;
+	for (i = 0; i < npt - 1; i++) {
+		struct envelope_segment *seg = &t->seg[i];
+		int y2 = data[i * 2 + 3];
 
-	y2 = data[index + 3];
+		/* Interpolate from the loop end to the loop start */
+		if (env->flg & XMP_ENVELOPE_LOOP && i == env->lpe &&
+		    valid_point(env->lps, XMP_MAX_ENV_POINTS)) {
+			y2 = data[(env->lps << 1) + 1];
+		}
+
+		seg->x1 = data[i * 2];
+		seg->x2 = data[i * 2 + 2];
+		seg->y1 = data[i * 2 + 1];
+		seg->dy = y2 - seg->y1;
+
+		if (seg->x2 < seg->x1)
+			t->sorted = 0;
+	}
 
-	return ((y2 - y1) * (x - x1) / (x2 - x1)) + y1;
+	return 0;
 }
 
+int compile_envelopes(struct module_data *m)
+{
+	struct xmp_module *mod = &m->mod;
+	int i;
+
+	m->xxe = arena_calloc(&m->arena, mod->ins > 0 ? mod->ins : 1,
+					sizeof (struct instrument_envelopes));
+	if (m->xxe == NULL)
+		return -1;
+
+	for (i = 0; i < mod->ins; i++) {
+		struct xmp_instrument *xxi = &mod->xxi[i];
+		struct instrument_envelopes *xxe = &m->xxe[i];
+
+		if (compile_envelope(m, &xxe->aei, &xxi->aei) < 0)
+			return -1;
+		if (compile_envelope(m, &xxe->pei, &xxi->pei) < 0)
+			return -1;
+		if (compile_envelope(m, &xxe->fei, &xxi->fei) < 0)
+			return -1;
+	}
+
+	return 0;
+}
 
-int update_envelope(struct xmp_envelope *ei, int x, int release)
+/* The cursor holds the segment used in the previous tick. Envelope ticks
+ * only move forward one step at a time, or jump back to a loop point, so
+ * the cursor is moved at most once in most ticks.
+ */
+int get_envelope(struct envelope_table *t, int x, int def, uint8 *cursor)
 {
-	int16 *env = ei->data;
-	int has_loop, has_sus;
+	struct envelope_segment *seg;
+	int s;
+
+	if (~t->flg & XMP_ENVELOPE_ON)
+		return def;
+
+	if (t->npt <= 0)
+		return 64;
+
+	if (x >= t->last_x || t->npt == 1)
+		return t->last_y;
+
+	if (t->sorted) {
+		s = *cursor;
+		if (s >= t->npt - 1 || x < t->seg[s].x1)
+			s = 0;
+		while (x >= t->seg[s].x2)
+			s++;
+		*cursor = s;
+	} else {
+		/* Unordered nodes, search backwards from the last node */
+		s = t->npt - 1;
+		do {
+			s--;
+		} while (s > 0 && t->seg[s].x1 > x);
+	}
 
+	/* interpolate */
+	seg = &t->seg[s];
+	if (seg->x2 == seg->x1)
+		return seg->y1;
+
+	return (seg->dy * (x - seg->x1) / (seg->x2 - seg->x1)) + seg->y1;
+}
+
+
+int update_envelope(struct envelope_table *t, int x, int release)
+{
 	if (x < 0xffff)	{	/* increment tick */
 		x++;
 	}
 
-	if (~ei->flg & XMP_ENVELOPE_ON) {
+	if (~t->flg & XMP_ENVELOPE_ON) {
 		return x;
 	}
 
-	if (ei->npt <= 0) {
+	if (t->npt <= 0) {
 		return x;
 	}
 
-	if (ei->lps >= ei->npt || ei->lpe >= ei->npt) {
-		has_loop = 0;
-	} else {
-		has_loop = ei->flg & XMP_ENVELOPE_LOOP;
-	}
-
-	has_sus = ei->flg & XMP_ENVELOPE_SUS;
-
-	if (ei->flg & XMP_ENVELOPE_SLOOP) {
-		if (!release && has_sus) {
-			if (x > env[ei->sue << 1])
-				x = env[ei->sus << 1];
-		} else if (has_loop) {
-			if (x > env[ei->lpe << 1])
-				x = env[ei->lps << 1];
+	if (t->flg & XMP_ENVELOPE_SLOOP) {
+		if (!release && t->has_sus) {
+			if (x > t->sue_x)
+				x = t->sus_x;
+		} else if (t->has_loop) {
+			if (x > t->lpe_x)
+				x = t->lps_x;
 		}
 	} else {
-		if (!release && has_sus && x > env[ei->sus << 1]) {
+		if (!release && t->has_sus && x > t->sus_x) {
 			/* stay in the sustain point */
-			x = env[ei->sus << 1];
+			x = t->sus_x;
 		}
 
-		if (has_loop && x > env[ei->lpe << 1]) {
-	    		if (!(release && has_sus && ei->sus == ei->lpe))
-				x = env[ei->lps << 1];
+		if (t->has_loop && x > t->lpe_x) {
+			if (!(release && t->has_sus && t->sus_lpe))
+				x = t->lps_x;
 		}
 	}
 
@@ -91,17 +180,16 @@ int update_envelope(struct xmp_envelope *ei, int x, int release)
 
 
 /* Returns: 0 if do nothing, <0 to reset channel, >0 if has fade */
-int check_envelope_fade(struct xmp_envelope *ei, int x)
+int check_envelope_fade(struct envelope_table *t, int x)
 {
-	int16 *env = ei->data;
-	int index;
+	if (~t->flg & XMP_ENVELOPE_ON)
+		return 0;
 
-	if (~ei->flg & XMP_ENVELOPE_ON)
+	if (t->npt <= 0)
 		return 0;
 
-	index = (ei->npt - 1) * 2;		/* last node */
-	if (x > env[index]) {
-		if (env[index + 1] == 0)
+	if (x > t->last_x) {
+		if (t->last_y == 0)
 			return -1;
 		else
 			return 1;
@@ -109,4 +197,3 @@ int check_envelope_fade(struct xmp_envelope *ei, int x)
 
 	return 0;
 }
-
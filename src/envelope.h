@@ -3,8 +3,38 @@
 
 /* Envelope */
 
-int get_envelope(struct xmp_envelope *, int, int);
-int update_envelope(struct xmp_envelope *, int, int);
-int check_envelope_fade(struct xmp_envelope *, int);
+/* Envelopes are compiled at load time into tables of segments between
+ * consecutive nodes, and loop and sustain points are resolved to ticks.
+ * Each channel keeps the current segment of its envelopes as a cursor,
+ * so evaluating an envelope doesn't need to search the node list.
+ */
+
+struct envelope_segment {
+	int x1, x2;		/* segment start and end ticks */
+	int y1, dy;		/* start value and rise */
+};
+
+struct envelope_table {
+	int flg;
+	int npt;		/* number of nodes */
+	int sorted;		/* node ticks don't decrease */
+	int last_x, last_y;	/* last node */
+	int has_loop, has_sus;
+	int sus_lpe;		/* sustain point is the loop end */
+	int lps_x, lpe_x;	/* loop start and end ticks */
+	int sus_x, sue_x;	/* sustain start and end ticks */
+	struct envelope_segment *seg;
+};
+
+struct instrument_envelopes {
+	struct envelope_table aei;
+	struct envelope_table pei;
+	struct envelope_table fei;
+};
+
+int compile_envelopes(struct module_data *);
+int get_envelope(struct envelope_table *, int, int, uint8 *);
+int update_envelope(struct envelope_table *, int, int);
+int check_envelope_fade(struct envelope_table *, int);
 
 #endif
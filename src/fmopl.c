@@ -35,6 +35,7 @@
  * Modified for xmp by Claudio Matsuoka, 2001-2012
  * - redefine inline
  * - don't use static state
+ * - build the common tables once and share them between chips
  * - buffer format changes
  */
 
@@ -48,6 +49,10 @@
 #include <math.h>
 #include "fmopl.h"
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 #ifndef PI
 #define PI 3.14159265358979323846
 #endif
@@ -190,24 +195,23 @@ static const INT32 SL_TABLE[16]={
 };
 #undef SC
 
-#if 0
-#define TL_MAX (EG_ENT*2) /* limit(tl + ksr + envelope) + sinwave */
+/* Tables shared by all chips, see OPL_InitTable() */
+
 /* TotalLevel : 48 24 12  6  3 1.5 0.75 (dB) */
 /* TL_TABLE[ 0      to TL_MAX          ] : plus  section */
 /* TL_TABLE[ TL_MAX to TL_MAX+TL_MAX-1 ] : minus section */
-static INT32 *TL_TABLE;
+static INT32 TL_TABLE[TL_MAX*2];
 
 /* pointers to TL_TABLE with sinwave output offset */
-static INT32 **SIN_TABLE;
+static INT32 *SIN_TABLE[SIN_ENT*4];
 
 /* LFO table */
-static INT32 *AMS_TABLE;
-static INT32 *VIB_TABLE;
+static INT32 AMS_TABLE[AMS_ENT*2];
+static INT32 VIB_TABLE[VIB_ENT*2];
 
 /* envelope output curve table */
 /* attack + decay + OFF */
 static INT32 ENV_CURVE[2*EG_ENT+1];
-#endif
 
 /* multiple table */
 #define ML 2
@@ -302,7 +306,7 @@ INLINE void OPL_KEYOFF(OPL_SLOT *SLOT)
 		/* set envelope counter from envleope output */
 		SLOT->evm = ENV_MOD_RR;
 		if( !(SLOT->evc&EG_DST) )
-			/*SLOT->evc = (ST->ENV_CURVE[SLOT->evc>>ENV_BITS]<<ENV_BITS) + EG_DST; */
+			/*SLOT->evc = (ENV_CURVE[SLOT->evc>>ENV_BITS]<<ENV_BITS) + EG_DST; */
 			SLOT->evc = EG_DST;
 		SLOT->eve = EG_DED;
 		SLOT->evs = SLOT->evsr;
@@ -345,7 +349,7 @@ INLINE UINT32 OPL_CALC_SLOT( OPL_SLOT *SLOT, OPL_STATE *ST )
 		}
 	}
 	/* calcrate envelope */
-	return SLOT->TLL+ST->ENV_CURVE[SLOT->evc>>ENV_BITS]+(SLOT->ams ? ST->ams : 0);
+	return SLOT->TLL+ENV_CURVE[SLOT->evc>>ENV_BITS]+(SLOT->ams ? ST->ams : 0);
 }
 
 /* set algorythm connection */
@@ -602,65 +606,44 @@ static void init_timetables( FM_OPL *OPL , int ARRATE , int DRRATE )
 }
 
 /* ---------- generic table initialize ---------- */
-static int OPLOpenTable( OPL_STATE *ST )
+static void OPLOpenTable( void )
 {
 	int s,t;
 	double rate;
 	int i,j;
 	double pom;
 
-	/* allocate dynamic tables */
-	if( (ST->TL_TABLE = malloc(TL_MAX*2*sizeof(INT32))) == NULL)
-		return 0;
-	if( (ST->SIN_TABLE = malloc(SIN_ENT*4 *sizeof(INT32 *))) == NULL)
-	{
-		free(ST->TL_TABLE);
-		return 0;
-	}
-	if( (ST->AMS_TABLE = malloc(AMS_ENT*2 *sizeof(INT32))) == NULL)
-	{
-		free(ST->TL_TABLE);
-		free(ST->SIN_TABLE);
-		return 0;
-	}
-	if( (ST->VIB_TABLE = malloc(VIB_ENT*2 *sizeof(INT32))) == NULL)
-	{
-		free(ST->TL_TABLE);
-		free(ST->SIN_TABLE);
-		free(ST->AMS_TABLE);
-		return 0;
-	}
 	/* make total level table */
 	for (t = 0;t < EG_ENT-1 ;t++){
 		rate = ((1<<TL_BITS)-1)/pow(10,EG_STEP*t/20);	/* dB -> voltage */
-		ST->TL_TABLE[       t] =  (int)rate;
-		ST->TL_TABLE[TL_MAX+t] = -ST->TL_TABLE[t];
-/*		LOG(LOG_INF,("TotalLevel(%3d) = %x\n",t,ST->TL_TABLE[t]));*/
+		TL_TABLE[       t] =  (int)rate;
+		TL_TABLE[TL_MAX+t] = -TL_TABLE[t];
+/*		LOG(LOG_INF,("TotalLevel(%3d) = %x\n",t,TL_TABLE[t]));*/
 	}
 	/* fill volume off area */
 	for ( t = EG_ENT-1; t < TL_MAX ;t++){
-		ST->TL_TABLE[t] = ST->TL_TABLE[TL_MAX+t] = 0;
+		TL_TABLE[t] = TL_TABLE[TL_MAX+t] = 0;
 	}
 
 	/* make sinwave table (total level offet) */
 	/* degree 0 = degree 180                   = off */
-	ST->SIN_TABLE[0] = ST->SIN_TABLE[SIN_ENT/2]         = &ST->TL_TABLE[EG_ENT-1];
+	SIN_TABLE[0] = SIN_TABLE[SIN_ENT/2]         = &TL_TABLE[EG_ENT-1];
 	for (s = 1;s <= SIN_ENT/4;s++){
 		pom = sin(2*PI*s/SIN_ENT); /* sin     */
 		pom = 20*log10(1/pom);	   /* decibel */
-		j = pom / EG_STEP;         /* ST->TL_TABLE steps */
+		j = pom / EG_STEP;         /* TL_TABLE steps */
 
         /* degree 0   -  90    , degree 180 -  90 : plus section */
-		ST->SIN_TABLE[          s] = ST->SIN_TABLE[SIN_ENT/2-s] = &ST->TL_TABLE[j];
+		SIN_TABLE[          s] = SIN_TABLE[SIN_ENT/2-s] = &TL_TABLE[j];
         /* degree 180 - 270    , degree 360 - 270 : minus section */
-		ST->SIN_TABLE[SIN_ENT/2+s] = ST->SIN_TABLE[SIN_ENT  -s] = &ST->TL_TABLE[TL_MAX+j];
+		SIN_TABLE[SIN_ENT/2+s] = SIN_TABLE[SIN_ENT  -s] = &TL_TABLE[TL_MAX+j];
 /*		LOG(LOG_INF,("sin(%3d) = %f:%f db\n",s,pom,(double)j * EG_STEP));*/
 	}
 	for (s = 0;s < SIN_ENT;s++)
 	{
-		ST->SIN_TABLE[SIN_ENT*1+s] = s<(SIN_ENT/2) ? ST->SIN_TABLE[s] : &ST->TL_TABLE[EG_ENT];
-		ST->SIN_TABLE[SIN_ENT*2+s] = ST->SIN_TABLE[s % (SIN_ENT/2)];
-		ST->SIN_TABLE[SIN_ENT*3+s] = (s/(SIN_ENT/4))&1 ? &ST->TL_TABLE[EG_ENT] : ST->SIN_TABLE[SIN_ENT*2+s];
+		SIN_TABLE[SIN_ENT*1+s] = s<(SIN_ENT/2) ? SIN_TABLE[s] : &TL_TABLE[EG_ENT];
+		SIN_TABLE[SIN_ENT*2+s] = SIN_TABLE[s % (SIN_ENT/2)];
+		SIN_TABLE[SIN_ENT*3+s] = (s/(SIN_ENT/4))&1 ? &TL_TABLE[EG_ENT] : SIN_TABLE[SIN_ENT*2+s];
 	}
 
 	/* envelope counter -> envelope output table */
@@ -669,40 +652,31 @@ static int OPLOpenTable( OPL_STATE *ST )
 		/* ATTACK curve */
 		pom = pow( ((double)(EG_ENT-1-i)/EG_ENT) , 8 ) * EG_ENT;
 		/* if( pom >= EG_ENT ) pom = EG_ENT-1; */
-		ST->ENV_CURVE[i] = (int)pom;
+		ENV_CURVE[i] = (int)pom;
 		/* DECAY ,RELEASE curve */
-		ST->ENV_CURVE[(EG_DST>>ENV_BITS)+i]= i;
+		ENV_CURVE[(EG_DST>>ENV_BITS)+i]= i;
 	}
 	/* off */
-	ST->ENV_CURVE[EG_OFF>>ENV_BITS]= EG_ENT-1;
+	ENV_CURVE[EG_OFF>>ENV_BITS]= EG_ENT-1;
 	/* make LFO ams table */
 	for (i=0; i<AMS_ENT; i++)
 	{
 		pom = (1.0+sin(2*PI*i/AMS_ENT))/2; /* sin */
-		ST->AMS_TABLE[i]         = (1.0/EG_STEP)*pom; /* 1dB   */
-		ST->AMS_TABLE[AMS_ENT+i] = (4.8/EG_STEP)*pom; /* 4.8dB */
+		AMS_TABLE[i]         = (1.0/EG_STEP)*pom; /* 1dB   */
+		AMS_TABLE[AMS_ENT+i] = (4.8/EG_STEP)*pom; /* 4.8dB */
 	}
 	/* make LFO vibrate table */
 	for (i=0; i<VIB_ENT; i++)
 	{
 		/* 100cent = 1seminote = 6% ?? */
 		pom = (double)VIB_RATE*0.06*sin(2*PI*i/VIB_ENT); /* +-100sect step */
-		ST->VIB_TABLE[i]         = VIB_RATE + (pom*0.07); /* +- 7cent */
-		ST->VIB_TABLE[VIB_ENT+i] = VIB_RATE + (pom*0.14); /* +-14cent */
-		/* LOG(LOG_INF,("vib %d=%d\n",i,ST->VIB_TABLE[VIB_ENT+i])); */
+		VIB_TABLE[i]         = VIB_RATE + (pom*0.07); /* +- 7cent */
+		VIB_TABLE[VIB_ENT+i] = VIB_RATE + (pom*0.14); /* +-14cent */
+		/* LOG(LOG_INF,("vib %d=%d\n",i,VIB_TABLE[VIB_ENT+i])); */
 	}
-	return 1;
 }
 
 
-static void OPLCloseTable( OPL_STATE *ST )
-{
-	free(ST->TL_TABLE);
-	free(ST->SIN_TABLE);
-	free(ST->AMS_TABLE);
-	free(ST->VIB_TABLE);
-}
-
 #ifndef XMP_OPL_CSM
 /* CSM Key Controll */
 INLINE void CSMKeyControll(OPL_CH *CH)
@@ -767,8 +741,8 @@ static void OPLWriteReg(FM_OPL *OPL, int r, int v)
 					int c;
 					for(c=0;c<OPL->max_ch;c++)
 					{
-						OPL->P_CH[c].SLOT[SLOT1].wavetable = &ST->SIN_TABLE[0];
-						OPL->P_CH[c].SLOT[SLOT2].wavetable = &ST->SIN_TABLE[0];
+						OPL->P_CH[c].SLOT[SLOT1].wavetable = &SIN_TABLE[0];
+						OPL->P_CH[c].SLOT[SLOT2].wavetable = &SIN_TABLE[0];
 					}
 				}
 			}
@@ -889,8 +863,8 @@ static void OPLWriteReg(FM_OPL *OPL, int r, int v)
 #ifdef XMP_OPL_RHYTHM
 			UINT8 rkey = OPL->rythm^v;
 #endif
-			OPL->ams_table = &ST->AMS_TABLE[v&0x80 ? AMS_ENT : 0];
-			OPL->vib_table = &ST->VIB_TABLE[v&0x40 ? VIB_ENT : 0];
+			OPL->ams_table = &AMS_TABLE[v&0x80 ? AMS_ENT : 0];
+			OPL->vib_table = &VIB_TABLE[v&0x40 ? VIB_ENT : 0];
 			OPL->rythm  = v&0x3f;
 
 #ifdef XMP_OPL_RHYTHM
@@ -1001,35 +975,46 @@ static void OPLWriteReg(FM_OPL *OPL, int r, int v)
 		if(OPL->wavesel)
 		{
 			/* LOG(LOG_INF,("OPL SLOT %d wave select %d\n",slot,v&3)); */
-			CH->SLOT[slot&1].wavetable = &ST->SIN_TABLE[(v&0x03)*SIN_ENT];
+			CH->SLOT[slot&1].wavetable = &SIN_TABLE[(v&0x03)*SIN_ENT];
 		}
 		return;
 	}
 }
 
-/* lock/unlock for common table */
-static int OPL_LockTable( OPL_STATE *ST )
+/* build the common tables once for all chips */
+#ifdef HAVE_PTHREAD_H
+static pthread_once_t table_once = PTHREAD_ONCE_INIT;
+#else
+static int table_done;
+#endif
+
+static void OPL_InitTable( void )
 {
-	ST->num_lock++;
-	if(ST->num_lock>1) return 0;
-	/* first time */
-	ST->cur_chip = NULL;
-	/* allocate total level table (128kb space) */
-	if( !OPLOpenTable(ST) )
-	{
-		ST->num_lock--;
-		return -1;
-	}
-	return 0;
+#ifdef HAVE_PTHREAD_H
+	pthread_once(&table_once, OPLOpenTable);
+#else
+	if(table_done) return;
+	OPLOpenTable();
+	table_done = 1;
+#endif
 }
 
-static void OPL_UnLockTable( OPL_STATE *ST )
+/* set up work pointers for this chip */
+static void OPL_InitState( FM_OPL *OPL )
 {
-	if(ST->num_lock) ST->num_lock--;
-	if(ST->num_lock) return;
-	/* last time */
-	ST->cur_chip = NULL;
-	OPLCloseTable(ST);
+	OPL_STATE *ST = &OPL->state;
+
+	/* channel pointers */
+	ST->S_CH = OPL->P_CH;
+	ST->E_CH = &ST->S_CH[9];
+	/* rythm slot */
+	ST->SLOT7_1 = &ST->S_CH[7].SLOT[SLOT1];
+	ST->SLOT7_2 = &ST->S_CH[7].SLOT[SLOT2];
+	ST->SLOT8_1 = &ST->S_CH[8].SLOT[SLOT1];
+	ST->SLOT8_2 = &ST->S_CH[8].SLOT[SLOT2];
+	/* LFO state */
+	ST->amsIncr = OPL->amsIncr;
+	ST->vibIncr = OPL->vibIncr;
 }
 
 #if (BUILD_YM3812 || BUILD_YM3526)
@@ -1048,22 +1033,9 @@ void YM3812UpdateOne(FM_OPL *OPL, FMSAMPLE *bk, int len, int vl, int vr, int st)
 	OPL_CH *CH,*R_CH;
 	OPL_STATE *ST = &OPL->state;
 
-	if( (void *)OPL != ST->cur_chip ){
-		ST->cur_chip = (void *)OPL;
-		/* channel pointers */
-		ST->S_CH = OPL->P_CH;
-		ST->E_CH = &ST->S_CH[9];
-		/* rythm slot */
-		ST->SLOT7_1 = &ST->S_CH[7].SLOT[SLOT1];
-		ST->SLOT7_2 = &ST->S_CH[7].SLOT[SLOT2];
-		ST->SLOT8_1 = &ST->S_CH[8].SLOT[SLOT1];
-		ST->SLOT8_2 = &ST->S_CH[8].SLOT[SLOT2];
-		/* LFO state */
-		ST->amsIncr = OPL->amsIncr;
-		ST->vibIncr = OPL->vibIncr;
-		ST->ams_table = OPL->ams_table;
-		ST->vib_table = OPL->vib_table;
-	}
+	/* LFO depth is set by register 0xbd */
+	ST->ams_table = OPL->ams_table;
+	ST->vib_table = OPL->vib_table;
 	R_CH = rythm ? &ST->S_CH[6] : ST->E_CH;
         while (len--) {
 		/* channel A         channel B         channel C      */
@@ -1117,22 +1089,8 @@ void Y8950UpdateOne(FM_OPL *OPL, void *buffer, int length)
 	/* setup DELTA-T unit */
 	YM_DELTAT_DECODE_PRESET(DELTAT);
 
-	if( (void *)OPL != ST->cur_chip ){
-		ST->cur_chip = (void *)OPL;
-		/* channel pointers */
-		ST->S_CH = OPL->P_CH;
-		ST->E_CH = &ST->S_CH[9];
-		/* rythm slot */
-		ST->SLOT7_1 = &ST->S_CH[7].SLOT[SLOT1];
-		ST->SLOT7_2 = &ST->S_CH[7].SLOT[SLOT2];
-		ST->SLOT8_1 = &ST->S_CH[8].SLOT[SLOT1];
-		ST->SLOT8_2 = &ST->S_CH[8].SLOT[SLOT2];
-		/* LFO state */
-		ST->amsIncr = OPL->amsIncr;
-		ST->vibIncr = OPL->vibIncr;
-		ams_table = OPL->ams_table;
-		vib_table = OPL->vib_table;
-	}
+	ams_table = OPL->ams_table;
+	vib_table = OPL->vib_table;
 	R_CH = rythm ? &ST->S_CH[6] : ST->E_CH;
     for( i=0; i < length ; i++ )
 	{
@@ -1166,7 +1124,6 @@ void Y8950UpdateOne(FM_OPL *OPL, void *buffer, int length)
 /* ---------- reset one of chip ---------- */
 void OPLResetChip(FM_OPL *OPL)
 {
-	OPL_STATE *ST = &OPL->state;
 	int c,s;
 	int i;
 
@@ -1187,7 +1144,7 @@ void OPLResetChip(FM_OPL *OPL)
 		for(s = 0 ; s < 2 ; s++ )
 		{
 			/* wave table */
-			CH->SLOT[s].wavetable = &ST->SIN_TABLE[0];
+			CH->SLOT[s].wavetable = &SIN_TABLE[0];
 			/* CH->SLOT[s].evm = ENV_MOD_RR; */
 			CH->SLOT[s].evc = EG_OFF;
 			CH->SLOT[s].eve = EG_OFF+1;
@@ -1229,10 +1186,8 @@ FM_OPL *OPLCreate(int type, int clock, int rate)
 	/* clear */
 	memset(ptr,0,state_size);
 	OPL        = (FM_OPL *)ptr; ptr+=sizeof(FM_OPL);
-	OPL->state.num_lock = 0;
-	OPL->state.cur_chip = NULL;
 
-	if( OPL_LockTable(&OPL->state) ==-1) return NULL;
+	OPL_InitTable();
 
 	OPL->P_CH  = (OPL_CH *)ptr; ptr+=sizeof(OPL_CH)*max_ch;
 #if BUILD_Y8950
@@ -1245,6 +1200,7 @@ FM_OPL *OPLCreate(int type, int clock, int rate)
 	OPL->max_ch = max_ch;
 	/* init grobal tables */
 	OPL_initalize(OPL);
+	OPL_InitState(OPL);
 	/* reset chip */
 	OPLResetChip(OPL);
 #ifdef OPL_OUTPUT_LOG
@@ -1278,7 +1234,6 @@ void OPLDestroy(FM_OPL *OPL)
 		opl_dbg_fp = NULL;
 	}
 #endif
-	OPL_UnLockTable(&OPL->state);
 	free(OPL);
 }
 
@@ -86,29 +86,14 @@ typedef struct fm_opl_channel {
 /* envelope output entries */
 #define EG_ENT   4096
 
-typedef struct fm_opl_state {
-#define TL_MAX (EG_ENT*2) /* limit(tl + ksr + envelope) + sinwave */
-	/* TotalLevel : 48 24 12  6  3 1.5 0.75 (dB) */
-	/* TL_TABLE[ 0      to TL_MAX          ] : plus  section */
-	/* TL_TABLE[ TL_MAX to TL_MAX+TL_MAX-1 ] : minus section */
-	INT32 *TL_TABLE;
-
-	/* pointers to TL_TABLE with sinwave output offset */
-	INT32 **SIN_TABLE;
-
-	/* LFO table */
-	INT32 *AMS_TABLE;
-	INT32 *VIB_TABLE;
+/* limit(tl + ksr + envelope) + sinwave */
+#define TL_MAX (EG_ENT*2)
 
-	/* envelope output curve table */
-	/* attack + decay + OFF */
-	INT32 ENV_CURVE[2*EG_ENT+1];
-
-	/* lock level of common table */
-	int num_lock;
-
-	/* work table */
-	void *cur_chip;	/* current chip point */
+/* Per-chip work state. The level, sine, LFO and envelope curve tables
+ * don't depend on the chip clock or sampling rate, so they're built once
+ * and shared read-only by all chips.
+ */
+typedef struct fm_opl_state {
 	/* current chip state */
 	/* FMSAMPLE  *bufL,*bufR; */
 	OPL_CH *S_CH;
@@ -131,6 +131,128 @@ const struct format_loader *const format_loader[] = {
 	NULL
 };
 
+/* Magic numbers at fixed offsets checked by the loader tests. A loader
+ * listed here can only recognize a file with one of its magic numbers, so
+ * the other loaders are not probed. Loaders not listed use heuristics
+ * and are always probed. Offset and size must fit in FORMAT_MAGIC_SIZE.
+ */
+static const struct format_magic {
+	const struct format_loader *loader;
+	short offset;
+	short size;
+	const char *id;
+} format_magic[] = {
+	{ &xm_loader,	  0, 17, "Extended Module: " },
+	{ &flt_loader,	  1080, 3, "FLT" },
+	{ &flt_loader,	  1080, 3, "EXO" },
+	{ &it_loader,	  0, 4, "IMPM" },
+	{ &s3m_loader,	  44, 4, "SCRM" },
+	{ &stm_loader,	  20, 8, "!Scream!" },
+	{ &stm_loader,	  20, 8, "BMOD2STM" },
+	{ &stx_loader,	  60, 4, "SCRM" },
+	{ &mtm_loader,	  0, 4, "MTM\x10" },
+	{ &ice_loader,	  1464, 4, "MTN\0" },
+	{ &ice_loader,	  1464, 4, "IT10" },
+	{ &imf_loader,	  60, 4, "IM10" },
+	{ &ptm_loader,	  44, 4, "PTMF" },
+	{ &mdl_loader,	  0, 4, "DMDL" },
+	{ &ult_loader,	  0, 14, "MAS_UTrack_V00" },
+	{ &liq_loader,	  0, 14, "Liquid Module:" },
+	{ &no_loader,	  0, 4, "NO\0\0" },
+	{ &masi_loader,	  0, 4, "PSM " },
+	{ &gal5_loader,	  8, 8, "AM  INIT" },
+	{ &gal4_loader,	  8, 8, "AMFFMAIN" },
+	{ &psm_loader,	  0, 4, "PSM\xfe" },
+	{ &amf_loader,	  0, 3, "AMF" },
+	{ &asylum_loader, 0, 24, "ASYLUM Music Format V1.0" },
+	{ &gdm_loader,	  0, 4, "GDM\xfe" },
+	{ &mmd1_loader,	  0, 4, "MMD0" },
+	{ &mmd1_loader,	  0, 4, "MMD1" },
+	{ &mmd3_loader,	  0, 4, "MMD2" },
+	{ &mmd3_loader,	  0, 4, "MMD3" },
+	{ &med2_loader,	  0, 4, "MED\x02" },
+	{ &med3_loader,	  0, 4, "MED\x03" },
+	{ &med4_loader,	  0, 4, "MED\x04" },
+	{ &dmf_loader,	  0, 4, "DDMF" },
+	{ &rtm_loader,	  0, 4, "RTMM" },
+	{ &pt3_loader,	  8, 8, "MODLVERS" },
+	{ &tcb_loader,	  0, 7, "AN COOL" },
+	{ &dt_loader,	  0, 4, "D.T." },
+	{ &gtk_loader,	  0, 3, "GTK" },
+	{ &dtt_loader,	  0, 4, "DskT" },
+	{ &mgt_loader,	  0, 3, "MGT" },
+	{ &arch_loader,	  0, 4, "MUSX" },
+	{ &digi_loader,	  0, 19, "DIGI Booster module" },
+	{ &dbm_loader,	  0, 4, "DBM0" },
+	{ &emod_loader,	  8, 4, "EMOD" },
+	{ &okt_loader,	  0, 8, "OKTASONG" },
+	{ &sfx_loader,	  60, 4, "SONG" },
+	{ &sfx_loader,	  124, 4, "SONG" },
+	{ &far_loader,	  0, 4, "FAR\xfe" },
+	{ &umx_loader,	  0, 4, "\xc1\x83\x2a\x9e" },
+	{ &stim_loader,	  0, 4, "STIM" },
+	{ &coco_loader,	  0, 1, "\x84" },
+	{ &coco_loader,	  0, 1, "\x88" },
+	{ &mtp_loader,	  0, 6, "SONGOK" },
+	{ &mtp_loader,	  0, 6, "IAN92a" },
+	{ &ssn_loader,	  0, 2, "if" },
+	{ &ssn_loader,	  0, 2, "JN" },
+	{ &fnk_loader,	  0, 4, "Funk" },
+	{ &amd_loader,	  1068, 3, "RoR" },
+	{ &rad_loader,	  0, 16, "RAD by REALiTY!!" },
+	{ &alm_loader,	  0, 4, "ALEY" },
+	{ &polly_loader,  0, 1, "\xae" },
+	{ NULL }
+};
+
+static int loader_index(const struct format_loader *loader)
+{
+	int i;
+
+	for (i = 0; format_loader[i] != NULL; i++) {
+		if (format_loader[i] == loader)
+			return i;
+	}
+
+	return -1;
+}
+
+/* List the loaders to probe for a file starting with the given bytes, in
+ * the same order as format_loader[]. Loaders whose magic numbers are not
+ * in the file are left out, so the first loader that recognizes the file
+ * is the same as when probing all of them.
+ */
+int format_candidates(const uint8 *b, long size,
+		      const struct format_loader **list)
+{
+	enum { PROBE, SKIP, MATCH } state[MAX_FORMATS];
+	const struct format_magic *fm;
+	int i, num;
+
+	for (i = 0; format_loader[i] != NULL; i++) {
+		state[i] = PROBE;
+	}
+
+	for (fm = format_magic; fm->loader != NULL; fm++) {
+		if ((i = loader_index(fm->loader)) < 0 || state[i] == MATCH)
+			continue;
+		if (fm->offset + fm->size <= size &&
+		    !memcmp(b + fm->offset, fm->id, fm->size)) {
+			state[i] = MATCH;
+		} else {
+			state[i] = SKIP;
+		}
+	}
+
+	for (num = i = 0; format_loader[i] != NULL; i++) {
+		if (state[i] != SKIP)
+			list[num++] = format_loader[i];
+	}
+	list[num] = NULL;
+
+	return num;
+}
+
 static const char *_farray[MAX_FORMATS] = { NULL };
 
 char **format_list()
@@ -3,17 +3,22 @@
 
 #include <stdio.h>
 #include "common.h"
+#include "hio.h"
 
 #define MAX_FORMATS 110
 
+/* Bytes needed to check the magic numbers in format_candidates() */
+#define FORMAT_MAGIC_SIZE 1472
+
 struct format_loader {
 	const char *name;
-	int (*const test)(FILE *, char *, const int);
-	int (*const loader)(struct module_data *, FILE *, const int);
+	int (*const test)(HIO_HANDLE *, char *, const int);
+	int (*const loader)(struct module_data *, HIO_HANDLE *, const int);
 };
 
 char **format_list(void);
-int pw_test_format(FILE *, char *, const int, struct xmp_test_info *);
+int format_candidates(const uint8 *, long, const struct format_loader **);
+int pw_test_format(HIO_HANDLE *, char *, const int, struct xmp_test_info *);
 
 #endif
 
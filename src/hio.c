@@ -0,0 +1,402 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2012 Claudio Matsuoka and Hipolito Carraro Jr
+ *
+ * This file is part of the Extended Module Player and is distributed
+ * under the terms of the GNU Lesser General Public License. See COPYING.LIB
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "hio.h"
+
+
+static HIO_HANDLE *hio_alloc(int type)
+{
+	HIO_HANDLE *h;
+
+	h = calloc(1, sizeof(HIO_HANDLE));
+	if (h == NULL)
+		return NULL;
+
+	h->type = type;
+	h->size = -1;
+
+	return h;
+}
+
+HIO_HANDLE *hio_open(const char *path, const char *mode)
+{
+	HIO_HANDLE *h;
+	FILE *f;
+
+	if ((f = fopen(path, mode)) == NULL)
+		return NULL;
+
+	if ((h = hio_open_file(f)) == NULL) {
+		fclose(f);
+		return NULL;
+	}
+
+	h->flags |= HIO_FLAG_CLOSE;
+
+	return h;
+}
+
+/* The file is not closed by hio_close() */
+HIO_HANDLE *hio_open_file(FILE *f)
+{
+	HIO_HANDLE *h;
+
+	if ((h = hio_alloc(HIO_HANDLE_TYPE_FILE)) == NULL)
+		return NULL;
+
+	h->file = f;
+
+	return h;
+}
+
+/* The buffer must remain valid until the handle is closed */
+HIO_HANDLE *hio_open_mem(const void *mem, long size)
+{
+	HIO_HANDLE *h;
+
+	if (mem == NULL || size < 0)
+		return NULL;
+
+	if ((h = hio_alloc(HIO_HANDLE_TYPE_MEMORY)) == NULL)
+		return NULL;
+
+	h->start = mem;
+	h->size = size;
+
+	return h;
+}
+
+/* Map a file read-only, falling back to stdio if it can't be mapped */
+HIO_HANDLE *hio_open_map(const char *path)
+{
+#ifdef HAVE_MMAP
+	HIO_HANDLE *h;
+	struct stat st;
+	void *mem;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY)) < 0)
+		return NULL;
+
+	if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+		goto fallback;
+
+	mem = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mem == MAP_FAILED)
+		goto fallback;
+	close(fd);
+
+	if ((h = hio_open_mem(mem, st.st_size)) == NULL) {
+		munmap(mem, st.st_size);
+		return NULL;
+	}
+
+	h->flags |= HIO_FLAG_UNMAP;
+
+	return h;
+
+    fallback:
+	close(fd);
+#endif
+	return hio_open(path, "rb");
+}
+
+int hio_close(HIO_HANDLE *h)
+{
+	int ret = 0;
+
+	if (h == NULL)
+		return -1;
+
+	if (h->type == HIO_HANDLE_TYPE_FILE) {
+		if (h->flags & HIO_FLAG_CLOSE)
+			ret = fclose(h->file);
+	}
+#ifdef HAVE_MMAP
+	else if (h->flags & HIO_FLAG_UNMAP) {
+		ret = munmap((void *)h->start, h->size);
+	}
+#endif
+	else if (h->flags & HIO_FLAG_FREE) {
+		free((void *)h->start);
+	}
+
+	free(h->prefix);
+	free(h);
+
+	return ret;
+}
+
+/* Keep the first bytes of a file stream in memory. Format tests seek back
+ * to the start of the file and read a few bytes each, so while probing
+ * most reads are served from the prefix instead of the file.
+ */
+int hio_cache_prefix(HIO_HANDLE *h, long size)
+{
+	if (h->type != HIO_HANDLE_TYPE_FILE || h->prefix != NULL)
+		return 0;
+
+	if ((h->prefix = malloc(size)) == NULL)
+		return -1;
+
+	if (fseek(h->file, 0, SEEK_SET) < 0) {
+		free(h->prefix);
+		h->prefix = NULL;
+		return -1;
+	}
+
+	h->prefix_size = fread(h->prefix, 1, size, h->file);
+	h->pos = 0;
+	h->eof = 0;
+	h->sync = 1;
+
+	return 0;
+}
+
+/* Stop using the prefix, file reads continue at the current position */
+void hio_drop_prefix(HIO_HANDLE *h)
+{
+	if (h->prefix == NULL)
+		return;
+
+	if (h->sync)
+		fseek(h->file, h->pos, SEEK_SET);
+	if (h->eof)
+		fgetc(h->file);		/* set the end of file indicator */
+
+	free(h->prefix);
+	h->prefix = NULL;
+}
+
+static size_t read_prefix(void *buf, size_t size, size_t num, HIO_HANDLE *h)
+{
+	long len, n, done = 0;
+
+	if (size == 0 || num == 0)
+		return 0;
+
+	len = size * num;
+
+	if (h->pos < h->prefix_size) {
+		n = h->prefix_size - h->pos;
+		if (n > len)
+			n = len;
+		memcpy(buf, h->prefix + h->pos, n);
+		h->pos += n;
+		h->sync = 1;
+		done = n;
+	}
+
+	if (done < len) {
+		if (h->sync) {
+			if (fseek(h->file, h->pos, SEEK_SET) < 0)
+				return done / size;
+			h->sync = 0;
+		}
+		n = fread((uint8 *)buf + done, 1, len - done, h->file);
+		h->pos += n;
+		done += n;
+		if (done < len)
+			h->eof = 1;
+	}
+
+	return done / size;
+}
+
+size_t hio_read(void *buf, size_t size, size_t num, HIO_HANDLE *h)
+{
+	long len, avail;
+
+	if (h->type == HIO_HANDLE_TYPE_FILE) {
+		if (h->prefix != NULL)
+			return read_prefix(buf, size, num, h);
+		return fread(buf, size, num, h->file);
+	}
+
+	if (size == 0 || num == 0)
+		return 0;
+
+	len = size * num;
+	avail = h->pos < h->size ? h->size - h->pos : 0;
+
+	if (len > avail) {
+		len = avail;
+		h->eof = 1;
+	}
+
+	memcpy(buf, h->start + h->pos, len);
+	h->pos += len;
+
+	return len / size;
+}
+
+int hio_seek(HIO_HANDLE *h, long offset, int whence)
+{
+	long pos;
+
+	if (h->type == HIO_HANDLE_TYPE_FILE && h->prefix == NULL)
+		return fseek(h->file, offset, whence);
+
+	switch (whence) {
+	case SEEK_SET:
+		pos = offset;
+		break;
+	case SEEK_CUR:
+		pos = h->pos + offset;
+		break;
+	case SEEK_END:
+		pos = hio_size(h) + offset;
+		break;
+	default:
+		return -1;
+	}
+
+	if (pos < 0)
+		return -1;
+
+	h->pos = pos;
+	h->eof = 0;
+	h->sync = 1;
+
+	return 0;
+}
+
+long hio_tell(HIO_HANDLE *h)
+{
+	if (h->type == HIO_HANDLE_TYPE_FILE && h->prefix == NULL)
+		return ftell(h->file);
+
+	return h->pos;
+}
+
+int hio_eof(HIO_HANDLE *h)
+{
+	if (h->type == HIO_HANDLE_TYPE_FILE && h->prefix == NULL)
+		return feof(h->file);
+
+	return h->eof;
+}
+
+long hio_size(HIO_HANDLE *h)
+{
+	struct stat st;
+
+	if (h->type == HIO_HANDLE_TYPE_FILE && h->size < 0) {
+		if (fstat(fileno(h->file), &st) < 0)
+			return -1;
+		h->size = st.st_size;
+	}
+
+	return h->size;
+}
+
+/* Multi-byte reads from memory are done in one step when the data is
+ * available, otherwise byte by byte to get the same results as a file.
+ */
+#define CAN_READ(h,n) ((h)->type == HIO_HANDLE_TYPE_MEMORY && \
+			(h)->pos >= 0 && (h)->pos + (n) <= (h)->size)
+
+int8 hio_read8s(HIO_HANDLE *h)
+{
+	return (int8)hio_read8(h);
+}
+
+uint16 hio_read16l(HIO_HANDLE *h)
+{
+	uint32 a, b;
+
+	if (CAN_READ(h, 2)) {
+		h->pos += 2;
+		return readmem16l((uint8 *)h->start + h->pos - 2);
+	}
+
+	a = hio_read8(h);
+	b = hio_read8(h);
+
+	return (b << 8) | a;
+}
+
+uint16 hio_read16b(HIO_HANDLE *h)
+{
+	uint32 a, b;
+
+	if (CAN_READ(h, 2)) {
+		h->pos += 2;
+		return readmem16b((uint8 *)h->start + h->pos - 2);
+	}
+
+	a = hio_read8(h);
+	b = hio_read8(h);
+
+	return (a << 8) | b;
+}
+
+uint32 hio_read24l(HIO_HANDLE *h)
+{
+	uint32 a, b, c;
+
+	a = hio_read8(h);
+	b = hio_read8(h);
+	c = hio_read8(h);
+
+	return (c << 16) | (b << 8) | a;
+}
+
+uint32 hio_read24b(HIO_HANDLE *h)
+{
+	uint32 a, b, c;
+
+	a = hio_read8(h);
+	b = hio_read8(h);
+	c = hio_read8(h);
+
+	return (a << 16) | (b << 8) | c;
+}
+
+uint32 hio_read32l(HIO_HANDLE *h)
+{
+	uint32 a, b, c, d;
+
+	if (CAN_READ(h, 4)) {
+		h->pos += 4;
+		return readmem32l((uint8 *)h->start + h->pos - 4);
+	}
+
+	a = hio_read8(h);
+	b = hio_read8(h);
+	c = hio_read8(h);
+	d = hio_read8(h);
+
+	return (d << 24) | (c << 16) | (b << 8) | a;
+}
+
+uint32 hio_read32b(HIO_HANDLE *h)
+{
+	uint32 a, b, c, d;
+
+	if (CAN_READ(h, 4)) {
+		h->pos += 4;
+		return readmem32b((uint8 *)h->start + h->pos - 4);
+	}
+
+	a = hio_read8(h);
+	b = hio_read8(h);
+	c = hio_read8(h);
+	d = hio_read8(h);
+
+	return (a << 24) | (b << 16) | (c << 8) | d;
+}
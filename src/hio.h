@@ -0,0 +1,81 @@
+#ifndef XMP_HIO_H
+#define XMP_HIO_H
+
+#include <stdio.h>
+#include "common.h"
+
+/* Input stream used by the format loaders. A handle reads either from a
+ * stdio file or from a memory buffer, which may be a private copy, a
+ * buffer owned by the caller or a read-only mapping of a file. Memory
+ * streams are read directly, without library or system calls per byte.
+ */
+
+#define HIO_HANDLE_TYPE_FILE	0
+#define HIO_HANDLE_TYPE_MEMORY	1
+
+#define HIO_FLAG_CLOSE		0x01	/* close the file on hio_close */
+#define HIO_FLAG_UNMAP		0x02	/* unmap the buffer on hio_close */
+#define HIO_FLAG_SHARE		0x04	/* loaders may keep pointers to data */
+#define HIO_FLAG_FREE		0x08	/* free the buffer on hio_close */
+
+typedef struct hio_handle {
+	int type;
+	int flags;
+	long size;
+	FILE *file;
+	const uint8 *start;
+	long pos;
+	int eof;
+	uint8 *prefix;		/* first bytes of a file, see hio_cache_prefix */
+	long prefix_size;
+	int sync;		/* file position differs from pos */
+} HIO_HANDLE;
+
+HIO_HANDLE *hio_open		(const char *, const char *);
+HIO_HANDLE *hio_open_file	(FILE *);
+HIO_HANDLE *hio_open_mem	(const void *, long);
+HIO_HANDLE *hio_open_map	(const char *);
+int	hio_close		(HIO_HANDLE *);
+size_t	hio_read		(void *, size_t, size_t, HIO_HANDLE *);
+int	hio_seek		(HIO_HANDLE *, long, int);
+long	hio_tell		(HIO_HANDLE *);
+int	hio_eof			(HIO_HANDLE *);
+long	hio_size		(HIO_HANDLE *);
+int	hio_cache_prefix	(HIO_HANDLE *, long);
+void	hio_drop_prefix		(HIO_HANDLE *);
+
+int8	hio_read8s		(HIO_HANDLE *);
+uint16	hio_read16l		(HIO_HANDLE *);
+uint16	hio_read16b		(HIO_HANDLE *);
+uint32	hio_read24l		(HIO_HANDLE *);
+uint32	hio_read24b		(HIO_HANDLE *);
+uint32	hio_read32l		(HIO_HANDLE *);
+uint32	hio_read32b		(HIO_HANDLE *);
+
+static inline uint8 hio_read8(HIO_HANDLE *h)
+{
+	if (h->type == HIO_HANDLE_TYPE_MEMORY) {
+		if (h->pos >= 0 && h->pos < h->size)
+			return h->start[h->pos++];
+		h->eof = 1;
+		return (uint8)EOF;
+	}
+
+	if (h->prefix != NULL) {
+		uint8 b;
+		return hio_read(&b, 1, 1, h) == 1 ? b : (uint8)EOF;
+	}
+
+	return (uint8)fgetc(h->file);
+}
+
+/* Check if data points into the buffer of a memory stream */
+static inline int hio_mapped(HIO_HANDLE *h, const void *data)
+{
+	const uint8 *p = data;
+
+	return h != NULL && h->type == HIO_HANDLE_TYPE_MEMORY &&
+		p >= h->start && p < h->start + h->size;
+}
+
+#endif /* XMP_HIO_H */
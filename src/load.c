@@ -20,86 +20,48 @@
 #include <limits.h>
 #endif
 
-#if !defined(HAVE_POPEN) && defined(WIN32)
-#include "../win32/ptpopen.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
 #endif
 
 #include "format.h"
-#include "list.h"
+#include "loaders/loader.h"
+#include "depackers/depacker.h"
 #include "md5.h"
 
 
-extern struct format_loader *format_loader[];
-
 void load_prologue(struct context_data *);
-void load_epilogue(struct context_data *);
-
-struct tmpfilename {
-	char *name;
-	struct list_head list;
-};
-
-int decrunch_arc	(FILE *, FILE *);
-int decrunch_arcfs	(FILE *, FILE *);
-int decrunch_sqsh	(FILE *, FILE *);
-int decrunch_pp		(FILE *, FILE *);
-int decrunch_mmcmp	(FILE *, FILE *);
-int decrunch_muse	(FILE *, FILE *);
-int decrunch_lzx	(FILE *, FILE *);
-int decrunch_oxm	(FILE *, FILE *);
-int decrunch_xfd	(FILE *, FILE *);
-int decrunch_s404	(FILE *, FILE *);
-int decrunch_zip	(FILE *, FILE *);
-int decrunch_gzip	(FILE *, FILE *);
-int decrunch_compress	(FILE *, FILE *);
-int decrunch_bzip2	(FILE *, FILE *);
-int decrunch_xz		(FILE *, FILE *);
-int decrunch_lha	(FILE *, FILE *);
-int test_oxm		(FILE *);
-char *test_xfd		(unsigned char *, int);
-
-enum {
-	BUILTIN_PP = 0x01,
-	BUILTIN_SQSH,
-	BUILTIN_MMCMP,
-	BUILTIN_ARC,
-	BUILTIN_ARCFS,
-	BUILTIN_S404,
-	BUILTIN_OXM,
-	BUILTIN_XFD,
-	BUILTIN_MUSE,
-	BUILTIN_LZX,
-	BUILTIN_ZIP,
-	BUILTIN_GZIP,
-	BUILTIN_COMPRESS,
-	BUILTIN_BZIP2,
-	BUILTIN_XZ,
-	BUILTIN_LHA,
-};
+int load_epilogue(struct context_data *);
 
-
-#if defined __EMX__ || defined WIN32
-#define REDIR_STDERR "2>NUL"
-#elif defined unix || defined __unix__
-#define REDIR_STDERR "2>/dev/null"
-#else
-#define REDIR_STDERR
+/* Module data used by more than one context. The allocations and the
+ * file mapping are released by the last context using the module.
+ */
+struct module_ref {
+	int count;
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_t lock;
 #endif
+	struct arena arena;
+	struct arena track_arena;
+	struct hio_handle *map;
+};
 
-#define DECRUNCH_MAX 5 /* don't recurse more than this */
+#define DECRUNCH_MAX 5 /* don't depack more than this */
 
 #define BUFLEN 16384
 
-static void set_md5sum(FILE *f, unsigned char *digest)
+#define PREFIX_SIZE 65536 /* file bytes kept in memory while probing */
+
+static void set_md5sum(HIO_HANDLE *f, unsigned char *digest)
 {
 	unsigned char buf[BUFLEN];
 	MD5_CTX ctx;
 	int bytes_read;
 
-	fseek(f, 0, SEEK_SET);
+	hio_seek(f, 0, SEEK_SET);
 
 	MD5Init(&ctx);
-	while ((bytes_read = fread(buf, 1, BUFLEN, f)) > 0) {
+	while ((bytes_read = hio_read(buf, 1, BUFLEN, f)) > 0) {
 		MD5Update(&ctx, buf, bytes_read);
 	}
 	MD5Final(&ctx);
@@ -107,304 +69,98 @@ static void set_md5sum(FILE *f, unsigned char *digest)
 	memcpy(digest, ctx.digest, 16);
 }
 
-#if 0
-
-static int decrunch(struct list_head *head, FILE **f, char **s, int ttl)
+/* Depack the file in memory, again while the result is packed. The handle
+ * is replaced by a memory handle to the depacked data, which is freed when
+ * the handle is closed.
+ */
+static int decrunch(HIO_HANDLE **h, int ttl)
 {
-    unsigned char b[1024];
-    char *cmd;
-    FILE *t;
-    int fd, builtin, res;
-    char *packer, *temp2, tmp[PATH_MAX];
-    struct tmpfilename *temp;
-    int headersize;
-
-    packer = cmd = NULL;
-    builtin = res = 0;
-
-    if (get_temp_dir(tmp, PATH_MAX) < 0)
-	return 0;
-
-    strncat(tmp, "xmp_XXXXXX", PATH_MAX);
+	HIO_HANDLE *f = *h, *d;
+	const struct depacker *dp;
+	struct depack_buffer out;
+	uint8 b[DEPACK_HEADER_SIZE];
+	uint8 *in;
+	long size;
+	int i, ret;
 
-    fseek(*f, 0, SEEK_SET);
-    if ((headersize = fread(b, 1, 1024, *f)) < 100)	/* minimum valid file size */
-	return 0;
+	for (; ttl > 0; ttl--) {
+		hio_seek(f, 0, SEEK_SET);
+		size = hio_read(b, 1, DEPACK_HEADER_SIZE, f);
 
-#if defined __AMIGA__ && !defined __AROS__
-    if (packer = test_xfd(b, 1024)) {
-	builtin = BUILTIN_XFD;
-    } else
-#endif
+		dp = NULL;
+		for (i = 0; depacker_list[i] != NULL; i++) {
+			if (depacker_list[i]->test(b, size)) {
+				dp = depacker_list[i];
+				break;
+			}
+		}
 
-    if (b[0] == 'P' && b[1] == 'K' &&
-	((b[2] == 3 && b[3] == 4) || (b[2] == '0' && b[3] == '0' &&
-	b[4] == 'P' && b[5] == 'K' && b[6] == 3 && b[7] == 4))) {
-
-	packer = "Zip";
-	builtin = BUILTIN_ZIP;
-    } else if (b[2] == '-' && b[3] == 'l' && b[4] == 'h') {
-	packer = "LHa";
-	builtin = BUILTIN_LHA;
-    } else if (b[0] == 31 && b[1] == 139) {
-	packer = "gzip";
-	builtin = BUILTIN_GZIP;
-    } else if (b[0] == 'B' && b[1] == 'Z' && b[2] == 'h') {
-	packer = "bzip2";
-	builtin = BUILTIN_BZIP2;
-    } else if (b[0] == 0xfd && b[3] == 'X' && b[4] == 'Z' && b[5] == 0x00) {
-	packer = "xz";
-	builtin = BUILTIN_XZ;
-    } else if (b[0] == 'Z' && b[1] == 'O' && b[2] == 'O' && b[3] == ' ') {
-	packer = "zoo";
-	cmd = "zoo xpq \"%s\"";
-    } else if (b[0] == 'M' && b[1] == 'O' && b[2] == '3') {
-	packer = "MO3";
-	cmd = "unmo3 -s \"%s\" STDOUT";
-    } else if (headersize > 300 &&
-	       b[257] == 'u' && b[258] == 's' && b[259] == 't' &&
-	       b[260] == 'a' && b[261] == 'r' &&
-	       ((b[262] == 0) || (b[262] == ' ' && b[263] == ' ' &&
-				  b[264] == 0))) {
-	packer = "tar";
-	cmd = "tar -xOf \"%s\"";
-    } else if (b[0] == 31 && b[1] == 157) {
-	packer = "compress";
-	builtin = BUILTIN_COMPRESS;
-    } else if (memcmp(b, "PP20", 4) == 0) {
-	packer = "PowerPack";
-	builtin = BUILTIN_PP;
-    } else if (memcmp(b, "XPKF", 4) == 0 && memcmp(b + 8, "SQSH", 4) == 0) {
-	packer = "SQSH";
-	builtin = BUILTIN_SQSH;
-    } else if (!memcmp(b, "Archive\0", 8)) {
-	packer = "ArcFS";
-	builtin = BUILTIN_ARCFS;
-    } else if (memcmp(b, "ziRCONia", 8) == 0) {
-	packer = "MMCMP";
-	builtin = BUILTIN_MMCMP;
-    } else if (memcmp(b, "MUSE", 4) == 0 && readmem32b(b + 4) == 0xdeadbeaf) {
-	packer = "J2B MUSE";
-	builtin = BUILTIN_MUSE;
-    } else if (memcmp(b, "MUSE", 4) == 0 && readmem32b(b + 4) == 0xdeadbabe) {
-	packer = "MOD2J2B MUSE";
-	builtin = BUILTIN_MUSE;
-    } else if (memcmp(b, "LZX", 3) == 0) {
-	packer = "LZX";
-	builtin = BUILTIN_LZX;
-    } else if (memcmp(b, "Rar", 3) == 0) {
-	packer = "rar";
-	cmd = "unrar p -inul -xreadme -x*.diz -x*.nfo -x*.txt "
-	    "-x*.exe -x*.com \"%s\"";
-    } else if (memcmp(b, "S404", 4) == 0) {
-	packer = "Stonecracker";
-	builtin = BUILTIN_S404;
-    } else if (test_oxm(*f) == 0) {
-	packer = "oggmod";
-	builtin = BUILTIN_OXM;
-    }
-
-    if (packer == NULL && b[0] == 0x1a) {
-	int x = b[1] & 0x7f;
-	int i, flag = 0;
-	long size;
-	
-	/* check file name */
-	for (i = 0; i < 13; i++) {
-	    if (b[2 + i] == 0) {
-		if (i == 0)		/* name can't be empty */
-		    flag = 1;
-		break;
-	    }
-	    if (!isprint(b[2 + i])) {	/* name must be printable */
-		flag = 1;
-		break;
-	    }
-	}
+		if (dp == NULL)
+			break;
 
-	size = readmem32l(b + 15);	/* max file size is 512KB */
-	if (size < 0 || size > 512 * 1024)
-		flag = 1;
-
-        if (flag == 0) {
-	    if (x >= 1 && x <= 9 && x != 7) {
-		packer = "Arc";
-		builtin = BUILTIN_ARC;
-	    } else if (x == 0x7f) {
-		packer = "!Spark";
-		builtin = BUILTIN_ARC;
-	    }
-	}
-    }
+		D_(D_WARN "depacking %s file", dp->name);
+
+		if ((size = hio_size(f)) < 0)
+			return -1;
+
+		/* Files that couldn't be mapped are read to memory */
+		if (f->type == HIO_HANDLE_TYPE_MEMORY) {
+			in = (uint8 *)f->start;
+		} else {
+			if ((in = malloc(size)) == NULL)
+				return -1;
+			hio_seek(f, 0, SEEK_SET);
+			if (hio_read(in, 1, size, f) != size) {
+				free(in);
+				return -1;
+			}
+		}
 
-    fseek(*f, 0, SEEK_SET);
+		memset(&out, 0, sizeof (out));
+		ret = dp->depack(in, size, &out);
 
-    if (packer == NULL)
-	return 0;
+		if (in != f->start)
+			free(in);
 
-#if defined ANDROID || defined __native_client__
-    /* Don't use external helpers in android */
-    if (cmd)
-	return 0;
-#endif
+		if (ret < 0 || (d = hio_open_mem(out.data, out.size)) == NULL) {
+			D_(D_CRIT "depack failed");
+			free(out.data);
+			return -1;
+		}
 
-    D_(D_WARN "Depacking %s file... ", packer);
-
-    temp = calloc(sizeof (struct tmpfilename), 1);
-    if (!temp) {
-	D_(D_CRIT "calloc failed");
-	return -1;
-    }
-
-    temp->name = strdup(tmp);
-    if ((fd = mkstemp(temp->name)) < 0) {
-	D_(D_CRIT "failed");
-	return -1;
-    }
-
-    list_add_tail(&temp->list, head);
-
-    if ((t = fdopen(fd, "w+b")) == NULL) {
-	D_(D_CRIT "failed");
-	return -1;
-    }
-
-    if (cmd) {
-#define BSIZE 0x4000
-	int n;
-	char line[1024], buf[BSIZE];
-	FILE *p;
-
-	snprintf(line, 1024, cmd, *s);
-
-#ifdef WIN32
-	/* Note: The _popen function returns an invalid file opaque, if
-	 * used in a Windows program, that will cause the program to hang
-	 * indefinitely. _popen works properly in a Console application.
-	 * To create a Windows application that redirects input and output,
-	 * read the section "Creating a Child Process with Redirected Input
-	 * and Output" in the Win32 SDK. -- Mirko 
-	 */
-	if ((p = popen(line, "rb")) == NULL) {
-#else
-	/* Linux popen fails with "rb" */
-	if ((p = popen(line, "r")) == NULL) {
-#endif
-	    D_(D_CRIT "failed");
-	    fclose(t);
-	    return -1;
+		d->flags |= HIO_FLAG_FREE;
+		hio_close(f);
+		*h = f = d;
 	}
-	while ((n = fread(buf, 1, BSIZE, p)) > 0)
-	    fwrite(buf, 1, n, t);
-	pclose (p);
-    } else {
-	switch (builtin) {
-	case BUILTIN_PP:    
-	    res = decrunch_pp(*f, t);
-	    break;
-	case BUILTIN_ARC:
-	    res = decrunch_arc(*f, t);
-	    break;
-	case BUILTIN_ARCFS:
-	    res = decrunch_arcfs(*f, t);
-	    break;
-	case BUILTIN_SQSH:    
-	    res = decrunch_sqsh(*f, t);
-	    break;
-	case BUILTIN_MMCMP:    
-	    res = decrunch_mmcmp(*f, t);
-	    break;
-	case BUILTIN_MUSE:    
-	    res = decrunch_muse(*f, t);
-	    break;
-	case BUILTIN_LZX:    
-	    res = decrunch_lzx(*f, t);
-	    break;
-	case BUILTIN_S404:
-	    res = decrunch_s404(*f, t);
-	    break;
-	case BUILTIN_ZIP:
-	    res = decrunch_zip(*f, t);
-	    break;
-	case BUILTIN_GZIP:
-	    res = decrunch_gzip(*f, t);
-	    break;
-	case BUILTIN_COMPRESS:
-	    res = decrunch_compress(*f, t);
-	    break;
-	case BUILTIN_BZIP2:
-	    res = decrunch_bzip2(*f, t);
-	    break;
-	case BUILTIN_XZ:
-	    res = decrunch_xz(*f, t);
-	    break;
-	case BUILTIN_LHA:
-	    res = decrunch_lha(*f, t);
-	    break;
-	case BUILTIN_OXM:
-	    res = decrunch_oxm(*f, t);
-	    break;
-#ifdef AMIGA
-	case BUILTIN_XFD:
-	    res = decrunch_xfd(*f, t);
-	    break;
-#endif
-	}
-    }
-
-    if (res < 0) {
-	D_(D_CRIT "failed");
-	fclose(t);
-	return -1;
-    }
-
-    D_(D_INFO "done");
-
-    fclose(*f);
-    *f = t;
- 
-    if (!--ttl) {
-	    return -1;
-    }
-    
-    temp2 = strdup(temp->name);
-    res = decrunch(head, f, &temp->name, ttl);
-    free(temp2);
-    /* Mirko: temp is now deallocated in unlink_tempfiles()
-     * not a problem, since unlink_tempfiles() is called after decrunch
-     * in loader routines
-     *
-     * free(temp);
-     */
-
-    return res;
-}
 
+	hio_seek(f, 0, SEEK_SET);
 
-/*
- * Windows doesn't allow you to unlink an open file, so we changed the
- * temp file cleanup system to remove temporary files after we close it
+	return 0;
+}
+
+/* Get the loaders to probe from the magic numbers at the start of the
+ * file. File streams keep their first bytes in memory until the caller
+ * drops the prefix, so the loader tests don't go through stdio.
  */
-static void unlink_tempfiles(struct list_head *head)
+static void probe_list(HIO_HANDLE *h, const struct format_loader **list)
 {
-	struct tmpfilename *li;
-	struct list_head *tmp;
-
-	/* can't use list_for_each when freeing the node! */
-	for (tmp = head->next; tmp != head; ) {
-		li = list_entry(tmp, struct tmpfilename, list);
-		D_(D_INFO "unlink tmpfile %s", li->name);
-		unlink(li->name);
-		free(li->name);
-		list_del(&li->list);
-		tmp = tmp->next;
-		free(li);
+	uint8 buf[FORMAT_MAGIC_SIZE];
+	long size;
+
+	if (h->type == HIO_HANDLE_TYPE_MEMORY) {
+		format_candidates(h->start, h->size, list);
+		return;
 	}
+
+	hio_cache_prefix(h, PREFIX_SIZE);
+	hio_seek(h, 0, SEEK_SET);
+	size = hio_read(buf, 1, FORMAT_MAGIC_SIZE, h);
+	format_candidates(buf, size, list);
 }
-#endif
 
-int xmp_test_modulef(FILE *f, struct xmp_test_info *info)
+static int test_module(HIO_HANDLE *h, struct xmp_test_info *info)
 {
+	const struct format_loader *list[MAX_FORMATS];
 	char buf[XMP_NAME_SIZE];
 	int i;
 
@@ -413,27 +169,46 @@ int xmp_test_modulef(FILE *f, struct xmp_test_info *info)
 		*info->type = 0;	/* reset type prior to testing */
 	}
 
-	for (i = 0; format_loader[i] != NULL; i++) {
-		fseek(f, 0, SEEK_SET);
-		if (format_loader[i]->test(f, buf, 0) == 0) {
+	probe_list(h, list);
+
+	for (i = 0; list[i] != NULL; i++) {
+		hio_seek(h, 0, SEEK_SET);
+		if (list[i]->test(h, buf, 0) == 0) {
 			if (info != NULL) {
 				strncpy(info->name, buf, XMP_NAME_SIZE);
-				strncpy(info->type, format_loader[i]->name,
+				strncpy(info->type, list[i]->name,
 							XMP_NAME_SIZE);
 			}
+			hio_drop_prefix(h);
 			return 0;
 		}
 	}
+
+	hio_drop_prefix(h);
+
         return -XMP_ERROR_FORMAT;
 }
 
+int xmp_test_modulef(FILE *f, struct xmp_test_info *info)
+{
+	HIO_HANDLE *h;
+	int ret;
+
+	if ((h = hio_open_file(f)) == NULL)
+		return -XMP_ERROR_SYSTEM;
+
+	ret = test_module(h, info);
+	hio_close(h);
+
+	return ret;
+}
+
 
 int xmp_test_module(char *path, struct xmp_test_info *info)
 {
-	FILE *f;
+	HIO_HANDLE *h;
 	struct stat st;
-	struct list_head tmpfiles_list;
-	int ret = -XMP_ERROR_FORMAT;;
+	int ret = -XMP_ERROR_FORMAT;
 
 	if (stat(path, &st) < 0)
 		return -XMP_ERROR_SYSTEM;
@@ -443,37 +218,60 @@ int xmp_test_module(char *path, struct xmp_test_info *info)
 		return -XMP_ERROR_SYSTEM;
 	}
 
-	if ((f = fopen(path, "rb")) == NULL)
+	if ((h = hio_open_map(path)) == NULL)
 		return -XMP_ERROR_SYSTEM;
 
-	INIT_LIST_HEAD(&tmpfiles_list);
-#if 0
-	if (decrunch(&tmpfiles_list, &f, &path, DECRUNCH_MAX) < 0) {
+	if (decrunch(&h, DECRUNCH_MAX) < 0) {
 		ret = -XMP_ERROR_DEPACK;
 		goto err;
 	}
-#endif
-	if (fstat(fileno(f), &st) < 0) {/* get size after decrunch */
+
+	if (hio_size(h) < 0) {		/* get size after decrunch */
 		ret = -XMP_ERROR_DEPACK;
 		goto err;
 	}
 
-	if (st.st_size < 256) {		/* set minimum valid module size */
+	if (hio_size(h) < 256) {	/* set minimum valid module size */
 		ret = -XMP_ERROR_FORMAT;
 		goto err;
 	}
 
-        ret = xmp_test_modulef(f, info);
+        ret = test_module(h, info);
 
     err:
-	fclose(f);
-//	unlink_tempfiles(&tmpfiles_list);
+	hio_close(h);
 	return ret;
 }
 
 
-/* FIXME: ugly code, check allocations */
-static void split_name(char *s, char **d, char **b)
+int xmp_test_module_from_memory(void *mem, long size,
+				struct xmp_test_info *info)
+{
+	HIO_HANDLE *h;
+	int ret;
+
+	if ((h = hio_open_mem(mem, size)) == NULL)
+		return -XMP_ERROR_INVALID;
+
+	if (decrunch(&h, DECRUNCH_MAX) < 0) {
+		ret = -XMP_ERROR_DEPACK;
+		goto err;
+	}
+
+	if (hio_size(h) < 256) {	/* set minimum valid module size */
+		ret = -XMP_ERROR_FORMAT;
+		goto err;
+	}
+
+	ret = test_module(h, info);
+
+    err:
+	hio_close(h);
+	return ret;
+}
+
+
+static int split_name(struct module_data *m, char *s, char **d, char **b)
 {
 	char *div;
 	int tmp;
@@ -481,76 +279,152 @@ static void split_name(char *s, char **d, char **b)
 	D_("alloc dirname/basename");
 	if ((div = strrchr(s, '/'))) {
 		tmp = div - s + 1;
-		*d = malloc(tmp + 1);
+		if ((*d = arena_malloc(&m->arena, tmp + 1)) == NULL)
+			return -1;
 		memcpy(*d, s, tmp);
 		(*d)[tmp] = 0;
-		*b = strdup(div + 1);
+		*b = arena_strdup(&m->arena, div + 1);
 	} else {
-		*d = strdup("");
-		*b = strdup(s);
+		*d = arena_strdup(&m->arena, "");
+		*b = arena_strdup(&m->arena, s);
 	}
+
+	return *d != NULL && *b != NULL ? 0 : -1;
 }
 
 
-int xmp_load_modulef(xmp_context opaque, FILE *f, char *path, size_t size)
+/* Keep the file mapping if samples are used in place or loaded later.
+ * Players never change loaded sample data, see invloop_sample().
+ */
+static void share_mapping(struct module_data *m, HIO_HANDLE *f)
+{
+	int i;
+
+	if (m->lazy != NULL) {
+		m->map = f;
+		return;
+	}
+
+	for (i = 0; i < m->mod.smp; i++) {
+		if (hio_mapped(f, m->mod.xxs[i].data)) {
+			m->map = f;
+			break;
+		}
+	}
+}
+
+static void release_module_data(struct module_data *m)
+{
+	arena_release(&m->arena);
+	arena_release(&m->track_arena);
+	m->trk_index = NULL;
+	m->row_index = NULL;
+	m->row_events = NULL;
+	m->xxe = NULL;
+	m->map = NULL;
+	m->lazy = NULL;
+	m->lazy_num = 0;
+}
+
+static int load_module(xmp_context opaque, HIO_HANDLE *f, char *path)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 	struct module_data *m = &ctx->m;
+	const struct format_loader *list[MAX_FORMATS];
 	int i;
 	int test_result, load_result;
 
-	split_name(path, &m->dirname, &m->basename);
+	if (split_name(m, path, &m->dirname, &m->basename) < 0) {
+		release_module_data(m);
+		return -XMP_ERROR_SYSTEM;
+	}
 	m->filename = path;	/* For ALM, SSMT, etc */
-	m->size = size;
+	m->size = hio_size(f);
+	m->map = NULL;
+	m->nodata = m->smpctl & XMP_SMPCTL_SKIP;
+	m->lazy = NULL;
+	m->lazy_num = 0;
+
+	/* Samples can be mapped or loaded later only from module data
+	 * kept in memory
+	 */
+	if ((m->smpctl & (XMP_SMPCTL_MAP | XMP_SMPCTL_LAZY)) &&
+	    (f->flags & (HIO_FLAG_UNMAP | HIO_FLAG_FREE)))
+		f->flags |= HIO_FLAG_SHARE;
 
 	load_prologue(ctx);
 
 	D_(D_WARN "load");
 	test_result = load_result = -1;
-	for (i = 0; format_loader[i] != NULL; i++) {
-		fseek(f, 0, SEEK_SET);
-		test_result = format_loader[i]->test(f, NULL, 0);
+	probe_list(f, list);
+	for (i = 0; list[i] != NULL; i++) {
+		hio_seek(f, 0, SEEK_SET);
+		test_result = list[i]->test(f, NULL, 0);
 		if (test_result == 0) {
-			fseek(f, 0, SEEK_SET);
-			D_(D_WARN "load format: %s", format_loader[i]->name);
-			load_result = format_loader[i]->loader(m, f, 0);
+			hio_drop_prefix(f);
+			hio_seek(f, 0, SEEK_SET);
+			D_(D_WARN "load format: %s", list[i]->name);
+			m->format = list[i]->name;
+			load_result = list[i]->loader(m, f, 0);
 			break;
 		}
 	}
+	hio_drop_prefix(f);
 
-	set_md5sum(f, m->md5);
-
-//	fclose(f);
+	/* Don't read the whole file when loading only the metadata */
+	if (m->nodata) {
+		memset(m->md5, 0, sizeof (m->md5));
+	} else {
+		set_md5sum(f, m->md5);
+	}
 
 	if (test_result < 0) {
-		free(m->basename);
-		free(m->dirname);
+		release_module_data(m);
 		return -XMP_ERROR_FORMAT;
 	}
 
+	/* Everything a failed loader allocated goes away with the arena */
 	if (load_result < 0) {
-		free(m->basename);
-		free(m->dirname);
+		release_module_data(m);
 		return -XMP_ERROR_LOAD;
 	}
 
+	share_mapping(m, f);
+
 	str_adj(m->mod.name);
 	if (!*m->mod.name) {
 		strncpy(m->mod.name, m->basename, XMP_NAME_SIZE);
 	}
 
-	load_epilogue(ctx);
+	if (load_epilogue(ctx) < 0) {
+		release_module_data(m);
+		return -XMP_ERROR_SYSTEM;
+	}
 
 	return 0;
+}
+
+int xmp_load_modulef(xmp_context opaque, FILE *f, char *path, size_t size)
+{
+	HIO_HANDLE *h;
+	int ret;
+
+	if ((h = hio_open_file(f)) == NULL)
+		return -XMP_ERROR_SYSTEM;
+
+	h->size = size;
+	ret = load_module(opaque, h, path);
+	hio_close(h);
 
+	return ret;
 }
 
 
 int xmp_load_module(xmp_context opaque, char *path)
 {
-	FILE *f;
+	struct context_data *ctx = (struct context_data *)opaque;
+	HIO_HANDLE *h;
 	struct stat st;
-	struct list_head tmpfiles_list;
         int ret = -XMP_ERROR_DEPACK;
 	D_(D_WARN "path = %s", path);
 
@@ -562,94 +436,205 @@ int xmp_load_module(xmp_context opaque, char *path)
 		return -XMP_ERROR_SYSTEM;
 	}
 
-	if ((f = fopen(path, "rb")) == NULL)
+	if ((h = hio_open_map(path)) == NULL)
 		return -XMP_ERROR_SYSTEM;
 
-	INIT_LIST_HEAD(&tmpfiles_list);
-#if 0
 	D_(D_INFO "decrunch");
-	if (decrunch(&tmpfiles_list, &f, &path, DECRUNCH_MAX) < 0)
+	if (decrunch(&h, DECRUNCH_MAX) < 0)
 		goto err_depack;
-#endif
-	if (fstat(fileno(f), &st) < 0)
+
+	if (hio_size(h) < 0)
 		goto err_depack;
 
-	if (st.st_size < 256) {			/* get size after decrunch */
-		fclose(f);
-//		unlink_tempfiles(&tmpfiles_list);
+	if (hio_size(h) < 256) {		/* get size after decrunch */
+		hio_close(h);
 		return -XMP_ERROR_FORMAT;
 	}
 
-        ret = xmp_load_modulef(opaque, f, path, st.st_size);
+        ret = load_module(opaque, h, path);
+	if (ret == 0 && ctx->m.map == h)
+		return 0;			/* mapping owned by the module */
 err_depack:
-	fclose(f);
-//	unlink_tempfiles(&tmpfiles_list);
+	hio_close(h);
         return ret;
 }
 
-void xmp_release_module(xmp_context opaque)
+int xmp_load_module_from_memory(xmp_context opaque, void *mem, long size)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
-	struct module_data *m = &ctx->m;
-	struct xmp_module *mod = &m->mod;
-	int i;
+	HIO_HANDLE *h;
+	int ret;
 
-	D_(D_INFO "Freeing memory");
+	if ((h = hio_open_mem(mem, size)) == NULL)
+		return -XMP_ERROR_INVALID;
 
-	if (m->extra) {
-		free(m->extra);
+	if (decrunch(&h, DECRUNCH_MAX) < 0) {
+		hio_close(h);
+		return -XMP_ERROR_DEPACK;
 	}
 
-	if (m->med_vol_table) {
-		for (i = 0; i < mod->ins; i++)
-			if (m->med_vol_table[i])
-				free(m->med_vol_table[i]);
-		free(m->med_vol_table);
+	if (hio_size(h) < 256) {
+		hio_close(h);
+		return -XMP_ERROR_FORMAT;
 	}
 
-	if (m->med_wav_table) {
-		for (i = 0; i < mod->ins; i++)
-			if (m->med_wav_table[i])
-				free(m->med_wav_table[i]);
-		free(m->med_wav_table);
-	}
+	/* No path: loaders looking for external files won't find any */
+	ret = load_module(opaque, h, "");
+	if (ret == 0 && ctx->m.map == h)
+		return 0;			/* depacked data owned by the module */
+	hio_close(h);
 
-	for (i = 0; i < mod->trk; i++) {
-		free(mod->xxt[i]);
-	}
+	return ret;
+}
 
-	for (i = 0; i < mod->pat; i++) {
-		free(mod->xxp[i]);
-	}
+static struct module_ref *new_module_ref(struct module_data *m)
+{
+	struct module_ref *ref;
+
+	if ((ref = malloc(sizeof (struct module_ref))) == NULL)
+		return NULL;
+
+	ref->count = 1;
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_init(&ref->lock, NULL);
+#endif
+
+	/* The module data now belongs to the reference */
+	ref->arena = m->arena;
+	ref->track_arena = m->track_arena;
+	ref->map = m->map;
+	m->arena.block = NULL;
+	m->track_arena.block = NULL;
+
+	return ref;
+}
+
+static void get_module_ref(struct module_ref *ref)
+{
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_lock(&ref->lock);
+#endif
+	ref->count++;
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_unlock(&ref->lock);
+#endif
+}
+
+static void put_module_ref(struct module_ref *ref)
+{
+	int count;
 
-	for (i = 0; i < mod->ins; i++) {
-		free(mod->xxi[i].sub);
-		if (mod->xxi[i].extra)
-			free(mod->xxi[i].extra);
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_lock(&ref->lock);
+#endif
+	count = --ref->count;
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_unlock(&ref->lock);
+#endif
+
+	if (count > 0)
+		return;
+
+	if (ref->map != NULL)
+		hio_close(ref->map);
+	arena_release(&ref->arena);
+	arena_release(&ref->track_arena);
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_destroy(&ref->lock);
+#endif
+	free(ref);
+}
+
+int xmp_share_module(xmp_context opaque, xmp_context source)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct context_data *src = (struct context_data *)source;
+	struct module_data *m = &ctx->m;
+	struct module_data *sm = &src->m;
+	struct arena arena, track_arena;
+	char *instrument_path;
+	int smpctl, patctl, scanctl;
+
+	if (ctx == src || ctx->p.xc_data != NULL)
+		return -XMP_ERROR_INVALID;
+
+	scan_wait(src);
+
+	/* The source must have a module, and this context must not */
+	if (sm->ref == NULL && sm->arena.block == NULL)
+		return -XMP_ERROR_INVALID;
+	if (m->ref != NULL || m->arena.block != NULL)
+		return -XMP_ERROR_INVALID;
+
+	if (sm->ref == NULL) {
+		/* Players sharing the module can't load samples */
+		load_lazy_samples(sm);
+		if ((sm->ref = new_module_ref(sm)) == NULL)
+			return -XMP_ERROR_SYSTEM;
 	}
+	get_module_ref(sm->ref);
+
+	/* Keep the settings of this context */
+	arena = m->arena;
+	track_arena = m->track_arena;
+	instrument_path = m->instrument_path;
+	smpctl = m->smpctl;
+	patctl = m->patctl;
+	scanctl = m->scanctl;
+
+	memcpy(m, sm, sizeof (struct module_data));
+
+	m->arena = arena;
+	m->track_arena = track_arena;
+	m->instrument_path = instrument_path;
+	m->smpctl = smpctl;
+	m->patctl = patctl;
+	m->scanctl = scanctl;
+	m->synth_chip = NULL;
+
+	/* Sequences are scanned with the module, but kept in the player */
+	memcpy(ctx->p.sequence_control, src->p.sequence_control,
+						XMP_MAX_MOD_LENGTH);
+	memcpy(ctx->p.scan, src->p.scan, sizeof(ctx->p.scan));
+
+	/* Samples changed by the source player aren't shared */
+	if (src->p.invloop.xxs != NULL)
+		m->mod.xxs = src->p.invloop.orig;
 
-	free(mod->xxt);
-	free(mod->xxp);
-	if (mod->smp > 0) {
-		for (i = 0; i < mod->smp; i++) {
-			if (mod->xxs[i].data != NULL)
-				free(mod->xxs[i].data - 4);
-		}
-		free(mod->xxs);
+	return 0;
+}
+
+void xmp_release_module(xmp_context opaque)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct module_data *m = &ctx->m;
+
+	D_(D_INFO "Freeing memory");
+
+	scan_wait(ctx);
+
+	if (m->ref != NULL) {
+		if (m->map == m->ref->map)
+			m->map = NULL;
+		put_module_ref(m->ref);
+		m->ref = NULL;
 	}
-	free(mod->xxi);
-	if (m->comment) {
-		free(m->comment);
+
+	if (m->map != NULL) {
+		hio_close(m->map);
+		m->map = NULL;
 	}
 
-	D_("free dirname/basename");
-	free(m->dirname);
-	free(m->basename);
+	/* Patterns, tracks, instruments, samples and format-specific data
+	 * were all allocated from the module arenas
+	 */
+	release_module_data(m);
 }
 
 void xmp_scan_module(xmp_context opaque)
 {
 	struct context_data *ctx = (struct context_data *)opaque;
 
+	scan_wait(ctx);
 	scan_sequences(ctx);
 }
@@ -1,8 +1,10 @@
+#include <stdlib.h>
 #include <string.h>
 #include <fnmatch.h>
 #include <stdint.h>
 #include "common.h"
 #include "synth.h"
+#include "envelope.h"
 
 /* 
  * Check whether the given string matches one of the blacklisted glob
@@ -50,6 +52,7 @@ void load_prologue(struct context_data *ctx)
 	m->quirk = 0;
 	m->read_event_type = READ_EVENT_MOD;
 	m->comment = NULL;
+	m->format = NULL;
 
 	/* Set defaults */
     	m->mod.pat = 0;
@@ -67,6 +70,7 @@ void load_prologue(struct context_data *ctx)
 	m->time_factor = DEFAULT_TIME_FACTOR;
 	m->med_vol_table = NULL;
 	m->med_wav_table = NULL;
+	m->trk_index = NULL;
 
 	for (i = 0; i < 64; i++) {
 		m->mod.xxc[i].pan = (((i + 1) / 2) % 2) * 0xff;
@@ -75,7 +79,229 @@ void load_prologue(struct context_data *ctx)
 	}
 }
 
-void load_epilogue(struct context_data *ctx)
+static size_t track_size(struct xmp_track *t)
+{
+	return sizeof (struct xmp_track) +
+		sizeof (struct xmp_event) * (t->rows > 1 ? t->rows - 1 : 0);
+}
+
+static uint32 track_hash(struct xmp_track *t)
+{
+	uint8 *d = (uint8 *)t->event;
+	uint32 h = 2166136261U ^ t->rows;	/* FNV-1a */
+	int i;
+
+	for (i = 0; i < t->rows * sizeof (struct xmp_event); i++) {
+		h = (h ^ d[i]) * 16777619U;
+	}
+
+	return h;
+}
+
+/*
+ * Copy the tracks to a single block in the order they are used by the
+ * patterns, storing identical tracks only once. Track numbers in the
+ * patterns don't change, duplicate entries in xxt just point to the
+ * same data. The arena holding the original tracks is released.
+ */
+static int compact_tracks(struct module_data *m)
+{
+	struct xmp_module *mod = &m->mod;
+	struct xmp_track *t, **uniq;
+	int *order, *canon, *head, *next;
+	int i, j, k, num, nuniq, mask;
+	uint32 *hash;
+	size_t size;
+	uint8 *pool;
+	int ret = -1;
+
+	if (mod->trk <= 0 || mod->xxt == NULL || mod->xxp == NULL)
+		return 0;
+
+	for (mask = 1; mask < mod->trk; mask <<= 1);
+
+	order = malloc(sizeof (int) * mod->trk);
+	canon = malloc(sizeof (int) * mod->trk);
+	next = malloc(sizeof (int) * mod->trk);
+	hash = malloc(sizeof (uint32) * mod->trk);
+	uniq = malloc(sizeof (struct xmp_track *) * mod->trk);
+	head = malloc(sizeof (int) * mask);
+	mask--;
+
+	if (!order || !canon || !next || !hash || !uniq || !head)
+		goto err;
+
+	/* Lay out tracks in pattern order, then those not in any pattern */
+	for (i = 0; i < mod->trk; i++) {
+		canon[i] = -2;
+	}
+	for (num = i = 0; i < mod->pat; i++) {
+		if (mod->xxp[i] == NULL)
+			continue;
+		for (j = 0; j < mod->chn; j++) {
+			k = mod->xxp[i]->index[j];
+			if (k >= 0 && k < mod->trk && canon[k] == -2) {
+				canon[k] = -1;
+				order[num++] = k;
+			}
+		}
+	}
+	for (i = 0; i < mod->trk; i++) {
+		if (canon[i] == -2)
+			order[num++] = i;
+	}
+
+	for (i = 0; i <= mask; i++) {
+		head[i] = -1;
+	}
+
+	size = 0;
+	nuniq = 0;
+	for (i = 0; i < mod->trk; i++) {
+		k = order[i];
+		t = mod->xxt[k];
+		canon[k] = -1;
+		if (t == NULL)
+			continue;
+
+		hash[k] = track_hash(t);
+		for (j = head[hash[k] & mask]; j >= 0; j = next[j]) {
+			if (hash[j] == hash[k] && mod->xxt[j]->rows == t->rows &&
+			    !memcmp(mod->xxt[j]->event, t->event,
+				    t->rows * sizeof (struct xmp_event))) {
+				canon[k] = canon[j];
+				break;
+			}
+		}
+
+		if (canon[k] < 0) {
+			canon[k] = nuniq++;
+			next[k] = head[hash[k] & mask];
+			head[hash[k] & mask] = k;
+			size += track_size(t);
+		}
+	}
+
+	if ((pool = arena_malloc(&m->arena, size)) == NULL)
+		goto err;
+
+	/* Copy each unique track once, in layout order */
+	for (i = 0; i < nuniq; i++) {
+		uniq[i] = NULL;
+	}
+	for (i = 0; i < mod->trk; i++) {
+		k = order[i];
+		t = mod->xxt[k];
+		if (t == NULL)
+			continue;
+		if (uniq[canon[k]] == NULL) {
+			size = track_size(t);
+			memcpy(pool, t, size);
+			uniq[canon[k]] = (struct xmp_track *)pool;
+			pool += size;
+		}
+	}
+
+	for (i = 0; i < mod->trk; i++) {
+		if (mod->xxt[i] != NULL)
+			mod->xxt[i] = uniq[canon[i]];
+	}
+
+	D_(D_INFO "compact tracks: %d unique of %d", nuniq, mod->trk);
+	arena_release(&m->track_arena);
+	ret = 0;
+
+    err:
+	free(head);
+	free(uniq);
+	free(hash);
+	free(next);
+	free(canon);
+	free(order);
+
+	return ret;
+}
+
+/* Build a flat pattern/channel table of tracks for the player */
+static int index_tracks(struct module_data *m)
+{
+	struct xmp_module *mod = &m->mod;
+	struct xmp_track *empty;
+	int i, j, k;
+
+	m->trk_index = arena_malloc(&m->arena, sizeof (struct xmp_track *) *
+					mod->pat * mod->chn);
+	empty = arena_calloc(&m->arena, 1, sizeof (struct xmp_track));
+	if (m->trk_index == NULL || empty == NULL)
+		return -1;
+
+	for (i = 0; i < mod->pat; i++) {
+		for (j = 0; j < mod->chn; j++) {
+			struct xmp_track *t = empty;
+
+			if (mod->xxp != NULL && mod->xxp[i] != NULL) {
+				k = mod->xxp[i]->index[j];
+				if (k >= 0 && k < mod->trk && mod->xxt != NULL &&
+				    mod->xxt[k] != NULL)
+					t = mod->xxt[k];
+			}
+			m->trk_index[i * mod->chn + j] = t;
+		}
+	}
+
+	return 0;
+}
+
+static int is_empty_event(struct xmp_event *e)
+{
+	return e->note == 0 && e->ins == 0 && e->vol == 0 && e->fxt == 0 &&
+		e->fxp == 0 && e->f2t == 0 && e->f2p == 0;
+}
+
+/* Mark the channels with events in each pattern row, so the player can
+ * skip decoding empty events
+ */
+static int index_events(struct module_data *m)
+{
+	struct xmp_module *mod = &m->mod;
+	int i, j, k, num;
+
+	m->row_index = arena_malloc(&m->arena, sizeof (int) *
+					(mod->pat > 0 ? mod->pat : 1));
+	if (m->row_index == NULL)
+		return -1;
+
+	for (num = i = 0; i < mod->pat; i++) {
+		m->row_index[i] = num;
+		if (mod->xxp != NULL && mod->xxp[i] != NULL)
+			num += mod->xxp[i]->rows;
+	}
+
+	m->row_events = arena_calloc(&m->arena, num > 0 ? num : 1,
+							sizeof (uint64));
+	if (m->row_events == NULL)
+		return -1;
+
+	for (i = 0; i < mod->pat; i++) {
+		struct xmp_track **track = PATTERN_TRACKS(i);
+		uint64 *row_events = m->row_events + m->row_index[i];
+
+		if (mod->xxp == NULL || mod->xxp[i] == NULL)
+			continue;
+
+		for (j = 0; j < mod->chn; j++) {
+			for (k = 0; k < mod->xxp[i]->rows; k++) {
+				if (k < track[j]->rows &&
+				    !is_empty_event(&track[j]->event[k]))
+					row_events[k] |= (uint64)1 << j;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int load_epilogue(struct context_data *ctx)
 {
 	struct module_data *m = &ctx->m;
 	int i, j;
@@ -114,7 +340,25 @@ void load_epilogue(struct context_data *ctx)
 		}
 	}
 
-	scan_sequences(ctx);
+	if (m->patctl & XMP_PATCTL_COMPACT) {
+		if (compact_tracks(m) < 0)
+			return -1;
+	}
+
+	if (index_tracks(m) < 0)
+		return -1;
+
+	if (m->patctl & XMP_PATCTL_INDEX) {
+		if (index_events(m) < 0)
+			return -1;
+	}
+
+	if (compile_envelopes(m) < 0)
+		return -1;
+
+	scan_start(ctx);
+
+	return 0;
 }
 
 
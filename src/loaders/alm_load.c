@@ -20,8 +20,8 @@
 #include <unistd.h>
 
 
-static int alm_test (FILE *, char *, const int);
-static int alm_load (struct module_data *, FILE *, const int);
+static int alm_test (HIO_HANDLE *, char *, const int);
+static int alm_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader alm_loader = {
     "Aley Keptr (ALM)",
@@ -29,11 +29,11 @@ const struct format_loader alm_loader = {
     alm_load
 };
 
-static int alm_test(FILE *f, char *t, const int start)
+static int alm_test(HIO_HANDLE *f, char *t, const int start)
 {
     char buf[7];
 
-    if (fread(buf, 1, 7, f) < 7)
+    if (hio_read(buf, 1, 7, f) < 7)
 	return -1;
 
     if (memcmp(buf, "ALEYMOD", 7) && memcmp(buf, "ALEY MO", 7))
@@ -56,32 +56,34 @@ struct alm_file_header {
 
 #define NAME_SIZE 255
 
-static int alm_load(struct module_data *m, FILE *f, const int start)
+static int alm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
     struct xmp_module *mod = &m->mod;
     int i, j;
     struct alm_file_header afh;
     struct xmp_event *event;
     uint8 b;
-    char *basename;
+    char *basename, *p;
     char filename[NAME_SIZE];
     char modulename[NAME_SIZE];
-    FILE *s;
+    HIO_HANDLE *s;
 
     LOAD_INIT();
 
-    fread(&afh.id, 7, 1, f);
+    hio_read(&afh.id, 7, 1, f);
 
     if (!strncmp((char *)afh.id, "ALEYMOD", 7))		/* Version 1.0 */
 	mod->spd = afh.speed / 2;
 
     strncpy(modulename, m->filename, NAME_SIZE);
-    basename = strtok (modulename, ".");
+    basename = modulename + strspn(modulename, ".");
+    if ((p = strchr(basename, '.')) != NULL)
+	*p = 0;
 
-    afh.speed = read8(f);
-    afh.length = read8(f);
-    afh.restart = read8(f);
-    fread(&afh.order, 128, 1, f);
+    afh.speed = hio_read8(f);
+    afh.length = hio_read8(f);
+    afh.restart = hio_read8(f);
+    hio_read(&afh.order, 128, 1, f);
 
     mod->len = afh.length;
     mod->rst = afh.restart;
@@ -112,10 +114,10 @@ static int alm_load(struct module_data *m, FILE *f, const int start)
 	TRACK_ALLOC (i);
 	for (j = 0; j < 64 * mod->chn; j++) {
 	    event = &EVENT (i, j % mod->chn, j / mod->chn);
-	    b = read8(f);
+	    b = hio_read8(f);
 	    if (b)
 		event->note = (b == 37) ? 0x61 : b + 48;
-	    event->ins = read8(f);
+	    event->ins = hio_read8(f);
 	}
     }
 
@@ -126,23 +128,24 @@ static int alm_load(struct module_data *m, FILE *f, const int start)
     D_(D_INFO "Loading samples: %d", mod->ins);
 
     for (i = 0; i < mod->ins; i++) {
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 	snprintf(filename, NAME_SIZE, "%s.%d", basename, i + 1);
-	s = fopen (filename, "rb");
+	s = hio_open(filename, "rb");
 
 	if (!(mod->xxi[i].nsm = (s != NULL)))
 	    continue;
 
-	int64_t len = fsize(s);
-	b = read8(s);		/* Get first octet */
+	int64_t len = hio_size(s);
+	b = hio_read8(s);		/* Get first octet */
 	mod->xxs[i].len = len - 5 * !b;
 
 	if (!b) {		/* Instrument with header */
-	    mod->xxs[i].lps = read16l(f);
-	    mod->xxs[i].lpe = read16l(f);
+	    mod->xxs[i].lps = hio_read16l(f);
+	    mod->xxs[i].lpe = hio_read16l(f);
 	    mod->xxs[i].flg = mod->xxs[i].lpe > mod->xxs[i].lps ? XMP_SAMPLE_LOOP : 0;
 	} else {
-	    fseek(s, 0, SEEK_SET);
+	    hio_seek(s, 0, SEEK_SET);
 	}
 
 	mod->xxi[i].sub[0].pan = 0x80;
@@ -153,9 +156,9 @@ static int alm_load(struct module_data *m, FILE *f, const int start)
 		filename, mod->xxs[i].len, mod->xxs[i].lps, mod->xxs[i].lpe,
 		mod->xxs[i].flg & XMP_SAMPLE_LOOP ? 'L' : ' ', mod->xxi[i].sub[0].vol);
 
-	load_sample(s, SAMPLE_FLAG_UNS, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
+	load_sample(m, s, SAMPLE_FLAG_UNS, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 
-	fclose(s);
+	hio_close(s);
     }
 
     /* ALM is LRLR, not LRRL */
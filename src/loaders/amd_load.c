@@ -10,8 +10,8 @@
 #include "synth.h"
 
 
-static int amd_test (FILE *, char *, const int);
-static int amd_load (struct module_data *, FILE *, const int);
+static int amd_test (HIO_HANDLE *, char *, const int);
+static int amd_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader amd_loader = {
     "Amusic Adlib Tracker (AMD)",
@@ -19,18 +19,18 @@ const struct format_loader amd_loader = {
     amd_load
 };
 
-static int amd_test(FILE *f, char *t, const int start)
+static int amd_test(HIO_HANDLE *f, char *t, const int start)
 {
     char buf[9];
 
-    fseek(f, start + 1062, SEEK_SET);
-    if (fread(buf, 1, 9, f) < 9)
+    hio_seek(f, start + 1062, SEEK_SET);
+    if (hio_read(buf, 1, 9, f) < 9)
 	return -1;
 
     if (memcmp(buf, "<o", 2) || memcmp(buf + 6, "RoR", 3))
 	return -1;
 
-    fseek(f, start + 0, SEEK_SET);
+    hio_seek(f, start + 0, SEEK_SET);
     read_title(f, t, 24);
 
     return 0;
@@ -57,7 +57,7 @@ struct amd_file_header {
 
 
 
-static int amd_load(struct module_data *m, FILE *f, const int start)
+static int amd_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
     struct xmp_module *mod = &m->mod;
     int r, i, j, tmode = 1;
@@ -70,17 +70,17 @@ static int amd_load(struct module_data *m, FILE *f, const int start)
 
     LOAD_INIT();
 
-    fread(&afh.name, 24, 1, f);
-    fread(&afh.author, 24, 1, f);
+    hio_read(&afh.name, 24, 1, f);
+    hio_read(&afh.author, 24, 1, f);
     for (i = 0; i < 26; i++) {
-	fread(&afh.ins[i].name, 23, 1, f);
-	fread(&afh.ins[i].reg, 11, 1, f);
+	hio_read(&afh.ins[i].name, 23, 1, f);
+	hio_read(&afh.ins[i].reg, 11, 1, f);
     }
-    afh.len = read8(f);
-    afh.pat = read8(f);
-    fread(&afh.order, 128, 1, f);
-    fread(&afh.magic, 9, 1, f);
-    afh.version = read8(f);
+    afh.len = hio_read8(f);
+    afh.pat = hio_read8(f);
+    hio_read(&afh.order, 128, 1, f);
+    hio_read(&afh.magic, 9, 1, f);
+    afh.version = hio_read8(f);
 
     mod->chn = 9;
     mod->bpm = 125;
@@ -101,7 +101,8 @@ static int amd_load(struct module_data *m, FILE *f, const int start)
 
     /* Load instruments */
     for (i = 0; i < mod->ins; i++) {
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 
 	copy_adjust(mod->xxi[i].name, afh.ins[i].name, 23);
 
@@ -116,7 +117,7 @@ static int amd_load(struct module_data *m, FILE *f, const int start)
 
 	D_(D_INFO "\n[%2X] %-23.23s", i, mod->xxi[i].name);
 
-	load_sample(f, SAMPLE_FLAG_ADLIB, NULL, regs);
+	load_sample(m, f, SAMPLE_FLAG_ADLIB, NULL, regs);
     }
 
     if (!afh.version) {
@@ -126,12 +127,13 @@ static int amd_load(struct module_data *m, FILE *f, const int start)
 
     D_(D_INFO "Stored patterns: %d", mod->pat);
 
-    mod->xxp = calloc (sizeof (struct xmp_pattern *), mod->pat + 1);
+    mod->xxp = arena_calloc(&m->arena,
+    			sizeof (struct xmp_pattern *), mod->pat + 1);
 
     for (i = 0; i < mod->pat; i++) {
 	PATTERN_ALLOC (i);
 	for (j = 0; j < 9; j++) {
-	    w = read16l(f);
+	    w = hio_read16l(f);
 	    mod->xxp[i]->index[j] = w;
 	    if (w > mod->trk)
 		mod->trk = w;
@@ -140,27 +142,27 @@ static int amd_load(struct module_data *m, FILE *f, const int start)
     }
     mod->trk++;
 
-    w = read16l(f);
+    w = hio_read16l(f);
 
     D_(D_INFO "Stored tracks: %d", w);
 
-    mod->xxt = calloc (sizeof (struct xmp_track *), mod->trk);
+    mod->xxt = arena_calloc(&m->arena, sizeof (struct xmp_track *), mod->trk);
     mod->trk = w;
 
     for (i = 0; i < mod->trk; i++) {
-	w = read16l(f);
-	mod->xxt[w] = calloc (sizeof (struct xmp_track) +
+	w = hio_read16l(f);
+	mod->xxt[w] = arena_calloc(&m->track_arena, sizeof (struct xmp_track) +
 	    sizeof (struct xmp_event) * 64, 1);
 	mod->xxt[w]->rows = 64;
 	for (r = 0; r < 64; r++) {
 	    event = &mod->xxt[w]->event[r];
-	    b = read8(f);		/* Effect parameter */
+	    b = hio_read8(f);		/* Effect parameter */
 	    if (b & 0x80) {
 		r += (b & 0x7f) - 1;
 		continue;
 	    }
 	    event->fxp = b;
-	    b = read8(f);		/* Instrument + effect type */
+	    b = hio_read8(f);		/* Instrument + effect type */
 	    event->ins = MSN (b);
 	    switch (b = LSN (b)) {
 	    case 0:		/* Arpeggio */
@@ -193,7 +195,7 @@ static int amd_load(struct module_data *m, FILE *f, const int start)
 		break;
 	    }
 	    event->fxt = b;
-	    b = read8(f);	/* Note + octave + instrument */
+	    b = hio_read8(f);	/* Note + octave + instrument */
 	    event->ins |= (b & 1) << 4;
 	    if ((event->note = MSN (b)))
 		event->note += (2 + ((b & 0xe) >> 1)) * 12;
@@ -13,8 +13,8 @@
 #define MAGIC_MNAM	MAGIC4('M','N','A','M')
 
 
-static int arch_test (FILE *, char *, const int);
-static int arch_load (struct module_data *, FILE *, const int);
+static int arch_test (HIO_HANDLE *, char *, const int);
+static int arch_load (struct module_data *, HIO_HANDLE *, const int);
 
 
 const struct format_loader arch_loader = {
@@ -48,23 +48,23 @@ static uint8 convert_vol(uint8 vol) {
 }
 #endif
 
-static int arch_test(FILE *f, char *t, const int start)
+static int arch_test(HIO_HANDLE *f, char *t, const int start)
 {
-	if (read32b(f) != MAGIC_MUSX)
+	if (hio_read32b(f) != MAGIC_MUSX)
 		return -1;
 
-	read32l(f);
+	hio_read32l(f);
 
-	while (!feof(f)) {
-		uint32 id = read32b(f);
-		uint32 len = read32l(f);
+	while (!hio_eof(f)) {
+		uint32 id = hio_read32b(f);
+		uint32 len = hio_read32l(f);
 
 		if (id == MAGIC_MNAM) {
 			read_title(f, t, 32);
 			return 0;
 		}
 
-		fseek(f, len, SEEK_CUR);
+		hio_seek(f, len, SEEK_CUR);
 	}
 
 	read_title(f, t, 0);
@@ -76,6 +76,7 @@ static int arch_test(FILE *f, char *t, const int start)
 struct local_data {
     int year, month, day;
     int pflag, sflag, max_ins;
+    int pat, ins;		/* next pattern and instrument */
     uint8 ster[8], rows[64];
 };
 
@@ -147,37 +148,37 @@ static void fix_effect(struct xmp_event *e)
 	}
 }
 
-static void get_tinf(struct module_data *m, int size, FILE *f, void *parm)
+static void get_tinf(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct local_data *data = (struct local_data *)parm;
 	int x;
 
-	x = read8(f);
+	x = hio_read8(f);
 	data->year = ((x & 0xf0) >> 4) * 10 + (x & 0x0f);
-	x = read8(f);
+	x = hio_read8(f);
 	data->year += ((x & 0xf0) >> 4) * 1000 + (x & 0x0f) * 100;
 
-	x = read8(f);
+	x = hio_read8(f);
 	data->month = ((x & 0xf0) >> 4) * 10 + (x & 0x0f);
 
-	x = read8(f);
+	x = hio_read8(f);
 	data->day = ((x & 0xf0) >> 4) * 10 + (x & 0x0f);
 }
 
-static void get_mvox(struct module_data *m, int size, FILE *f, void *parm)
+static void get_mvox(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 
-	mod->chn = read32l(f);
+	mod->chn = hio_read32l(f);
 }
 
-static void get_ster(struct module_data *m, int size, FILE *f, void *parm)
+static void get_ster(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
 	int i;
 
-	fread(data->ster, 1, 8, f);
+	hio_read(data->ster, 1, 8, f);
 	
 	for (i=0; i < mod->chn; i++) {
 		if (data->ster[i] > 0 && data->ster[i] < 8) {
@@ -186,66 +187,67 @@ static void get_ster(struct module_data *m, int size, FILE *f, void *parm)
 	}
 }
 
-static void get_mnam(struct module_data *m, int size, FILE *f, void *parm)
+static void get_mnam(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 
-	fread(mod->name, 1, 32, f);
+	hio_read(mod->name, 1, 32, f);
 }
 
-static void get_anam(struct module_data *m, int size, FILE *f, void *parm)
+static void get_anam(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
-	/*fread(m->author, 1, 32, f); */
+	/*hio_read(m->author, 1, 32, f); */
 }
 
-static void get_mlen(struct module_data *m, int size, FILE *f, void *parm)
+static void get_mlen(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 
-	mod->len = read32l(f);
+	mod->len = hio_read32l(f);
 }
 
-static void get_pnum(struct module_data *m, int size, FILE *f, void *parm)
+static void get_pnum(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 
-	mod->pat = read32l(f);
+	mod->pat = hio_read32l(f);
 }
 
-static void get_plen(struct module_data *m, int size, FILE *f, void *parm)
+static void get_plen(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct local_data *data = (struct local_data *)parm;
 
-	fread(data->rows, 1, 64, f);
+	hio_read(data->rows, 1, 64, f);
 }
 
-static void get_sequ(struct module_data *m, int size, FILE *f, void *parm)
+static void get_sequ(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 
-	fread(mod->xxo, 1, 128, f);
+	hio_read(mod->xxo, 1, 128, f);
 
 	set_type(m, "Archimedes Tracker");
 
 	MODULE_INFO();
 }
 
-static void get_patt(struct module_data *m, int size, FILE *f, void *parm)
+static void get_patt(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
-	static int i = 0;
-	int j, k;
+	int i, j, k;
 	struct xmp_event *event;
 
 	if (!data->pflag) {
 		D_(D_INFO "Stored patterns: %d", mod->pat);
 		data->pflag = 1;
-		i = 0;
+		data->pat = 0;
 		mod->trk = mod->pat * mod->chn;
 		PATTERN_INIT();
 	}
 
+	i = data->pat++;
+
 	PATTERN_ALLOC(i);
 	mod->xxp[i]->rows = data->rows[i];
 	TRACK_ALLOC(i);
@@ -254,10 +256,10 @@ static void get_patt(struct module_data *m, int size, FILE *f, void *parm)
 		for (k = 0; k < mod->chn; k++) {
 			event = &EVENT(i, k, j);
 
-			event->fxp = read8(f);
-			event->fxt = read8(f);
-			event->ins = read8(f);
-			event->note = read8(f);
+			event->fxp = hio_read8(f);
+			event->fxt = hio_read8(f);
+			event->ins = hio_read8(f);
+			event->note = hio_read8(f);
 
 			if (event->note)
 				event->note += 48;
@@ -265,15 +267,13 @@ static void get_patt(struct module_data *m, int size, FILE *f, void *parm)
 			fix_effect(event);
 		}
 	}
-
-	i++;
 }
 
-static void get_samp(struct module_data *m, int size, FILE *f, void *parm)
+static void get_samp(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
-	static int i = 0;
+	int i;
 
 	if (!data->sflag) {
 		mod->smp = mod->ins = 36;
@@ -283,9 +283,11 @@ static void get_samp(struct module_data *m, int size, FILE *f, void *parm)
 
 		data->sflag = 1;
 		data->max_ins = 0;
-		i = 0;
+		data->ins = 0;
 	}
 
+	i = data->ins;
+
 	/* FIXME: More than 36 sample slots used.  Unfortunately we
 	 * have no way to handle this without two passes, and there's
 	 * only officially supposed to be 36, so ignore the rest.
@@ -293,31 +295,32 @@ static void get_samp(struct module_data *m, int size, FILE *f, void *parm)
 	if (i >= 36)
 		return;
 
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
-	read32l(f);	/* SNAM */
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
+	hio_read32l(f);	/* SNAM */
 	{
 		/* should usually be 0x14 but zero is not unknown */
-		int name_len = read32l(f);
+		int name_len = hio_read32l(f);
 		if (name_len < 32)
-			fread(mod->xxi[i].name, 1, name_len, f);
+			hio_read(mod->xxi[i].name, 1, name_len, f);
 	}
-	read32l(f);	/* SVOL */
-	read32l(f);
-	/* mod->xxi[i].sub[0].vol = convert_vol(read32l(f)); */
-	mod->xxi[i].sub[0].vol = read32l(f) & 0xff;
-	read32l(f);	/* SLEN */
-	read32l(f);
-	mod->xxs[i].len = read32l(f);
-	read32l(f);	/* ROFS */
-	read32l(f);
-	mod->xxs[i].lps = read32l(f);
-	read32l(f);	/* RLEN */
-	read32l(f);
-	mod->xxs[i].lpe = read32l(f);
-
-	read32l(f);	/* SDAT */
-	read32l(f);
-	read32l(f);	/* 0x00000000 */
+	hio_read32l(f);	/* SVOL */
+	hio_read32l(f);
+	/* mod->xxi[i].sub[0].vol = convert_vol(hio_read32l(f)); */
+	mod->xxi[i].sub[0].vol = hio_read32l(f) & 0xff;
+	hio_read32l(f);	/* SLEN */
+	hio_read32l(f);
+	mod->xxs[i].len = hio_read32l(f);
+	hio_read32l(f);	/* ROFS */
+	hio_read32l(f);
+	mod->xxs[i].lps = hio_read32l(f);
+	hio_read32l(f);	/* RLEN */
+	hio_read32l(f);
+	mod->xxs[i].lpe = hio_read32l(f);
+
+	hio_read32l(f);	/* SDAT */
+	hio_read32l(f);
+	hio_read32l(f);	/* 0x00000000 */
 
 	mod->xxi[i].nsm = 1;
 	mod->xxi[i].sub[0].sid = i;
@@ -336,7 +339,7 @@ static void get_samp(struct module_data *m, int size, FILE *f, void *parm)
 		mod->xxs[i].lpe = mod->xxs[i].len;
 	}
 
-	load_sample(f, SAMPLE_FLAG_VIDC, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
+	load_sample(m, f, SAMPLE_FLAG_VIDC, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 
 	D_(D_INFO "[%2X] %-20.20s %05x %05x %05x %c V%02x",
 				i, mod->xxi[i].name,
@@ -346,11 +349,11 @@ static void get_samp(struct module_data *m, int size, FILE *f, void *parm)
 				mod->xxs[i].flg & XMP_SAMPLE_LOOP ? 'L' : ' ',
 				mod->xxi[i].sub[0].vol);
 
-	i++;
+	data->ins++;
 	data->max_ins++;
 }
 
-static int arch_load(struct module_data *m, FILE *f, const int start)
+static int arch_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct xmp_module *mod = &m->mod;
 	iff_handle handle;
@@ -359,8 +362,8 @@ static int arch_load(struct module_data *m, FILE *f, const int start)
 
 	LOAD_INIT();
 
-	read32b(f);	/* MUSX */
-	read32b(f);
+	hio_read32b(f);	/* MUSX */
+	hio_read32b(f);
 
 	data.pflag = data.sflag = 0;
 	data.year = data.month = data.day = 0;
@@ -385,7 +388,7 @@ static int arch_load(struct module_data *m, FILE *f, const int start)
 	iff_set_quirk(handle, IFF_LITTLE_ENDIAN);
 
 	/* Load IFF chunks */
-	while (!feof(f)) {
+	while (!hio_eof(f)) {
 		iff_chunk(handle, m, f, &data);
 	}
 
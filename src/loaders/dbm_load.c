@@ -17,8 +17,8 @@
 #define MAGIC_DBM0	MAGIC4('D','B','M','0')
 
 
-static int dbm_test(FILE *, char *, const int);
-static int dbm_load (struct module_data *, FILE *, const int);
+static int dbm_test(HIO_HANDLE *, char *, const int);
+static int dbm_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader dbm_loader = {
 	"DigiBooster Pro (DBM)",
@@ -26,12 +26,12 @@ const struct format_loader dbm_loader = {
 	dbm_load
 };
 
-static int dbm_test(FILE * f, char *t, const int start)
+static int dbm_test(HIO_HANDLE *f, char *t, const int start)
 {
-	if (read32b(f) != MAGIC_DBM0)
+	if (hio_read32b(f) != MAGIC_DBM0)
 		return -1;
 
-	fseek(f, 12, SEEK_CUR);
+	hio_seek(f, 12, SEEK_CUR);
 	read_title(f, t, 44);
 
 	return 0;
@@ -43,22 +43,22 @@ struct local_data {
 };
 
 
-static void get_info(struct module_data *m, int size, FILE *f, void *parm)
+static void get_info(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 
-	mod->ins = read16b(f);
-	mod->smp = read16b(f);
-	read16b(f);			/* Songs */
-	mod->pat = read16b(f);
-	mod->chn = read16b(f);
+	mod->ins = hio_read16b(f);
+	mod->smp = hio_read16b(f);
+	hio_read16b(f);			/* Songs */
+	mod->pat = hio_read16b(f);
+	mod->chn = hio_read16b(f);
 
 	mod->trk = mod->pat * mod->chn;
 
 	INSTRUMENT_INIT();
 }
 
-static void get_song(struct module_data *m, int size, FILE *f, void *parm)
+static void get_song(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
@@ -70,17 +70,17 @@ static void get_song(struct module_data *m, int size, FILE *f, void *parm)
 
 	data->have_song = 1;
 
-	fread(buffer, 44, 1, f);
+	hio_read(buffer, 44, 1, f);
 	D_(D_INFO "Song name: %s", buffer);
 
-	mod->len = read16b(f);
+	mod->len = hio_read16b(f);
 	D_(D_INFO "Song length: %d patterns", mod->len);
 
 	for (i = 0; i < mod->len; i++)
-		mod->xxo[i] = read16b(f);
+		mod->xxo[i] = hio_read16b(f);
 }
 
-static void get_inst(struct module_data *m, int size, FILE *f, void *parm)
+static void get_inst(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	int i;
@@ -90,23 +90,24 @@ static void get_inst(struct module_data *m, int size, FILE *f, void *parm)
 	D_(D_INFO "Instruments: %d", mod->ins);
 
 	for (i = 0; i < mod->ins; i++) {
-		mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+		mod->xxi[i].sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), 1);
 
 		mod->xxi[i].nsm = 1;
-		fread(buffer, 30, 1, f);
+		hio_read(buffer, 30, 1, f);
 		copy_adjust(mod->xxi[i].name, buffer, 30);
-		snum = read16b(f);
+		snum = hio_read16b(f);
 		if (snum == 0 || snum > mod->smp)
 			continue;
 		mod->xxi[i].sub[0].sid = --snum;
-		mod->xxi[i].sub[0].vol = read16b(f);
-		c2spd = read32b(f);
-		mod->xxs[snum].lps = read32b(f);
-		mod->xxs[snum].lpe = mod->xxs[i].lps + read32b(f);
-		mod->xxi[i].sub[0].pan = 0x80 + (int16)read16b(f);
+		mod->xxi[i].sub[0].vol = hio_read16b(f);
+		c2spd = hio_read32b(f);
+		mod->xxs[snum].lps = hio_read32b(f);
+		mod->xxs[snum].lpe = mod->xxs[i].lps + hio_read32b(f);
+		mod->xxi[i].sub[0].pan = 0x80 + (int16)hio_read16b(f);
 		if (mod->xxi[i].sub[0].pan > 0xff)
 			mod->xxi[i].sub[0].pan = 0xff;
-		flags = read16b(f);
+		flags = hio_read16b(f);
 		mod->xxs[snum].flg = flags & 0x03 ? XMP_SAMPLE_LOOP : 0;
 		mod->xxs[snum].flg |= flags & 0x02 ? XMP_SAMPLE_LOOP_BIDIR : 0;
 
@@ -118,7 +119,7 @@ static void get_inst(struct module_data *m, int size, FILE *f, void *parm)
 	}
 }
 
-static void get_patt(struct module_data *m, int size, FILE *f, void *parm)
+static void get_patt(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	int i, c, r, n, sz;
@@ -136,18 +137,18 @@ static void get_patt(struct module_data *m, int size, FILE *f, void *parm)
 
 	for (i = 0; i < mod->pat; i++) {
 		PATTERN_ALLOC(i);
-		mod->xxp[i]->rows = read16b(f);
+		mod->xxp[i]->rows = hio_read16b(f);
 		TRACK_ALLOC(i);
 
-		sz = read32b(f);
+		sz = hio_read32b(f);
 		//printf("rows = %d, size = %d\n", mod->xxp[i]->rows, sz);
 
 		r = 0;
 		c = -1;
 
 		while (sz > 0) {
-			//printf("  offset=%x,  sz = %d, ", ftell(f), sz);
-			c = read8(f);
+			//printf("  offset=%x,  sz = %d, ", hio_tell(f), sz);
+			c = hio_read8(f);
 			if (--sz <= 0) break;
 			//printf("c = %02x\n", c);
 
@@ -158,7 +159,7 @@ static void get_patt(struct module_data *m, int size, FILE *f, void *parm)
 			}
 			c--;
 
-			n = read8(f);
+			n = hio_read8(f);
 			if (--sz <= 0) break;
 			//printf("    n = %d\n", n);
 
@@ -168,28 +169,28 @@ static void get_patt(struct module_data *m, int size, FILE *f, void *parm)
 				event = &EVENT(i, c, r);
 
 			if (n & 0x01) {
-				x = read8(f);
+				x = hio_read8(f);
 				event->note = 13 + MSN(x) * 12 + LSN(x);
 				if (--sz <= 0) break;
 			}
 			if (n & 0x02) {
-				event->ins = read8(f);
+				event->ins = hio_read8(f);
 				if (--sz <= 0) break;
 			}
 			if (n & 0x04) {
-				event->fxt = read8(f);
+				event->fxt = hio_read8(f);
 				if (--sz <= 0) break;
 			}
 			if (n & 0x08) {
-				event->fxp = read8(f);
+				event->fxp = hio_read8(f);
 				if (--sz <= 0) break;
 			}
 			if (n & 0x10) {
-				event->f2t = read8(f);
+				event->f2t = hio_read8(f);
 				if (--sz <= 0) break;
 			}
 			if (n & 0x20) {
-				event->f2p = read8(f);
+				event->f2p = hio_read8(f);
 				if (--sz <= 0) break;
 			}
 
@@ -208,7 +209,7 @@ static void get_patt(struct module_data *m, int size, FILE *f, void *parm)
 	}
 }
 
-static void get_smpl(struct module_data *m, int size, FILE *f, void *parm)
+static void get_smpl(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	int i, flags;
@@ -216,8 +217,8 @@ static void get_smpl(struct module_data *m, int size, FILE *f, void *parm)
 	D_(D_INFO "Stored samples: %d", mod->smp);
 
 	for (i = 0; i < mod->smp; i++) {
-		flags = read32b(f);
-		mod->xxs[i].len = read32b(f);
+		flags = hio_read32b(f);
+		mod->xxs[i].len = hio_read32b(f);
 
 		if (flags & 0x02) {
 			mod->xxs[i].flg |= XMP_SAMPLE_16BIT;
@@ -225,11 +226,11 @@ static void get_smpl(struct module_data *m, int size, FILE *f, void *parm)
 
 		if (flags & 0x04) {	/* Skip 32-bit samples */
 			mod->xxs[i].len <<= 2;
-			fseek(f, mod->xxs[i].len, SEEK_CUR);
+			hio_seek(f, mod->xxs[i].len, SEEK_CUR);
 			continue;
 		}
 		
-		load_sample(f, SAMPLE_FLAG_BIGEND, &mod->xxs[i], NULL);
+		load_sample(m, f, SAMPLE_FLAG_BIGEND, &mod->xxs[i], NULL);
 
 		if (mod->xxs[i].len == 0)
 			continue;
@@ -244,33 +245,33 @@ static void get_smpl(struct module_data *m, int size, FILE *f, void *parm)
 	}
 }
 
-static void get_venv(struct module_data *m, int size, FILE *f, void *parm)
+static void get_venv(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	int i, j, nenv, ins;
 
-	nenv = read16b(f);
+	nenv = hio_read16b(f);
 
 	D_(D_INFO "Vol envelopes  : %d ", nenv);
 
 	for (i = 0; i < nenv; i++) {
-		ins = read16b(f) - 1;
-		mod->xxi[ins].aei.flg = read8(f) & 0x07;
-		mod->xxi[ins].aei.npt = read8(f);
-		mod->xxi[ins].aei.sus = read8(f);
-		mod->xxi[ins].aei.lps = read8(f);
-		mod->xxi[ins].aei.lpe = read8(f);
-		read8(f);	/* 2nd sustain */
-		//read8(f);	/* reserved */
+		ins = hio_read16b(f) - 1;
+		mod->xxi[ins].aei.flg = hio_read8(f) & 0x07;
+		mod->xxi[ins].aei.npt = hio_read8(f);
+		mod->xxi[ins].aei.sus = hio_read8(f);
+		mod->xxi[ins].aei.lps = hio_read8(f);
+		mod->xxi[ins].aei.lpe = hio_read8(f);
+		hio_read8(f);	/* 2nd sustain */
+		//hio_read8(f);	/* reserved */
 
 		for (j = 0; j < 32; j++) {
-			mod->xxi[ins].aei.data[j * 2 + 0] = read16b(f);
-			mod->xxi[ins].aei.data[j * 2 + 1] = read16b(f);
+			mod->xxi[ins].aei.data[j * 2 + 0] = hio_read16b(f);
+			mod->xxi[ins].aei.data[j * 2 + 1] = hio_read16b(f);
 		}
 	}
 }
 
-static int dbm_load(struct module_data *m, FILE *f, const int start)
+static int dbm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct xmp_module *mod = &m->mod;
 	iff_handle handle;
@@ -281,13 +282,13 @@ static int dbm_load(struct module_data *m, FILE *f, const int start)
 
 	LOAD_INIT();
 
-	read32b(f);		/* DBM0 */
+	hio_read32b(f);		/* DBM0 */
 
 	data.have_song = 0;
-	version = read16b(f);
+	version = hio_read16b(f);
 
-	fseek(f, 10, SEEK_CUR);
-	fread(name, 1, 44, f);
+	hio_seek(f, 10, SEEK_CUR);
+	hio_read(name, 1, 44, f);
 
 	handle = iff_new();
 	if (handle == NULL)
@@ -307,7 +308,7 @@ static int dbm_load(struct module_data *m, FILE *f, const int start)
 	MODULE_INFO();
 
 	/* Load IFF chunks */
-	while (!feof(f)) {
+	while (!hio_eof(f)) {
 		iff_chunk(handle, m, f, &data);
 	}
 
@@ -15,8 +15,8 @@
 #define MAGIC_D_T_	MAGIC4('D','.','T','.')
 
 
-static int dt_test(FILE *, char *, const int);
-static int dt_load (struct module_data *, FILE *, const int);
+static int dt_test(HIO_HANDLE *, char *, const int);
+static int dt_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader dt_loader = {
 	"Digital Tracker (DTM)",
@@ -24,18 +24,18 @@ const struct format_loader dt_loader = {
 	dt_load
 };
 
-static int dt_test(FILE *f, char *t, const int start)
+static int dt_test(HIO_HANDLE *f, char *t, const int start)
 {
-	if (read32b(f) != MAGIC_D_T_)
+	if (hio_read32b(f) != MAGIC_D_T_)
 		return -1;
 
-	read32b(f);			/* chunk size */
-	read16b(f);			/* type */
-	read16b(f);			/* 0xff then mono */
-	read16b(f);			/* reserved */
-	read16b(f);			/* tempo */
-	read16b(f);			/* bpm */
-	read32b(f);			/* undocumented */
+	hio_read32b(f);			/* chunk size */
+	hio_read16b(f);			/* type */
+	hio_read16b(f);			/* 0xff then mono */
+	hio_read16b(f);			/* reserved */
+	hio_read16b(f);			/* tempo */
+	hio_read16b(f);			/* bpm */
+	hio_read32b(f);			/* undocumented */
 
 	read_title(f, t, 32);
 
@@ -46,62 +46,64 @@ static int dt_test(FILE *f, char *t, const int start)
 struct local_data {
     int pflag, sflag;
     int realpat;
+    int last_pat;		/* next pattern to allocate */
+    int ins;			/* next instrument */
 };
 
 
-static void get_d_t_(struct module_data *m, int size, FILE *f, void *parm)
+static void get_d_t_(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	int b;
 
-	read16b(f);			/* type */
-	read16b(f);			/* 0xff then mono */
-	read16b(f);			/* reserved */
-	mod->spd = read16b(f);
-	if ((b = read16b(f)) > 0)	/* RAMBO.DTM has bpm 0 */
+	hio_read16b(f);			/* type */
+	hio_read16b(f);			/* 0xff then mono */
+	hio_read16b(f);			/* reserved */
+	mod->spd = hio_read16b(f);
+	if ((b = hio_read16b(f)) > 0)	/* RAMBO.DTM has bpm 0 */
 		mod->bpm = b;
-	read32b(f);			/* undocumented */
+	hio_read32b(f);			/* undocumented */
 
-	fread(mod->name, 32, 1, f);
+	hio_read(mod->name, 32, 1, f);
 	set_type(m, "Digital Tracker DTM");
 
 	MODULE_INFO();
 }
 
-static void get_s_q_(struct module_data *m, int size, FILE *f, void *parm)
+static void get_s_q_(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	int i, maxpat;
 
-	mod->len = read16b(f);
-	mod->rst = read16b(f);
-	read32b(f);	/* reserved */
+	mod->len = hio_read16b(f);
+	mod->rst = hio_read16b(f);
+	hio_read32b(f);	/* reserved */
 
 	for (maxpat = i = 0; i < 128; i++) {
-		mod->xxo[i] = read8(f);
+		mod->xxo[i] = hio_read8(f);
 		if (mod->xxo[i] > maxpat)
 			maxpat = mod->xxo[i];
 	}
 	mod->pat = maxpat + 1;
 }
 
-static void get_patt(struct module_data *m, int size, FILE *f, void *parm)
+static void get_patt(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
 
-	mod->chn = read16b(f);
-	data->realpat = read16b(f);
+	mod->chn = hio_read16b(f);
+	data->realpat = hio_read16b(f);
 	mod->trk = mod->chn * mod->pat;
 }
 
-static void get_inst(struct module_data *m, int size, FILE *f, void *parm)
+static void get_inst(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	int i, c2spd;
 	uint8 name[30];
 
-	mod->ins = mod->smp = read16b(f);
+	mod->ins = mod->smp = hio_read16b(f);
 
 	D_(D_INFO "Instruments    : %d ", mod->ins);
 
@@ -110,23 +112,24 @@ static void get_inst(struct module_data *m, int size, FILE *f, void *parm)
 	for (i = 0; i < mod->ins; i++) {
 		int fine, replen, flag;
 
-		mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+		mod->xxi[i].sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), 1);
 
-		read32b(f);		/* reserved */
-		mod->xxs[i].len = read32b(f);
+		hio_read32b(f);		/* reserved */
+		mod->xxs[i].len = hio_read32b(f);
 		mod->xxi[i].nsm = !!mod->xxs[i].len;
-		fine = read8s(f);	/* finetune */
-		mod->xxi[i].sub[0].vol = read8(f);
+		fine = hio_read8s(f);	/* finetune */
+		mod->xxi[i].sub[0].vol = hio_read8(f);
 		mod->xxi[i].sub[0].pan = 0x80;
-		mod->xxs[i].lps = read32b(f);
-		replen = read32b(f);
+		mod->xxs[i].lps = hio_read32b(f);
+		replen = hio_read32b(f);
 		mod->xxs[i].lpe = mod->xxs[i].lps + replen - 1;
 		mod->xxs[i].flg = replen > 2 ?  XMP_SAMPLE_LOOP : 0;
 
-		fread(name, 22, 1, f);
+		hio_read(name, 22, 1, f);
 		copy_adjust(mod->xxi[i].name, name, 22);
 
-		flag = read16b(f);	/* bit 0-7:resol 8:stereo */
+		flag = hio_read16b(f);	/* bit 0-7:resol 8:stereo */
 		if ((flag & 0xff) > 8) {
 			mod->xxs[i].flg |= XMP_SAMPLE_16BIT;
 			mod->xxs[i].len >>= 1;
@@ -134,8 +137,8 @@ static void get_inst(struct module_data *m, int size, FILE *f, void *parm)
 			mod->xxs[i].lpe >>= 1;
 		}
 
-		read32b(f);		/* midi note (0x00300000) */
-		c2spd = read32b(f);	/* frequency */
+		hio_read32b(f);		/* midi note (0x00300000) */
+		c2spd = hio_read32b(f);	/* frequency */
 		c2spd_to_note(c2spd, &mod->xxi[i].sub[0].xpo, &mod->xxi[i].sub[0].fin);
 
 		/* It's strange that we have both c2spd and finetune */
@@ -158,42 +161,41 @@ static void get_inst(struct module_data *m, int size, FILE *f, void *parm)
 	}
 }
 
-static void get_dapt(struct module_data *m, int size, FILE *f, void *parm)
+static void get_dapt(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
 	int pat, i, j, k;
 	struct xmp_event *event;
-	static int last_pat;
 	int rows;
 
 	if (!data->pflag) {
 		D_(D_INFO "Stored patterns: %d", mod->pat);
 		data->pflag = 1;
-		last_pat = 0;
+		data->last_pat = 0;
 		PATTERN_INIT();
 	}
 
-	read32b(f);	/* 0xffffffff */
-	i = pat = read16b(f);
-	rows = read16b(f);
+	hio_read32b(f);	/* 0xffffffff */
+	i = pat = hio_read16b(f);
+	rows = hio_read16b(f);
 
-	for (i = last_pat; i <= pat; i++) {
+	for (i = data->last_pat; i <= pat; i++) {
 		PATTERN_ALLOC(i);
 		mod->xxp[i]->rows = rows;
 		TRACK_ALLOC(i);
 	}
-	last_pat = pat + 1;
+	data->last_pat = pat + 1;
 
 	for (j = 0; j < rows; j++) {
 		for (k = 0; k < mod->chn; k++) {
 			uint8 a, b, c, d;
 
 			event = &EVENT(pat, k, j);
-			a = read8(f);
-			b = read8(f);
-			c = read8(f);
-			d = read8(f);
+			a = hio_read8(f);
+			b = hio_read8(f);
+			c = hio_read8(f);
+			d = hio_read8(f);
 			if (a) {
 				a--;
 				event->note = 12 * (a >> 4) + (a & 0x0f) + 12;
@@ -206,27 +208,27 @@ static void get_dapt(struct module_data *m, int size, FILE *f, void *parm)
 	}
 }
 
-static void get_dait(struct module_data *m, int size, FILE *f, void *parm)
+static void get_dait(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
-	static int i = 0;
+	int i;
 
 	if (!data->sflag) {
 		D_(D_INFO "Stored samples : %d ", mod->smp);
 		data->sflag = 1;
-		i = 0;
+		data->ins = 0;
 	}
 
+	i = data->ins++;
+
 	if (size > 2) {
-		load_sample(f, SAMPLE_FLAG_BIGEND,
+		load_sample(m, f, SAMPLE_FLAG_BIGEND,
 				&mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 	}
-
-	i++;
 }
 
-static int dt_load(struct module_data *m, FILE *f, const int start)
+static int dt_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	iff_handle handle;
 	struct local_data data;
@@ -248,7 +250,7 @@ static int dt_load(struct module_data *m, FILE *f, const int start)
 	iff_register(handle, "DAIT", get_dait);
 
 	/* Load IFF chunks */
-	while (!feof(f)) {
+	while (!hio_eof(f)) {
 		iff_chunk(handle, m, f , &data);
 	}
 
@@ -38,7 +38,7 @@ struct fcm_header {
 };
     
 
-int fcm_load(struct module_data *m, FILE *f)
+int fcm_load(struct module_data *m, HIO_HANDLE *f)
 {
     int i, j, k;
     struct xmp_event *event;
@@ -47,7 +47,7 @@ int fcm_load(struct module_data *m, FILE *f)
 
     LOAD_INIT();
 
-    fread (&fh, 1, sizeof (struct fcm_header), f);
+    hio_read(&fh, 1, sizeof (struct fcm_header), f);
 
     if (fh.magic[0] != 'F' || fh.magic[1] != 'C' || fh.magic[2] != '-' ||
 	fh.magic[3] != 'M' || fh.name_id[0] != 'N')
@@ -60,7 +60,7 @@ int fcm_load(struct module_data *m, FILE *f)
 
     mod->len = fh.len;
 
-    fread (mod->xxo, 1, mod->len, f);
+    hio_read(mod->xxo, 1, mod->len, f);
 
     for (mod->pat = i = 0; i < mod->len; i++) {
 	if (mod->xxo[i] > mod->pat)
@@ -76,7 +76,8 @@ int fcm_load(struct module_data *m, FILE *f)
 	B_ENDIAN16 (fh.ins[i].size);
 	B_ENDIAN16 (fh.ins[i].loop_start);
 	B_ENDIAN16 (fh.ins[i].loop_size);
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 	mod->xxs[i].len = 2 * fh.ins[i].size;
 	mod->xxs[i].lps = 2 * fh.ins[i].loop_start;
 	mod->xxs[i].lpe = mod->xxs[i].lps + 2 * fh.ins[i].loop_size;
@@ -106,7 +107,7 @@ int fcm_load(struct module_data *m, FILE *f)
     if (V(0))
 	report ("Stored patterns: %d ", mod->pat);
 
-    fread (fe, 4, 1, f);	/* Skip 'SONG' pseudo chunk ID */
+    hio_read(fe, 4, 1, f);	/* Skip 'SONG' pseudo chunk ID */
 
     for (i = 0; i < mod->pat; i++) {
 	PATTERN_ALLOC (i);
@@ -115,7 +116,7 @@ int fcm_load(struct module_data *m, FILE *f)
 	for (j = 0; j < 64; j++) {
 	    for (k = 0; k < 4; k++) {
 		event = &EVENT (i, k, j);
-		fread (fe, 4, 1, f);
+		hio_read(fe, 4, 1, f);
 		cvt_pt_event (event, fe);
 	    }
 	}
@@ -128,14 +129,14 @@ int fcm_load(struct module_data *m, FILE *f)
 
     /* Load samples */
 
-    fread (fe, 4, 1, f);	/* Skip 'SAMP' pseudo chunk ID */
+    hio_read(fe, 4, 1, f);	/* Skip 'SAMP' pseudo chunk ID */
 
     if (V(0))
 	report ("\nStored samples : %d ", mod->smp);
     for (i = 0; i < mod->smp; i++) {
 	if (!mod->xxs[i].len)
 	    continue;
-	load_sample(f, 0, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
+	load_sample(m, f, 0, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 	if (V(0))
 	    report (".");
     }
@@ -10,8 +10,8 @@
 #include "mod.h"
 #include "period.h"
 
-static int flt_test (FILE *, char *, const int);
-static int flt_load (struct module_data *, FILE *, const int);
+static int flt_test (HIO_HANDLE *, char *, const int);
+static int flt_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader flt_loader = {
     "Startrekker (MOD)",
@@ -19,12 +19,12 @@ const struct format_loader flt_loader = {
     flt_load
 };
 
-static int flt_test(FILE *f, char *t, const int start)
+static int flt_test(HIO_HANDLE *f, char *t, const int start)
 {
     char buf[4];
 
-    fseek(f, start + 1080, SEEK_SET);
-    if (fread(buf, 1, 4, f) < 4)
+    hio_seek(f, start + 1080, SEEK_SET);
+    if (hio_read(buf, 1, 4, f) < 4)
 	return -1;
 
     /* Also RASP? */
@@ -34,7 +34,7 @@ static int flt_test(FILE *f, char *t, const int start)
     if (buf[3] != '4' && buf[3] != '8' && buf[3] != 'M')
 	return -1;
 
-    fseek(f, start + 0, SEEK_SET);
+    hio_seek(f, start + 0, SEEK_SET);
     read_title(f, t, 20);
 
     return 0;
@@ -84,26 +84,26 @@ struct am_instrument {
 
 
 
-static int is_am_instrument(FILE *nt, int i)
+static int is_am_instrument(HIO_HANDLE *nt, int i)
 {
     char buf[2];
     int16 wf;
 
-    fseek(nt, 144 + i * 120, SEEK_SET);
-    if (fread(buf, 1, 2, nt) < 2)
+    hio_seek(nt, 144 + i * 120, SEEK_SET);
+    if (hio_read(buf, 1, 2, nt) < 2)
 	return 0;
     if (memcmp(buf, "AM", 2))
 	return 0;
 
-    fseek(nt, 24, SEEK_CUR);
-    wf = read16b(nt);
+    hio_seek(nt, 24, SEEK_CUR);
+    wf = hio_read16b(nt);
     if (wf < 0 || wf > 3)
 	return 0;
 
     return 1;
 }
 
-static void read_am_instrument(struct module_data *m, FILE *nt, int i)
+static void read_am_instrument(struct module_data *m, HIO_HANDLE *nt, int i)
 {
     struct xmp_module *mod = &m->mod;
     struct am_instrument am;
@@ -111,22 +111,22 @@ static void read_am_instrument(struct module_data *m, FILE *nt, int i)
     int a, b;
     int8 am_noise[1024];
 
-    fseek(nt, 144 + i * 120 + 2 + 4, SEEK_SET);
-    am.l0 = read16b(nt);
-    am.a1l = read16b(nt);
-    am.a1s = read16b(nt);
-    am.a2l = read16b(nt);
-    am.a2s = read16b(nt);
-    am.sl = read16b(nt);
-    am.ds = read16b(nt);
-    am.st = read16b(nt);
-    read16b(nt);
-    am.rs = read16b(nt);
-    am.wf = read16b(nt);
-    am.p_fall = -(int16)read16b(nt);
-    am.v_amp = read16b(nt);
-    am.v_spd = read16b(nt);
-    am.fq = read16b(nt);
+    hio_seek(nt, 144 + i * 120 + 2 + 4, SEEK_SET);
+    am.l0 = hio_read16b(nt);
+    am.a1l = hio_read16b(nt);
+    am.a1s = hio_read16b(nt);
+    am.a2l = hio_read16b(nt);
+    am.a2s = hio_read16b(nt);
+    am.sl = hio_read16b(nt);
+    am.ds = hio_read16b(nt);
+    am.st = hio_read16b(nt);
+    hio_read16b(nt);
+    am.rs = hio_read16b(nt);
+    am.wf = hio_read16b(nt);
+    am.p_fall = -(int16)hio_read16b(nt);
+    am.v_amp = hio_read16b(nt);
+    am.v_spd = hio_read16b(nt);
+    am.fq = hio_read16b(nt);
 
 #if 0
 printf("L0=%d A1L=%d A1S=%d A2L=%d A2S=%d SL=%d DS=%d ST=%d RS=%d WF=%d\n",
@@ -262,11 +262,11 @@ am.l0, am.a1l, am.a1s, am.a2l, am.a2s, am.sl, am.ds, am.st, am.rs, am.wf);
 	mod->xxi[i].fei.data[3] = 10 * (am.p_fall < 0 ? -256 : 256);
     }
 
-    load_sample(NULL, SAMPLE_FLAG_NOLOAD, &mod->xxs[mod->xxi[i].sub[0].sid], wave);
+    load_sample(m, NULL, SAMPLE_FLAG_NOLOAD, &mod->xxs[mod->xxi[i].sub[0].sid], wave);
 }
 
 
-static int flt_load(struct module_data *m, FILE *f, const int start)
+static int flt_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
     struct xmp_module *mod = &m->mod;
     int i, j;
@@ -276,7 +276,7 @@ static int flt_load(struct module_data *m, FILE *f, const int start)
     char *tracker;
     char filename[1024];
     char buf[16];
-    FILE *nt;
+    HIO_HANDLE *nt;
     int am_synth;
 
     LOAD_INIT();
@@ -284,13 +284,13 @@ static int flt_load(struct module_data *m, FILE *f, const int start)
     /* See if we have the synth parameters file */
     am_synth = 0;
     snprintf(filename, 1024, "%s%s.NT", m->dirname, m->basename);
-    if ((nt = fopen(filename, "rb")) == NULL) {
+    if ((nt = hio_open(filename, "rb")) == NULL) {
 	snprintf(filename, 1024, "%s%s.nt", m->dirname, m->basename);
-	if ((nt = fopen(filename, "rb")) == NULL) {
+	if ((nt = hio_open(filename, "rb")) == NULL) {
 	    snprintf(filename, 1024, "%s%s.AS", m->dirname, m->basename);
-	    if ((nt = fopen(filename, "rb")) == NULL) {
+	    if ((nt = hio_open(filename, "rb")) == NULL) {
 	        snprintf(filename, 1024, "%s%s.as", m->dirname, m->basename);
-	        nt = fopen(filename, "rb");
+	        nt = hio_open(filename, "rb");
 	    }
 	}
     }
@@ -298,7 +298,7 @@ static int flt_load(struct module_data *m, FILE *f, const int start)
     tracker = "Startrekker";
 
     if (nt) {
-	fread(buf, 1, 16, nt);
+	hio_read(buf, 1, 16, nt);
 	if (memcmp(buf, "ST1.2 ModuleINFO", 16) == 0) {
 	    am_synth = 1;
 	    tracker = "Startrekker 1.2";
@@ -311,19 +311,19 @@ static int flt_load(struct module_data *m, FILE *f, const int start)
 	}
     }
 
-    fread(&mh.name, 20, 1, f);
+    hio_read(&mh.name, 20, 1, f);
     for (i = 0; i < 31; i++) {
-	fread(&mh.ins[i].name, 22, 1, f);	/* Instrument name */
-	mh.ins[i].size = read16b(f);		/* Length in 16-bit words */
-	mh.ins[i].finetune = read8(f);		/* Finetune (signed nibble) */
-	mh.ins[i].volume = read8(f);		/* Linear playback volume */
-	mh.ins[i].loop_start = read16b(f);	/* Loop start in 16-bit words */
-	mh.ins[i].loop_size = read16b(f);	/* Loop size in 16-bit words */
+	hio_read(&mh.ins[i].name, 22, 1, f);	/* Instrument name */
+	mh.ins[i].size = hio_read16b(f);		/* Length in 16-bit words */
+	mh.ins[i].finetune = hio_read8(f);		/* Finetune (signed nibble) */
+	mh.ins[i].volume = hio_read8(f);		/* Linear playback volume */
+	mh.ins[i].loop_start = hio_read16b(f);	/* Loop start in 16-bit words */
+	mh.ins[i].loop_size = hio_read16b(f);	/* Loop size in 16-bit words */
     }
-    mh.len = read8(f);
-    mh.restart = read8(f);
-    fread(&mh.order, 128, 1, f);
-    fread(&mh.magic, 4, 1, f);
+    mh.len = hio_read8(f);
+    mh.restart = hio_read8(f);
+    hio_read(&mh.order, 128, 1, f);
+    hio_read(&mh.magic, 4, 1, f);
 
     if (mh.magic[3] == '4')
 	mod->chn = 4;
@@ -354,7 +354,8 @@ static int flt_load(struct module_data *m, FILE *f, const int start)
     INSTRUMENT_INIT();
 
     for (i = 0; i < mod->ins; i++) {
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 	mod->xxs[i].len = 2 * mh.ins[i].size;
 	mod->xxs[i].lps = 2 * mh.ins[i].loop_start;
 	mod->xxs[i].lpe = mod->xxs[i].lps + 2 * mh.ins[i].loop_size;
@@ -401,13 +402,13 @@ static int flt_load(struct module_data *m, FILE *f, const int start)
 	TRACK_ALLOC(i);
 	for (j = 0; j < (64 * 4); j++) {
 	    event = &EVENT(i, j % 4, j / 4);
-	    fread(mod_event, 1, 4, f);
+	    hio_read(mod_event, 1, 4, f);
 	    cvt_pt_event(event, mod_event);
 	}
 	if (mod->chn > 4) {
 	    for (j = 0; j < (64 * 4); j++) {
 		event = &EVENT(i, (j % 4) + 4, j / 4);
-		fread(mod_event, 1, 4, f);
+		hio_read(mod_event, 1, 4, f);
 		cvt_pt_event(event, mod_event);
 
 		/* no macros */
@@ -432,12 +433,12 @@ static int flt_load(struct module_data *m, FILE *f, const int start)
 	    }
 	    continue;
 	}
-	load_sample(f, SAMPLE_FLAG_FULLREP,
+	load_sample(m, f, SAMPLE_FLAG_FULLREP,
 					&mod->xxs[mod->xxi[i].sub[0].sid], NULL);
     }
 
     if (nt)
-	fclose(nt);
+	hio_close(nt);
 
     return 0;
 }
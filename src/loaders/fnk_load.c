@@ -12,8 +12,8 @@
 #define MAGIC_Funk	MAGIC4('F','u','n','k')
 
 
-static int fnk_test (FILE *, char *, const int);
-static int fnk_load (struct module_data *, FILE *, const int);
+static int fnk_test (HIO_HANDLE *, char *, const int);
+static int fnk_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader fnk_loader = {
     "Funktracker (FNK)",
@@ -21,18 +21,18 @@ const struct format_loader fnk_loader = {
     fnk_load
 };
 
-static int fnk_test(FILE *f, char *t, const int start)
+static int fnk_test(HIO_HANDLE *f, char *t, const int start)
 {
     uint8 a, b;
     int size;
 
-    if (read32b(f) != MAGIC_Funk)
+    if (hio_read32b(f) != MAGIC_Funk)
 	return -1;
 
-    read8(f); 
-    a = read8(f);
-    b = read8(f); 
-    read8(f); 
+    hio_read8(f); 
+    a = hio_read8(f);
+    b = hio_read8(f); 
+    hio_read8(f); 
 
     if ((a >> 1) < 10)			/* creation year (-1980) */
 	return -1;
@@ -40,11 +40,11 @@ static int fnk_test(FILE *f, char *t, const int start)
     if (MSN(b) > 7 || LSN(b) > 9)	/* CPU and card */
 	return -1;
 
-    size = read32l(f);
+    size = hio_read32l(f);
     if (size < 1024)
 	return -1;
 
-    if (size != fsize(f))
+    if (size != hio_size(f))
 	return -1;
 
     read_title(f, t, 0);
@@ -76,7 +76,7 @@ struct fnk_header {
 };
 
 
-static int fnk_load(struct module_data *m, FILE *f, const int start)
+static int fnk_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
     struct xmp_module *mod = &m->mod;
     int i, j;
@@ -87,23 +87,23 @@ static int fnk_load(struct module_data *m, FILE *f, const int start)
 
     LOAD_INIT();
 
-    fread(&ffh.marker, 4, 1, f);
-    fread(&ffh.info, 4, 1, f);
-    ffh.filesize = read32l(f);
-    fread(&ffh.fmt, 4, 1, f);
-    ffh.loop = read8(f);
-    fread(&ffh.order, 256, 1, f);
-    fread(&ffh.pbrk, 128, 1, f);
+    hio_read(&ffh.marker, 4, 1, f);
+    hio_read(&ffh.info, 4, 1, f);
+    ffh.filesize = hio_read32l(f);
+    hio_read(&ffh.fmt, 4, 1, f);
+    ffh.loop = hio_read8(f);
+    hio_read(&ffh.order, 256, 1, f);
+    hio_read(&ffh.pbrk, 128, 1, f);
 
     for (i = 0; i < 64; i++) {
-	fread(&ffh.fih[i].name, 19, 1, f);
-	ffh.fih[i].loop_start = read32l(f);
-	ffh.fih[i].length = read32l(f);
-	ffh.fih[i].volume = read8(f);
-	ffh.fih[i].pan = read8(f);
-	ffh.fih[i].shifter = read8(f);
-	ffh.fih[i].waveform = read8(f);
-	ffh.fih[i].retrig = read8(f);
+	hio_read(&ffh.fih[i].name, 19, 1, f);
+	ffh.fih[i].loop_start = hio_read32l(f);
+	ffh.fih[i].length = hio_read32l(f);
+	ffh.fih[i].volume = hio_read8(f);
+	ffh.fih[i].pan = hio_read8(f);
+	ffh.fih[i].shifter = hio_read8(f);
+	ffh.fih[i].waveform = hio_read8(f);
+	ffh.fih[i].retrig = hio_read8(f);
     }
 
     day = ffh.info[0] & 0x1f;
@@ -162,7 +162,8 @@ static int fnk_load(struct module_data *m, FILE *f, const int start)
 
     /* Convert instruments */
     for (i = 0; i < mod->ins; i++) {
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 	mod->xxi[i].nsm = !!(mod->xxs[i].len = ffh.fih[i].length);
 	mod->xxs[i].lps = ffh.fih[i].loop_start;
 	if (mod->xxs[i].lps == -1)
@@ -196,7 +197,7 @@ static int fnk_load(struct module_data *m, FILE *f, const int start)
 
 	for (j = 0; j < 64 * mod->chn; j++) {
 	    event = &EVENT(i, j % mod->chn, j / mod->chn);
-	    fread(&ev, 1, 3, f);
+	    hio_read(&ev, 1, 3, f);
 
 	    switch (ev[0] >> 2) {
 	    case 0x3f:
@@ -281,7 +282,7 @@ static int fnk_load(struct module_data *m, FILE *f, const int start)
 	if (mod->xxs[i].len <= 2)
 	    continue;
 
-	load_sample(f, 0, &mod->xxs[i], NULL);
+	load_sample(m, f, 0, &mod->xxs[i], NULL);
 
     }
 
@@ -10,8 +10,8 @@
 #include "period.h"
 
 
-static int gtk_test(FILE *, char *, const int);
-static int gtk_load (struct module_data *, FILE *, const int);
+static int gtk_test(HIO_HANDLE *, char *, const int);
+static int gtk_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader gtk_loader = {
 	"Graoumf Tracker (GTK)",
@@ -19,11 +19,11 @@ const struct format_loader gtk_loader = {
 	gtk_load
 };
 
-static int gtk_test(FILE * f, char *t, const int start)
+static int gtk_test(HIO_HANDLE *f, char *t, const int start)
 {
 	char buf[4];
 
-	if (fread(buf, 1, 4, f) < 4)
+	if (hio_read(buf, 1, 4, f) < 4)
 		return -1;
 
 	if (memcmp(buf, "GTK", 3) || buf[3] > 4)
@@ -34,7 +34,7 @@ static int gtk_test(FILE * f, char *t, const int start)
 	return 0;
 }
 
-static int gtk_load(struct module_data *m, FILE *f, const int start)
+static int gtk_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct xmp_module *mod = &m->mod;
 	struct xmp_event *event;
@@ -45,18 +45,18 @@ static int gtk_load(struct module_data *m, FILE *f, const int start)
 
 	LOAD_INIT();
 
-	fread(buffer, 4, 1, f);
+	hio_read(buffer, 4, 1, f);
 	ver = buffer[3];
-	fread(mod->name, 32, 1, f);
+	hio_read(mod->name, 32, 1, f);
 	set_type(m, "Graoumf Tracker GTK v%d", ver);
-	fseek(f, 160, SEEK_CUR);	/* skip comments */
+	hio_seek(f, 160, SEEK_CUR);	/* skip comments */
 
-	mod->ins = read16b(f);
+	mod->ins = hio_read16b(f);
 	mod->smp = mod->ins;
-	rows = read16b(f);
-	mod->chn = read16b(f);
-	mod->len = read16b(f);
-	mod->rst = read16b(f);
+	rows = hio_read16b(f);
+	mod->chn = hio_read16b(f);
+	mod->len = hio_read16b(f);
+	mod->rst = hio_read16b(f);
 
 	MODULE_INFO();
 
@@ -64,35 +64,36 @@ static int gtk_load(struct module_data *m, FILE *f, const int start)
 
 	INSTRUMENT_INIT();
 	for (i = 0; i < mod->ins; i++) {
-		mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
-		fread(buffer, 28, 1, f);
+		mod->xxi[i].sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), 1);
+		hio_read(buffer, 28, 1, f);
 		copy_adjust(mod->xxi[i].name, buffer, 28);
 
 		if (ver == 1) {
-			read32b(f);
-			mod->xxs[i].len = read32b(f);
-			mod->xxs[i].lps = read32b(f);
-			size = read32b(f);
+			hio_read32b(f);
+			mod->xxs[i].len = hio_read32b(f);
+			mod->xxs[i].lps = hio_read32b(f);
+			size = hio_read32b(f);
 			mod->xxs[i].lpe = mod->xxs[i].lps + size - 1;
-			read16b(f);
-			read16b(f);
+			hio_read16b(f);
+			hio_read16b(f);
 			mod->xxi[i].sub[0].vol = 0x40;
 			mod->xxi[i].sub[0].pan = 0x80;
 			bits = 1;
 			c2spd = 8363;
 		} else {
-			fseek(f, 14, SEEK_CUR);
-			read16b(f);		/* autobal */
-			bits = read16b(f);	/* 1 = 8 bits, 2 = 16 bits */
-			c2spd = read16b(f);
+			hio_seek(f, 14, SEEK_CUR);
+			hio_read16b(f);		/* autobal */
+			bits = hio_read16b(f);	/* 1 = 8 bits, 2 = 16 bits */
+			c2spd = hio_read16b(f);
 			c2spd_to_note(c2spd, &mod->xxi[i].sub[0].xpo, &mod->xxi[i].sub[0].fin);
-			mod->xxs[i].len = read32b(f);
-			mod->xxs[i].lps = read32b(f);
-			size = read32b(f);
+			mod->xxs[i].len = hio_read32b(f);
+			mod->xxs[i].lps = hio_read32b(f);
+			size = hio_read32b(f);
 			mod->xxs[i].lpe = mod->xxs[i].lps + size - 1;
-			mod->xxi[i].sub[0].vol = read16b(f) / 4;
-			read8(f);
-			mod->xxi[i].sub[0].fin = read8s(f);
+			mod->xxi[i].sub[0].vol = hio_read16b(f) / 4;
+			hio_read8(f);
+			mod->xxi[i].sub[0].fin = hio_read8s(f);
 		}
 
 		mod->xxi[i].nsm = !!mod->xxs[i].len;
@@ -119,7 +120,7 @@ static int gtk_load(struct module_data *m, FILE *f, const int start)
 	}
 
 	for (i = 0; i < 256; i++)
-		mod->xxo[i] = read16b(f);
+		mod->xxo[i] = hio_read16b(f);
 
 	for (patmax = i = 0; i < mod->len; i++) {
 		if (mod->xxo[i] > patmax)
@@ -143,15 +144,15 @@ static int gtk_load(struct module_data *m, FILE *f, const int start)
 			for (k = 0; k < mod->chn; k++) {
 				event = &EVENT (i, k, j);
 
-				event->note = read8(f);
+				event->note = hio_read8(f);
 				if (event->note) {
 					event->note += 12;
 				}
-				event->ins = read8(f);
-				event->fxt = read8(f);
-				event->fxp = read8(f);
+				event->ins = hio_read8(f);
+				event->fxt = hio_read8(f);
+				event->fxp = hio_read8(f);
 				if (ver >= 4) {
-					event->vol = read8(f);
+					event->vol = hio_read8(f);
 				}
 
 				/* Ignore extended effects */
@@ -170,7 +171,7 @@ static int gtk_load(struct module_data *m, FILE *f, const int start)
 	for (i = 0; i < mod->ins; i++) {
 		if (mod->xxs[i].len == 0)
 			continue;
-		load_sample(f, 0, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
+		load_sample(m, f, 0, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 	}
 
 	return 0;
@@ -12,8 +12,8 @@
 
 #define MAGIC_HVL	MAGIC4('H','V','L', 0)
 
-static int hvl_test (FILE *, char *, const int);
-static int hvl_load (struct module_data *, FILE *, const int);
+static int hvl_test (HIO_HANDLE *, char *, const int);
+static int hvl_load (struct module_data *, HIO_HANDLE *, const int);
 
 
 const struct format_loader hvl_loader = {
@@ -23,13 +23,13 @@ const struct format_loader hvl_loader = {
 	hvl_load
 };
 
-static int hvl_test(FILE *f, char *t, const int start)
+static int hvl_test(HIO_HANDLE *f, char *t, const int start)
 {
-	if (read32b(f) != MAGIC_HVL)
+	if (hio_read32b(f) != MAGIC_HVL)
 		return -1;
 
-	uint16 off = read16b(f);
-	if (fseek(f, off + 1, SEEK_SET))
+	uint16 off = hio_read16b(f);
+	if (hio_seek(f, off + 1, SEEK_SET))
 		return -1;
 
 	read_title(f, t, 32);
@@ -176,7 +176,7 @@ static void fix_effect (uint8 *fx, uint8 *param) {
 	}
 }
 
-static int hvl_load(struct module_data *m, FILE *f, const int start)
+static int hvl_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct player_data *p = &ctx->p;
 	struct xmp_module *mod = &m->mod;
@@ -184,23 +184,23 @@ static int hvl_load(struct module_data *m, FILE *f, const int start)
 
 	LOAD_INIT();
 
-	read32b(f);
+	hio_read32b(f);
 
-	uint16 title_offset = read16b(f);
-	tmp = read16b(f);
+	uint16 title_offset = hio_read16b(f);
+	tmp = hio_read16b(f);
 	mod->len = tmp & 0xfff;
 	blank = tmp & 0x8000;
 		
-	tmp = read16b(f);
+	tmp = hio_read16b(f);
 	mod->chn = (tmp >> 10) + 4;
 	mod->rst = tmp & 1023;
 
-	int pattlen = read8(f);
-	mod->trk = read8(f) + 1;
-	mod->ins = read8(f);
-	int subsongs = read8(f);
-	int gain = read8(f);
-	int stereo = read8(f);
+	int pattlen = hio_read8(f);
+	mod->trk = hio_read8(f) + 1;
+	mod->ins = hio_read8(f);
+	int subsongs = hio_read8(f);
+	int gain = hio_read8(f);
+	int stereo = hio_read8(f);
 
 	D_(D_WARN "pattlen=%d npatts=%d nins=%d seqlen=%d stereo=%02x",
 		pattlen, mod->trk, mod->ins, mod->len, stereo);
@@ -213,11 +213,11 @@ static int hvl_load(struct module_data *m, FILE *f, const int start)
 	PATTERN_INIT();
 	INSTRUMENT_INIT();
 
-	fseek (f, subsongs*2, SEEK_CUR);
+	hio_seek(f, subsongs*2, SEEK_CUR);
 
 	uint8 *seqbuf = malloc(mod->len * mod->chn * 2);
 	uint8 *seqptr = seqbuf;
-	fread (seqbuf, 1, mod->len * mod->chn * 2, f);
+	hio_read(seqbuf, 1, mod->len * mod->chn * 2, f);
 
 	uint8 **transbuf = malloc (mod->len * mod->chn * sizeof(uint8 *));
 	int transposed = 0;
@@ -252,13 +252,15 @@ static int hvl_load(struct module_data *m, FILE *f, const int start)
 
 	if (transposed) {
 		mod->trk += transposed;
-		mod->xxt = realloc(mod->xxt, mod->trk * sizeof (struct xmp_track *));
+		mod->xxt = arena_realloc(&m->arena,
+					mod->xxt, mod->trk * sizeof (struct xmp_track *));
 	}
 	
 	reportv(ctx, 0, "Stored tracks  : %d ", mod->trk);
 
 	for (i = 0; i < mod->trk; i++) {
-		mod->xxt[i] = calloc(sizeof(struct xmp_track) +
+		mod->xxt[i] = arena_calloc(&m->track_arena,
+					sizeof(struct xmp_track) +
 				   sizeof(struct xmp_event) * pattlen - 1, 1);
                 mod->xxt[i]->rows = pattlen;
 
@@ -284,10 +286,10 @@ static int hvl_load(struct module_data *m, FILE *f, const int start)
 
 		for (j = 0; j < mod->xxt[i]->rows; j++) {
 			struct xmp_event *event = &mod->xxt[i]->event[j];
-			int note = read8(f);			
+			int note = hio_read8(f);			
 
 			if (note != 0x3f) {
-				uint32 b = read32b(f);
+				uint32 b = hio_read32b(f);
 				event->note = note?note+24:0;
 				event->ins = b >> 24;
 				event->fxt = (b & 0xf00000) >> 20;
@@ -317,9 +319,10 @@ static int hvl_load(struct module_data *m, FILE *f, const int start)
 		int vol, fspd, wavelen, flow, vibdel, hclen, hc;
 		int vibdep, vibspd, sqmin, sqmax, sqspd, fmax, plen, pspd;
 		int Alen, Avol, Dlen, Dvol, Slen, Rlen, Rvol;
-                mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+                mod->xxi[i].sub = arena_calloc(&m->arena,
+                			sizeof (struct xmp_subinstrument), 1);
 
-		fread(buf, 22, 1, f);
+		hio_read(buf, 22, 1, f);
 
 		vol = buf[0];		/* Master volume (0 to 64) */
 		fspd = ((buf[1] >> 3) & 0x1f) | ((buf[12] >> 2) & 0x20);
@@ -359,7 +362,7 @@ static int hvl_load(struct module_data *m, FILE *f, const int start)
 
 		mod->xxi[i].fei.flg = XMP_ENVELOPE_ON; /* | XMP_ENVELOPE_LOOP;*/
 		mod->xxi[i].fei.npt = plen*2;
-		mod->xxfe[i] = calloc (4, mod->xxi[i].fei.npt);
+		mod->xxfe[i] = arena_calloc(&m->arena, 4, mod->xxi[i].fei.npt);
 
 		int note=0;
 		int jump = -1;
@@ -367,7 +370,7 @@ static int hvl_load(struct module_data *m, FILE *f, const int start)
 
 		for (j = 0; j < plen; j++) {
 			uint8 tmp[5];
-			fread (tmp, 1, 5, f);
+			hio_read(tmp, 1, 5, f);
 
 			int fx1 = tmp[0] & 15;
 			int fx2 = (tmp[1] >> 3) & 15;
@@ -439,7 +442,7 @@ static int hvl_load(struct module_data *m, FILE *f, const int start)
 			i, vol, Alen, Avol, Dlen, Dvol, Slen, Rlen, Rvol, wave);
 		mod->xxi[i].aei.flg = XMP_ENVELOPE_ON;
 		mod->xxi[i].aei.npt = 5;
-		mod->xxae[i] = calloc (4, mod->xxi[i].aei.npt);
+		mod->xxae[i] = arena_calloc(&m->arena, 4, mod->xxi[i].aei.npt);
 		mod->xxae[i][0] = 0;
 		mod->xxae[i][1] = vol;
 		mod->xxae[i][2] = Alen; /* these are *not* multiplied by pspd */
@@ -490,7 +493,7 @@ static int hvl_load(struct module_data *m, FILE *f, const int start)
 			break;
 		}
 
-		load_sample(NULL, SAMPLE_FLAG_NOLOAD, &mod->xxs[i], (char *)b);
+		load_sample(m, NULL, SAMPLE_FLAG_NOLOAD, &mod->xxs[i], (char *)b);
 	}
 
 
@@ -498,12 +501,12 @@ static int hvl_load(struct module_data *m, FILE *f, const int start)
 		int len, i;
 		uint8 *namebuf, *nameptr;
 
-		fseek (f, 0, SEEK_END);
-		len = ftell(f) - title_offset;
-		fseek (f, title_offset, SEEK_SET);
+		hio_seek(f, 0, SEEK_END);
+		len = hio_tell(f) - title_offset;
+		hio_seek(f, title_offset, SEEK_SET);
 
 		nameptr = namebuf = malloc (len+1);
-		fread (namebuf, 1, len, f);
+		hio_read(namebuf, 1, len, f);
 		namebuf[len]=0;
 
 		copy_adjust ((uint8 *)mod->name, namebuf, 32);
@@ -14,8 +14,8 @@
 #define MAGIC_IT10	MAGIC4('I','T','1','0')
 
 
-static int ice_test (FILE *, char *, const int);
-static int ice_load (struct module_data *, FILE *, const int);
+static int ice_test (HIO_HANDLE *, char *, const int);
+static int ice_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader ice_loader = {
     "Soundtracker 2.6/Ice Tracker (MTN)",
@@ -23,16 +23,16 @@ const struct format_loader ice_loader = {
     ice_load
 };
 
-static int ice_test(FILE *f, char *t, const int start)
+static int ice_test(HIO_HANDLE *f, char *t, const int start)
 {
     uint32 magic;
 
-    fseek(f, start + 1464, SEEK_SET);
-    magic = read32b(f);
+    hio_seek(f, start + 1464, SEEK_SET);
+    magic = hio_read32b(f);
     if (magic != MAGIC_MTN_ && magic != MAGIC_IT10)
 	return -1;
 
-    fseek(f, start + 0, SEEK_SET);
+    hio_seek(f, start + 0, SEEK_SET);
     read_title(f, t, 28);
 
     return 0;
@@ -58,7 +58,7 @@ struct ice_header {
 };
 
 
-static int ice_load(struct module_data *m, FILE *f, const int start)
+static int ice_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
     struct xmp_module *mod = &m->mod;
     int i, j;
@@ -68,19 +68,19 @@ static int ice_load(struct module_data *m, FILE *f, const int start)
 
     LOAD_INIT();
 
-    fread(&ih.title, 20, 1, f);
+    hio_read(&ih.title, 20, 1, f);
     for (i = 0; i < 31; i++) {
-	fread(&ih.ins[i].name, 22, 1, f);
-	ih.ins[i].len = read16b(f);
-	ih.ins[i].finetune = read8(f);
-	ih.ins[i].volume = read8(f);
-	ih.ins[i].loop_start = read16b(f);
-	ih.ins[i].loop_size = read16b(f);
+	hio_read(&ih.ins[i].name, 22, 1, f);
+	ih.ins[i].len = hio_read16b(f);
+	ih.ins[i].finetune = hio_read8(f);
+	ih.ins[i].volume = hio_read8(f);
+	ih.ins[i].loop_start = hio_read16b(f);
+	ih.ins[i].loop_size = hio_read16b(f);
     }
-    ih.len = read8(f);
-    ih.trk = read8(f);
-    fread(&ih.ord, 128 * 4, 1, f);
-    ih.magic = read32b(f);
+    ih.len = hio_read8(f);
+    ih.trk = hio_read8(f);
+    hio_read(&ih.ord, 128 * 4, 1, f);
+    ih.magic = hio_read32b(f);
 
     if (ih.magic == MAGIC_IT10)
         set_type(m, "Ice Tracker IT10");
@@ -101,7 +101,8 @@ static int ice_load(struct module_data *m, FILE *f, const int start)
     INSTRUMENT_INIT();
 
     for (i = 0; i < mod->ins; i++) {
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 	mod->xxi[i].nsm = !!(mod->xxs[i].len = 2 * ih.ins[i].len);
 	mod->xxs[i].lps = 2 * ih.ins[i].loop_start;
 	mod->xxs[i].lpe = mod->xxs[i].lps + 2 * ih.ins[i].loop_size;
@@ -133,12 +134,13 @@ static int ice_load(struct module_data *m, FILE *f, const int start)
     D_(D_INFO "Stored tracks: %d", mod->trk);
 
     for (i = 0; i < mod->trk; i++) {
-	mod->xxt[i] = calloc (sizeof (struct xmp_track) + sizeof
+	mod->xxt[i] = arena_calloc(&m->track_arena,
+				sizeof (struct xmp_track) + sizeof
 		(struct xmp_event) * 64, 1);
 	mod->xxt[i]->rows = 64;
 	for (j = 0; j < mod->xxt[i]->rows; j++) {
 		event = &mod->xxt[i]->event[j];
-		fread (ev, 1, 4, f);
+		hio_read(ev, 1, 4, f);
 		cvt_pt_event (event, ev);
 	}
     }
@@ -152,7 +154,7 @@ static int ice_load(struct module_data *m, FILE *f, const int start)
     for (i = 0; i < mod->ins; i++) {
 	if (mod->xxs[i].len <= 4)
 	    continue;
-	load_sample(f, 0, &mod->xxs[i], NULL);
+	load_sample(m, f, 0, &mod->xxs[i], NULL);
     }
 
     return 0;
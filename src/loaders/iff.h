@@ -2,6 +2,7 @@
 #define __IFF_H
 
 #include "list.h"
+#include "hio.h"
 
 #define IFF_NOBUFFER 0x0001
 
@@ -22,17 +23,17 @@ struct iff_header {
 
 struct iff_info {
 	char id[5];
-	void (*loader)(struct module_data *, int, FILE *, void *);
+	void (*loader)(struct module_data *, int, HIO_HANDLE *, void *);
 	struct list_head list;
 };
 
 iff_handle iff_new(void);
-void iff_chunk(iff_handle, struct module_data *, FILE *, void *);
+void iff_chunk(iff_handle, struct module_data *, HIO_HANDLE *, void *);
 void iff_register(iff_handle, char *,
-		  void (*loader)(struct module_data *, int, FILE *, void *));
+		  void (*loader)(struct module_data *, int, HIO_HANDLE *, void *));
 void iff_id_size(iff_handle, int);
 void iff_set_quirk(iff_handle, int);
 void iff_release(iff_handle);
-int iff_process(iff_handle, struct module_data *, char *, long, FILE *, void *);
+int iff_process(iff_handle, struct module_data *, char *, long, HIO_HANDLE *, void *);
 
 #endif /* __IFF_H */
@@ -51,8 +51,8 @@ struct ims_header {
 };
 
 
-static int ims_test (FILE *, char *, const int);
-static int ims_load (struct module_data *, FILE *, const int);
+static int ims_test (HIO_HANDLE *, char *, const int);
+static int ims_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader ims_loader = {
     "Images Music System (IMS)",
@@ -60,7 +60,7 @@ const struct format_loader ims_loader = {
     ims_load
 };
 
-static int ims_test(FILE *f, char *t, const int start)
+static int ims_test(HIO_HANDLE *f, char *t, const int start)
 {
     int i;
     int smp_size, pat;
@@ -68,18 +68,18 @@ static int ims_test(FILE *f, char *t, const int start)
 
     smp_size = 0;
 
-    fread(&ih.title, 20, 1, f);
+    hio_read(&ih.title, 20, 1, f);
 
     for (i = 0; i < 31; i++) {
-	if (fread(&ih.ins[i].name, 1, 20, f) < 20)
+	if (hio_read(&ih.ins[i].name, 1, 20, f) < 20)
 	    return -1;
 
-	ih.ins[i].finetune = (int16)read16b(f);
-	ih.ins[i].size = read16b(f);
-	ih.ins[i].unknown = read8(f);
-	ih.ins[i].volume = read8(f);
-	ih.ins[i].loop_start = read16b(f);
-	ih.ins[i].loop_size = read16b(f);
+	ih.ins[i].finetune = (int16)hio_read16b(f);
+	ih.ins[i].size = hio_read16b(f);
+	ih.ins[i].unknown = hio_read8(f);
+	ih.ins[i].volume = hio_read8(f);
+	ih.ins[i].loop_start = hio_read16b(f);
+	ih.ins[i].loop_size = hio_read16b(f);
 
 	smp_size += ih.ins[i].size * 2;
 
@@ -102,10 +102,10 @@ static int ims_test(FILE *f, char *t, const int start)
     if (smp_size < 8)
 	return -1;
 
-    ih.len = read8(f);
-    ih.zero = read8(f);
-    fread (&ih.orders, 128, 1, f);
-    fread (&ih.magic, 4, 1, f);
+    ih.len = hio_read8(f);
+    ih.zero = hio_read8(f);
+    hio_read(&ih.orders, 128, 1, f);
+    hio_read(&ih.magic, 4, 1, f);
   
     if (ih.zero > 1)		/* not sure what this is */
 	return -1;
@@ -124,14 +124,14 @@ static int ims_test(FILE *f, char *t, const int start)
     if (pat > 0x7f || ih.len == 0 || ih.len > 0x7f)
 	return -1;
    
-    fseek(f, start + 0, SEEK_SET);
+    hio_seek(f, start + 0, SEEK_SET);
     read_title(f, t, 20);
 
     return 0;
 }
 
 
-static int ims_load(struct module_data *m, FILE *f, const int start)
+static int ims_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
     struct xmp_module *mod = &m->mod;
     int i, j;
@@ -147,24 +147,24 @@ static int ims_load(struct module_data *m, FILE *f, const int start)
     mod->smp = mod->ins;
     smp_size = 0;
 
-    fread (&ih.title, 20, 1, f);
+    hio_read(&ih.title, 20, 1, f);
 
     for (i = 0; i < 31; i++) {
-	fread (&ih.ins[i].name, 20, 1, f);
-	ih.ins[i].finetune = (int16)read16b(f);
-	ih.ins[i].size = read16b(f);
-	ih.ins[i].unknown = read8(f);
-	ih.ins[i].volume = read8(f);
-	ih.ins[i].loop_start = read16b(f);
-	ih.ins[i].loop_size = read16b(f);
+	hio_read(&ih.ins[i].name, 20, 1, f);
+	ih.ins[i].finetune = (int16)hio_read16b(f);
+	ih.ins[i].size = hio_read16b(f);
+	ih.ins[i].unknown = hio_read8(f);
+	ih.ins[i].volume = hio_read8(f);
+	ih.ins[i].loop_start = hio_read16b(f);
+	ih.ins[i].loop_size = hio_read16b(f);
 
 	smp_size += ih.ins[i].size * 2;
     }
 
-    ih.len = read8(f);
-    ih.zero = read8(f);
-    fread (&ih.orders, 128, 1, f);
-    fread (&ih.magic, 4, 1, f);
+    ih.len = hio_read8(f);
+    ih.zero = hio_read8(f);
+    hio_read(&ih.orders, 128, 1, f);
+    hio_read(&ih.magic, 4, 1, f);
   
     mod->len = ih.len;
     memcpy (mod->xxo, ih.orders, mod->len);
@@ -184,7 +184,8 @@ static int ims_load(struct module_data *m, FILE *f, const int start)
     INSTRUMENT_INIT();
 
     for (i = 0; i < mod->ins; i++) {
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 	mod->xxs[i].len = 2 * ih.ins[i].size;
 	mod->xxs[i].lpe = mod->xxs[i].lps + 2 * ih.ins[i].loop_size;
 	mod->xxs[i].flg = ih.ins[i].loop_size > 1 ? XMP_SAMPLE_LOOP : 0;
@@ -214,7 +215,7 @@ static int ims_load(struct module_data *m, FILE *f, const int start)
 	TRACK_ALLOC(i);
 	for (j = 0; j < 0x100; j++) {
 	    event = &EVENT (i, j & 0x3, j >> 2);
-	    fread (ims_event, 1, 3, f);
+	    hio_read(ims_event, 1, 3, f);
 
 	    /* Event format:
 	     *
@@ -257,7 +258,7 @@ static int ims_load(struct module_data *m, FILE *f, const int start)
     for (i = 0; i < mod->smp; i++) {
 	if (!mod->xxs[i].len)
 	    continue;
-	load_sample(f, 0, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
+	load_sample(m, f, 0, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
     }
 
     return 0;
@@ -15,8 +15,8 @@
 #define MAGIC_IMPS	MAGIC4('I','M','P','S')
 
 
-static int it_test (FILE *, char *, const int);
-static int it_load (struct module_data *, FILE *, const int);
+static int it_test (HIO_HANDLE *, char *, const int);
+static int it_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader it_loader = {
     "Impulse Tracker (IT)",
@@ -33,9 +33,9 @@ struct tm *localtime_r(const time_t *timep, struct tm *result)
 }
 #endif
 
-static int it_test(FILE *f, char *t, const int start)
+static int it_test(HIO_HANDLE *f, char *t, const int start)
 {
-    if (read32b(f) != MAGIC_IMPM)
+    if (hio_read32b(f) != MAGIC_IMPM)
 	return -1;
 
     read_title(f, t, 26);
@@ -80,8 +80,8 @@ static const uint8 fx[] = {
 };
 
 
-int itsex_decompress8 (FILE *, void *, int, int);
-int itsex_decompress16 (FILE *, void *, int, int);
+int itsex_decompress8 (HIO_HANDLE *, void *, int, int);
+int itsex_decompress16 (HIO_HANDLE *, void *, int, int);
 
 
 static void xlat_fx(int c, struct xmp_event *e, uint8 *arpeggio_val,
@@ -241,7 +241,7 @@ static void fix_name(uint8 *s, int l)
 }
 
 
-static int it_load(struct module_data *m, FILE *f, const int start)
+static int it_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
     struct xmp_module *mod = &m->mod;
     int r, c, i, j, k, pat_len;
@@ -266,35 +266,35 @@ static int it_load(struct module_data *m, FILE *f, const int start)
     LOAD_INIT();
 
     /* Load and convert header */
-    read32b(f);		/* magic */
+    hio_read32b(f);		/* magic */
 
-    fread(&ifh.name, 26, 1, f);
-    ifh.hilite_min = read8(f);
-    ifh.hilite_maj = read8(f);
+    hio_read(&ifh.name, 26, 1, f);
+    ifh.hilite_min = hio_read8(f);
+    ifh.hilite_maj = hio_read8(f);
 
-    ifh.ordnum = read16l(f);
-    ifh.insnum = read16l(f);
-    ifh.smpnum = read16l(f);
-    ifh.patnum = read16l(f);
+    ifh.ordnum = hio_read16l(f);
+    ifh.insnum = hio_read16l(f);
+    ifh.smpnum = hio_read16l(f);
+    ifh.patnum = hio_read16l(f);
 
-    ifh.cwt = read16l(f);
-    ifh.cmwt = read16l(f);
-    ifh.flags = read16l(f);
-    ifh.special = read16l(f);
+    ifh.cwt = hio_read16l(f);
+    ifh.cmwt = hio_read16l(f);
+    ifh.flags = hio_read16l(f);
+    ifh.special = hio_read16l(f);
 
-    ifh.gv = read8(f);
-    ifh.mv = read8(f);
-    ifh.is = read8(f);
-    ifh.it = read8(f);
-    ifh.sep = read8(f);
-    ifh.pwd = read8(f);
+    ifh.gv = hio_read8(f);
+    ifh.mv = hio_read8(f);
+    ifh.is = hio_read8(f);
+    ifh.it = hio_read8(f);
+    ifh.sep = hio_read8(f);
+    ifh.pwd = hio_read8(f);
 
-    ifh.msglen = read16l(f);
-    ifh.msgofs = read32l(f);
-    ifh.rsvd = read32l(f);
+    ifh.msglen = hio_read16l(f);
+    ifh.msgofs = hio_read32l(f);
+    ifh.rsvd = hio_read32l(f);
 
-    fread(&ifh.chpan, 64, 1, f);
-    fread(&ifh.chvol, 64, 1, f);
+    hio_read(&ifh.chpan, 64, 1, f);
+    hio_read(&ifh.chvol, 64, 1, f);
 
     strncpy(mod->name, (char *)ifh.name, XMP_NAME_SIZE);
     mod->len = ifh.ordnum;
@@ -336,7 +336,7 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 
 	mod->xxc[i].vol = ifh.chvol[i];
     }
-    fread(mod->xxo, 1, mod->len, f);
+    hio_read(mod->xxo, 1, mod->len, f);
 
     new_fx = ifh.flags & IT_OLD_FX ? 0 : 1;
 
@@ -348,11 +348,11 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	}
     }
     for (i = 0; i < mod->ins; i++)
-	pp_ins[i] = read32l(f);
+	pp_ins[i] = hio_read32l(f);
     for (i = 0; i < mod->smp; i++)
-	pp_smp[i] = read32l(f);
+	pp_smp[i] = hio_read32l(f);
     for (i = 0; i < mod->pat; i++)
-	pp_pat[i] = read32l(f);
+	pp_pat[i] = hio_read32l(f);
 
     m->c4rate = C4_NTSC_RATE;
 
@@ -441,15 +441,15 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	mod->ins = mod->smp;
 
     if (ifh.special & IT_HAS_MSG) {
-	if ((m->comment = malloc(ifh.msglen + 1)) == NULL)
+	if ((m->comment = arena_malloc(&m->arena, ifh.msglen + 1)) == NULL)
 	    return -1;
-	i = ftell(f);
-	fseek(f, start + ifh.msgofs, SEEK_SET);
+	i = hio_tell(f);
+	hio_seek(f, start + ifh.msgofs, SEEK_SET);
 
 	D_(D_INFO "Message length : %d", ifh.msglen);
 
 	for (j = 0; j < ifh.msglen; j++) {
-	    b = read8(f);
+	    b = hio_read8(f);
 	    if (b == '\r')
 		b = '\n';
 	    if ((b < 32 || b > 127) && b != '\n' && b != '\t')
@@ -458,7 +458,7 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	}
 	m->comment[j] = 0;
 
-	fseek(f, i, SEEK_SET);
+	hio_seek(f, i, SEEK_SET);
     }
 
     INSTRUMENT_INIT();
@@ -476,36 +476,36 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 
 	if ((ifh.flags & IT_USE_INST) && (ifh.cmwt >= 0x200)) {
 	    /* New instrument format */
-	    fseek(f, start + pp_ins[i], SEEK_SET);
-
-	    i2h.magic = read32b(f);
-	    fread(&i2h.dosname, 12, 1, f);
-	    i2h.zero = read8(f);
-	    i2h.nna = read8(f);
-	    i2h.dct = read8(f);
-	    i2h.dca = read8(f);
-	    i2h.fadeout = read16l(f);
-
-	    i2h.pps = read8(f);
-	    i2h.ppc = read8(f);
-	    i2h.gbv = read8(f);
-	    i2h.dfp = read8(f);
-	    i2h.rv = read8(f);
-	    i2h.rp = read8(f);
-	    i2h.trkvers = read16l(f);
-
-	    i2h.nos = read8(f);
-	    i2h.rsvd1 = read8(f);
-	    fread(&i2h.name, 26, 1, f);
+	    hio_seek(f, start + pp_ins[i], SEEK_SET);
+
+	    i2h.magic = hio_read32b(f);
+	    hio_read(&i2h.dosname, 12, 1, f);
+	    i2h.zero = hio_read8(f);
+	    i2h.nna = hio_read8(f);
+	    i2h.dct = hio_read8(f);
+	    i2h.dca = hio_read8(f);
+	    i2h.fadeout = hio_read16l(f);
+
+	    i2h.pps = hio_read8(f);
+	    i2h.ppc = hio_read8(f);
+	    i2h.gbv = hio_read8(f);
+	    i2h.dfp = hio_read8(f);
+	    i2h.rv = hio_read8(f);
+	    i2h.rp = hio_read8(f);
+	    i2h.trkvers = hio_read16l(f);
+
+	    i2h.nos = hio_read8(f);
+	    i2h.rsvd1 = hio_read8(f);
+	    hio_read(&i2h.name, 26, 1, f);
 
 	    fix_name(i2h.name, 26);
 
-	    i2h.ifc = read8(f);
-	    i2h.ifr = read8(f);
-	    i2h.mch = read8(f);
-	    i2h.mpr = read8(f);
-	    i2h.mbnk = read16l(f);
-	    fread(&i2h.keys, 240, 1, f);
+	    i2h.ifc = hio_read8(f);
+	    i2h.ifr = hio_read8(f);
+	    i2h.mch = hio_read8(f);
+	    i2h.mpr = hio_read8(f);
+	    i2h.mbnk = hio_read16l(f);
+	    hio_read(&i2h.keys, 240, 1, f);
 
 	    copy_adjust(xxi->name, i2h.name, 25);
 	    xxi->rls = i2h.fadeout << 6;
@@ -513,17 +513,17 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	    /* Envelopes */
 
 #define BUILD_ENV(X) { \
-            env.flg = read8(f); \
-            env.num = read8(f); \
-            env.lpb = read8(f); \
-            env.lpe = read8(f); \
-            env.slb = read8(f); \
-            env.sle = read8(f); \
+            env.flg = hio_read8(f); \
+            env.num = hio_read8(f); \
+            env.lpb = hio_read8(f); \
+            env.lpe = hio_read8(f); \
+            env.slb = hio_read8(f); \
+            env.sle = hio_read8(f); \
             for (j = 0; j < 25; j++) { \
-            	env.node[j].y = read8(f); \
-            	env.node[j].x = read16l(f); \
+            	env.node[j].y = hio_read8(f); \
+            	env.node[j].x = hio_read16l(f); \
             } \
-            env.unused = read8(f); \
+            env.unused = hio_read8(f); \
 	    xxi->X##ei.flg = env.flg & IT_ENV_ON ? XMP_ENVELOPE_ON : 0; \
 	    xxi->X##ei.flg |= env.flg & IT_ENV_LOOP ? XMP_ENVELOPE_LOOP : 0; \
 	    xxi->X##ei.flg |= env.flg & IT_ENV_SLOOP ? (XMP_ENVELOPE_SUS|XMP_ENVELOPE_SLOOP) : 0; \
@@ -583,7 +583,8 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	    xxi->vol = i2h.gbv >> 1;
 
 	    if (k) {
-		xxi->sub = calloc(sizeof (struct xmp_subinstrument), k);
+		xxi->sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), k);
 		for (j = 0; j < k; j++) {
 		    xxi->sub[j].sid = inst_rmap[j];
 		    xxi->sub[j].nna = i2h.nna;
@@ -613,34 +614,34 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 
 	} else if (ifh.flags & IT_USE_INST) {
 /* Old instrument format */
-	    fseek(f, start + pp_ins[i], SEEK_SET);
+	    hio_seek(f, start + pp_ins[i], SEEK_SET);
 
-	    i1h.magic = read32b(f);
-	    fread(&i1h.dosname, 12, 1, f);
+	    i1h.magic = hio_read32b(f);
+	    hio_read(&i1h.dosname, 12, 1, f);
 
-	    i1h.zero = read8(f);
-	    i1h.flags = read8(f);
-	    i1h.vls = read8(f);
-	    i1h.vle = read8(f);
-	    i1h.sls = read8(f);
-	    i1h.sle = read8(f);
-	    i1h.rsvd1 = read16l(f);
-	    i1h.fadeout = read16l(f);
+	    i1h.zero = hio_read8(f);
+	    i1h.flags = hio_read8(f);
+	    i1h.vls = hio_read8(f);
+	    i1h.vle = hio_read8(f);
+	    i1h.sls = hio_read8(f);
+	    i1h.sle = hio_read8(f);
+	    i1h.rsvd1 = hio_read16l(f);
+	    i1h.fadeout = hio_read16l(f);
 
-	    i1h.nna = read8(f);
-	    i1h.dnc = read8(f);
-	    i1h.trkvers = read16l(f);
-	    i1h.nos = read8(f);
-	    i1h.rsvd2 = read8(f);
+	    i1h.nna = hio_read8(f);
+	    i1h.dnc = hio_read8(f);
+	    i1h.trkvers = hio_read16l(f);
+	    i1h.nos = hio_read8(f);
+	    i1h.rsvd2 = hio_read8(f);
 
-	    fread(&i1h.name, 26, 1, f);
+	    hio_read(&i1h.name, 26, 1, f);
 
 	    fix_name(i1h.name, 26);
 
-	    fread(&i1h.rsvd3, 6, 1, f);
-	    fread(&i1h.keys, 240, 1, f);
-	    fread(&i1h.epoint, 200, 1, f);
-	    fread(&i1h.enode, 50, 1, f);
+	    hio_read(&i1h.rsvd3, 6, 1, f);
+	    hio_read(&i1h.keys, 240, 1, f);
+	    hio_read(&i1h.epoint, 200, 1, f);
+	    hio_read(&i1h.enode, 50, 1, f);
 
 	    copy_adjust(xxi->name, i1h.name, 25);
 
@@ -694,7 +695,8 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	    xxi->vol = i2h.gbv >> 1;
 
 	    if (k) {
-		xxi->sub = calloc(sizeof (struct xmp_subinstrument), k);
+		xxi->sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), k);
 		for (j = 0; j < k; j++) {
 		    xxi->sub[j].sid = inst_rmap[j];
 		    xxi->sub[j].nna = i1h.nna;
@@ -724,33 +726,34 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	struct xmp_sample *xxs = &mod->xxs[i];
 
 	if (~ifh.flags & IT_USE_INST)
-	    mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
-	fseek(f, start + pp_smp[i], SEEK_SET);
-
-	ish.magic = read32b(f);
-	fread(&ish.dosname, 12, 1, f);
-	ish.zero = read8(f);
-	ish.gvl = read8(f);
-	ish.flags = read8(f);
-	ish.vol = read8(f);
-	fread(&ish.name, 26, 1, f);
+	    mod->xxi[i].sub = arena_calloc(&m->arena,
+	    			sizeof (struct xmp_subinstrument), 1);
+	hio_seek(f, start + pp_smp[i], SEEK_SET);
+
+	ish.magic = hio_read32b(f);
+	hio_read(&ish.dosname, 12, 1, f);
+	ish.zero = hio_read8(f);
+	ish.gvl = hio_read8(f);
+	ish.flags = hio_read8(f);
+	ish.vol = hio_read8(f);
+	hio_read(&ish.name, 26, 1, f);
 
 	fix_name(ish.name, 26);
 
-	ish.convert = read8(f);
-	ish.dfp = read8(f);
-	ish.length = read32l(f);
-	ish.loopbeg = read32l(f);
-	ish.loopend = read32l(f);
-	ish.c5spd = read32l(f);
-	ish.sloopbeg = read32l(f);
-	ish.sloopend = read32l(f);
-	ish.sample_ptr = read32l(f);
-
-	ish.vis = read8(f);
-	ish.vid = read8(f);
-	ish.vir = read8(f);
-	ish.vit = read8(f);
+	ish.convert = hio_read8(f);
+	ish.dfp = hio_read8(f);
+	ish.length = hio_read32l(f);
+	ish.loopbeg = hio_read32l(f);
+	ish.loopend = hio_read32l(f);
+	ish.c5spd = hio_read32l(f);
+	ish.sloopbeg = hio_read32l(f);
+	ish.sloopend = hio_read32l(f);
+	ish.sample_ptr = hio_read32l(f);
+
+	ish.vis = hio_read8(f);
+	ish.vid = hio_read8(f);
+	ish.vir = hio_read8(f);
+	ish.vit = hio_read8(f);
 
 	/* Changed to continue to allow use-brdg.it and use-funk.it to
 	 * load correctly (both IT 2.04)
@@ -818,13 +821,15 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	if (ish.flags & IT_SMP_SAMPLE && xxs->len > 1) {
 	    int cvt = 0;
 
-	    fseek(f, start + ish.sample_ptr, SEEK_SET);
+	    hio_seek(f, start + ish.sample_ptr, SEEK_SET);
 
 	    if (~ish.convert & IT_CVT_SIGNED)
 		cvt |= SAMPLE_FLAG_UNS;
 
 	    /* Handle compressed samples using Tammo Hinrichs' routine */
-	    if (ish.flags & IT_SMP_COMP) {
+	    if (m->smpctl & XMP_SMPCTL_SKIP) {
+		load_sample(m, NULL, SAMPLE_FLAG_NOLOAD | cvt, &mod->xxs[i], NULL);
+	    } else if (ish.flags & IT_SMP_COMP) {
 		uint8 *buf;
 		buf = calloc(1, xxs->len * 2);
 
@@ -842,10 +847,10 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 					ish.convert & IT_CVT_DIFF);
 		}
 
-		load_sample(NULL, SAMPLE_FLAG_NOLOAD | cvt, &mod->xxs[i], buf);
+		load_sample(m, NULL, SAMPLE_FLAG_NOLOAD | cvt, &mod->xxs[i], buf);
 		free (buf);
 	    } else {
-		load_sample(f, cvt, &mod->xxs[i], NULL);
+		load_sample(m, f, cvt, &mod->xxs[i], NULL);
 	    }
 	}
     }
@@ -866,23 +871,24 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	/* If the offset to a pattern is 0, the pattern is empty */
 	if (!pp_pat[i]) {
 	    mod->xxp[i]->rows = 64;
-	    mod->xxt[i * mod->chn] = calloc (sizeof (struct xmp_track) +
+	    mod->xxt[i * mod->chn] = arena_calloc(&m->track_arena,
+	    			sizeof (struct xmp_track) +
 		sizeof (struct xmp_event) * 64, 1);
 	    mod->xxt[i * mod->chn]->rows = 64;
 	    for (j = 0; j < mod->chn; j++)
 		mod->xxp[i]->index[j] = i * mod->chn;
 	    continue;
 	}
-	fseek(f, start + pp_pat[i], SEEK_SET);
-	pat_len = read16l(f) /* - 4*/;
-	mod->xxp[i]->rows = read16l(f);
+	hio_seek(f, start + pp_pat[i], SEEK_SET);
+	pat_len = hio_read16l(f) /* - 4*/;
+	mod->xxp[i]->rows = hio_read16l(f);
 	TRACK_ALLOC (i);
 	memset (mask, 0, L_CHANNELS);
-	read16l(f);
-	read16l(f);
+	hio_read16l(f);
+	hio_read16l(f);
 
 	while (--pat_len >= 0) {
-	    b = read8(f);
+	    b = hio_read8(f);
 	    if (!b) {
 		r++;
 		continue;
@@ -890,7 +896,7 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	    c = (b - 1) & 63;
 
 	    if (b & 0x80) {
-		mask[c] = read8(f);
+		mask[c] = hio_read8(f);
 		pat_len--;
 	    }
 	    /*
@@ -901,7 +907,7 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 	     */
 	    event = c >= mod->chn ? &dummy : &EVENT (i, c, r);
 	    if (mask[c] & 0x01) {
-		b = read8(f);
+		b = hio_read8(f);
 
 		if (b > 0x7f && b < 0xfd)
 			b = 0;
@@ -923,20 +929,20 @@ static int it_load(struct module_data *m, FILE *f, const int start)
 		pat_len--;
 	    }
 	    if (mask[c] & 0x02) {
-		b = read8(f);
+		b = hio_read8(f);
 		lastevent[c].ins = event->ins = b;
 		pat_len--;
 	    }
 	    if (mask[c] & 0x04) {
-		b = read8(f);
+		b = hio_read8(f);
 		lastevent[c].vol = event->vol = b;
 		xlat_volfx(event);
 		pat_len--;
 	    }
 	    if (mask[c] & 0x08) {
-		b = read8(f);
+		b = hio_read8(f);
 		event->fxt = b;
-		event->fxp = read8(f);
+		event->fxp = hio_read8(f);
 		xlat_fx(c, event, arpeggio_val, last_h, last_fxp, new_fx);
 		lastevent[c].fxt = event->fxt;
 		lastevent[c].fxp = event->fxp;
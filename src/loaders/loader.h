@@ -23,19 +23,33 @@
 #define SAMPLE_FLAG_SPECTRUM	0x4000	/* Spectrum synth instrument */
 
 #define SAMPLE_FLAG_SYNTH	(SAMPLE_FLAG_ADLIB | SAMPLE_FLAG_SPECTRUM)
+#define SAMPLE_FLAG_CONVERT	(SAMPLE_FLAG_DIFF | SAMPLE_FLAG_UNS | \
+				 SAMPLE_FLAG_8BDIFF | SAMPLE_FLAG_7BIT | \
+				 SAMPLE_FLAG_VIDC | SAMPLE_FLAG_STEREO)
+
+/* Sample data left in the module file, see XMP_SMPCTL_LAZY */
+struct lazy_sample {
+	long offset;		/* position of the data in the file */
+	int flags;		/* sample flags used to load the data */
+	int len;		/* sample length in the file */
+	int pending;		/* data not loaded yet */
+};
 
 
 char *copy_adjust(char *, uint8 *, int);
 int test_name(uint8 *, int);
-void read_title(FILE *, char *, int);
+void read_title(HIO_HANDLE *, char *, int);
 void set_xxh_defaults(struct xmp_module *);
 void cvt_pt_event(struct xmp_event *, uint8 *);
 void disable_continue_fx(struct xmp_event *);
 int check_filename_case(char *, char *, char *, int);
 void get_instrument_path(struct module_data *, char *, int);
 void set_type(struct module_data *, char *, ...);
-int load_sample(FILE *, int, struct xmp_sample *, void *);
-int64_t file_size(FILE *);
+int load_sample(struct module_data *, HIO_HANDLE *, int, struct xmp_sample *, void *);
+int load_lazy_sample(struct module_data *, int);
+void load_lazy_samples(struct module_data *);
+uint8 *copy_sample(struct xmp_sample *);
+void free_sample(uint8 *);
 
 extern uint8 ord_xlat[];
 extern const int arch_vol_table[];
@@ -49,7 +63,7 @@ static inline int is_big_endian() {
     (((uint32)(a)<<24)|((uint32)(b)<<16)|((uint32)(c)<<8)|(d))
 
 #define LOAD_INIT() do { \
-    fseek(f, start, SEEK_SET); \
+    hio_seek(f, start, SEEK_SET); \
 } while (0)
 
 #define MODULE_INFO() do { \
@@ -57,56 +71,42 @@ static inline int is_big_endian() {
     D_(D_WARN "Module type: %s", m->mod.type); \
 } while (0)
 
+/* Module data is allocated from the context arena and released in one
+ * step by xmp_release_module(), so there are no matching free macros.
+ */
 #define INSTRUMENT_INIT() do { \
-    mod->xxi = calloc(sizeof (struct xmp_instrument), mod->ins); \
-    if (mod->smp) { mod->xxs = calloc (sizeof (struct xmp_sample), mod->smp); }\
+    mod->xxi = arena_calloc(&m->arena, \
+	sizeof (struct xmp_instrument), mod->ins); \
+    if (mod->smp) { mod->xxs = arena_calloc(&m->arena, \
+	sizeof (struct xmp_sample), mod->smp); }\
 } while (0)
 
 #define PATTERN_INIT() do { \
-    mod->xxt = calloc(sizeof (struct xmp_track *), mod->trk); \
-    mod->xxp = calloc(sizeof (struct xmp_pattern *), mod->pat + 1); \
+    mod->xxt = arena_calloc(&m->arena, \
+	sizeof (struct xmp_track *), mod->trk); \
+    mod->xxp = arena_calloc(&m->arena, \
+	sizeof (struct xmp_pattern *), mod->pat + 1); \
 } while (0)
 
 #define PATTERN_ALLOC(x) do { \
-    mod->xxp[x] = calloc(1, sizeof (struct xmp_pattern) + \
+    mod->xxp[x] = arena_calloc(&m->arena, 1, sizeof (struct xmp_pattern) + \
 	sizeof (int) * (mod->chn - 1)); \
 } while (0)
 
+/* All tracks of a pattern are allocated in a single contiguous chunk.
+ * Tracks have an arena of their own, which is dropped if the module
+ * is compacted after loading.
+ */
 #define TRACK_ALLOC(i) do { \
     int j; \
+    size_t tsize = sizeof (struct xmp_track) + \
+	sizeof (struct xmp_event) * (mod->xxp[i]->rows - 1); \
+    uint8 *tbuf = arena_calloc(&m->track_arena, mod->chn, tsize); \
     for (j = 0; j < mod->chn; j++) { \
 	mod->xxp[i]->index[j] = i * mod->chn + j; \
-	mod->xxt[i * mod->chn + j] = calloc (sizeof (struct xmp_track) + \
-	    sizeof (struct xmp_event) * (mod->xxp[i]->rows - 1), 1); \
+	mod->xxt[i * mod->chn + j] = (struct xmp_track *)(tbuf + j * tsize); \
 	mod->xxt[i * mod->chn + j]->rows = mod->xxp[i]->rows; \
     } \
 } while (0)
 
-#define INSTRUMENT_DEALLOC_ALL(i) do { \
-    int k; \
-    for (k = (i) - 1; k >= 0; k--) free(mod->xxi[k]); \
-    free(mod->xxfe); \
-    free(mod->xxpe); \
-    free(mod->xxae); \
-    if (mod->smp) free(mod->xxs); \
-    free(mod->xxi); \
-    free(mod->xxim); \
-    free(mod->xxi); \
-} while (0)
-
-#define PATTERN_DEALLOC_ALL(x) do { \
-    int k; \
-    for (k = x; k >= 0; k--) free(mod->xxp[k]); \
-    free(mod->xxp); \
-} while (0)
-
-#define TRACK_DEALLOC_ALL(i) do { \
-    int j, k; \
-    for (k = i; k >= 0; k--) { \
-	for (j = 0; j < mod->chn; j++) \
-	    free(mod->xxt[k * mod->chn + j]); \
-    } \
-    free(mod->xxt); \
-} while (0)
-
 #endif
@@ -61,8 +61,8 @@
 #define MAGIC_OPLH	MAGIC4('O','P','L','H')
 
 
-static int masi_test (FILE *, char *, const int);
-static int masi_load (struct module_data *, FILE *, const int);
+static int masi_test (HIO_HANDLE *, char *, const int);
+static int masi_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader masi_loader = {
 	"Epic MegaGames MASI (PSM)",
@@ -70,28 +70,28 @@ const struct format_loader masi_loader = {
 	masi_load
 };
 
-static int masi_test(FILE *f, char *t, const int start)
+static int masi_test(HIO_HANDLE *f, char *t, const int start)
 {
 	int val;
 
-	if (read32b(f) != MAGIC_PSM_)
+	if (hio_read32b(f) != MAGIC_PSM_)
 		return -1;
 
-	read8(f);
-	read8(f);
-	read8(f);
-	if (read8(f) != 0)
+	hio_read8(f);
+	hio_read8(f);
+	hio_read8(f);
+	if (hio_read8(f) != 0)
 		return -1;
 
-	if (read32b(f) != MAGIC_FILE) 
+	if (hio_read32b(f) != MAGIC_FILE) 
 		return -1;
 
-	read32b(f);
-	val = read32l(f);
-	fseek(f, val, SEEK_CUR);
+	hio_read32b(f);
+	val = hio_read32l(f);
+	hio_seek(f, val, SEEK_CUR);
 
-	if (read32b(f) == MAGIC_TITL) {
-		val = read32l(f);
+	if (hio_read32b(f) == MAGIC_TITL) {
+		val = hio_read32l(f);
 		read_title(f, t, val);
 	} else {
 		read_title(f, t, 0);
@@ -108,20 +108,20 @@ struct local_data {
     uint8 *pord;
 };
 
-static void get_sdft(struct module_data *m, int size, FILE *f, void *parm)
+static void get_sdft(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 }
 
-static void get_titl(struct module_data *m, int size, FILE *f, void *parm)
+static void get_titl(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	char buf[40];
 	
-	fread(buf, 1, 40, f);
+	hio_read(buf, 1, 40, f);
 	strncpy(mod->name, buf, size > 32 ? 32 : size);
 }
 
-static void get_dsmp_cnt(struct module_data *m, int size, FILE *f, void *parm)
+static void get_dsmp_cnt(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 
@@ -129,44 +129,45 @@ static void get_dsmp_cnt(struct module_data *m, int size, FILE *f, void *parm)
 	mod->smp = mod->ins;
 }
 
-static void get_pbod_cnt(struct module_data *m, int size, FILE *f, void *parm)
+static void get_pbod_cnt(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
 	char buf[20];
 
 	mod->pat++;
-	fread(buf, 1, 20, f);
+	hio_read(buf, 1, 20, f);
 	if (buf[9] != 0 && buf[13] == 0)
 		data->sinaria = 1;
 }
 
 
-static void get_dsmp(struct module_data *m, int size, FILE *f, void *parm)
+static void get_dsmp(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
 	int i, srate;
 	int finetune;
 
-	read8(f);				/* flags */
-	fseek(f, 8, SEEK_CUR);			/* songname */
-	fseek(f, data->sinaria ? 8 : 4, SEEK_CUR);	/* smpid */
+	hio_read8(f);				/* flags */
+	hio_seek(f, 8, SEEK_CUR);			/* songname */
+	hio_seek(f, data->sinaria ? 8 : 4, SEEK_CUR);	/* smpid */
 
 	i = data->cur_ins;
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 
-	fread(&mod->xxi[i].name, 1, 34, f);
+	hio_read(&mod->xxi[i].name, 1, 34, f);
 	str_adj((char *)mod->xxi[i].name);
-	fseek(f, 5, SEEK_CUR);
-	read8(f);		/* insno */
-	read8(f);
-	mod->xxs[i].len = read32l(f);
+	hio_seek(f, 5, SEEK_CUR);
+	hio_read8(f);		/* insno */
+	hio_read8(f);
+	mod->xxs[i].len = hio_read32l(f);
 	mod->xxi[i].nsm = !!(mod->xxs[i].len);
-	mod->xxs[i].lps = read32l(f);
-	mod->xxs[i].lpe = read32l(f);
+	mod->xxs[i].lps = hio_read32l(f);
+	mod->xxs[i].lpe = hio_read32l(f);
 	mod->xxs[i].flg = mod->xxs[i].lpe > 2 ? XMP_SAMPLE_LOOP : 0;
-	read16l(f);
+	hio_read16l(f);
 
 	if ((int32)mod->xxs[i].lpe < 0)
 		mod->xxs[i].lpe = 0;
@@ -178,14 +179,14 @@ static void get_dsmp(struct module_data *m, int size, FILE *f, void *parm)
 		if (mod->xxs[i].lpe > 2)
 			mod->xxs[i].lpe -= 2;
 
-		finetune = (int8)(read8s(f) << 4);
+		finetune = (int8)(hio_read8s(f) << 4);
 	}
 
-	mod->xxi[i].sub[0].vol = read8(f) / 2 + 1;
-	read32l(f);
+	mod->xxi[i].sub[0].vol = hio_read8(f) / 2 + 1;
+	hio_read32l(f);
 	mod->xxi[i].sub[0].pan = 0x80;
 	mod->xxi[i].sub[0].sid = i;
-	srate = read32l(f);
+	srate = hio_read32l(f);
 
 	D_(D_INFO "[%2X] %-32.32s %05x %05x %05x %c V%02x %+04d %5d", i,
 		mod->xxi[i].name, mod->xxs[i].len, mod->xxs[i].lps, mod->xxs[i].lpe,
@@ -196,14 +197,14 @@ static void get_dsmp(struct module_data *m, int size, FILE *f, void *parm)
 	c2spd_to_note(srate, &mod->xxi[i].sub[0].xpo, &mod->xxi[i].sub[0].fin);
 	mod->xxi[i].sub[0].fin += finetune;
 
-	fseek(f, 16, SEEK_CUR);
-	load_sample(f, SAMPLE_FLAG_8BDIFF, &mod->xxs[i], NULL);
+	hio_seek(f, 16, SEEK_CUR);
+	load_sample(m, f, SAMPLE_FLAG_8BDIFF, &mod->xxs[i], NULL);
 
 	data->cur_ins++;
 }
 
 
-static void get_pbod(struct module_data *m, int size, FILE *f, void *parm)
+static void get_pbod(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
@@ -215,10 +216,10 @@ static void get_pbod(struct module_data *m, int size, FILE *f, void *parm)
 
 	i = data->cur_pat;
 
-	len = read32l(f);
-	fread(data->pnam + i * 8, 1, data->sinaria ? 8 : 4, f);
+	len = hio_read32l(f);
+	hio_read(data->pnam + i * 8, 1, data->sinaria ? 8 : 4, f);
 
-	rows = read16l(f);
+	rows = hio_read16l(f);
 
 	PATTERN_ALLOC(i);
 	mod->xxp[i]->rows = rows;
@@ -227,20 +228,20 @@ static void get_pbod(struct module_data *m, int size, FILE *f, void *parm)
 	r = 0;
 
 	do {
-		rowlen = read16l(f) - 2;
+		rowlen = hio_read16l(f) - 2;
 		while (rowlen > 0) {
-			flag = read8(f);
+			flag = hio_read8(f);
 	
 			if (rowlen == 1)
 				break;
 	
-			chan = read8(f);
+			chan = hio_read8(f);
 			rowlen -= 2;
 	
 			event = chan < mod->chn ? &EVENT(i, chan, r) : &dummy;
 	
 			if (flag & 0x80) {
-				uint8 note = read8(f);
+				uint8 note = hio_read8(f);
 				rowlen--;
 				if (data->sinaria)
 					note += 37;
@@ -250,18 +251,18 @@ static void get_pbod(struct module_data *m, int size, FILE *f, void *parm)
 			}
 
 			if (flag & 0x40) {
-				event->ins = read8(f) + 1;
+				event->ins = hio_read8(f) + 1;
 				rowlen--;
 			}
 	
 			if (flag & 0x20) {
-				event->vol = read8(f) / 2;
+				event->vol = hio_read8(f) / 2;
 				rowlen--;
 			}
 	
 			if (flag & 0x10) {
-				uint8 fxt = read8(f);
-				uint8 fxp = read8(f);
+				uint8 fxt = hio_read8(f);
+				uint8 fxp = hio_read8(f);
 				rowlen -= 2;
 	
 				/* compressed events */
@@ -320,7 +321,7 @@ printf("p%d r%d c%d: compressed event %02x %02x\n", i, r, chan, fxt, fxp);
 					fxp = (EX_RETRIG << 4) | (fxp & 0x0f); 
 					break;
 				case 0x29:		/* unknown */
-					read16l(f);
+					hio_read16l(f);
 					rowlen -= 2;
 					break;
 				case 0x33:		/* position Jump */
@@ -350,15 +351,15 @@ printf("p%d r%d c%d: unknown effect %02x %02x\n", i, r, chan, fxt, fxp);
 	data->cur_pat++;
 }
 
-static void get_song(struct module_data *m, int size, FILE *f, void *parm)
+static void get_song(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 
-	fseek(f, 10, SEEK_CUR);
-	mod->chn = read8(f);
+	hio_seek(f, 10, SEEK_CUR);
+	mod->chn = hio_read8(f);
 }
 
-static void get_song_2(struct module_data *m, int size, FILE *f, void *parm)
+static void get_song_2(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	struct local_data *data = (struct local_data *)parm;
@@ -366,53 +367,53 @@ static void get_song_2(struct module_data *m, int size, FILE *f, void *parm)
 	char c, buf[20];
 	int i;
 
-	fread(buf, 1, 9, f);
-	read16l(f);
+	hio_read(buf, 1, 9, f);
+	hio_read16l(f);
 
 	D_(D_INFO "Subsong title: %-9.9s", buf);
 
-	magic = read32b(f);
+	magic = hio_read32b(f);
 	while (magic != MAGIC_OPLH) {
 		int skip;
-		skip = read32l(f);;
-		fseek(f, skip, SEEK_CUR);
-		magic = read32b(f);
+		skip = hio_read32l(f);;
+		hio_seek(f, skip, SEEK_CUR);
+		magic = hio_read32b(f);
 	}
 
-	read32l(f);	/* chunk size */
+	hio_read32l(f);	/* chunk size */
 
-	fseek(f, 9, SEEK_CUR);		/* unknown data */
+	hio_seek(f, 9, SEEK_CUR);		/* unknown data */
 	
-	c = read8(f);
-	for (i = 0; c != 0x01; c = read8(f)) {
+	c = hio_read8(f);
+	for (i = 0; c != 0x01; c = hio_read8(f)) {
 		switch (c) {
 		case 0x07:
-			mod->spd = read8(f);
-			read8(f);		/* 08 */
-			mod->bpm = read8(f);
+			mod->spd = hio_read8(f);
+			hio_read8(f);		/* 08 */
+			mod->bpm = hio_read8(f);
 			break;
 		case 0x0d:
-			read8(f);		/* channel number? */
-			mod->xxc[i].pan = read8(f);
-			read8(f);		/* flags? */
+			hio_read8(f);		/* channel number? */
+			mod->xxc[i].pan = hio_read8(f);
+			hio_read8(f);		/* flags? */
 			i++;
 			break;
 		case 0x0e:
-			read8(f);		/* channel number? */
-			read8(f);		/* ? */
+			hio_read8(f);		/* channel number? */
+			hio_read8(f);		/* ? */
 			break;
 		default:
-			printf("channel %d: %02x %02x\n", i, c, read8(f));
+			printf("channel %d: %02x %02x\n", i, c, hio_read8(f));
 		}
 	}
 
-	for (; c == 0x01; c = read8(f)) {
-		fread(data->pord + mod->len * 8, 1, data->sinaria ? 8 : 4, f);
+	for (; c == 0x01; c = hio_read8(f)) {
+		hio_read(data->pord + mod->len * 8, 1, data->sinaria ? 8 : 4, f);
 		mod->len++;
 	}
 }
 
-static int masi_load(struct module_data *m, FILE *f, const int start)
+static int masi_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct xmp_module *mod = &m->mod;
 	iff_handle handle;
@@ -422,16 +423,16 @@ static int masi_load(struct module_data *m, FILE *f, const int start)
 
 	LOAD_INIT();
 
-	read32b(f);
+	hio_read32b(f);
 
 	data.sinaria = 0;
 	mod->name[0] = 0;
 
-	fseek(f, 8, SEEK_CUR);		/* skip file size and FILE */
+	hio_seek(f, 8, SEEK_CUR);		/* skip file size and HIO_HANDLE */
 	mod->smp = mod->ins = 0;
 	data.cur_pat = 0;
 	data.cur_ins = 0;
-	offset = ftell(f);
+	offset = hio_tell(f);
 
 	handle = iff_new();
 	if (handle == NULL)
@@ -446,7 +447,7 @@ static int masi_load(struct module_data *m, FILE *f, const int start)
 	iff_set_quirk(handle, IFF_LITTLE_ENDIAN);
 
 	/* Load IFF chunks */
-	while (!feof(f)) {
+	while (!hio_eof(f)) {
 		iff_chunk(handle, m, f, &data);
 	}
 
@@ -466,7 +467,7 @@ static int masi_load(struct module_data *m, FILE *f, const int start)
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 	D_(D_INFO "Stored samples : %d", mod->smp);
 
-	fseek(f, start + offset, SEEK_SET);
+	hio_seek(f, start + offset, SEEK_SET);
 
 	mod->len = 0;
 
@@ -481,7 +482,7 @@ static int masi_load(struct module_data *m, FILE *f, const int start)
 	iff_set_quirk(handle, IFF_LITTLE_ENDIAN);
 
 	/* Load IFF chunks */
-	while (!feof (f)) {
+	while (!hio_eof(f)) {
 		iff_chunk(handle, m, f, &data);
 	}
 
@@ -19,8 +19,8 @@
 #define MAGIC_MED4	MAGIC4('M','E','D',4)
 #undef MED4_DEBUG
 
-static int med4_test(FILE *, char *, const int);
-static int med4_load (struct module_data *, FILE *, const int);
+static int med4_test(HIO_HANDLE *, char *, const int);
+static int med4_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader med4_loader = {
 	"MED 2.10 MED4 (MED)",
@@ -28,9 +28,9 @@ const struct format_loader med4_loader = {
 	med4_load
 };
 
-static int med4_test(FILE *f, char *t, const int start)
+static int med4_test(HIO_HANDLE *f, char *t, const int start)
 {
-	if (read32b(f) !=  MAGIC_MED4)
+	if (hio_read32b(f) !=  MAGIC_MED4)
 		return -1;
 
 	read_title(f, t, 0);
@@ -122,24 +122,24 @@ static void fix_effect(struct xmp_event *event)
 	}
 }
 
-static inline uint8 read4(FILE *f, int *read4_ctl)
+/* The byte with a pending low nibble is kept in read4_ctl, above bit 0 */
+static inline uint8 read4(HIO_HANDLE *f, int *read4_ctl)
 {
-	static uint8 b = 0;
-	uint8 ret;
+	uint8 b, ret;
 
 	if (*read4_ctl & 0x01) {
-		ret = b & 0x0f;
+		ret = (*read4_ctl >> 8) & 0x0f;
+		*read4_ctl = 0;
 	} else {
-		b = read8(f);
+		b = hio_read8(f);
 		ret = b >> 4;
+		*read4_ctl = (b << 8) | 0x01;
 	}
 
-	*read4_ctl ^= 0x01;
-
 	return ret;
 }
 
-static inline uint16 read12b(FILE *f, int *read4_ctl)
+static inline uint16 read12b(HIO_HANDLE *f, int *read4_ctl)
 {
 	uint32 a, b, c;
 
@@ -158,9 +158,7 @@ struct temp_inst {
 	int transpose;
 };
 
-struct temp_inst temp_inst[32];
-
-static int med4_load(struct module_data *m, FILE *f, const int start)
+static int med4_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct xmp_module *mod = &m->mod;
 	int i, j, k;
@@ -168,6 +166,7 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 	int transp, masksz;
 	int pos, vermaj, vermin;
 	uint8 trkvol[16], buf[1024];
+	struct temp_inst temp_inst[32];
 	struct xmp_event *event;
 	int flags, hexvol = 0;
 	int num_ins, num_smp;
@@ -177,7 +176,7 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 	
 	LOAD_INIT();
 
-	read32b(f);		/* Skip magic */
+	hio_read32b(f);		/* Skip magic */
 
 	vermaj = 2;
 	vermin = 10;
@@ -185,11 +184,11 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 	/*
 	 * Check if we have a MEDV chunk at the end of the file
 	 */
-	pos = ftell(f);
-	fseek(f, 0, SEEK_END);
-	if (ftell(f) > 2000) {
-		fseek(f, -1023, SEEK_CUR);
-		fread(buf, 1, 1024, f);
+	pos = hio_tell(f);
+	hio_seek(f, 0, SEEK_END);
+	if (hio_tell(f) > 2000) {
+		hio_seek(f, -1023, SEEK_CUR);
+		hio_read(buf, 1, 1024, f);
 		for (i = 0; i < 1012; i++) {
 			if (!memcmp(buf + i, "MEDV\000\000\000\004", 8)) {
 				vermaj = *(buf + i + 10);
@@ -198,17 +197,17 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 			}
 		}
 	}
-	fseek(f, start + pos, SEEK_SET);
+	hio_seek(f, start + pos, SEEK_SET);
 
 	snprintf(mod->type, XMP_NAME_SIZE, "MED %d.%02d MED4", vermaj, vermin);
 
-	m0 = read8(f);
+	m0 = hio_read8(f);
 
 	mask = masksz = 0;
 	for (i = 0; i < 8; i++, m0 <<= 1) {
 		if (m0 & 0x80) {
 			mask <<= 8;
-			mask |= read8(f);
+			mask |= hio_read8(f);
 			masksz++;
 		}
 	}
@@ -228,12 +227,12 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 			continue;
 
 		/* read flags */
-	   	c = read8(f);
+	   	c = hio_read8(f);
 
 		/* read instrument name */
-		size = read8(f);
+		size = hio_read8(f);
 		for (j = 0; j < size; j++)
-			buf[j] = read8(f);
+			buf[j] = hio_read8(f);
 		buf[j] = 0;
 #ifdef MED4_DEBUG
 		printf("%02x %02x %2d [%s]\n", i, c, size, buf);
@@ -242,17 +241,17 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 		temp_inst[i].volume = 0x40;
 
 		if ((c & 0x01) == 0)
-			temp_inst[i].loop_start = read16b(f) << 1;
+			temp_inst[i].loop_start = hio_read16b(f) << 1;
 		if ((c & 0x02) == 0)
-			loop_len = read16b(f) << 1;
+			loop_len = hio_read16b(f) << 1;
 		if ((c & 0x04) == 0)	/* ? Tanko2 (MED 3.00 demo) */
-			read8(f);
+			hio_read8(f);
 		if ((c & 0x08) == 0)	/* Tim Newsham's "span" */
-			read8(f);
+			hio_read8(f);
 		if ((c & 0x20) == 0)
-			temp_inst[i].volume = read8(f);
+			temp_inst[i].volume = hio_read8(f);
 		if ((c & 0x40) == 0)
-			temp_inst[i].transpose = read8s(f);
+			temp_inst[i].transpose = hio_read8s(f);
 
 		temp_inst[i].loop_end = temp_inst[i].loop_start + loop_len;
 
@@ -261,12 +260,12 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 		num_ins++;
 	}
 
-	mod->pat = read16b(f);
-	mod->len = read16b(f);
+	mod->pat = hio_read16b(f);
+	mod->len = hio_read16b(f);
 #ifdef MED4_DEBUG
 	printf("pat=%x len=%x\n", mod->pat, mod->len);
 #endif
-	fread(mod->xxo, 1, mod->len, f);
+	hio_read(mod->xxo, 1, mod->len, f);
 
 	/* From MED V3.00 docs:
 	 *
@@ -275,17 +274,17 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 	 * tempos 1 - 10 are Tracker-compatible (but obsolete, because
 	 * secondary tempo can be used now).
 	 */
-	tempo = read16b(f);
+	tempo = hio_read16b(f);
 	if (tempo <= 10) {
 		mod->spd = tempo;
 		mod->bpm = 125;
 	} else {
 		mod->bpm = 125 * tempo / 33;
 	}
-        transp = read8s(f);
-        read8s(f);
-        flags = read8s(f);
-	mod->spd = read8(f);
+        transp = hio_read8s(f);
+        hio_read8s(f);
+        flags = hio_read8s(f);
+	mod->spd = hio_read8(f);
 
 	if (~flags & 0x20)	/* sliding */
 		m->quirk |= QUIRK_VSALL | QUIRK_PBALL;
@@ -297,10 +296,10 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 	if (vermaj == 2)	/* Happy.med has tempo 5 but loads as 6 */
 		mod->spd = flags & 0x20 ? 5 : 6;
 
-	fseek(f, 20, SEEK_CUR);
+	hio_seek(f, 20, SEEK_CUR);
 
-	fread(trkvol, 1, 16, f);
-	read8(f);		/* master vol */
+	hio_read(trkvol, 1, 16, f);
+	hio_read8(f);		/* master vol */
 
 	MODULE_INFO();
 
@@ -309,9 +308,9 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 	for (i = 0; i < 32; i++)
 		temp_inst[i].transpose += transp;
 
-	read8(f);
-	mod->chn = read8(f);;
-	fseek(f, -2, SEEK_CUR);
+	hio_read8(f);
+	mod->chn = hio_read8(f);;
+	hio_seek(f, -2, SEEK_CUR);
 	mod->trk = mod->chn * mod->pat;
 
 	PATTERN_INIT();
@@ -326,25 +325,25 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 
 #ifdef MED4_DEBUG
 		printf("\n===== PATTERN %d =====\n", i);
-		printf("offset = %lx\n", ftell(f));
+		printf("offset = %lx\n", hio_tell(f));
 #endif
 
-		size = read8(f);	/* pattern control block */
-		chn = read8(f);
-		rows = read8(f) + 1;
-		plen = read16b(f);
-		ctl = read8(f);
+		size = hio_read8(f);	/* pattern control block */
+		chn = hio_read8(f);
+		rows = hio_read8(f) + 1;
+		plen = hio_read16b(f);
+		ctl = hio_read8(f);
 
 		PATTERN_ALLOC(i);
 		mod->xxp[i]->rows = rows;
 		TRACK_ALLOC(i);
 
-		linemsk0 = ctl & 0x80 ? ~0 : ctl & 0x40 ? 0 : read32b(f);
-		fxmsk0   = ctl & 0x20 ? ~0 : ctl & 0x10 ? 0 : read32b(f);
+		linemsk0 = ctl & 0x80 ? ~0 : ctl & 0x40 ? 0 : hio_read32b(f);
+		fxmsk0   = ctl & 0x20 ? ~0 : ctl & 0x10 ? 0 : hio_read32b(f);
 
 		if (rows > 32) {
-			linemsk1=ctl & 0x08 ? ~0 : ctl & 0x04 ? 0 : read32b(f);
-			fxmsk1 = ctl & 0x02 ? ~0 : ctl & 0x01 ? 0 : read32b(f);
+			linemsk1=ctl & 0x08 ? ~0 : ctl & 0x04 ? 0 : hio_read32b(f);
+			fxmsk1 = ctl & 0x02 ? ~0 : ctl & 0x01 ? 0 : hio_read32b(f);
 		} else {
 			linemsk1 = 0;
 			fxmsk1 = 0;
@@ -363,10 +362,8 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 #endif
 
 		/* check block end */
-		if (read8(f) != 0xff) {
+		if (hio_read8(f) != 0xff) {
 			D_(D_CRIT "error: module is corrupted");
-			TRACK_DEALLOC_ALL(i);
-			PATTERN_DEALLOC_ALL(i);
 			return -1;
 		}
 
@@ -466,25 +463,25 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 
 	mod->ins =  num_ins;
 
-	m->med_vol_table = calloc(sizeof(uint8 *), mod->ins);
-        m->med_wav_table = calloc(sizeof(uint8 *), mod->ins);
+	m->med_vol_table = arena_calloc(&m->arena, sizeof(uint8 *), mod->ins);
+        m->med_wav_table = arena_calloc(&m->arena, sizeof(uint8 *), mod->ins);
 
 	/*
 	 * Load samples
 	 */
-	mask = read32b(f);
-	read16b(f);
+	mask = hio_read32b(f);
+	hio_read16b(f);
 
 #ifdef MED4_DEBUG
 	printf("instrument mask: %08x\n", mask);
 #endif
 
-	read16b(f);	/* ?!? */
+	hio_read16b(f);	/* ?!? */
 
 	mask <<= 1;	/* no instrument #0 */
 
 	/* obtain number of samples */
-	pos = ftell(f);
+	pos = hio_tell(f);
 	num_smp = 0;
 	{
 		int _len, _type, _mask = mask;
@@ -493,23 +490,23 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 
 			if (~_mask & 0x80000000)
 				continue;
-			read16b(f);
-			_len = read16b(f);
-			_type = (int16)read16b(f);
+			hio_read16b(f);
+			_len = hio_read16b(f);
+			_type = (int16)hio_read16b(f);
 
-			_pos = ftell(f);
+			_pos = hio_tell(f);
 
 			if (_type == 0 || _type == -2) {
 				num_smp++;
 			} else if (_type == -1) {
-				fseek(f, 20, SEEK_CUR);
-				num_smp += read16b(f);
+				hio_seek(f, 20, SEEK_CUR);
+				num_smp += hio_read16b(f);
 			}
 
-			fseek(f, _pos + _len, SEEK_SET);
+			hio_seek(f, _pos + _len, SEEK_SET);
 		}
 	}
-	fseek(f, pos, SEEK_SET);
+	hio_seek(f, pos, SEEK_SET);
 
 	mod->smp = num_smp;
 
@@ -525,9 +522,9 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 		if (~mask & 0x80000000)
 			continue;
 
-		x1 = read16b(f);
-		length = read16b(f);
-		type = (int16)read16b(f);	/* instrument type */
+		x1 = hio_read16b(f);
+		length = hio_read16b(f);
+		type = (int16)hio_read16b(f);	/* instrument type */
 
 		strncpy((char *)mod->xxi[i].name, temp_inst[i].name, 32);
 
@@ -539,31 +536,33 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 
 		if (type == -2) {			/* Hybrid */
 			int length, type;
-			int pos = ftell(f);
-
-			read32b(f);	/* ? - MSH 00 */
-			read16b(f);	/* ? - ffff */
-			read16b(f);	/* ? - 0000 */
-			read16b(f);	/* ? - 0000 */
-			synth.rep = read16b(f);		/* ? */
-			synth.replen = read16b(f);	/* ? */
-			synth.voltbllen = read16b(f);
-			synth.wftbllen = read16b(f);
-			synth.volspeed = read8(f);
-			synth.wfspeed = read8(f);
-			synth.wforms = read16b(f);
-			fread(synth.voltbl, 1, synth.voltbllen, f);;
-			fread(synth.wftbl, 1, synth.wftbllen, f);;
-
-			fseek(f,  pos + read32b(f), SEEK_SET);
-			length = read32b(f);
-			type = read16b(f);
-
-			mod->xxi[i].extra = malloc(sizeof (struct med_extras));
+			int pos = hio_tell(f);
+
+			hio_read32b(f);	/* ? - MSH 00 */
+			hio_read16b(f);	/* ? - ffff */
+			hio_read16b(f);	/* ? - 0000 */
+			hio_read16b(f);	/* ? - 0000 */
+			synth.rep = hio_read16b(f);		/* ? */
+			synth.replen = hio_read16b(f);	/* ? */
+			synth.voltbllen = hio_read16b(f);
+			synth.wftbllen = hio_read16b(f);
+			synth.volspeed = hio_read8(f);
+			synth.wfspeed = hio_read8(f);
+			synth.wforms = hio_read16b(f);
+			hio_read(synth.voltbl, 1, synth.voltbllen, f);;
+			hio_read(synth.wftbl, 1, synth.wftbllen, f);;
+
+			hio_seek(f,  pos + hio_read32b(f), SEEK_SET);
+			length = hio_read32b(f);
+			type = hio_read16b(f);
+
+			mod->xxi[i].extra = arena_malloc(&m->arena,
+						sizeof (struct med_extras));
 			if (mod->xxi[i].extra == NULL)
 				return -1;
 
-			mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+			mod->xxi[i].sub = arena_calloc(&m->arena,
+						sizeof (struct xmp_subinstrument), 1);
 			if (mod->xxi[i].sub == NULL)
 				return -1;
 
@@ -587,37 +586,39 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 				       mod->xxi[i].sub[0].xpo /*,
 				       mod->xxi[i].sub[0].fin >> 4*/);
 
-			load_sample(f, 0, &mod->xxs[smp_idx], NULL);
+			load_sample(m, f, 0, &mod->xxs[smp_idx], NULL);
 
 			smp_idx++;
 
-			m->med_vol_table[i] = calloc(1, synth.voltbllen);
+			m->med_vol_table[i] = arena_calloc(&m->arena,
+						1, synth.voltbllen);
 			memcpy(m->med_vol_table[i], synth.voltbl, synth.voltbllen);
 
-			m->med_wav_table[i] = calloc(1, synth.wftbllen);
+			m->med_wav_table[i] = arena_calloc(&m->arena,
+						1, synth.wftbllen);
 			memcpy(m->med_wav_table[i], synth.wftbl, synth.wftbllen);
 
 			continue;
 		}
 
 		if (type == -1) {		/* Synthetic */
-			int pos = ftell(f);
-
-			read32b(f);	/* ? - MSH 00 */
-			read16b(f);	/* ? - ffff */
-			read16b(f);	/* ? - 0000 */
-			read16b(f);	/* ? - 0000 */
-			synth.rep = read16b(f);		/* ? */
-			synth.replen = read16b(f);	/* ? */
-			synth.voltbllen = read16b(f);
-			synth.wftbllen = read16b(f);
-			synth.volspeed = read8(f);
-			synth.wfspeed = read8(f);
-			synth.wforms = read16b(f);
-			fread(synth.voltbl, 1, synth.voltbllen, f);;
-			fread(synth.wftbl, 1, synth.wftbllen, f);;
+			int pos = hio_tell(f);
+
+			hio_read32b(f);	/* ? - MSH 00 */
+			hio_read16b(f);	/* ? - ffff */
+			hio_read16b(f);	/* ? - 0000 */
+			hio_read16b(f);	/* ? - 0000 */
+			synth.rep = hio_read16b(f);		/* ? */
+			synth.replen = hio_read16b(f);	/* ? */
+			synth.voltbllen = hio_read16b(f);
+			synth.wftbllen = hio_read16b(f);
+			synth.volspeed = hio_read8(f);
+			synth.wfspeed = hio_read8(f);
+			synth.wforms = hio_read16b(f);
+			hio_read(synth.voltbl, 1, synth.voltbllen, f);;
+			hio_read(synth.wftbl, 1, synth.wftbllen, f);;
 			for (j = 0; j < synth.wforms; j++)
-				synth.wf[j] = read32b(f);
+				synth.wf[j] = hio_read32b(f);
 
 			D_(D_INFO "  VS:%02x WS:%02x WF:%02x %02x %+03d",
 					synth.volspeed, synth.wfspeed,
@@ -629,11 +630,13 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 			if (synth.wforms == 0xffff)	
 				continue;
 
-			mod->xxi[i].extra = malloc(sizeof (struct med_extras));
+			mod->xxi[i].extra = arena_malloc(&m->arena,
+						sizeof (struct med_extras));
 			if (mod->xxi[i].extra == NULL)
 				return -1;
 
-			mod->xxi[i].sub = calloc(sizeof(struct xmp_subinstrument),
+			mod->xxi[i].sub = arena_calloc(&m->arena,
+						sizeof(struct xmp_subinstrument),
 							synth.wforms);
 			if (mod->xxi[i].sub == NULL)
 				return -1;
@@ -649,38 +652,41 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 				mod->xxi[i].sub[j].sid = smp_idx;
 				mod->xxi[i].sub[j].fin = 0 /*exp_smp.finetune*/;
 
-				fseek(f, pos + synth.wf[j], SEEK_SET);
-/*printf("pos=%lx tell=%lx ", pos, ftell(f));*/
+				hio_seek(f, pos + synth.wf[j], SEEK_SET);
+/*printf("pos=%lx tell=%lx ", pos, hio_tell(f));*/
 
-				mod->xxs[smp_idx].len = read16b(f) * 2;
+				mod->xxs[smp_idx].len = hio_read16b(f) * 2;
 /*printf("idx=%x len=%x\n", synth.wf[j], mod->xxs[smp_idx].len);*/
 				mod->xxs[smp_idx].lps = 0;
 				mod->xxs[smp_idx].lpe = mod->xxs[smp_idx].len;
 				mod->xxs[smp_idx].flg = XMP_SAMPLE_LOOP;
 
-				load_sample(f,
+				load_sample(m, f,
 					0, &mod->xxs[smp_idx], NULL);
 
 				smp_idx++;
 			}
 
-			m->med_vol_table[i] = calloc(1, synth.voltbllen);
+			m->med_vol_table[i] = arena_calloc(&m->arena,
+						1, synth.voltbllen);
 			memcpy(m->med_vol_table[i], synth.voltbl, synth.voltbllen);
 
-			m->med_wav_table[i] = calloc(1, synth.wftbllen);
+			m->med_wav_table[i] = arena_calloc(&m->arena,
+						1, synth.wftbllen);
 			memcpy(m->med_wav_table[i], synth.wftbl, synth.wftbllen);
 
-			fseek(f, pos + length, SEEK_SET);
+			hio_seek(f, pos + length, SEEK_SET);
 			continue;
 		}
 
 		if (type != 0) {
-			fseek(f, length, SEEK_CUR);
+			hio_seek(f, length, SEEK_CUR);
 			continue;
 		}
 
                 /* instr type is sample */
-		mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+		mod->xxi[i].sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), 1);
                 mod->xxi[i].nsm = 1;
 		
 		mod->xxi[i].sub[0].vol = temp_inst[i].volume;
@@ -700,36 +706,36 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 			mod->xxs[smp_idx].flg & XMP_SAMPLE_LOOP ? 'L' : ' ',
 			mod->xxi[i].sub[0].vol, mod->xxi[i].sub[0].xpo);
 
-		load_sample(f, 0,
+		load_sample(m, f, 0,
 				  &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 
 		smp_idx++;
 	}
 
-	read16b(f);	/* unknown */
+	hio_read16b(f);	/* unknown */
 
 	/* IFF-like section */
-	while (!feof(f)) {
+	while (!hio_eof(f)) {
 		int32 id, size, s2, pos, ver;
 
-		if ((id = read32b(f)) < 0)
+		if ((id = hio_read32b(f)) < 0)
 			break;
 
-		if ((size = read32b(f)) < 0)
+		if ((size = hio_read32b(f)) < 0)
 			break;
 
-		pos = ftell(f);
+		pos = hio_tell(f);
 
 		switch (id) {
 		case MAGIC4('M','E','D','V'):
-			ver = read32b(f);
+			ver = hio_read32b(f);
 			D_(D_INFO "MED Version: %d.%0d\n",
 					(ver & 0xff00) >> 8, ver & 0xff);
 			break;
 		case MAGIC4('A','N','N','O'):
 			/* annotation */
 			s2 = size < 1023 ? size : 1023;
-			fread(buf, 1, s2, f);
+			hio_read(buf, 1, s2, f);
 			buf[s2] = 0;
 			D_(D_INFO "Annotation: %s\n", buf);
 			break;
@@ -738,7 +744,7 @@ static int med4_load(struct module_data *m, FILE *f, const int start)
 			break;
 		}
 
-		fseek(f, pos + size, SEEK_SET);
+		hio_seek(f, pos + size, SEEK_SET);
 	}
 
 	return 0;
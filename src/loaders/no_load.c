@@ -14,8 +14,8 @@
  */
 
 
-static int no_test (FILE *, char *, const int);
-static int no_load (struct module_data *, FILE *, const int);
+static int no_test (HIO_HANDLE *, char *, const int);
+static int no_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader no_loader = {
 	"Liquid Tracker NO (LIQ)",
@@ -23,12 +23,12 @@ const struct format_loader no_loader = {
 	no_load
 };
 
-static int no_test(FILE *f, char *t, const int start)
+static int no_test(HIO_HANDLE *f, char *t, const int start)
 {
-	if (read32b(f) != 0x4e4f0000)		/* NO 0x00 0x00 */
+	if (hio_read32b(f) != 0x4e4f0000)		/* NO 0x00 0x00 */
 		return -1;
 
-	read_title(f, t, read8(f));
+	read_title(f, t, hio_read8(f));
 
 	return 0;
 }
@@ -53,7 +53,7 @@ static const uint8 fx[] = {
 };
 
 
-static int no_load(struct module_data *m, FILE *f, const int start)
+static int no_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct xmp_module *mod = &m->mod;
 	struct xmp_event *event;
@@ -62,39 +62,39 @@ static int no_load(struct module_data *m, FILE *f, const int start)
 
 	LOAD_INIT();
 
-	read32b(f);			/* NO 0x00 0x00 */
+	hio_read32b(f);			/* NO 0x00 0x00 */
 
 	set_type(m, "Liquid Tracker");
 
-	nsize = read8(f);
+	nsize = hio_read8(f);
 	for (i = 0; i < nsize; i++) {
-		uint8 x = read8(f);
+		uint8 x = hio_read8(f);
 		if (i < XMP_NAME_SIZE)
 			mod->name[i] = x;
 	}
 
-	read16l(f);
-	read16l(f);
-	read16l(f);
-	read16l(f);
-	read8(f);
-	mod->pat = read8(f);
-	read8(f);
-	mod->chn = read8(f);
+	hio_read16l(f);
+	hio_read16l(f);
+	hio_read16l(f);
+	hio_read16l(f);
+	hio_read8(f);
+	mod->pat = hio_read8(f);
+	hio_read8(f);
+	mod->chn = hio_read8(f);
 	mod->trk = mod->pat * mod->chn;
-	read8(f);
-	read16l(f);
-	read16l(f);
-	read8(f);
+	hio_read8(f);
+	hio_read16l(f);
+	hio_read16l(f);
+	hio_read8(f);
 	mod->ins = mod->smp = 63;
 
 	for (i = 0; i < 256; i++) {
-		uint8 x = read8(f);
+		uint8 x = hio_read8(f);
 		if (x == 0xff)
 			break;
 		mod->xxo[i] = x;
 	}
-	fseek(f, 255 - i, SEEK_CUR);
+	hio_seek(f, 255 - i, SEEK_CUR);
 	mod->len = i;
 
 	MODULE_INFO();
@@ -105,12 +105,13 @@ static int no_load(struct module_data *m, FILE *f, const int start)
 	for (i = 0; i < mod->ins; i++) {
 		int hasname, c2spd;
 
-		mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+		mod->xxi[i].sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), 1);
 
-		nsize = read8(f);
+		nsize = hio_read8(f);
 		hasname = 0;
 		for (j = 0; j < nsize; j++) {
-			uint8 x = read8(f);
+			uint8 x = hio_read8(f);
 			if (x != 0x20)
 				hasname = 1;
 			if (j < 32)
@@ -119,15 +120,15 @@ static int no_load(struct module_data *m, FILE *f, const int start)
 		if (!hasname)
 			mod->xxi[i].name[0] = 0;
 
-		read32l(f);
-		read32l(f);
-		mod->xxi[i].sub[0].vol = read8(f);
-		c2spd = read16l(f);
-		mod->xxs[i].len = read16l(f);
-		mod->xxs[i].lps = read16l(f);
-		mod->xxs[i].lpe = read16l(f);
-		read32l(f);
-		read16l(f);
+		hio_read32l(f);
+		hio_read32l(f);
+		mod->xxi[i].sub[0].vol = hio_read8(f);
+		c2spd = hio_read16l(f);
+		mod->xxs[i].len = hio_read16l(f);
+		mod->xxs[i].lps = hio_read16l(f);
+		mod->xxs[i].lpe = hio_read16l(f);
+		hio_read32l(f);
+		hio_read16l(f);
 
 		mod->xxi[i].nsm = !!(mod->xxs[i].len);
 		mod->xxs[i].lps = 0;
@@ -153,7 +154,7 @@ static int no_load(struct module_data *m, FILE *f, const int start)
 	D_(D_INFO "Stored patterns: %d ", mod->pat);
 
 	for (i = 0; i < mod->pat; i++) {
-//printf("%d  %x\n", i, ftell(f));
+//printf("%d  %x\n", i, hio_tell(f));
 		PATTERN_ALLOC(i);
 		mod->xxp[i]->rows = 64;
 		TRACK_ALLOC(i);
@@ -164,7 +165,7 @@ static int no_load(struct module_data *m, FILE *f, const int start)
 
 				event = &EVENT (i, k, j);
 
-				x = read32l(f);
+				x = hio_read32l(f);
 				note = x & 0x0000003f;
 				ins = (x & 0x00001fc0) >> 6;
 				vol = (x & 0x000fe000) >> 13;
@@ -191,7 +192,7 @@ static int no_load(struct module_data *m, FILE *f, const int start)
 	for (i = 0; i < mod->ins; i++) {
 		if (mod->xxs[i].len == 0)
 			continue;
-		load_sample(f, SAMPLE_FLAG_UNS, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
+		load_sample(m, f, SAMPLE_FLAG_UNS, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 	}
 
 	m->quirk |= QUIRKS_ST3;
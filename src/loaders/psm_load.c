@@ -12,8 +12,8 @@
 #define MAGIC_PSM_	MAGIC4('P','S','M',0xfe)
 
 
-static int psm_test (FILE *, char *, const int);
-static int psm_load (struct module_data *, FILE *, const int);
+static int psm_test (HIO_HANDLE *, char *, const int);
+static int psm_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader psm_loader = {
 	"Protracker Studio (PSM)",
@@ -21,9 +21,9 @@ const struct format_loader psm_loader = {
 	psm_load
 };
 
-static int psm_test(FILE *f, char *t, const int start)
+static int psm_test(HIO_HANDLE *f, char *t, const int start)
 {
-	if (read32b(f) != MAGIC_PSM_)
+	if (hio_read32b(f) != MAGIC_PSM_)
 		return -1;
 
 	read_title(f, t, 60);
@@ -34,7 +34,7 @@ static int psm_test(FILE *f, char *t, const int start)
 
 /* FIXME: effects translation */
 
-static int psm_load(struct module_data *m, FILE *f, const int start)
+static int psm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct xmp_module *mod = &m->mod;
 	int c, r, i;
@@ -46,71 +46,72 @@ static int psm_load(struct module_data *m, FILE *f, const int start)
  
 	LOAD_INIT();
 
-	read32b(f);
+	hio_read32b(f);
 
-	fread(buf, 1, 60, f);
+	hio_read(buf, 1, 60, f);
 	strncpy(mod->name, (char *)buf, XMP_NAME_SIZE);
 
-	type = read8(f);	/* song type */
-	ver = read8(f);		/* song version */
-	mode = read8(f);	/* pattern version */
+	type = hio_read8(f);	/* song type */
+	ver = hio_read8(f);		/* song version */
+	mode = hio_read8(f);	/* pattern version */
 
 	if (type & 0x01)	/* song mode not supported */
 		return -1;
 
 	set_type(m, "Protracker Studio PSM %d.%02d", MSN(ver), LSN(ver));
 
-	mod->spd = read8(f);
-	mod->bpm = read8(f);
-	read8(f);		/* master volume */
-	read16l(f);		/* song length */
-	mod->len = read16l(f);
-	mod->pat = read16l(f);
-	mod->ins = read16l(f);
-	mod->chn = read16l(f);
-	read16l(f);		/* channels used */
+	mod->spd = hio_read8(f);
+	mod->bpm = hio_read8(f);
+	hio_read8(f);		/* master volume */
+	hio_read16l(f);		/* song length */
+	mod->len = hio_read16l(f);
+	mod->pat = hio_read16l(f);
+	mod->ins = hio_read16l(f);
+	mod->chn = hio_read16l(f);
+	hio_read16l(f);		/* channels used */
 	mod->smp = mod->ins;
 	mod->trk = mod->pat * mod->chn;
 
-	p_ord = read32l(f);
-	p_chn = read32l(f);
-	p_pat = read32l(f);
-	p_ins = read32l(f);
+	p_ord = hio_read32l(f);
+	p_chn = hio_read32l(f);
+	p_pat = hio_read32l(f);
+	p_ins = hio_read32l(f);
 
 	/* should be this way but fails with Silverball song 6 */
 	//mod->flg |= ~type & 0x02 ? XXM_FLG_MODRNG : 0;
 
 	MODULE_INFO();
 
-	fseek(f, start + p_ord, SEEK_SET);
-	fread(mod->xxo, 1, mod->len, f);
+	hio_seek(f, start + p_ord, SEEK_SET);
+	hio_read(mod->xxo, 1, mod->len, f);
 
-	fseek(f, start + p_chn, SEEK_SET);
-	fread(buf, 1, 16, f);
+	hio_seek(f, start + p_chn, SEEK_SET);
+	hio_read(buf, 1, 16, f);
 
 	INSTRUMENT_INIT();
 
-	fseek(f, start + p_ins, SEEK_SET);
+	hio_seek(f, start + p_ins, SEEK_SET);
 	for (i = 0; i < mod->ins; i++) {
 		uint16 flags, c2spd;
 		int finetune;
 
-		mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+		mod->xxi[i].sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), 1);
 
-		fread(buf, 1, 13, f);		/* sample filename */
-		fread(buf, 1, 24, f);		/* sample description */
+		hio_read(buf, 1, 13, f);		/* sample filename */
+		hio_read(buf, 1, 24, f);		/* sample description */
 		strncpy((char *)mod->xxi[i].name, (char *)buf, 24);
 		str_adj((char *)mod->xxi[i].name);
-		p_smp[i] = read32l(f);
-		read32l(f);			/* memory location */
-		read16l(f);			/* sample number */
-		flags = read8(f);		/* sample type */
-		mod->xxs[i].len = read32l(f); 
-		mod->xxs[i].lps = read32l(f);
-		mod->xxs[i].lpe = read32l(f);
-		finetune = (int8)(read8(f) << 4);
-		mod->xxi[i].sub[0].vol = read8(f);
-		c2spd = 8363 * read16l(f) / 8448;
+		p_smp[i] = hio_read32l(f);
+		hio_read32l(f);			/* memory location */
+		hio_read16l(f);			/* sample number */
+		flags = hio_read8(f);		/* sample type */
+		mod->xxs[i].len = hio_read32l(f); 
+		mod->xxs[i].lps = hio_read32l(f);
+		mod->xxs[i].lpe = hio_read32l(f);
+		finetune = (int8)(hio_read8(f) << 4);
+		mod->xxi[i].sub[0].vol = hio_read8(f);
+		c2spd = 8363 * hio_read16l(f) / 8448;
 		mod->xxi[i].sub[0].pan = 0x80;
 		mod->xxi[i].sub[0].sid = i;
 		mod->xxi[i].nsm = !!mod->xxs[i].len;
@@ -130,14 +131,14 @@ static int psm_load(struct module_data *m, FILE *f, const int start)
 
 	D_(D_INFO "Stored patterns: %d", mod->pat);
 
-	fseek(f, start + p_pat, SEEK_SET);
+	hio_seek(f, start + p_pat, SEEK_SET);
 	for (i = 0; i < mod->pat; i++) {
 		int len;
 		uint8 b, rows, chan;
 
-		len = read16l(f) - 4;
-		rows = read8(f);
-		chan = read8(f);
+		len = hio_read16l(f) - 4;
+		rows = hio_read8(f);
+		chan = hio_read8(f);
 
 		PATTERN_ALLOC (i);
 		mod->xxp[i]->rows = rows;
@@ -145,7 +146,7 @@ static int psm_load(struct module_data *m, FILE *f, const int start)
 
 		for (r = 0; r < rows; r++) {
 			while (len > 0) {
-				b = read8(f);
+				b = hio_read8(f);
 				len--;
 
 				if (b == 0)
@@ -155,19 +156,19 @@ static int psm_load(struct module_data *m, FILE *f, const int start)
 				event = &EVENT(i, c, r);
 	
 				if (b & 0x80) {
-					event->note = read8(f) + 36 + 1;
-					event->ins = read8(f);
+					event->note = hio_read8(f) + 36 + 1;
+					event->ins = hio_read8(f);
 					len -= 2;
 				}
 	
 				if (b & 0x40) {
-					event->vol = read8(f) + 1;
+					event->vol = hio_read8(f) + 1;
 					len--;
 				}
 	
 				if (b & 0x20) {
-					event->fxt = read8(f);
-					event->fxp = read8(f);
+					event->fxt = hio_read8(f);
+					event->fxp = hio_read8(f);
 					len -= 2;
 /* printf("p%d r%d c%d: %02x %02x\n", i, r, c, event->fxt, event->fxp); */
 				}
@@ -175,7 +176,7 @@ static int psm_load(struct module_data *m, FILE *f, const int start)
 		}
 
 		if (len > 0)
-			fseek(f, len, SEEK_CUR);
+			hio_seek(f, len, SEEK_CUR);
 	}
 
 	/* Read samples */
@@ -183,8 +184,8 @@ static int psm_load(struct module_data *m, FILE *f, const int start)
 	D_(D_INFO "Stored samples: %d", mod->smp);
 
 	for (i = 0; i < mod->ins; i++) {
-		fseek(f, start + p_smp[i], SEEK_SET);
-		load_sample(f, SAMPLE_FLAG_DIFF, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
+		hio_seek(f, start + p_smp[i], SEEK_SET);
+		load_sample(m, f, SAMPLE_FLAG_DIFF, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 	}
 
 	return 0;
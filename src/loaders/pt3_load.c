@@ -16,9 +16,9 @@
 #define MAGIC_VERS	MAGIC4('V','E','R','S')
 #define MAGIC_INFO	MAGIC4('I','N','F','O')
 
-static int pt3_test(FILE *, char *, const int);
-static int pt3_load(struct module_data *, FILE *, const int);
-static int ptdt_load(struct module_data *, FILE *, const int);
+static int pt3_test(HIO_HANDLE *, char *, const int);
+static int pt3_load(struct module_data *, HIO_HANDLE *, const int);
+static int ptdt_load(struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader pt3_loader = {
 	"Protracker 3",
@@ -26,25 +26,25 @@ const struct format_loader pt3_loader = {
 	pt3_load
 };
 
-static int pt3_test(FILE *f, char *t, const int start)
+static int pt3_test(HIO_HANDLE *f, char *t, const int start)
 {
-	if (read32b(f) != MAGIC_FORM)
+	if (hio_read32b(f) != MAGIC_FORM)
 		return -1;
 
-	read32b(f);	/* skip size */
+	hio_read32b(f);	/* skip size */
 
-	if (read32b(f) != MAGIC_MODL)
+	if (hio_read32b(f) != MAGIC_MODL)
 		return -1;
 
-	if (read32b(f) != MAGIC_VERS)
+	if (hio_read32b(f) != MAGIC_VERS)
 		return -1;
 
-	read32b(f);	/* skip size */
+	hio_read32b(f);	/* skip size */
 
-	fseek(f, 10, SEEK_CUR);
+	hio_seek(f, 10, SEEK_CUR);
 	
-	if (read32b(f) == MAGIC_INFO) {
-		read32b(f);	/* skip size */
+	if (hio_read32b(f) == MAGIC_INFO) {
+		hio_read32b(f);	/* skip size */
 		read_title(f, t, 32);
 	} else {
 		read_title(f, t, 0);
@@ -63,29 +63,29 @@ static int pt3_test(FILE *f, char *t, const int start)
 #define PT3_FLAG_RAWPAT	0x0080	/* Packed patterns if not set */
 
 
-static void get_info(struct module_data *m, int size, FILE *f, void *parm)
+static void get_info(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	struct xmp_module *mod = &m->mod;
 	int flags;
 	int day, month, year, hour, min, sec;
 	int dhour, dmin, dsec;
 
-	fread(mod->name, 1, 32, f);
-	mod->ins = read16b(f);
-	mod->len = read16b(f);
-	mod->pat = read16b(f);
-	mod->gvl = read16b(f);
-	mod->bpm = read16b(f);
-	flags = read16b(f);
-	day   = read16b(f);
-	month = read16b(f);
-	year  = read16b(f);
-	hour  = read16b(f);
-	min   = read16b(f);
-	sec   = read16b(f);
-	dhour = read16b(f);
-	dmin  = read16b(f);
-	dsec  = read16b(f);
+	hio_read(mod->name, 1, 32, f);
+	mod->ins = hio_read16b(f);
+	mod->len = hio_read16b(f);
+	mod->pat = hio_read16b(f);
+	mod->gvl = hio_read16b(f);
+	mod->bpm = hio_read16b(f);
+	flags = hio_read16b(f);
+	day   = hio_read16b(f);
+	month = hio_read16b(f);
+	year  = hio_read16b(f);
+	hour  = hio_read16b(f);
+	min   = hio_read16b(f);
+	sec   = hio_read16b(f);
+	dhour = hio_read16b(f);
+	dmin  = hio_read16b(f);
+	dsec  = hio_read16b(f);
 
 	MODULE_INFO();
 
@@ -94,31 +94,31 @@ static void get_info(struct module_data *m, int size, FILE *f, void *parm)
 	D_(D_INFO "Playing time: %02d:%02d:%02d", dhour, dmin, dsec);
 }
 
-static void get_cmnt(struct module_data *m, int size, FILE *f, void *parm)
+static void get_cmnt(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	D_(D_INFO "Comment size: %d", size);
 }
 
-static void get_ptdt(struct module_data *m, int size, FILE *f, void *parm)
+static void get_ptdt(struct module_data *m, int size, HIO_HANDLE *f, void *parm)
 {
 	ptdt_load(m, f, 0);
 }
 
-static int pt3_load(struct module_data *m, FILE *f, const int start)
+static int pt3_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	iff_handle handle;
 	char buf[20];
 
 	LOAD_INIT();
 
-	read32b(f);		/* FORM */
-	read32b(f);		/* size */
-	read32b(f);		/* MODL */
+	hio_read32b(f);		/* FORM */
+	hio_read32b(f);		/* size */
+	hio_read32b(f);		/* MODL */
 
-	read32b(f);		/* VERS */
-	read32b(f);		/* VERS size */
+	hio_read32b(f);		/* VERS */
+	hio_read32b(f);		/* VERS size */
 
-	fread(buf, 1, 10, f);
+	hio_read(buf, 1, 10, f);
 	set_type(m, "%-6.6s IFFMODL", buf + 4);
 
 	handle = iff_new();
@@ -133,7 +133,7 @@ static int pt3_load(struct module_data *m, FILE *f, const int start)
 	iff_set_quirk(handle, IFF_FULL_CHUNK_SIZE);
 
 	/* Load IFF chunks */
-	while (!feof(f))
+	while (!hio_eof(f))
 		iff_chunk(handle, m, f, NULL);
 
 	iff_release(handle);
@@ -141,7 +141,7 @@ static int pt3_load(struct module_data *m, FILE *f, const int start)
 	return 0;
 }
 
-static int ptdt_load(struct module_data *m, FILE *f, const int start)
+static int ptdt_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct xmp_module *mod = &m->mod;
 	int i, j;
@@ -149,19 +149,19 @@ static int ptdt_load(struct module_data *m, FILE *f, const int start)
 	struct mod_header mh;
 	uint8 mod_event[4];
 
-	fread(&mh.name, 20, 1, f);
+	hio_read(&mh.name, 20, 1, f);
 	for (i = 0; i < 31; i++) {
-		fread(&mh.ins[i].name, 22, 1, f);
-		mh.ins[i].size = read16b(f);
-		mh.ins[i].finetune = read8(f);
-		mh.ins[i].volume = read8(f);
-		mh.ins[i].loop_start = read16b(f);
-		mh.ins[i].loop_size = read16b(f);
+		hio_read(&mh.ins[i].name, 22, 1, f);
+		mh.ins[i].size = hio_read16b(f);
+		mh.ins[i].finetune = hio_read8(f);
+		mh.ins[i].volume = hio_read8(f);
+		mh.ins[i].loop_start = hio_read16b(f);
+		mh.ins[i].loop_size = hio_read16b(f);
 	}
-	mh.len = read8(f);
-	mh.restart = read8(f);
-	fread(&mh.order, 128, 1, f);
-	fread(&mh.magic, 4, 1, f);
+	mh.len = hio_read8(f);
+	mh.restart = hio_read8(f);
+	hio_read(&mh.order, 128, 1, f);
+	hio_read(&mh.magic, 4, 1, f);
 
 	mod->ins = 31;
 	mod->smp = mod->ins;
@@ -181,7 +181,8 @@ static int ptdt_load(struct module_data *m, FILE *f, const int start)
 	INSTRUMENT_INIT();
 
 	for (i = 0; i < mod->ins; i++) {
-		mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+		mod->xxi[i].sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), 1);
 		mod->xxs[i].len = 2 * mh.ins[i].size;
 		mod->xxs[i].lps = 2 * mh.ins[i].loop_start;
 		mod->xxs[i].lpe = mod->xxs[i].lps + 2 * mh.ins[i].loop_size;
@@ -215,7 +216,7 @@ static int ptdt_load(struct module_data *m, FILE *f, const int start)
 		TRACK_ALLOC(i);
 		for (j = 0; j < (64 * 4); j++) {
 			event = &EVENT(i, j % 4, j / 4);
-			fread(mod_event, 1, 4, f);
+			hio_read(mod_event, 1, 4, f);
 			cvt_pt_event(event, mod_event);
 		}
 	}
@@ -228,7 +229,7 @@ static int ptdt_load(struct module_data *m, FILE *f, const int start)
 	for (i = 0; i < mod->smp; i++) {
 		if (!mod->xxs[i].len)
 			continue;
-		load_sample(f, 0, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
+		load_sample(m, f, 0, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 	}
 
 	return 0;
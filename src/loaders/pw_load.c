@@ -19,8 +19,8 @@
 
 extern struct list_head *checked_format;
 
-static int pw_test(FILE *, char *, const int);
-static int pw_load(struct module_data *, FILE *, const int);
+static int pw_test(HIO_HANDLE *, char *, const int);
+static int pw_load(struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader pw_loader = {
 	"prowizard",
@@ -30,7 +30,7 @@ const struct format_loader pw_loader = {
 
 #define BUF_SIZE 0x10000
 
-int pw_test_format(FILE *f, char *t, const int start,
+int pw_test_format(HIO_HANDLE *f, char *t, const int start,
 		   struct xmp_test_info *info)
 {
 	unsigned char *b;
@@ -38,7 +38,7 @@ int pw_test_format(FILE *f, char *t, const int start,
 	int s = BUF_SIZE;
 
 	b = calloc(1, BUF_SIZE);
-	fread(b, s, 1, f);
+	hio_read(b, s, 1, f);
 
 	while ((extra = pw_check(b, s, info)) > 0) {
 		unsigned char *buf = realloc(b, s + extra);
@@ -47,7 +47,7 @@ int pw_test_format(FILE *f, char *t, const int start,
 			return -1;
 		}
 		b = buf;
-		fread(b + s, extra, 1, f);
+		hio_read(b + s, extra, 1, f);
 		s += extra;
 	}
 
@@ -56,12 +56,12 @@ int pw_test_format(FILE *f, char *t, const int start,
 	return extra == 0 ? 0 : -1;
 }
 
-static int pw_test(FILE *f, char *t, const int start)
+static int pw_test(HIO_HANDLE *f, char *t, const int start)
 {
 	return pw_test_format(f, t, start, NULL);
 }
 
-static int pw_load(struct module_data *m, FILE *f, const int start)
+static int pw_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct xmp_module *mod = &m->mod;
 	struct xmp_event *event;
@@ -82,7 +82,7 @@ static int pw_load(struct module_data *m, FILE *f, const int start)
 	if ((fd = mkstemp(tmp)) < 0)
 		return -1;
 
-	if (pw_wizardry(fileno(f), fd, &name) < 0) {
+	if (pw_wizardry(fileno(f->file), fd, &name) < 0) {
 		close(fd);
 		unlink(tmp);
 		return -1;
@@ -99,19 +99,19 @@ static int pw_load(struct module_data *m, FILE *f, const int start)
 
 	LOAD_INIT();
 
-	fread(&mh.name, 20, 1, f);
+	hio_read(&mh.name, 20, 1, f);
 	for (i = 0; i < 31; i++) {
-		fread(&mh.ins[i].name, 22, 1, f);
-		mh.ins[i].size = read16b(f);
-		mh.ins[i].finetune = read8(f);
-		mh.ins[i].volume = read8(f);
-		mh.ins[i].loop_start = read16b(f);
-		mh.ins[i].loop_size = read16b(f);
+		hio_read(&mh.ins[i].name, 22, 1, f);
+		mh.ins[i].size = hio_read16b(f);
+		mh.ins[i].finetune = hio_read8(f);
+		mh.ins[i].volume = hio_read8(f);
+		mh.ins[i].loop_start = hio_read16b(f);
+		mh.ins[i].loop_size = hio_read16b(f);
 	}
-	mh.len = read8(f);
-	mh.restart = read8(f);
-	fread(&mh.order, 128, 1, f);
-	fread(&mh.magic, 4, 1, f);
+	mh.len = hio_read8(f);
+	mh.restart = hio_read8(f);
+	hio_read(&mh.order, 128, 1, f);
+	hio_read(&mh.magic, 4, 1, f);
 
 	if (memcmp(mh.magic, "M.K.", 4))
 		goto err;
@@ -141,7 +141,8 @@ static int pw_load(struct module_data *m, FILE *f, const int start)
 	INSTRUMENT_INIT();
 
 	for (i = 0; i < mod->ins; i++) {
-		mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+		mod->xxi[i].sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), 1);
 		mod->xxs[i].len = 2 * mh.ins[i].size;
 		mod->xxs[i].lps = 2 * mh.ins[i].loop_start;
 		mod->xxs[i].lpe = mod->xxs[i].lps + 2 * mh.ins[i].loop_size;
@@ -174,7 +175,7 @@ static int pw_load(struct module_data *m, FILE *f, const int start)
 		TRACK_ALLOC(i);
 		for (j = 0; j < (64 * 4); j++) {
 			event = &EVENT(i, j % 4, j / 4);
-			fread(mod_event, 1, 4, f);
+			hio_read(mod_event, 1, 4, f);
 			cvt_pt_event(event, mod_event);
 		}
 	}
@@ -185,15 +186,15 @@ static int pw_load(struct module_data *m, FILE *f, const int start)
 
 	D_(D_INFO "Stored samples: %d", mod->smp);
 	for (i = 0; i < mod->smp; i++) {
-		load_sample(f, 0, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
+		load_sample(m, f, 0, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 	}
 
-	fclose(f);
+	hio_close(f);
 	unlink(tmp);
 	return 0;
 
 err:
-	fclose(f);
+	hio_close(f);
 	unlink(tmp);
 	return -1;
 }
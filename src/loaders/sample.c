@@ -190,83 +190,200 @@ static void unroll_loop(struct xmp_sample *xxs)
 }
 
 
-int load_sample(FILE *f, int flags, struct xmp_sample *xxs, void *buffer)
+/* Add the extra samples around the sample start, end and loop end used
+ * for interpolation
+ */
+static void add_guard_samples(struct xmp_sample *xxs, int bytelen,
+			      int unroll_extralen)
 {
-	int bytelen, extralen, unroll_extralen, i;
+	int i;
 
-	/* Synth patches
-	 * Default is YM3128 for historical reasons
-	 */
-	if (flags & SAMPLE_FLAG_SYNTH) {
-		int size = 11;	/* Adlib instrument size */
+	/* Add extra samples at end */
+	if (xxs->flg & XMP_SAMPLE_16BIT) {
+		for (i = 0; i < 8; i++) {
+			xxs->data[bytelen + i] = xxs->data[bytelen - 2 + i];
+		}
+	} else {
+		for (i = 0; i < 4; i++) {
+			xxs->data[bytelen + i] = xxs->data[bytelen - 1 + i];
+		}
+	}
 
-		if (flags & SAMPLE_FLAG_SPECTRUM) {
-			size = sizeof(struct spectrum_sample);
-		} else if (flags & SAMPLE_FLAG_HSC) {
-			convert_hsc_to_sbi(buffer);
+	/* Add extra samples at start */
+	if (xxs->flg & XMP_SAMPLE_16BIT) {
+		xxs->data[-2] = xxs->data[0];
+		xxs->data[-1] = xxs->data[1];
+	} else {
+		xxs->data[-1] = xxs->data[0];
+	}
+
+	/* Fix sample at loop */
+	if (xxs->flg & XMP_SAMPLE_LOOP) {
+		if (xxs->flg & XMP_SAMPLE_16BIT) {
+			int lpe = xxs->lpe * 2 + unroll_extralen;
+			int lps = xxs->lps * 2;
+			xxs->data[lpe] = xxs->data[lpe - 2];
+			xxs->data[lpe + 1] = xxs->data[lpe - 1];
+			for (i = 0; i < 6; i++) {
+				xxs->data[lpe + 2 + i] = xxs->data[lps + i];
+			}
+		} else {
+			int lpe = xxs->lpe + unroll_extralen;
+			int lps = xxs->lps;
+			xxs->data[lpe] = xxs->data[lpe - 1];
+			for (i = 0; i < 3; i++) {
+				xxs->data[lpe + 1 + i] = xxs->data[lps + i];
+			}
 		}
+	}
+}
 
-		if ((xxs->data = malloc(size + 4)) == NULL)
-			return -1;
-		*(uint32 *)xxs->data = 0;
-		xxs->data += 4;
+/* Use sample data in place if it's stored in a shared memory stream in
+ * native format. The mixer adds the guard samples that would be written
+ * around the sample end and loop points.
+ */
+static int map_sample(HIO_HANDLE *f, int flags, struct xmp_sample *xxs,
+		      int bytelen)
+{
+	const uint8 *data;
+	long pos;
 
-		memcpy(xxs->data, buffer, size);
+	if (flags & (SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_CONVERT |
+						SAMPLE_FLAG_FULLREP)) {
+		return -1;
+	}
 
-		xxs->flg |= XMP_SAMPLE_SYNTH;
-		xxs->len = size;
+	if (xxs->flg & XMP_SAMPLE_LOOP_BIDIR)
+		return -1;
 
-		return 0;
+	pos = hio_tell(f);
+	if (pos < 0 || pos + bytelen > f->size)
+		return -1;
+
+	data = f->start + pos;
+
+	if (xxs->flg & XMP_SAMPLE_16BIT) {
+		if (is_big_endian() ^ ((flags & SAMPLE_FLAG_BIGEND) != 0))
+			return -1;
+		if ((size_t)data & 1)
+			return -1;
 	}
 
-	/* Empty samples
-	 */
-	if (xxs->len == 0) {
-		return 0;
+	if (bytelen >= 5 && !memcmp(data, "ADPCM", 5))
+		return -1;
+
+	xxs->data = (uint8 *)data;
+	hio_seek(f, pos + bytelen, SEEK_SET);
+
+	return 0;
+}
+
+/* Leave the sample data out when loading only the module metadata. The
+ * file position is moved past the data, and the length and loop changes
+ * made by the conversions are kept.
+ */
+static void skip_sample(HIO_HANDLE *f, int flags, struct xmp_sample *xxs,
+			int bytelen)
+{
+	if (~flags & SAMPLE_FLAG_NOLOAD) {
+		uint8 buf[5];
+		long pos = hio_tell(f);
+
+		if (hio_read(buf, 1, 5, f) == 5 && !memcmp(buf, "ADPCM", 5))
+			bytelen = 5 + 16 + (bytelen >> 1);
+		hio_seek(f, pos + bytelen, SEEK_SET);
 	}
 
-	/* Loop parameters sanity check
-	 */
-	if (xxs->lpe > xxs->len) {
-		xxs->lpe = xxs->len;
+	if (flags & SAMPLE_FLAG_STEREO) {
+		xxs->len /= 2;
 	}
-	if (xxs->lps >= xxs->len || xxs->lps >= xxs->lpe) {
-		xxs->lps = xxs->lpe = 0;
-		xxs->flg &= ~(XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
+
+	if (flags & SAMPLE_FLAG_FULLREP) {
+	    if (xxs->lps == 0 && xxs->len > xxs->lpe)
+		xxs->flg |= XMP_SAMPLE_LOOP_FULL;
 	}
 
-	/* Patches with samples
-	 * Allocate extra sample for interpolation.
-	 */
-	bytelen = xxs->len;
-	extralen = 4;
-	unroll_extralen = 0;
+	xxs->data = NULL;
+}
+
+/* Size in bytes of the sample data and of the unrolled part of a
+ * bidirectional loop
+ */
+static void sample_size(struct xmp_sample *xxs, int *bytelen,
+			int *unroll_extralen)
+{
+	*bytelen = xxs->len;
+	*unroll_extralen = 0;
 
-	/* Disable birectional loop flag if sample is not looped
-	 */
-	if (xxs->flg & XMP_SAMPLE_LOOP_BIDIR) {
-		if (~xxs->flg & XMP_SAMPLE_LOOP)
-			xxs->flg &= ~XMP_SAMPLE_LOOP_BIDIR;
-	}
-	/* Unroll bidirectional loops
-	 */
 	if (xxs->flg & XMP_SAMPLE_LOOP_BIDIR) {
-		unroll_extralen = (xxs->lpe - xxs->lps) -
+		*unroll_extralen = (xxs->lpe - xxs->lps) -
 				(xxs->len - xxs->lpe);
 
-		if (unroll_extralen < 0) {
-			unroll_extralen = 0;
+		if (*unroll_extralen < 0) {
+			*unroll_extralen = 0;
 		}
 	}
 
 	if (xxs->flg & XMP_SAMPLE_16BIT) {
-		bytelen *= 2;
-		extralen *= 2;
-		unroll_extralen *= 2;
+		*bytelen *= 2;
+		*unroll_extralen *= 2;
+	}
+}
+
+/* Leave the sample data in the module file until the sample is played.
+ * The file position and conversion flags are recorded, and the length
+ * and loop changes made by the conversions are applied now.
+ */
+static int defer_sample(struct module_data *m, HIO_HANDLE *f, int flags,
+			struct xmp_sample *xxs, int bytelen)
+{
+	struct xmp_module *mod = &m->mod;
+	struct lazy_sample *ls;
+	int smp;
+
+	if (flags & SAMPLE_FLAG_NOLOAD)
+		return -1;
+
+	/* Only samples in the module sample list can be found later */
+	if (mod->xxs == NULL || xxs < mod->xxs || xxs >= mod->xxs + mod->smp)
+		return -1;
+	smp = xxs - mod->xxs;
+
+	if (m->lazy == NULL) {
+		m->lazy = arena_calloc(&m->arena, mod->smp,
+					sizeof (struct lazy_sample));
+		if (m->lazy == NULL)
+			return -1;
+		m->lazy_num = mod->smp;
 	}
 
+	if (smp >= m->lazy_num)
+		return -1;
+
+	ls = &m->lazy[smp];
+	ls->offset = hio_tell(f);
+	ls->flags = flags;
+	ls->len = xxs->len;
+	ls->pending = 1;
+
+	skip_sample(f, flags, xxs, bytelen);
+
+	return 0;
+}
+
+/* Read the sample data and convert it to the format used by the mixer */
+static int read_sample(struct module_data *m, HIO_HANDLE *f, int flags,
+		       struct xmp_sample *xxs, void *buffer)
+{
+	int bytelen, extralen, unroll_extralen;
+
+	sample_size(xxs, &bytelen, &unroll_extralen);
+	extralen = xxs->flg & XMP_SAMPLE_16BIT ? 8 : 4;
+
 	/* add guard bytes before the buffer for higher order interpolation */
-	if ((xxs->data = malloc(bytelen + extralen + unroll_extralen + 4)) == NULL)
+	xxs->data = arena_malloc(&m->arena,
+			bytelen + extralen + unroll_extralen + 4);
+	if (xxs->data == NULL)
 		return -1;
 	*(uint32 *)xxs->data = 0;
 	xxs->data += 4;
@@ -275,22 +392,22 @@ int load_sample(FILE *f, int flags, struct xmp_sample *xxs, void *buffer)
 		memcpy(xxs->data, buffer, bytelen);
 	} else {
 		uint8 buf[5];
-		int pos = ftell(f);
-		int num = fread(buf, 1, 5, f);
+		int pos = hio_tell(f);
+		int num = hio_read(buf, 1, 5, f);
 
-		fseek(f, pos, SEEK_SET);
+		hio_seek(f, pos, SEEK_SET);
 
 		if (num == 5 && !memcmp(buf, "ADPCM", 5)) {
 			int x2 = bytelen >> 1;
 			char table[16];
 
-			fseek(f, 5, SEEK_CUR);	/* Skip "ADPCM" */
-			fread(table, 1, 16, f);
-			fread(xxs->data + x2, 1, x2, f);
+			hio_seek(f, 5, SEEK_CUR);	/* Skip "ADPCM" */
+			hio_read(table, 1, 16, f);
+			hio_read(xxs->data + x2, 1, x2, f);
 			adpcm4_decoder((uint8 *)xxs->data + x2,
 				       (uint8 *)xxs->data, table, bytelen);
 		} else {
-			int x = fread(xxs->data, 1, bytelen, f);
+			int x = hio_read(xxs->data, 1, bytelen, f);
 			if (x != bytelen) {
 				fprintf(stderr, "libxmp: short read (%d) in "
 					"sample load\n", x - bytelen);
@@ -348,45 +465,158 @@ int load_sample(FILE *f, int flags, struct xmp_sample *xxs, void *buffer)
 		unroll_loop(xxs);
 		bytelen += unroll_extralen;
 	}
-	
-	/* Add extra samples at end */
-	if (xxs->flg & XMP_SAMPLE_16BIT) {
-		for (i = 0; i < 8; i++) {
-			xxs->data[bytelen + i] = xxs->data[bytelen - 2 + i];
-		}
-	} else {
-		for (i = 0; i < 4; i++) {
-			xxs->data[bytelen + i] = xxs->data[bytelen - 1 + i];
+
+	add_guard_samples(xxs, bytelen, unroll_extralen);
+
+	return 0;
+}
+
+int load_sample(struct module_data *m, HIO_HANDLE *f, int flags,
+		struct xmp_sample *xxs, void *buffer)
+{
+	int bytelen, unroll_extralen;
+
+	/* Synth patches
+	 * Default is YM3128 for historical reasons
+	 */
+	if (flags & SAMPLE_FLAG_SYNTH) {
+		int size = 11;	/* Adlib instrument size */
+
+		if (flags & SAMPLE_FLAG_SPECTRUM) {
+			size = sizeof(struct spectrum_sample);
+		} else if (flags & SAMPLE_FLAG_HSC) {
+			convert_hsc_to_sbi(buffer);
 		}
+
+		if ((xxs->data = arena_malloc(&m->arena, size + 4)) == NULL)
+			return -1;
+		*(uint32 *)xxs->data = 0;
+		xxs->data += 4;
+
+		memcpy(xxs->data, buffer, size);
+
+		xxs->flg |= XMP_SAMPLE_SYNTH;
+		xxs->len = size;
+
+		return 0;
 	}
 
-	/* Add extra samples at start */
-	if (xxs->flg & XMP_SAMPLE_16BIT) {
-		xxs->data[-2] = xxs->data[0];
-		xxs->data[-1] = xxs->data[1];
-	} else {
-		xxs->data[-1] = xxs->data[0];
+	/* Empty samples
+	 */
+	if (xxs->len == 0) {
+		return 0;
 	}
 
-	/* Fix sample at loop */
-	if (xxs->flg & XMP_SAMPLE_LOOP) {
-		if (xxs->flg & XMP_SAMPLE_16BIT) {
-			int lpe = xxs->lpe * 2 + unroll_extralen;
-			int lps = xxs->lps * 2;
-			xxs->data[lpe] = xxs->data[lpe - 2];
-			xxs->data[lpe + 1] = xxs->data[lpe - 1];
-			for (i = 0; i < 6; i++) {
-				xxs->data[lpe + 2 + i] = xxs->data[lps + i];
-			}
-		} else {
-			int lpe = xxs->lpe + unroll_extralen;
-			int lps = xxs->lps;
-			xxs->data[lpe] = xxs->data[lpe - 1];
-			for (i = 0; i < 3; i++) {
-				xxs->data[lpe + 1 + i] = xxs->data[lps + i];
-			}
-		}
+	/* Loop parameters sanity check
+	 */
+	if (xxs->lpe > xxs->len) {
+		xxs->lpe = xxs->len;
+	}
+	if (xxs->lps >= xxs->len || xxs->lps >= xxs->lpe) {
+		xxs->lps = xxs->lpe = 0;
+		xxs->flg &= ~(XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
+	}
+
+	/* Disable birectional loop flag if sample is not looped
+	 */
+	if (xxs->flg & XMP_SAMPLE_LOOP_BIDIR) {
+		if (~xxs->flg & XMP_SAMPLE_LOOP)
+			xxs->flg &= ~XMP_SAMPLE_LOOP_BIDIR;
+	}
+
+	sample_size(xxs, &bytelen, &unroll_extralen);
+
+	if (m->nodata) {
+		skip_sample(f, flags, xxs, bytelen);
+		return 0;
+	}
+
+	/* Samples in shared handles are mapped, unless the handle is only
+	 * shared to load samples later
+	 */
+	if (f != NULL && f->flags & HIO_FLAG_SHARE) {
+		int lazy = m->smpctl & XMP_SMPCTL_LAZY;
+
+		if ((!lazy || m->smpctl & XMP_SMPCTL_MAP) &&
+		    map_sample(f, flags, xxs, bytelen) == 0)
+			return 0;
+		if (lazy && defer_sample(m, f, flags, xxs, bytelen) == 0)
+			return 0;
+	}
+
+	return read_sample(m, f, flags, xxs, buffer);
+}
+
+/* Load the data of a sample left in the module file. Samples that can't
+ * be loaded are made empty.
+ */
+int load_lazy_sample(struct module_data *m, int smp)
+{
+	struct xmp_sample *xxs = &m->mod.xxs[smp];
+	struct lazy_sample *ls;
+
+	if (m->lazy == NULL || smp >= m->lazy_num || !m->lazy[smp].pending)
+		return 0;
+
+	ls = &m->lazy[smp];
+	ls->pending = 0;
+
+	/* Stereo samples are downmixed from the length in the file */
+	if (ls->flags & SAMPLE_FLAG_STEREO)
+		xxs->len = ls->len;
+	hio_seek(m->map, ls->offset, SEEK_SET);
+
+	if (read_sample(m, m->map, ls->flags, xxs, NULL) < 0) {
+		xxs->data = NULL;
+		xxs->len = xxs->lps = xxs->lpe = 0;
+		xxs->flg &= ~(XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
+		return -1;
 	}
 
 	return 0;
 }
+
+/* Load all samples left in the module file, before the sample list is
+ * used by more than one player
+ */
+void load_lazy_samples(struct module_data *m)
+{
+	int i;
+
+	for (i = 0; i < m->lazy_num; i++) {
+		load_lazy_sample(m, i);
+	}
+}
+
+/* Copy loaded sample data to a buffer allocated with malloc(), for players
+ * that change sample data while playing. Loaded data may be shared with
+ * other players or mapped from the module file, so it's never changed.
+ */
+uint8 *copy_sample(struct xmp_sample *xxs)
+{
+	struct xmp_sample copy;
+	int bytelen, unroll_extralen;
+	uint8 *data;
+
+	sample_size(xxs, &bytelen, &unroll_extralen);
+	bytelen += unroll_extralen;
+
+	/* guard bytes before the data and up to four samples after it */
+	if ((data = malloc(4 + bytelen + 8)) == NULL)
+		return NULL;
+	*(uint32 *)data = 0;
+	data += 4;
+
+	memcpy(data, xxs->data, bytelen);
+
+	copy = *xxs;
+	copy.data = data;
+	add_guard_samples(&copy, bytelen, unroll_extralen);
+
+	return data;
+}
+
+void free_sample(uint8 *data)
+{
+	free(data - 4);
+}
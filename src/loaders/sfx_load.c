@@ -22,8 +22,8 @@
 #define MAGIC_SONG	MAGIC4('S','O','N','G')
 
 
-static int sfx_test (FILE *, char *, const int);
-static int sfx_load (struct module_data *, FILE *, const int);
+static int sfx_test (HIO_HANDLE *, char *, const int);
+static int sfx_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader sfx_loader = {
     "SoundFX",
@@ -31,14 +31,14 @@ const struct format_loader sfx_loader = {
     sfx_load
 };
 
-static int sfx_test(FILE *f, char *t, const int start)
+static int sfx_test(HIO_HANDLE *f, char *t, const int start)
 {
     uint32 a, b;
 
-    fseek(f, 4 * 15, SEEK_CUR);
-    a = read32b(f);
-    fseek(f, 4 * 15, SEEK_CUR);
-    b = read32b(f);
+    hio_seek(f, 4 * 15, SEEK_CUR);
+    a = hio_read32b(f);
+    hio_seek(f, 4 * 15, SEEK_CUR);
+    b = hio_read32b(f);
 
     if (a != MAGIC_SONG && b != MAGIC_SONG)
 	return -1;
@@ -71,7 +71,7 @@ struct sfx_header2 {
 };
 
 
-static int sfx_13_20_load(struct module_data *m, FILE *f, const int nins, const int start)
+static int sfx_13_20_load(struct module_data *m, HIO_HANDLE *f, const int nins, const int start)
 {
     struct xmp_module *mod = &m->mod;
     int i, j;
@@ -85,11 +85,11 @@ static int sfx_13_20_load(struct module_data *m, FILE *f, const int nins, const
     LOAD_INIT();
 
     for (i = 0; i < nins; i++)
-	ins_size[i] = read32b(f);
+	ins_size[i] = hio_read32b(f);
 
-    sfx.magic = read32b(f);
-    sfx.delay = read16b(f);
-    fread(&sfx.unknown, 14, 1, f);
+    sfx.magic = hio_read32b(f);
+    sfx.delay = hio_read16b(f);
+    hio_read(&sfx.unknown, 14, 1, f);
 
     if (sfx.magic != MAGIC_SONG)
 	return -1;
@@ -99,17 +99,17 @@ static int sfx_13_20_load(struct module_data *m, FILE *f, const int nins, const
     mod->bpm = 14565 * 122 / sfx.delay;
 
     for (i = 0; i < mod->ins; i++) {
-	fread(&ins[i].name, 22, 1, f);
-	ins[i].len = read16b(f);
-	ins[i].finetune = read8(f);
-	ins[i].volume = read8(f);
-	ins[i].loop_start = read16b(f);
-	ins[i].loop_length = read16b(f);
+	hio_read(&ins[i].name, 22, 1, f);
+	ins[i].len = hio_read16b(f);
+	ins[i].finetune = hio_read8(f);
+	ins[i].volume = hio_read8(f);
+	ins[i].loop_start = hio_read16b(f);
+	ins[i].loop_length = hio_read16b(f);
     }
 
-    sfx2.len = read8(f);
-    sfx2.restart = read8(f);
-    fread(&sfx2.order, 128, 1, f);
+    sfx2.len = hio_read8(f);
+    sfx2.restart = hio_read8(f);
+    hio_read(&sfx2.order, 128, 1, f);
 
     mod->len = sfx2.len;
     if (mod->len > 0x7f)
@@ -134,7 +134,8 @@ static int sfx_13_20_load(struct module_data *m, FILE *f, const int nins, const
     INSTRUMENT_INIT();
 
     for (i = 0; i < mod->ins; i++) {
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 	mod->xxi[i].nsm = !!(mod->xxs[i].len = ins_size[i]);
 	mod->xxs[i].lps = ins[i].loop_start;
 	mod->xxs[i].lpe = mod->xxs[i].lps + 2 * ins[i].loop_length;
@@ -163,7 +164,7 @@ static int sfx_13_20_load(struct module_data *m, FILE *f, const int nins, const
 
 	for (j = 0; j < 64 * mod->chn; j++) {
 	    event = &EVENT(i, j % mod->chn, j / mod->chn);
-	    fread(ev, 1, 4, f);
+	    hio_read(ev, 1, 4, f);
 
 	    event->note = period_to_note((LSN (ev[0]) << 8) | ev[1]);
 	    event->ins = (MSN (ev[0]) << 4) | MSN (ev[2]);
@@ -209,14 +210,14 @@ static int sfx_13_20_load(struct module_data *m, FILE *f, const int nins, const
     for (i = 0; i < mod->ins; i++) {
 	if (mod->xxs[i].len <= 2)
 	    continue;
-	load_sample(f, 0, &mod->xxs[i], NULL);
+	load_sample(m, f, 0, &mod->xxs[i], NULL);
     }
 
     return 0;
 }
 
 
-static int sfx_load(struct module_data *m, FILE *f, const int start)
+static int sfx_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
     if (sfx_13_20_load(m, f, 15, start) < 0)
 	return sfx_13_20_load(m, f, 31, start);
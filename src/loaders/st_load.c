@@ -17,8 +17,8 @@
 #include "mod.h"
 #include "period.h"
 
-static int st_test (FILE *, char *, const int);
-static int st_load (struct module_data *, FILE *, const int);
+static int st_test (HIO_HANDLE *, char *, const int);
+static int st_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader st_loader = {
     "Soundtracker (MOD)",
@@ -33,36 +33,36 @@ static const int period[] = {
     -1
 };
 
-static int st_test(FILE *f, char *t, const int start)
+static int st_test(HIO_HANDLE *f, char *t, const int start)
 {
     int i, j, k;
     int pat, smp_size;
     struct st_header mh;
     uint8 mod_event[4];
 
-    int64_t size = fsize(f);
+    int64_t size = hio_size(f);
 
     if (size < 600)
 	return -1;
 
     smp_size = 0;
 
-    fseek(f, start, SEEK_SET);
-    fread(mh.name, 1, 20, f);
+    hio_seek(f, start, SEEK_SET);
+    hio_read(mh.name, 1, 20, f);
     if (test_name(mh.name, 20) < 0)
 	return -1;
 
     for (i = 0; i < 15; i++) {
-	fread(mh.ins[i].name, 1, 22, f);
-	mh.ins[i].size = read16b(f);
-	mh.ins[i].finetune = read8(f);
-	mh.ins[i].volume = read8(f);
-	mh.ins[i].loop_start = read16b(f);
-	mh.ins[i].loop_size = read16b(f);
+	hio_read(mh.ins[i].name, 1, 22, f);
+	mh.ins[i].size = hio_read16b(f);
+	mh.ins[i].finetune = hio_read8(f);
+	mh.ins[i].volume = hio_read8(f);
+	mh.ins[i].loop_start = hio_read16b(f);
+	mh.ins[i].loop_size = hio_read16b(f);
     }
-    mh.len = read8(f);
-    mh.restart = read8(f);
-    fread(mh.order, 1, 128, f);
+    mh.len = hio_read8(f);
+    mh.restart = hio_read8(f);
+    hio_read(mh.order, 1, 128, f);
 	
     for (pat = i = 0; i < 128; i++) {
 	if (mh.order[i] > 0x7f)
@@ -122,7 +122,7 @@ static int st_test(FILE *f, char *t, const int start)
 	for (j = 0; j < (64 * 4); j++) {
 	    int p;
 	
-	    fread (mod_event, 1, 4, f);
+	    hio_read(mod_event, 1, 4, f);
 
 	    if (MSN(mod_event[0]))	/* sample number > 15 */
 		return -1;
@@ -144,13 +144,13 @@ static int st_test(FILE *f, char *t, const int start)
 	}
     }
 
-    fseek(f, start, SEEK_SET);
+    hio_seek(f, start, SEEK_SET);
     read_title(f, t, 20);
 
     return 0;
 }
 
-static int st_load(struct module_data *m, FILE *f, const int start)
+static int st_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
     struct xmp_module *mod = &m->mod;
     int i, j;
@@ -170,18 +170,18 @@ static int st_load(struct module_data *m, FILE *f, const int start)
     mod->smp = mod->ins;
     smp_size = 0;
 
-    fread(mh.name, 1, 20, f);
+    hio_read(mh.name, 1, 20, f);
     for (i = 0; i < 15; i++) {
-	fread(mh.ins[i].name, 1, 22, f);
-	mh.ins[i].size = read16b(f);
-	mh.ins[i].finetune = read8(f);
-	mh.ins[i].volume = read8(f);
-	mh.ins[i].loop_start = read16b(f);
-	mh.ins[i].loop_size = read16b(f);
+	hio_read(mh.ins[i].name, 1, 22, f);
+	mh.ins[i].size = hio_read16b(f);
+	mh.ins[i].finetune = hio_read8(f);
+	mh.ins[i].volume = hio_read8(f);
+	mh.ins[i].loop_start = hio_read16b(f);
+	mh.ins[i].loop_size = hio_read16b(f);
     }
-    mh.len = read8(f);
-    mh.restart = read8(f);
-    fread(mh.order, 1, 128, f);
+    mh.len = hio_read8(f);
+    mh.restart = hio_read8(f);
+    hio_read(mh.order, 1, 128, f);
 	
     mod->len = mh.len;
     mod->rst = mh.restart;
@@ -223,7 +223,8 @@ static int st_load(struct module_data *m, FILE *f, const int start)
     INSTRUMENT_INIT();
 
     for (i = 0; i < mod->ins; i++) {
-	mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+	mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 	mod->xxs[i].len = 2 * mh.ins[i].size;
 	mod->xxs[i].lps = mh.ins[i].loop_start;
 	mod->xxs[i].lpe = mod->xxs[i].lps + 2 * mh.ins[i].loop_size;
@@ -243,11 +244,11 @@ static int st_load(struct module_data *m, FILE *f, const int start)
 
     /* Scan patterns for tracker detection */
     fxused = 0;
-    pos = ftell(f);
+    pos = hio_tell(f);
 
     for (i = 0; i < mod->pat; i++) {
 	for (j = 0; j < (64 * mod->chn); j++) {
-	    fread (mod_event, 1, 4, f);
+	    hio_read(mod_event, 1, 4, f);
 
 	    cvt_pt_event (&ev, mod_event);
 
@@ -297,7 +298,7 @@ static int st_load(struct module_data *m, FILE *f, const int start)
 	D_(D_CRIT "File size error: %d", serr);
     }
 
-    fseek(f, start + pos, SEEK_SET);
+    hio_seek(f, start + pos, SEEK_SET);
 
     PATTERN_INIT();
 
@@ -311,7 +312,7 @@ static int st_load(struct module_data *m, FILE *f, const int start)
 	TRACK_ALLOC (i);
 	for (j = 0; j < (64 * mod->chn); j++) {
 	    event = &EVENT (i, j % mod->chn, j / mod->chn);
-	    fread (mod_event, 1, 4, f);
+	    hio_read(mod_event, 1, 4, f);
 
 	    cvt_pt_event(event, mod_event);
 	}
@@ -361,7 +362,7 @@ static int st_load(struct module_data *m, FILE *f, const int start)
     for (i = 0; i < mod->smp; i++) {
 	if (!mod->xxs[i].len)
 	    continue;
-	load_sample(f, SAMPLE_FLAG_FULLREP,
+	load_sample(m, f, SAMPLE_FLAG_FULLREP,
 			&mod->xxs[mod->xxi[i].sub[0].sid], NULL);
     }
 
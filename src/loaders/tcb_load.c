@@ -17,8 +17,8 @@
 #include "loader.h"
 
 
-static int tcb_test(FILE *, char *, const int);
-static int tcb_load (struct module_data *, FILE *, const int);
+static int tcb_test(HIO_HANDLE *, char *, const int);
+static int tcb_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader tcb_loader = {
 	"TCB Tracker",
@@ -26,11 +26,11 @@ const struct format_loader tcb_loader = {
 	tcb_load
 };
 
-static int tcb_test(FILE *f, char *t, const int start)
+static int tcb_test(HIO_HANDLE *f, char *t, const int start)
 {
 	uint8 buffer[10];
 
-	if (fread(buffer, 1, 8, f) < 8)
+	if (hio_read(buffer, 1, 8, f) < 8)
 		return -1;
 	if (memcmp(buffer, "AN COOL.", 8) && memcmp(buffer, "AN COOL!", 8))
 		return -1;
@@ -40,7 +40,7 @@ static int tcb_test(FILE *f, char *t, const int start)
 	return 0;
 }
 
-static int tcb_load(struct module_data *m, FILE *f, const int start)
+static int tcb_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
 	struct xmp_module *mod = &m->mod;
 	struct xmp_event *event;
@@ -51,12 +51,12 @@ static int tcb_load(struct module_data *m, FILE *f, const int start)
 
 	LOAD_INIT();
 
-	fread(buffer, 8, 1, f);
+	hio_read(buffer, 8, 1, f);
 
 	set_type(m, "TCB Tracker", buffer);
 
-	read16b(f);	/* ? */
-	mod->pat = read16b(f);
+	hio_read16b(f);	/* ? */
+	mod->pat = hio_read16b(f);
 	mod->ins = 16;
 	mod->smp = mod->ins;
 	mod->chn = 4;
@@ -64,14 +64,14 @@ static int tcb_load(struct module_data *m, FILE *f, const int start)
 
 	m->quirk |= QUIRK_MODRNG;
 
-	read16b(f);	/* ? */
+	hio_read16b(f);	/* ? */
 
 	for (i = 0; i < 128; i++)
-		mod->xxo[i] = read8(f);
+		mod->xxo[i] = hio_read8(f);
 
-	mod->len = read8(f);
-	read8(f);	/* ? */
-	read16b(f);	/* ? */
+	mod->len = hio_read8(f);
+	hio_read8(f);	/* ? */
+	hio_read16b(f);	/* ? */
 
 	MODULE_INFO();
 
@@ -79,18 +79,19 @@ static int tcb_load(struct module_data *m, FILE *f, const int start)
 
 	/* Read instrument names */
 	for (i = 0; i < mod->ins; i++) {
-		mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
-		fread(buffer, 8, 1, f);
+		mod->xxi[i].sub = arena_calloc(&m->arena,
+					sizeof (struct xmp_subinstrument), 1);
+		hio_read(buffer, 8, 1, f);
 		copy_adjust(mod->xxi[i].name, buffer, 8);
 	}
 
-	read16b(f);	/* ? */
+	hio_read16b(f);	/* ? */
 	for (i = 0; i < 5; i++)
-		read16b(f);
+		hio_read16b(f);
 	for (i = 0; i < 5; i++)
-		read16b(f);
+		hio_read16b(f);
 	for (i = 0; i < 5; i++)
-		read16b(f);
+		hio_read16b(f);
 
 	PATTERN_INIT();
 
@@ -107,12 +108,12 @@ static int tcb_load(struct module_data *m, FILE *f, const int start)
 				int b;
 				event = &EVENT (i, k, j);
 
-				b = read8(f);
+				b = hio_read8(f);
 				if (b) {
 					event->note = 12 * (b >> 4);
 					event->note += (b & 0xf) + 36;
 				}
-				b = read8(f);
+				b = hio_read8(f);
 				event->ins = b >> 4;
 				if (event->ins)
 					event->ins += 1;
@@ -130,29 +131,29 @@ static int tcb_load(struct module_data *m, FILE *f, const int start)
 		}
 	}
 
-	base_offs = ftell(f);
-	read32b(f);	/* remaining size */
+	base_offs = hio_tell(f);
+	hio_read32b(f);	/* remaining size */
 
 	/* Read instrument data */
 
 	for (i = 0; i < mod->ins; i++) {
-		mod->xxi[i].sub[0].vol = read8(f) / 2;
+		mod->xxi[i].sub[0].vol = hio_read8(f) / 2;
 		mod->xxi[i].sub[0].pan = 0x80;
-		unk1[i] = read8(f);
-		unk2[i] = read8(f);
-		unk3[i] = read8(f);
+		unk1[i] = hio_read8(f);
+		unk2[i] = hio_read8(f);
+		unk3[i] = hio_read8(f);
 	}
 
 
 	for (i = 0; i < mod->ins; i++) {
-		soffs[i] = read32b(f);
-		mod->xxs[i].len = read32b(f);
+		soffs[i] = hio_read32b(f);
+		mod->xxs[i].len = hio_read32b(f);
 	}
 
-	read32b(f);
-	read32b(f);
-	read32b(f);
-	read32b(f);
+	hio_read32b(f);
+	hio_read32b(f);
+	hio_read32b(f);
+	hio_read32b(f);
 
 	for (i = 0; i < mod->ins; i++) {
 		mod->xxi[i].nsm = !!(mod->xxs[i].len);
@@ -176,8 +177,8 @@ static int tcb_load(struct module_data *m, FILE *f, const int start)
 	D_(D_INFO "Stored samples: %d", mod->smp);
 
 	for (i = 0; i < mod->ins; i++) {
-		fseek(f, start + base_offs + soffs[i], SEEK_SET);
-		load_sample(f, SAMPLE_FLAG_UNS, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
+		hio_seek(f, start + base_offs + soffs[i], SEEK_SET);
+		load_sample(m, f, SAMPLE_FLAG_UNS, &mod->xxs[mod->xxi[i].sub[0].sid], NULL);
 	}
 
 	return 0;
@@ -24,8 +24,8 @@
 
 #define MAX_SAMP 1024
 
-static int xm_test (FILE *, char *, const int);
-static int xm_load (struct module_data *, FILE *, const int);
+static int xm_test (HIO_HANDLE *, char *, const int);
+static int xm_load (struct module_data *, HIO_HANDLE *, const int);
 
 const struct format_loader xm_loader = {
     "Fast Tracker II (XM)",
@@ -33,11 +33,11 @@ const struct format_loader xm_loader = {
     xm_load
 };
 
-static int xm_test(FILE *f, char *t, const int start)
+static int xm_test(HIO_HANDLE *f, char *t, const int start)
 {
     char buf[20];
 
-    if (fread(buf, 1, 17, f) < 17)		/* ID text */
+    if (hio_read(buf, 1, 17, f) < 17)		/* ID text */
 	return -1;
 
     if (memcmp(buf, "Extended Module: ", 17))
@@ -48,7 +48,7 @@ static int xm_test(FILE *f, char *t, const int start)
     return 0;
 }
 
-static int xm_load(struct module_data *m, FILE *f, const int start)
+static int xm_load(struct module_data *m, HIO_HANDLE *f, const int start)
 {
     struct xmp_module *mod = &m->mod;
     int i, j, r;
@@ -64,23 +64,23 @@ static int xm_load(struct module_data *m, FILE *f, const int start)
 
     LOAD_INIT();
 
-    fread(&xfh.id, 17, 1, f);		/* ID text */
-    fread(&xfh.name, 20, 1, f);		/* Module name */
-    read8(f);				/* 0x1a */
-    fread(&xfh.tracker, 20, 1, f);	/* Tracker name */
-    xfh.version = read16l(f);		/* Version number, minor-major */
-    xfh.headersz = read32l(f);		/* Header size */
-    xfh.songlen = read16l(f);		/* Song length */
-    xfh.restart = read16l(f);		/* Restart position */
-    xfh.channels = read16l(f);		/* Number of channels */
-    xfh.patterns = read16l(f);		/* Number of patterns */
-    xfh.instruments = read16l(f);	/* Number of instruments */
-    xfh.flags = read16l(f);		/* 0=Amiga freq table, 1=Linear */
-    xfh.tempo = read16l(f);		/* Default tempo */
-    xfh.bpm = read16l(f);		/* Default BPM */
+    hio_read(&xfh.id, 17, 1, f);		/* ID text */
+    hio_read(&xfh.name, 20, 1, f);		/* Module name */
+    hio_read8(f);				/* 0x1a */
+    hio_read(&xfh.tracker, 20, 1, f);	/* Tracker name */
+    xfh.version = hio_read16l(f);		/* Version number, minor-major */
+    xfh.headersz = hio_read32l(f);		/* Header size */
+    xfh.songlen = hio_read16l(f);		/* Song length */
+    xfh.restart = hio_read16l(f);		/* Restart position */
+    xfh.channels = hio_read16l(f);		/* Number of channels */
+    xfh.patterns = hio_read16l(f);		/* Number of patterns */
+    xfh.instruments = hio_read16l(f);	/* Number of instruments */
+    xfh.flags = hio_read16l(f);		/* 0=Amiga freq table, 1=Linear */
+    xfh.tempo = hio_read16l(f);		/* Default tempo */
+    xfh.bpm = hio_read16l(f);		/* Default BPM */
 
     /* Honor header size -- needed by BoobieSqueezer XMs */
-    fread(&xfh.order, xfh.headersz - 0x14, 1, f); /* Pattern order table */
+    hio_read(&xfh.order, xfh.headersz - 0x14, 1, f); /* Pattern order table */
 
     strncpy(mod->name, (char *)xfh.name, 20);
 
@@ -126,7 +126,7 @@ static int xm_load(struct module_data *m, FILE *f, const int start)
 
     /* Honor header size */
 
-    fseek(f, start + xfh.headersz + 60, SEEK_SET);
+    hio_seek(f, start + xfh.headersz + 60, SEEK_SET);
 
     /* XM 1.02/1.03 has a different structure. This is a hack to re-order
      * the loader and recognize 1.02 files correctly.
@@ -143,10 +143,10 @@ load_patterns:
      * Mon, 04 Jan 1999 11:17:20 +0100
      */
     for (i = 0; i < mod->pat; i++) {
-	xph.length = read32l(f);
-	xph.packing = read8(f);
-	xph.rows = xfh.version > 0x0102 ? read16l(f) : read8(f) + 1;
-	xph.datasize = read16l(f);
+	xph.length = hio_read32l(f);
+	xph.packing = hio_read8(f);
+	xph.rows = xfh.version > 0x0102 ? hio_read16l(f) : hio_read8(f) + 1;
+	xph.datasize = hio_read16l(f);
 
 	PATTERN_ALLOC(i);
 	if (!(r = mod->xxp[i]->rows = xph.rows))
@@ -155,7 +155,7 @@ load_patterns:
 
 	if (xph.datasize) {
 	    pat = patbuf = calloc(1, xph.datasize);
-	    fread (patbuf, 1, xph.datasize, f);
+	    hio_read(patbuf, 1, xph.datasize, f);
 	    for (j = 0; j < (mod->chn * r); j++) {
 		if ((pat - patbuf) >= xph.datasize)
 		    break;
@@ -255,7 +255,8 @@ load_patterns:
     PATTERN_ALLOC(i);
 
     mod->xxp[i]->rows = 64;
-    mod->xxt[i * mod->chn] = calloc (1, sizeof (struct xmp_track) +
+    mod->xxt[i * mod->chn] = arena_calloc(&m->track_arena,
+    			1, sizeof (struct xmp_track) +
 	sizeof (struct xmp_event) * 64);
     mod->xxt[i * mod->chn]->rows = 64;
     for (j = 0; j < mod->chn; j++)
@@ -276,21 +277,21 @@ load_instruments:
 
     for (i = 0; i < mod->ins; i++) {
 
-	xih.size = read32l(f);			/* Instrument size */
+	xih.size = hio_read32l(f);			/* Instrument size */
 
 	/* Modules converted with MOD2XM 1.0 always say we have 31
 	 * instruments, but file may end abruptly before that. This test
 	 * will not work if file has trailing garbage.
 	 */
-	if (feof(f)) {
+	if (hio_eof(f)) {
 		mod->ins = i;
 		break;
 	}
 
-	fread(&xih.name, 22, 1, f);		/* Instrument name */
-	xih.type = read8(f);			/* Instrument type (always 0) */
-	xih.samples = read16l(f);		/* Number of samples */
-	xih.sh_size = read32l(f);		/* Sample header size */
+	hio_read(&xih.name, 22, 1, f);		/* Instrument name */
+	xih.type = hio_read8(f);			/* Instrument type (always 0) */
+	xih.samples = hio_read16l(f);		/* Number of samples */
+	xih.sh_size = hio_read32l(f);		/* Sample header size */
 
 	/* Sanity check */
 	if (xih.samples > 0x10 || (xih.samples > 0 && xih.sh_size > 0x100)) {
@@ -307,40 +308,41 @@ load_instruments:
 	D_(D_INFO "[%2X] %-22.22s %2d", i, mod->xxi[i].name, mod->xxi[i].nsm);
 
 	if (mod->xxi[i].nsm) {
-	    mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), mod->xxi[i].nsm);
+	    mod->xxi[i].sub = arena_calloc(&m->arena,
+	    			sizeof (struct xmp_subinstrument), mod->xxi[i].nsm);
 
 	    /* for BoobieSqueezer (see http://boobie.rotfl.at/)
 	     * It works pretty much the same way as Impulse Tracker's sample
 	     * only mode, where it will strip off the instrument data.
 	     */
 	    if (xih.size == 0x26) {
-		read8(f);
-		read32l(f);
+		hio_read8(f);
+		hio_read32l(f);
 		memset(&xi, 0, sizeof (struct xm_instrument));
 	    } else {
-		fread(&xi.sample, 96, 1, f);	/* Sample map */
+		hio_read(&xi.sample, 96, 1, f);	/* Sample map */
 		for (j = 0; j < 24; j++)
-		    xi.v_env[j] = read16l(f);	/* Points for volume envelope */
+		    xi.v_env[j] = hio_read16l(f);	/* Points for volume envelope */
 		for (j = 0; j < 24; j++)
-		    xi.p_env[j] = read16l(f);	/* Points for pan envelope */
-		xi.v_pts = read8(f);		/* Number of volume points */
-		xi.p_pts = read8(f);		/* Number of pan points */
-		xi.v_sus = read8(f);		/* Volume sustain point */
-		xi.v_start = read8(f);		/* Volume loop start point */
-		xi.v_end = read8(f);		/* Volume loop end point */
-		xi.p_sus = read8(f);		/* Pan sustain point */
-		xi.p_start = read8(f);		/* Pan loop start point */
-		xi.p_end = read8(f);		/* Pan loop end point */
-		xi.v_type = read8(f);		/* Bit 0:On 1:Sustain 2:Loop */
-		xi.p_type = read8(f);		/* Bit 0:On 1:Sustain 2:Loop */
-		xi.y_wave = read8(f);		/* Vibrato waveform */
-		xi.y_sweep = read8(f);		/* Vibrato sweep */
-		xi.y_depth = read8(f);		/* Vibrato depth */
-		xi.y_rate = read8(f);		/* Vibrato rate */
-		xi.v_fade = read16l(f);		/* Volume fadeout */
+		    xi.p_env[j] = hio_read16l(f);	/* Points for pan envelope */
+		xi.v_pts = hio_read8(f);		/* Number of volume points */
+		xi.p_pts = hio_read8(f);		/* Number of pan points */
+		xi.v_sus = hio_read8(f);		/* Volume sustain point */
+		xi.v_start = hio_read8(f);		/* Volume loop start point */
+		xi.v_end = hio_read8(f);		/* Volume loop end point */
+		xi.p_sus = hio_read8(f);		/* Pan sustain point */
+		xi.p_start = hio_read8(f);		/* Pan loop start point */
+		xi.p_end = hio_read8(f);		/* Pan loop end point */
+		xi.v_type = hio_read8(f);		/* Bit 0:On 1:Sustain 2:Loop */
+		xi.p_type = hio_read8(f);		/* Bit 0:On 1:Sustain 2:Loop */
+		xi.y_wave = hio_read8(f);		/* Vibrato waveform */
+		xi.y_sweep = hio_read8(f);		/* Vibrato sweep */
+		xi.y_depth = hio_read8(f);		/* Vibrato depth */
+		xi.y_rate = hio_read8(f);		/* Vibrato rate */
+		xi.v_fade = hio_read16l(f);		/* Volume fadeout */
 
 		/* Skip reserved space */
-		fseek(f, (int)xih.size - 33 /*sizeof (xih)*/ - 208 /*sizeof (xi)*/, SEEK_CUR);
+		hio_seek(f, (int)xih.size - 33 /*sizeof (xih)*/ - 208 /*sizeof (xi)*/, SEEK_CUR);
 
 		/* Envelope */
 		mod->xxi[i].rls = xi.v_fade;
@@ -372,16 +374,16 @@ load_instruments:
 	    }
 
 	    for (j = 0; j < mod->xxi[i].nsm; j++, sample_num++) {
-		xsh[j].length = read32l(f);	/* Sample length */
-		xsh[j].loop_start = read32l(f);	/* Sample loop start */
-		xsh[j].loop_length = read32l(f);/* Sample loop length */
-		xsh[j].volume = read8(f);	/* Volume */
-		xsh[j].finetune = read8s(f);	/* Finetune (-128..+127) */
-		xsh[j].type = read8(f);		/* Flags */
-		xsh[j].pan = read8(f);		/* Panning (0-255) */
-		xsh[j].relnote = read8s(f);	/* Relative note number */
-		xsh[j].reserved = read8(f);
-		fread(&xsh[j].name, 22, 1, f);	/* Sample_name */
+		xsh[j].length = hio_read32l(f);	/* Sample length */
+		xsh[j].loop_start = hio_read32l(f);	/* Sample loop start */
+		xsh[j].loop_length = hio_read32l(f);/* Sample loop length */
+		xsh[j].volume = hio_read8(f);	/* Volume */
+		xsh[j].finetune = hio_read8s(f);	/* Finetune (-128..+127) */
+		xsh[j].type = hio_read8(f);		/* Flags */
+		xsh[j].pan = hio_read8(f);		/* Panning (0-255) */
+		xsh[j].relnote = hio_read8s(f);	/* Relative note number */
+		xsh[j].reserved = hio_read8(f);
+		hio_read(&xsh[j].name, 22, 1, f);	/* Sample_name */
 
 		mod->xxi[i].sub[j].vol = xsh[j].volume;
 		mod->xxi[i].sub[j].pan = xsh[j].pan;
@@ -428,7 +430,7 @@ load_instruments:
 		    mod->xxi[i].sub[j].pan, mod->xxi[i].sub[j].xpo);
 
 		if (xfh.version > 0x0103) {
-		    load_sample(f, SAMPLE_FLAG_DIFF,
+		    load_sample(m, f, SAMPLE_FLAG_DIFF,
 				&mod->xxs[mod->xxi[i].sub[j].sid], NULL);
 		}
 	    }
@@ -452,11 +454,12 @@ load_instruments:
 	     * generalization should take care of both cases.
 	     */
 
-	     fseek(f, (int)xih.size - 33 /*sizeof (xih)*/, SEEK_CUR);
+	     hio_seek(f, (int)xih.size - 33 /*sizeof (xih)*/, SEEK_CUR);
 	}
     }
     mod->smp = sample_num;
-    mod->xxs = realloc(mod->xxs, sizeof (struct xmp_sample) * mod->smp);
+    mod->xxs = arena_realloc(&m->arena,
+    			mod->xxs, sizeof (struct xmp_sample) * mod->smp);
 
     if (xfh.version <= 0x0103) {
 	goto load_patterns;
@@ -470,7 +473,7 @@ load_samples:
     if (xfh.version <= 0x0103) {
 	for (i = 0; i < mod->ins; i++) {
 	    for (j = 0; j < mod->xxi[i].nsm; j++) {
-		load_sample(f, SAMPLE_FLAG_DIFF,
+		load_sample(m, f, SAMPLE_FLAG_DIFF,
 				&mod->xxs[mod->xxi[i].sub[j].sid], NULL);
 	    }
 	}
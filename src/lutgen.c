@@ -259,6 +259,35 @@ void windowed_fir_init(void)
 }
 
 
+/* period lookup doc,
+ *
+ *   periods are proportional to 2^(-d/12), with d the note number plus
+ *   a pitch bend in 1/100 of semitone (cents) and 1/128 of cent. Split
+ *   in octaves, cents and fine steps, 2^(d/12) becomes
+ *
+ *     2^oct * period_cent_lut[cents] * period_fine_lut[fine]
+ */
+
+#define PERIOD_CENTS        1200
+#define PERIOD_FINESTEPS    128
+
+double period_cent_lut[PERIOD_CENTS];
+double period_fine_lut[PERIOD_FINESTEPS];
+
+void period_init(void)
+{
+    int i;
+
+    for (i = 0; i < PERIOD_CENTS; i++) {
+        period_cent_lut[i] = pow(2, (double)i / PERIOD_CENTS);
+    }
+
+    for (i = 0; i < PERIOD_FINESTEPS; i++) {
+        period_fine_lut[i] = pow(2, (double)i / (PERIOD_CENTS * PERIOD_FINESTEPS));
+    }
+}
+
+
 #define LOOP(x, y) \
     printf("static signed short %s[%lu] = {\n", #x, y); \
     \
@@ -272,22 +301,43 @@ void windowed_fir_init(void)
     printf("\n};\n\n");
 
 #define LOOP2(x, y) \
-for(int j = 0; j < 4; j++) { \
-    printf("static int16 %s%d[%lu] = {\n\t", #x, j, y); \
+    printf("const int16 %s[%lu] = {\n\t", #x, 4 * y); \
     \
-    for (int i = 0; i < y; i++) { \
+    for (int i = 0; i < 4 * y; i++) { \
         if (i && !(i % 8)) { \
             printf("\n\t"); \
         } \
-        printf(" %d,", x[i * 4 + j]); \
+        printf(" %d,", x[i]); \
     } \
     \
-    printf("\n};\n\n"); \
-}
+    printf("\n};\n\n");
+
+
+#define LOOP3(x, y) \
+    printf("static const double %s[%d] = {\n\t", #x, y); \
+    \
+    for (int i = 0; i < y; i++) { \
+        if (i && !(i % 3)) { \
+            printf("\n\t"); \
+        } \
+        printf(" %.17g,", x[i]); \
+    } \
+    \
+    printf("\n};\n\n");
 
 
+/* Run with -p to generate period_lut.h */
 int main(int argc, char **argv)
 {
+    if (argc > 1 && argv[1][0] == '-' && argv[1][1] == 'p') {
+        period_init();
+
+        LOOP3(period_cent_lut, PERIOD_CENTS);
+        LOOP3(period_fine_lut, PERIOD_FINESTEPS);
+
+        return 0;
+    }
+
     cubic_spline_init();
     windowed_fir_init();
 
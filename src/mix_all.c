@@ -44,12 +44,13 @@
 #define SPLINE_FRACSHIFT ((16 - SPLINE_FRACBITS) - 2)
 #define SPLINE_FRACMASK  (((1L << (16 - SPLINE_FRACSHIFT)) - 1) & ~3)
 
+/* Coefficients are interleaved, four for each fractional position */
 #define SPLINE_INTERP() do { \
-    int f = frac >> 6; \
-    smp_in = (cubic_spline_lut0[f] * sptr[pos - 1] + \
-              cubic_spline_lut1[f] * sptr[pos    ] + \
-              cubic_spline_lut3[f] * sptr[pos + 2] + \
-              cubic_spline_lut2[f] * sptr[pos + 1]) >> SPLINE_SHIFT; \
+    const int16 *c = &cubic_spline_lut[(frac >> 6) << 2]; \
+    smp_in = (c[0] * sptr[pos - 1] + \
+              c[1] * sptr[pos    ] + \
+              c[3] * sptr[pos + 2] + \
+              c[2] * sptr[pos + 1]) >> SPLINE_SHIFT; \
 } while (0)
 
 #define UPDATE_POS() do { \
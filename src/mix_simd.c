@@ -0,0 +1,474 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2013 Claudio Matsuoka and Hipolito Carraro Jr.
+ *
+ * This file is part of the Extended Module Player and is distributed
+ * under the terms of the GNU Lesser General Public License. See COPYING.LIB
+ * for more information.
+ */
+
+#include "common.h"
+#include "virtual.h"
+#include "mixer.h"
+
+
+/* SIMD mixers
+ *
+ * Vectorized versions of the unfiltered mixers in mix_all.c, computing
+ * four (SSE2) or eight (AVX2) output frames per iteration. Lanes use the
+ * same 32-bit integer arithmetic as the scalar mixers, so results are
+ * bit-exact. The anticlick attack ramp and the frames left at the end of
+ * each run are rendered by the scalar mixers. Filtered mixers are
+ * recursive on their own output and stay scalar.
+ */
+
+int mixer_simd_level(void)
+{
+#ifdef HAVE_X86_SIMD
+	if (__builtin_cpu_supports("avx2"))
+		return MIXER_SIMD_AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return MIXER_SIMD_SSE2;
+#endif
+	return MIXER_SIMD_NONE;
+}
+
+#ifdef HAVE_X86_SIMD
+
+#include <string.h>
+#include <immintrin.h>
+
+#define MIX_FN(x) void x (struct mixer_voice *, int *, int, int, int, int)
+
+MIX_FN(smix_mono_8bit_nearest);
+MIX_FN(smix_mono_8bit_linear);
+MIX_FN(smix_mono_16bit_nearest);
+MIX_FN(smix_mono_16bit_linear);
+MIX_FN(smix_stereo_8bit_nearest);
+MIX_FN(smix_stereo_8bit_linear);
+MIX_FN(smix_stereo_16bit_nearest);
+MIX_FN(smix_stereo_16bit_linear);
+MIX_FN(smix_mono_8bit_spline);
+MIX_FN(smix_mono_16bit_spline);
+MIX_FN(smix_stereo_8bit_spline);
+MIX_FN(smix_stereo_16bit_spline);
+
+/* Interleaved spline coefficients from precomp_lut.h */
+extern const int16 cubic_spline_lut[];
+
+#define SPLINE_SHIFT	14
+
+/* Lane positions are computed as frac + n * step in 32 bits */
+#define SIMD_MAX_STEP	(1 << 24)
+
+#define TARGET_SSE2	__attribute__((target("sse2")))
+#define TARGET_AVX2	__attribute__((target("avx2")))
+
+#define SMIX_MIXER(t, f) t void f(struct mixer_voice *vi, int *buffer, \
+    int count, int vl, int vr, int step)
+
+/* Common mixer body. Frames in the attack ramp are rendered by the scalar
+ * mixer, then blocks of width frames are mixed by the vector code and
+ * the remaining frames are handed back to the scalar mixer using a copy
+ * of the voice with the updated position.
+ */
+#define SIMD_MIXER(t, name, scalar, type, ramp, chn, width, decl, block) \
+SMIX_MIXER(t, name) \
+{ \
+    type *sptr = vi->sptr; \
+    int pos, frac, n = 0; \
+    int64 x; \
+    decl; \
+    if (step >= SIMD_MAX_STEP) { \
+	scalar(vi, buffer, count, vl, vr, step); \
+	return; \
+    } \
+    if (ramp && vi->attack) { \
+	n = vi->attack < count ? vi->attack : count; \
+	scalar(vi, buffer, n, vl, vr, step); \
+	buffer += n * chn; \
+	count -= n; \
+    } \
+    x = vi->frac + (int64)step * n; \
+    pos = vi->pos + (int)(x >> SMIX_SHIFT); \
+    frac = x & SMIX_MASK; \
+    for (; count >= width; count -= width) { \
+	block; \
+	buffer += width * chn; \
+	x = frac + (int64)step * width; \
+	pos += x >> SMIX_SHIFT; \
+	frac = x & SMIX_MASK; \
+    } \
+    if (count > 0) { \
+	struct mixer_voice v = *vi; \
+	v.pos = pos; \
+	v.frac = frac; \
+	scalar(&v, buffer, count, vl, vr, step); \
+    } \
+}
+
+
+/*
+ * SSE2 mixers, four frames per iteration
+ */
+
+/* Low 32 bits of the lane products, same as the scalar int multiply */
+static inline TARGET_SSE2 __m128i mullo_sse2(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/* Four spline taps starting at sptr[pos - 1], as 16 bit values */
+static inline TARGET_SSE2 __m128i taps_8bit_sse2(int8 *s0, int8 *s1)
+{
+    int32 a, b;
+    __m128i t;
+
+    memcpy(&a, s0 - 1, 4);
+    memcpy(&b, s1 - 1, 4);
+    t = _mm_unpacklo_epi32(_mm_cvtsi32_si128(a), _mm_cvtsi32_si128(b));
+
+    return _mm_srai_epi16(_mm_unpacklo_epi8(t, t), 8);
+}
+
+static inline TARGET_SSE2 __m128i taps_16bit_sse2(int16 *s0, int16 *s1)
+{
+    return _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i *)(s0 - 1)),
+                              _mm_loadl_epi64((__m128i *)(s1 - 1)));
+}
+
+static inline TARGET_SSE2 __m128i coef_sse2(int f0, int f1)
+{
+    return _mm_unpacklo_epi64(
+		_mm_loadl_epi64((__m128i *)&cubic_spline_lut[f0 << 2]),
+		_mm_loadl_epi64((__m128i *)&cubic_spline_lut[f1 << 2]));
+}
+
+/* Add the pairs of partial sums from madd */
+static inline TARGET_SSE2 __m128i hsum_sse2(__m128i a, __m128i b)
+{
+    __m128 x = _mm_castsi128_ps(a), y = _mm_castsi128_ps(b);
+
+    return _mm_add_epi32(
+	_mm_castps_si128(_mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0))),
+	_mm_castps_si128(_mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1))));
+}
+
+#define SSE2_DECL \
+    int lp[4], lf[4]; \
+    __m128i smp; \
+    const __m128i kstep = _mm_setr_epi32(0, step, 2 * step, 3 * step); \
+    const __m128i mask = _mm_set1_epi32(SMIX_MASK)
+
+#define SSE2_POSITIONS() do { \
+    __m128i fr = _mm_add_epi32(_mm_set1_epi32(frac), kstep); \
+    _mm_storeu_si128((__m128i *)lp, _mm_add_epi32(_mm_set1_epi32(pos), \
+				_mm_srli_epi32(fr, SMIX_SHIFT))); \
+    _mm_storeu_si128((__m128i *)lf, _mm_and_si128(fr, mask)); \
+} while (0)
+
+#define SSE2_NEAREST() do { \
+    SSE2_POSITIONS(); \
+    smp = _mm_setr_epi32(sptr[lp[0]], sptr[lp[1]], sptr[lp[2]], sptr[lp[3]]); \
+} while (0)
+
+#define SSE2_LINEAR() do { \
+    __m128i l1, dt; \
+    SSE2_POSITIONS(); \
+    l1 = _mm_setr_epi32(sptr[lp[0]], sptr[lp[1]], sptr[lp[2]], sptr[lp[3]]); \
+    dt = _mm_sub_epi32(_mm_setr_epi32(sptr[lp[0] + 1], sptr[lp[1] + 1], \
+			sptr[lp[2] + 1], sptr[lp[3] + 1]), l1); \
+    smp = _mm_add_epi32(l1, _mm_srai_epi32(mullo_sse2( \
+			_mm_loadu_si128((__m128i *)lf), dt), SMIX_SHIFT)); \
+} while (0)
+
+#define SSE2_SPLINE(bits) do { \
+    __m128i m0, m1; \
+    SSE2_POSITIONS(); \
+    m0 = _mm_madd_epi16(coef_sse2(lf[0] >> 6, lf[1] >> 6), \
+		taps_##bits##bit_sse2(sptr + lp[0], sptr + lp[1])); \
+    m1 = _mm_madd_epi16(coef_sse2(lf[2] >> 6, lf[3] >> 6), \
+		taps_##bits##bit_sse2(sptr + lp[2], sptr + lp[3])); \
+    smp = _mm_srai_epi32(hsum_sse2(m0, m1), SPLINE_SHIFT); \
+} while (0)
+
+#define SSE2_MIX_MONO(shift) do { \
+    __m128i *b = (__m128i *)buffer; \
+    __m128i l = mullo_sse2(smp, _mm_set1_epi32(vl >> (shift))); \
+    _mm_storeu_si128(b, _mm_add_epi32(_mm_loadu_si128(b), l)); \
+} while (0)
+
+#define SSE2_MIX_STEREO(shift) do { \
+    __m128i *b = (__m128i *)buffer; \
+    __m128i r = mullo_sse2(smp, _mm_set1_epi32(vr >> (shift))); \
+    __m128i l = mullo_sse2(smp, _mm_set1_epi32(vl >> (shift))); \
+    _mm_storeu_si128(b, _mm_add_epi32(_mm_loadu_si128(b), \
+				_mm_unpacklo_epi32(r, l))); \
+    _mm_storeu_si128(b + 1, _mm_add_epi32(_mm_loadu_si128(b + 1), \
+				_mm_unpackhi_epi32(r, l))); \
+} while (0)
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_mono_8bit_nearest, smix_mono_8bit_nearest,
+	int8, 0, 1, 4, SSE2_DECL, SSE2_NEAREST(); SSE2_MIX_MONO(0))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_mono_16bit_nearest, smix_mono_16bit_nearest,
+	int16, 0, 1, 4, SSE2_DECL, SSE2_NEAREST(); SSE2_MIX_MONO(8))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_stereo_8bit_nearest, smix_stereo_8bit_nearest,
+	int8, 0, 2, 4, SSE2_DECL, SSE2_NEAREST(); SSE2_MIX_STEREO(0))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_stereo_16bit_nearest, smix_stereo_16bit_nearest,
+	int16, 0, 2, 4, SSE2_DECL, SSE2_NEAREST(); SSE2_MIX_STEREO(8))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_mono_8bit_linear, smix_mono_8bit_linear,
+	int8, 1, 1, 4, SSE2_DECL, SSE2_LINEAR(); SSE2_MIX_MONO(0))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_mono_16bit_linear, smix_mono_16bit_linear,
+	int16, 1, 1, 4, SSE2_DECL, SSE2_LINEAR(); SSE2_MIX_MONO(8))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_stereo_8bit_linear, smix_stereo_8bit_linear,
+	int8, 1, 2, 4, SSE2_DECL, SSE2_LINEAR(); SSE2_MIX_STEREO(0))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_stereo_16bit_linear, smix_stereo_16bit_linear,
+	int16, 1, 2, 4, SSE2_DECL, SSE2_LINEAR(); SSE2_MIX_STEREO(8))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_mono_8bit_spline, smix_mono_8bit_spline,
+	int8, 1, 1, 4, SSE2_DECL, SSE2_SPLINE(8); SSE2_MIX_MONO(0))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_mono_16bit_spline, smix_mono_16bit_spline,
+	int16, 1, 1, 4, SSE2_DECL, SSE2_SPLINE(16); SSE2_MIX_MONO(8))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_stereo_8bit_spline, smix_stereo_8bit_spline,
+	int8, 1, 2, 4, SSE2_DECL, SSE2_SPLINE(8); SSE2_MIX_STEREO(0))
+
+SIMD_MIXER(TARGET_SSE2, smix_sse2_stereo_16bit_spline, smix_stereo_16bit_spline,
+	int16, 1, 2, 4, SSE2_DECL, SSE2_SPLINE(16); SSE2_MIX_STEREO(8))
+
+
+/*
+ * AVX2 mixers, eight frames per iteration
+ *
+ * Samples are fetched with 32 bit gathers placing the wanted taps in the
+ * upper bytes of each lane, reading at most the guard bytes load_sample()
+ * adds around the sample data.
+ */
+
+#define AVX2_DECL \
+    __m256i lp, lf, smp; \
+    const __m256i kstep = _mm256_setr_epi32(0, step, 2 * step, 3 * step, \
+				4 * step, 5 * step, 6 * step, 7 * step); \
+    const __m256i mask = _mm256_set1_epi32(SMIX_MASK)
+
+#define AVX2_POSITIONS() do { \
+    __m256i fr = _mm256_add_epi32(_mm256_set1_epi32(frac), kstep); \
+    lp = _mm256_add_epi32(_mm256_set1_epi32(pos), \
+				_mm256_srli_epi32(fr, SMIX_SHIFT)); \
+    lf = _mm256_and_si256(fr, mask); \
+} while (0)
+
+#define GATHER(base, scale) \
+    _mm256_i32gather_epi32((const int *)(base), lp, scale)
+
+/* Sign-extended byte n (0 is the lowest) of each lane */
+#define BYTE(x, n) _mm256_srai_epi32(_mm256_slli_epi32(x, 24 - 8 * (n)), 24)
+#define WORD_LO(x) _mm256_srai_epi32(_mm256_slli_epi32(x, 16), 16)
+#define WORD_HI(x) _mm256_srai_epi32(x, 16)
+
+#define AVX2_NEAREST_8BIT() do { \
+    AVX2_POSITIONS(); \
+    smp = _mm256_srai_epi32(GATHER(sptr - 3, 1), 24); \
+} while (0)
+
+#define AVX2_NEAREST_16BIT() do { \
+    AVX2_POSITIONS(); \
+    smp = WORD_HI(GATHER(sptr - 1, 2)); \
+} while (0)
+
+#define AVX2_INTERP(l1, l2) \
+    _mm256_add_epi32(l1, _mm256_srai_epi32(_mm256_mullo_epi32(lf, \
+				_mm256_sub_epi32(l2, l1)), SMIX_SHIFT))
+
+#define AVX2_LINEAR_8BIT() do { \
+    __m256i t; \
+    AVX2_POSITIONS(); \
+    t = GATHER(sptr - 2, 1); \
+    smp = AVX2_INTERP(BYTE(t, 2), BYTE(t, 3)); \
+} while (0)
+
+#define AVX2_LINEAR_16BIT() do { \
+    __m256i t; \
+    AVX2_POSITIONS(); \
+    t = GATHER(sptr, 2); \
+    smp = AVX2_INTERP(WORD_LO(t), WORD_HI(t)); \
+} while (0)
+
+/* Four coefficients per lane, four lanes per gather */
+#define COEF(i) _mm256_i32gather_epi64((const long long *)cubic_spline_lut, \
+				i, 8)
+
+/* Partial sums come out as 0 1 4 5 | 2 3 6 7 after hadd */
+#define AVX2_SPLINE_SUM(t0, t1) do { \
+    __m256i fi = _mm256_srli_epi32(lf, 6); \
+    __m256i m0 = _mm256_madd_epi16(COEF(_mm256_castsi256_si128(fi)), t0); \
+    __m256i m1 = _mm256_madd_epi16(COEF(_mm256_extracti128_si256(fi, 1)), t1); \
+    smp = _mm256_srai_epi32(_mm256_permute4x64_epi64(_mm256_hadd_epi32(m0, \
+		m1), _MM_SHUFFLE(3, 1, 2, 0)), SPLINE_SHIFT); \
+} while (0)
+
+#define AVX2_SPLINE_8BIT() do { \
+    __m256i t; \
+    AVX2_POSITIONS(); \
+    t = GATHER(sptr - 1, 1); \
+    AVX2_SPLINE_SUM(_mm256_cvtepi8_epi16(_mm256_castsi256_si128(t)), \
+		_mm256_cvtepi8_epi16(_mm256_extracti128_si256(t, 1))); \
+} while (0)
+
+#define AVX2_SPLINE_16BIT() do { \
+    AVX2_POSITIONS(); \
+    AVX2_SPLINE_SUM( \
+	_mm256_i32gather_epi64((const long long *)(sptr - 1), \
+		_mm256_castsi256_si128(lp), 2), \
+	_mm256_i32gather_epi64((const long long *)(sptr - 1), \
+		_mm256_extracti128_si256(lp, 1), 2)); \
+} while (0)
+
+#define AVX2_MIX_MONO(shift) do { \
+    __m256i *b = (__m256i *)buffer; \
+    __m256i l = _mm256_mullo_epi32(smp, _mm256_set1_epi32(vl >> (shift))); \
+    _mm256_storeu_si256(b, _mm256_add_epi32(_mm256_loadu_si256(b), l)); \
+} while (0)
+
+#define AVX2_MIX_STEREO(shift) do { \
+    __m256i *b = (__m256i *)buffer; \
+    __m256i r = _mm256_mullo_epi32(smp, _mm256_set1_epi32(vr >> (shift))); \
+    __m256i l = _mm256_mullo_epi32(smp, _mm256_set1_epi32(vl >> (shift))); \
+    __m256i lo = _mm256_unpacklo_epi32(r, l); \
+    __m256i hi = _mm256_unpackhi_epi32(r, l); \
+    _mm256_storeu_si256(b, _mm256_add_epi32(_mm256_loadu_si256(b), \
+			_mm256_permute2x128_si256(lo, hi, 0x20))); \
+    _mm256_storeu_si256(b + 1, _mm256_add_epi32(_mm256_loadu_si256(b + 1), \
+			_mm256_permute2x128_si256(lo, hi, 0x31))); \
+} while (0)
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_mono_8bit_nearest, smix_mono_8bit_nearest,
+	int8, 0, 1, 8, AVX2_DECL, AVX2_NEAREST_8BIT(); AVX2_MIX_MONO(0))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_mono_16bit_nearest, smix_mono_16bit_nearest,
+	int16, 0, 1, 8, AVX2_DECL, AVX2_NEAREST_16BIT(); AVX2_MIX_MONO(8))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_stereo_8bit_nearest, smix_stereo_8bit_nearest,
+	int8, 0, 2, 8, AVX2_DECL, AVX2_NEAREST_8BIT(); AVX2_MIX_STEREO(0))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_stereo_16bit_nearest, smix_stereo_16bit_nearest,
+	int16, 0, 2, 8, AVX2_DECL, AVX2_NEAREST_16BIT(); AVX2_MIX_STEREO(8))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_mono_8bit_linear, smix_mono_8bit_linear,
+	int8, 1, 1, 8, AVX2_DECL, AVX2_LINEAR_8BIT(); AVX2_MIX_MONO(0))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_mono_16bit_linear, smix_mono_16bit_linear,
+	int16, 1, 1, 8, AVX2_DECL, AVX2_LINEAR_16BIT(); AVX2_MIX_MONO(8))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_stereo_8bit_linear, smix_stereo_8bit_linear,
+	int8, 1, 2, 8, AVX2_DECL, AVX2_LINEAR_8BIT(); AVX2_MIX_STEREO(0))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_stereo_16bit_linear, smix_stereo_16bit_linear,
+	int16, 1, 2, 8, AVX2_DECL, AVX2_LINEAR_16BIT(); AVX2_MIX_STEREO(8))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_mono_8bit_spline, smix_mono_8bit_spline,
+	int8, 1, 1, 8, AVX2_DECL, AVX2_SPLINE_8BIT(); AVX2_MIX_MONO(0))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_mono_16bit_spline, smix_mono_16bit_spline,
+	int16, 1, 1, 8, AVX2_DECL, AVX2_SPLINE_16BIT(); AVX2_MIX_MONO(8))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_stereo_8bit_spline, smix_stereo_8bit_spline,
+	int8, 1, 2, 8, AVX2_DECL, AVX2_SPLINE_8BIT(); AVX2_MIX_STEREO(0))
+
+SIMD_MIXER(TARGET_AVX2, smix_avx2_stereo_16bit_spline, smix_stereo_16bit_spline,
+	int16, 1, 2, 8, AVX2_DECL, AVX2_SPLINE_16BIT(); AVX2_MIX_STEREO(8))
+
+
+/* Downmix to float and wide integer samples, see downmix_float() and
+ * downmix_int_32bit() in mixer.c. Conversions are exact or rounded the
+ * same way as the scalar code. Return the number of samples converted,
+ * the rest is left to the scalar code.
+ */
+
+TARGET_SSE2 int downmix_sse2_float(float *dest, int32 *src, int num,
+								float scale)
+{
+	__m128 k = _mm_set1_ps(scale);
+	int n;
+
+	for (n = 0; n + 4 <= num; n += 4) {
+		__m128i x = _mm_loadu_si128((__m128i *)(src + n));
+		_mm_storeu_ps(dest + n, _mm_mul_ps(_mm_cvtepi32_ps(x), k));
+	}
+
+	return n;
+}
+
+TARGET_SSE2 int downmix_sse2_int32(int32 *dest, int32 *src, int num,
+		int lshift, int rshift, int32 lo, int32 hi, int32 offs)
+{
+	__m128i vlo = _mm_set1_epi32(lo);
+	__m128i vhi = _mm_set1_epi32(hi);
+	__m128i voffs = _mm_set1_epi32(offs);
+	__m128i l = _mm_cvtsi32_si128(lshift);
+	__m128i r = _mm_cvtsi32_si128(rshift);
+	__m128i x, m;
+	int n;
+
+	for (n = 0; n + 4 <= num; n += 4) {
+		x = _mm_loadu_si128((__m128i *)(src + n));
+		m = _mm_cmpgt_epi32(x, vhi);
+		x = _mm_or_si128(_mm_and_si128(m, vhi), _mm_andnot_si128(m, x));
+		m = _mm_cmplt_epi32(x, vlo);
+		x = _mm_or_si128(_mm_and_si128(m, vlo), _mm_andnot_si128(m, x));
+		x = _mm_sll_epi32(_mm_sra_epi32(x, r), l);
+		_mm_storeu_si128((__m128i *)(dest + n), _mm_add_epi32(x, voffs));
+	}
+
+	return n;
+}
+
+TARGET_AVX2 int downmix_avx2_float(float *dest, int32 *src, int num,
+								float scale)
+{
+	__m256 k = _mm256_set1_ps(scale);
+	int n;
+
+	for (n = 0; n + 8 <= num; n += 8) {
+		__m256i x = _mm256_loadu_si256((__m256i *)(src + n));
+		_mm256_storeu_ps(dest + n,
+				_mm256_mul_ps(_mm256_cvtepi32_ps(x), k));
+	}
+
+	return n;
+}
+
+TARGET_AVX2 int downmix_avx2_int32(int32 *dest, int32 *src, int num,
+		int lshift, int rshift, int32 lo, int32 hi, int32 offs)
+{
+	__m256i vlo = _mm256_set1_epi32(lo);
+	__m256i vhi = _mm256_set1_epi32(hi);
+	__m256i voffs = _mm256_set1_epi32(offs);
+	__m128i l = _mm_cvtsi32_si128(lshift);
+	__m128i r = _mm_cvtsi32_si128(rshift);
+	__m256i x;
+	int n;
+
+	for (n = 0; n + 8 <= num; n += 8) {
+		x = _mm256_loadu_si256((__m256i *)(src + n));
+		x = _mm256_max_epi32(_mm256_min_epi32(x, vhi), vlo);
+		x = _mm256_sll_epi32(_mm256_sra_epi32(x, r), l);
+		_mm256_storeu_si256((__m256i *)(dest + n),
+					_mm256_add_epi32(x, voffs));
+	}
+
+	return n;
+}
+
+#endif /* HAVE_X86_SIMD */
@@ -9,12 +9,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
 
 #include "common.h"
 #include "virtual.h"
 #include "mixer.h"
 #include "synth.h"
 #include "period.h"
+#include "hio.h"
+#include "loaders/loader.h"
 
 
 #define FLAG_16_BITS	0x01
@@ -24,11 +27,19 @@
 #define FLAG_SYNTH	0x20
 #define FIDX_FLAGMASK	(FLAG_16_BITS | FLAG_STEREO | FLAG_FILTER)
 
+#define EDGE_SIZE	 16	/* samples copied around mapped sample edges */
+#define EDGE_LEAD	 3	/* samples read before the mixing position */
+
 #define DOWNMIX_SHIFT	 12
 #define LIM8_HI		 127
 #define LIM8_LO		-128
 #define LIM16_HI	 32767
 #define LIM16_LO	-32768
+#define LIM24_HI	 0x7fffff
+#define LIM24_LO	-0x800000
+
+/* Widest output sample, in bytes */
+#define MAX_SAMPLE_SIZE	 4
 
 #define MIX_FN(x) void x (struct mixer_voice *, int *, int, int, int, int)
 
@@ -99,6 +110,114 @@ static mixer_set spline_mixers = {
 	smix_stereo_16bit_spline_filter
 };
 
+#ifdef HAVE_X86_SIMD
+
+MIX_FN(smix_sse2_mono_8bit_nearest);
+MIX_FN(smix_sse2_mono_8bit_linear);
+MIX_FN(smix_sse2_mono_16bit_nearest);
+MIX_FN(smix_sse2_mono_16bit_linear);
+MIX_FN(smix_sse2_stereo_8bit_nearest);
+MIX_FN(smix_sse2_stereo_8bit_linear);
+MIX_FN(smix_sse2_stereo_16bit_nearest);
+MIX_FN(smix_sse2_stereo_16bit_linear);
+MIX_FN(smix_sse2_mono_8bit_spline);
+MIX_FN(smix_sse2_mono_16bit_spline);
+MIX_FN(smix_sse2_stereo_8bit_spline);
+MIX_FN(smix_sse2_stereo_16bit_spline);
+MIX_FN(smix_avx2_mono_8bit_nearest);
+MIX_FN(smix_avx2_mono_8bit_linear);
+MIX_FN(smix_avx2_mono_16bit_nearest);
+MIX_FN(smix_avx2_mono_16bit_linear);
+MIX_FN(smix_avx2_stereo_8bit_nearest);
+MIX_FN(smix_avx2_stereo_8bit_linear);
+MIX_FN(smix_avx2_stereo_16bit_nearest);
+MIX_FN(smix_avx2_stereo_16bit_linear);
+MIX_FN(smix_avx2_mono_8bit_spline);
+MIX_FN(smix_avx2_mono_16bit_spline);
+MIX_FN(smix_avx2_stereo_8bit_spline);
+MIX_FN(smix_avx2_stereo_16bit_spline);
+
+int downmix_sse2_float(float *, int32 *, int, float);
+int downmix_sse2_int32(int32 *, int32 *, int, int, int, int32, int32, int32);
+int downmix_avx2_float(float *, int32 *, int, float);
+int downmix_avx2_int32(int32 *, int32 *, int, int, int, int32, int32, int32);
+
+/* SIMD mixers, same layout as above. Filtered mixers are scalar only. */
+
+static mixer_set sse2_nearest_mixers = {
+	smix_sse2_mono_8bit_nearest,
+	smix_sse2_mono_16bit_nearest,
+	smix_sse2_stereo_8bit_nearest,
+	smix_sse2_stereo_16bit_nearest,
+
+	smix_sse2_mono_8bit_nearest,
+	smix_sse2_mono_16bit_nearest,
+	smix_sse2_stereo_8bit_nearest,
+	smix_sse2_stereo_16bit_nearest,
+};
+
+static mixer_set sse2_linear_mixers = {
+	smix_sse2_mono_8bit_linear,
+	smix_sse2_mono_16bit_linear,
+	smix_sse2_stereo_8bit_linear,
+	smix_sse2_stereo_16bit_linear,
+
+	smix_mono_8bit_linear_filter,
+	smix_mono_16bit_linear_filter,
+	smix_stereo_8bit_linear_filter,
+	smix_stereo_16bit_linear_filter
+};
+
+static mixer_set sse2_spline_mixers = {
+	smix_sse2_mono_8bit_spline,
+	smix_sse2_mono_16bit_spline,
+	smix_sse2_stereo_8bit_spline,
+	smix_sse2_stereo_16bit_spline,
+
+	smix_mono_8bit_spline_filter,
+	smix_mono_16bit_spline_filter,
+	smix_stereo_8bit_spline_filter,
+	smix_stereo_16bit_spline_filter
+};
+
+static mixer_set avx2_nearest_mixers = {
+	smix_avx2_mono_8bit_nearest,
+	smix_avx2_mono_16bit_nearest,
+	smix_avx2_stereo_8bit_nearest,
+	smix_avx2_stereo_16bit_nearest,
+
+	smix_avx2_mono_8bit_nearest,
+	smix_avx2_mono_16bit_nearest,
+	smix_avx2_stereo_8bit_nearest,
+	smix_avx2_stereo_16bit_nearest,
+};
+
+static mixer_set avx2_linear_mixers = {
+	smix_avx2_mono_8bit_linear,
+	smix_avx2_mono_16bit_linear,
+	smix_avx2_stereo_8bit_linear,
+	smix_avx2_stereo_16bit_linear,
+
+	smix_mono_8bit_linear_filter,
+	smix_mono_16bit_linear_filter,
+	smix_stereo_8bit_linear_filter,
+	smix_stereo_16bit_linear_filter
+};
+
+static mixer_set avx2_spline_mixers = {
+	smix_avx2_mono_8bit_spline,
+	smix_avx2_mono_16bit_spline,
+	smix_avx2_stereo_8bit_spline,
+	smix_avx2_stereo_16bit_spline,
+
+	smix_mono_8bit_spline_filter,
+	smix_mono_16bit_spline_filter,
+	smix_stereo_8bit_spline_filter,
+	smix_stereo_16bit_spline_filter
+};
+
+#endif
+
 /* Downmix 32bit samples to 8bit, signed or unsigned, mono or stereo output */
 static void downmix_int_8bit(char *dest, int32 *src, int num, int amp, int offs)
 {
@@ -137,6 +256,38 @@ static void downmix_int_16bit(int16 *dest, int32 *src, int num, int amp, int off
 }
 
 
+/* Downmix 32bit samples to 24 or 32bit words, signed or unsigned. Samples
+ * are clamped to [lo, hi] before shifting, so the left shift used for 32bit
+ * output can't overflow.
+ */
+static void downmix_int_32bit(int32 *dest, int32 *src, int num, int lshift,
+			      int rshift, int32 lo, int32 hi, int32 offs)
+{
+	int32 smp;
+
+	for (; num--; src++, dest++) {
+		smp = *src;
+		if (smp > hi) {
+			smp = hi;
+		} else if (smp < lo) {
+			smp = lo;
+		}
+		*dest = (int32)(((uint32)(smp >> rshift) << lshift) + offs);
+	}
+}
+
+
+/* Downmix 32bit samples to float, mono or stereo output. Full scale 16bit
+ * output maps to [-1.0, 1.0), louder samples are not clipped.
+ */
+static void downmix_float(float *dest, int32 *src, int num, float scale)
+{
+	for (; num--; src++, dest++) {
+		*dest = (float)*src * scale;
+	}
+}
+
+
 /* Prepare the mixer for the next tick */
 void mixer_prepare(struct context_data *ctx)
 {
@@ -272,22 +423,156 @@ static void anticlick(struct context_data *ctx, int voc, int vol, int pan,
 }
 
 
-/* Fill the output buffer calling one of the handlers. The buffer contains
- * sound for one tick (a PAL frame or 1/50s for standard vblank-timed mods)
+/* Value of a mapped sample at idx as if the loader had added guard
+ * samples: the first sample is repeated before the start and the last
+ * after the end, and the loop end is followed by the loop start.
+ */
+static int guard_sample(struct xmp_sample *xxs, int idx)
+{
+	int lpe = xxs->lpe;
+
+	if (xxs->flg & XMP_SAMPLE_LOOP) {
+		if (idx == lpe) {
+			idx = lpe - 1;
+		} else if (idx > lpe && idx <= lpe + 3) {
+			return guard_sample(xxs, xxs->lps + idx - lpe - 1);
+		}
+	}
+
+	if (idx < 0) {
+		idx = 0;
+	} else if (idx >= xxs->len) {
+		idx = xxs->len - 1;
+	}
+
+	if (xxs->flg & XMP_SAMPLE_16BIT) {
+		return ((int16 *)xxs->data)[idx];
+	} else {
+		return ((int8 *)xxs->data)[idx];
+	}
+}
+
+/* Number of output samples until the voice position passes pos */
+static inline int samples_until(struct mixer_voice *vi, int pos, int step)
+{
+	if (vi->pos > pos)
+		return 0;
+
+	return 1 + ((((int64)(pos - vi->pos + 1) << SMIX_SHIFT) -
+						vi->frac - 1) / step);
+}
+
+/* Mapped samples are used in place and have no guard samples. Parts of
+ * the run where the interpolation reads past the sample edges are mixed
+ * from a copy of the data around the voice position. The 8 bit AVX2
+ * mixers gather four bytes ending at the position, so up to EDGE_LEAD
+ * samples before it are read.
+ */
+static void mix_mapped(struct mixer_voice *vi, struct xmp_sample *xxs,
+		       void (*mix_fn)(), int32 *buf, int samples,
+		       int vol_l, int vol_r, int step, int stereo)
+{
+	struct mixer_voice v = *vi;
+	union {
+		int8 b[EDGE_SIZE];
+		int16 w[EDGE_SIZE];
+	} edge;
+	int i, num, start;
+
+	while (samples > 0) {
+		start = 0;
+		num = v.pos >= EDGE_LEAD ?
+				samples_until(&v, v.end - 3, step) : 0;
+
+		if (num > 0) {
+			v.sptr = xxs->data;
+		} else {
+			start = v.pos - EDGE_LEAD;
+			for (i = 0; i < EDGE_SIZE; i++) {
+				if (xxs->flg & XMP_SAMPLE_16BIT) {
+					edge.w[i] = guard_sample(xxs, start + i);
+				} else {
+					edge.b[i] = guard_sample(xxs, start + i);
+				}
+			}
+			num = samples_until(&v, start + EDGE_SIZE - 3, step);
+			v.sptr = &edge;
+			v.pos -= start;
+		}
+
+		if (num > samples) {
+			num = samples;
+		}
+
+		mix_fn(&v, buf, num, vol_l, vol_r, step);
+		buf += stereo ? num * 2 : num;
+		samples -= num;
+
+		v.pos += start;
+		v.frac += step * num;
+		v.pos += v.frac >> SMIX_SHIFT;
+		v.frac &= SMIX_MASK;
+	}
+
+	vi->attack = v.attack;
+	vi->filter = v.filter;
+}
+
+/* Stand-in for an unfiltered mixer call when the tick is not rendered:
+ * advance the attack ramp and mix only the last output values, which is
+ * all the anticlick code needs from the voice.
  */
-void mixer_softmixer(struct context_data *ctx)
+static void silent_mix(struct mixer_voice *vi, struct xmp_sample *mapped,
+		       void (*mix_fn)(), int samples, int vol_l, int vol_r,
+		       int step, int stereo, int ramp)
+{
+	struct mixer_voice v;
+	int32 tail[2] = { 0, 0 };
+	int num = stereo ? 1 : 2;
+	int skip = samples - num;
+
+	if (skip >= 0) {
+		v = *vi;
+		v.frac += step * skip;
+		v.pos += v.frac >> SMIX_SHIFT;
+		v.frac &= SMIX_MASK;
+		if (ramp) {
+			v.attack = v.attack > skip ? v.attack - skip : 0;
+		}
+		if (mapped) {
+			mix_mapped(&v, mapped, mix_fn, tail, num, vol_l,
+							vol_r, step, stereo);
+		} else {
+			mix_fn(&v, tail, num, vol_l, vol_r, step);
+		}
+		vi->sright = tail[0];
+		vi->sleft = tail[1];
+	}
+
+	if (ramp) {
+		vi->attack = vi->attack > samples ? vi->attack - samples : 0;
+	}
+}
+
+
+/* Mix count samples of the current tick, starting at sample start, into
+ * the 32 bit buffer. A tick can be mixed in several parts so that voices
+ * change in the middle of it. In silent mode voices are advanced without
+ * rendering, leaving the mixer in the same state as a full render.
+ */
+void mixer_mix(struct context_data *ctx, int start, int count, int silent)
 {
 	struct player_data *p = &ctx->p;
 	struct mixer_data *s = &ctx->s;
 	struct module_data *m = &ctx->m;
-	struct xmp_sample *xxs;
+	struct xmp_sample *xxs, *mapped;
 	struct mixer_voice *vi;
 	int samples, size;
 	int vol_l, vol_r, step, voc;
 	int prev_l, prev_r;
 	int lps, lpe;
 	int synth = 1;
-	int32 *buf_pos;
+	int32 *buf, *buf_pos;
 	void (*mix_fn)();
 	mixer_set *mixers;
 
@@ -305,9 +590,34 @@ void mixer_softmixer(struct context_data *ctx)
 		mixers = &linear_mixers;
 	}
 
-	mixer_prepare(ctx);
+#ifdef HAVE_X86_SIMD
+	if (s->simd == MIXER_SIMD_AVX2) {
+		if (mixers == &nearest_mixers) {
+			mixers = &avx2_nearest_mixers;
+		} else if (mixers == &linear_mixers) {
+			mixers = &avx2_linear_mixers;
+		} else {
+			mixers = &avx2_spline_mixers;
+		}
+	} else if (s->simd == MIXER_SIMD_SSE2) {
+		if (mixers == &nearest_mixers) {
+			mixers = &sse2_nearest_mixers;
+		} else if (mixers == &linear_mixers) {
+			mixers = &sse2_linear_mixers;
+		} else {
+			mixers = &sse2_spline_mixers;
+		}
+	}
+#endif
 
-	rampdown(ctx, -1, NULL, 0);	/* Anti-click */
+	buf = s->buf32 + start * (s->format & XMP_FORMAT_MONO ? 1 : 2);
+
+	if (count <= 0)
+		return;
+
+	/* Anti-click for voices stopped before this part */
+	rampdown(ctx, -1, buf, count < SLOW_RELEASE ? count : SLOW_RELEASE);
+	s->dtright = s->dtleft = 0;
 
 	for (voc = 0; voc < p->virt.maxvoc; voc++) {
 		vi = &p->virt.voice_array[voc];
@@ -320,15 +630,16 @@ void mixer_softmixer(struct context_data *ctx)
 			continue;
 		}
 
-		vi->pos0 = vi->pos;
+		if (start == 0)
+			vi->pos0 = vi->pos;
 
-		buf_pos = s->buf32;
+		buf_pos = buf;
 		vol_r = vi->vol * (0x80 - vi->pan);
 		vol_l = vi->vol * (0x80 + vi->pan);
 
 		if (vi->fidx & FLAG_SYNTH) {
 			if (synth) {
-				m->synth->mixer(ctx, buf_pos, s->ticksize,
+				m->synth->mixer(ctx, buf_pos, count,
 						vol_l >> 7, vol_r >> 7,
 						vi->fidx & FLAG_STEREO);
 				synth = 0;
@@ -345,12 +656,13 @@ void mixer_softmixer(struct context_data *ctx)
 		xxs = &m->mod.xxs[vi->smp];
 		lps = xxs->lps;
 		lpe = xxs->lpe;
+		mapped = hio_mapped(m->map, xxs->data) ? xxs : NULL;
 
 		if (p->flags & XMP_FLAGS_FIXLOOP) {
 			lps >>= 1;
 		}
 
-		for (size = s->ticksize; size > 0; ) {
+		for (size = count; size > 0; ) {
 			/* How many samples we can write before the loop break
 			 * or sample end... */
 			if (vi->pos >= vi->end) {
@@ -390,18 +702,37 @@ void mixer_softmixer(struct context_data *ctx)
 
 				mix_fn = (*mixers)[mixer];
 
-				/* Call the output handler */
-				if (samples >= 0) {
-					mix_fn(vi, buf_pos, samples, vol_l,
-								vol_r, step);
+				/* Filters keep state in the voice, so filtered
+				 * voices are always mixed
+				 */
+				if (silent && (~mixer & FLAG_FILTER)) {
+					silent_mix(vi, mapped, mix_fn, samples,
+						vol_l, vol_r, step,
+						mix_size != samples,
+						s->interp != XMP_INTERP_NEAREST);
 					buf_pos += mix_size;
-				}
-
-				/* For Hipolito's anticlick routine */
-				idx = 0;
-				if (mix_size >= 2) {
-					vi->sright = buf_pos[idx - 2] - prev_r;
-					vi->sleft = buf_pos[idx - 1] - prev_l;
+				} else {
+					/* Call the output handler */
+					if (mapped) {
+						mix_mapped(vi, mapped, mix_fn,
+							buf_pos, samples, vol_l,
+							vol_r, step,
+							mix_size != samples);
+						buf_pos += mix_size;
+					} else if (samples >= 0) {
+						mix_fn(vi, buf_pos, samples,
+							vol_l, vol_r, step);
+						buf_pos += mix_size;
+					}
+
+					/* For Hipolito's anticlick routine */
+					idx = 0;
+					if (mix_size >= 2) {
+						vi->sright = buf_pos[idx - 2] -
+									prev_r;
+						vi->sleft = buf_pos[idx - 1] -
+									prev_l;
+					}
 				}
 			}
 
@@ -432,8 +763,27 @@ void mixer_softmixer(struct context_data *ctx)
 			}
 		}
 	}
+}
+
+/* Fill the output buffer calling one of the handlers. The buffer contains
+ * sound for one tick (a PAL frame or 1/50s for standard vblank-timed mods).
+ */
+void mixer_softmixer(struct context_data *ctx, int silent)
+{
+	struct mixer_data *s = &ctx->s;
 
-	/* Render final frame */
+	mixer_prepare(ctx);
+	mixer_mix(ctx, 0, s->ticksize, silent);
+}
+
+/* Render the final frame from the 32 bit mixing buffer into the output
+ * buffer, which must hold at least mixer_buffer_size() bytes. Callers
+ * may pass their own buffer to avoid copying the tick around.
+ */
+void mixer_downmix(struct context_data *ctx, void *buffer)
+{
+	struct mixer_data *s = &ctx->s;
+	int size, shift, n = 0;
 
 	size = s->ticksize;
 	if (~s->format & XMP_FORMAT_MONO) {
@@ -441,15 +791,80 @@ void mixer_softmixer(struct context_data *ctx)
 	}
 	assert(size <= XMP_MAX_FRAMESIZE);
 
-	if (s->format & XMP_FORMAT_8BIT) {
-		downmix_int_8bit(s->buffer, s->buf32, size, s->amplify,
+	shift = DOWNMIX_SHIFT - s->amplify;
+
+	if (s->format & XMP_FORMAT_FLOAT) {
+		float scale = 1.0f / (1 << (shift + 15));
+#ifdef HAVE_X86_SIMD
+		if (s->simd == MIXER_SIMD_AVX2) {
+			n = downmix_avx2_float(buffer, s->buf32, size, scale);
+		} else if (s->simd == MIXER_SIMD_SSE2) {
+			n = downmix_sse2_float(buffer, s->buf32, size, scale);
+		}
+#endif
+		downmix_float((float *)buffer + n, s->buf32 + n, size - n,
+									scale);
+	} else if (s->format & (XMP_FORMAT_32BIT | XMP_FORMAT_24BIT)) {
+		int lshift, rshift;
+		int32 lo, hi, offs;
+
+		if (s->format & XMP_FORMAT_32BIT) {
+			lshift = 16 - shift;
+			rshift = 0;
+			lo = INT32_MIN >> lshift;
+			hi = INT32_MAX >> lshift;
+			offs = s->format & XMP_FORMAT_UNSIGNED ? INT32_MIN : 0;
+		} else {
+			lshift = 0;
+			rshift = shift - 8;
+			lo = LIM24_LO * (1 << rshift);
+			hi = (LIM24_HI + 1) * (1 << rshift) - 1;
+			offs = s->format & XMP_FORMAT_UNSIGNED ? -LIM24_LO : 0;
+		}
+#ifdef HAVE_X86_SIMD
+		if (s->simd == MIXER_SIMD_AVX2) {
+			n = downmix_avx2_int32(buffer, s->buf32, size,
+					lshift, rshift, lo, hi, offs);
+		} else if (s->simd == MIXER_SIMD_SSE2) {
+			n = downmix_sse2_int32(buffer, s->buf32, size,
+					lshift, rshift, lo, hi, offs);
+		}
+#endif
+		downmix_int_32bit((int32 *)buffer + n, s->buf32 + n, size - n,
+					lshift, rshift, lo, hi, offs);
+	} else if (s->format & XMP_FORMAT_8BIT) {
+		downmix_int_8bit(buffer, s->buf32, size, s->amplify,
 				s->format & XMP_FORMAT_UNSIGNED ? 0x80 : 0);
 	} else {
-		downmix_int_16bit((int16 *)s->buffer, s->buf32, size,s->amplify,
+		downmix_int_16bit(buffer, s->buf32, size, s->amplify,
 				s->format & XMP_FORMAT_UNSIGNED ? 0x8000 : 0);
 	}
+}
 
-	s->dtright = s->dtleft = 0;
+/* Size in bytes of one output sample */
+static int sample_size(int format)
+{
+	if (format & (XMP_FORMAT_FLOAT | XMP_FORMAT_32BIT | XMP_FORMAT_24BIT)) {
+		return 4;
+	} else if (format & XMP_FORMAT_8BIT) {
+		return 1;
+	} else {
+		return 2;
+	}
+}
+
+/* Size in bytes of the last rendered frame */
+int mixer_buffer_size(struct context_data *ctx)
+{
+	struct mixer_data *s = &ctx->s;
+	int size;
+
+	size = s->ticksize;
+	if (~s->format & XMP_FORMAT_MONO) {
+		size *= 2;
+	}
+
+	return size * sample_size(s->format);
 }
 
 void mixer_voicepos(struct context_data *ctx, int voc, int pos, int frac)
@@ -538,6 +953,10 @@ void mixer_setpatch(struct context_data *ctx, int voc, int smp)
 
 	mixer_setvol(ctx, voc, 0);
 
+	/* Samples left in the module file are loaded when first played */
+	if (xxs->data == NULL && m->lazy != NULL)
+		load_lazy_sample(m, smp);
+
 	vi->sptr = xxs->data;
 	vi->fidx |= FLAG_ACTIVE;
 
@@ -643,7 +1062,7 @@ int mixer_on(struct context_data *ctx, int rate, int format, int c4rate)
 {
 	struct mixer_data *s = &ctx->s;
 
-	s->buffer = calloc(2, XMP_MAX_FRAMESIZE);
+	s->buffer = calloc(MAX_SAMPLE_SIZE, XMP_MAX_FRAMESIZE);
 	if (s->buffer == NULL)
 		goto err;
 
@@ -660,6 +1079,7 @@ int mixer_on(struct context_data *ctx, int rate, int format, int c4rate)
 	s->dsp = XMP_DSP_LOWPASS;	/* enable filters by default */
 	s->numvoc = SMIX_NUMVOC;
 	s->dtright = s->dtleft = 0;
+	s->simd = mixer_simd_level();
 
 	return 0;
 
@@ -9,6 +9,11 @@
 
 #define FILTER_SHIFT	16
 
+/* SIMD mixer levels */
+#define MIXER_SIMD_NONE	0
+#define MIXER_SIMD_SSE2	1
+#define MIXER_SIMD_AVX2	2
+
 /* Anticlick ramps */
 #define SLOW_ATTACK_SHIFT 4
 #define SLOW_ATTACK	(1 << SLOW_ATTACK_SHIFT)
@@ -16,24 +21,21 @@
 
 
 struct mixer_voice {
+	/* Mixing state, used for every active voice in every tick */
 	int chn;		/* channel number */
-	int root;		/* */
-	unsigned int age;	/* */
-	int note;		/* */
-	int pan;		/* */
-	int vol;		/* */
 	int period;		/* current period */
-	int pos;		/* position in sample */
-	int pos0;		/* position in sample before mixing */
-	int frac;		/* interpolation */
+	int vol;		/* */
+	int pan;		/* */
 	int fidx;		/* function index */
-	int ins;		/* instrument number */
 	int smp;		/* sample number */
+	void *sptr;		/* sample pointer */
+	int pos;		/* position in sample */
+	int frac;		/* interpolation */
 	int end;		/* loop end */
-	int act;		/* nna info & status of voice */
 	int sleft;		/* last left sample output, in 32bit */
 	int sright;		/* last right sample output, in 32bit */
-	void *sptr;		/* sample pointer */
+	int attack;		/* ramp up anticlick */
+	int sample_loop;	/* set if sample has looped */
 
 	struct {
 		int r1;		/* filter variables */
@@ -47,8 +49,15 @@ struct mixer_voice {
 		int resonance;
 	} filter;
 
-	int attack;		/* ramp up anticlick */
-	int sample_loop;	/* set if sample has looped */
+	/* Voice allocation and position reporting */
+	int root;		/* */
+	unsigned int age;	/* */
+	int note;		/* */
+	int ins;		/* instrument number */
+	int act;		/* nna info & status of voice */
+	int pos0;		/* position in sample before mixing */
+	int next;		/* next voice with the same root */
+	int prev;		/* previous voice with the same root */
 };
 
 int	mixer_on		(struct context_data *, int, int, int);
@@ -57,12 +66,17 @@ void    mixer_setvol		(struct context_data *, int, int);
 void    mixer_seteffect		(struct context_data *, int, int, int);
 void    mixer_setpan		(struct context_data *, int, int);
 int	mixer_numvoices		(struct context_data *, int);
-void	mixer_softmixer		(struct context_data *);
+void	mixer_softmixer		(struct context_data *, int);
+void	mixer_prepare		(struct context_data *);
+void	mixer_mix		(struct context_data *, int, int, int);
+void	mixer_downmix		(struct context_data *, void *);
+int	mixer_buffer_size	(struct context_data *);
 void	mixer_reset		(struct context_data *);
 void	mixer_setpatch		(struct context_data *, int, int);
 void	mixer_voicepos		(struct context_data *, int, int, int);
 int	mixer_getvoicepos	(struct context_data *, int);
 void	mixer_setnote		(struct context_data *, int, int);
 void	mixer_setbend		(struct context_data *, int, int);
+int	mixer_simd_level	(void);
 
 #endif /* XMP_MIXER_H */
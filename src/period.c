@@ -10,6 +10,7 @@
 #include <string.h>
 #include "common.h"
 #include "period.h"
+#include "period_lut.h"
 
 #include <math.h>
 
@@ -32,6 +33,29 @@ static const int period_amiga[] = {
 };
 
 
+/* Pitch steps are 1/128 of cent, 153600 steps per octave */
+#define STEPS_PER_CENT	128
+#define STEPS_PER_OCT	(1200 * STEPS_PER_CENT)
+
+/* Compute 2^(x / 153600) using the octave, cent and fine step tables
+ * from period_lut.h instead of pow()
+ */
+static inline double pow2_steps(int x)
+{
+    int oct, r;
+
+    if (x >= 0) {
+	oct = x / STEPS_PER_OCT;
+    } else {
+	oct = -((STEPS_PER_OCT - 1 - x) / STEPS_PER_OCT);
+    }
+    r = x - oct * STEPS_PER_OCT;
+
+    return ldexp(period_cent_lut[r / STEPS_PER_CENT] *
+		 period_fine_lut[r % STEPS_PER_CENT], oct);
+}
+
+
 /* Get period from note */
 inline double note_to_period(int n, int f, int type)
 {
@@ -39,15 +63,14 @@ inline double note_to_period(int n, int f, int type)
 
     return type ?
 	(240.0 - d) * 16 :			/* Linear */
-        13694.0 / pow(2, d / 12);		/* Amiga */
+        13694.0 / pow2_steps(n * 12800 + f * 100);	/* Amiga */
 }
 
 
 /* For the software mixer */
 int note_to_period_mix(int n, int b)
 {
-    double d = (double)n + (double)b / 12800;
-    return (int)(8192.0 * XMP_PERIOD_BASE / pow(2, d / 12));
+    return (int)(8192.0 * XMP_PERIOD_BASE / pow2_steps(n * 12800 + b));
 }
 
 
@@ -0,0 +1,449 @@
+static const double period_cent_lut[1200] = {
+	 1, 1.0005777895065548, 1.0011559128538237,
+	 1.0017343702346959, 1.0023131618421728, 1.0028922878693671,
+	 1.0034717485095028, 1.0040515439559159, 1.0046316744020538,
+	 1.005212140041476, 1.0057929410678534, 1.0063740776749694,
+	 1.0069555500567189, 1.0075373584071088, 1.0081195029202583,
+	 1.008701983790399, 1.0092848012118742, 1.0098679553791396,
+	 1.0104514464867638, 1.0110352747294271, 1.0116194403019225,
+	 1.0122039433991559, 1.0127887842161454, 1.0133739629480218,
+	 1.0139594797900291, 1.0145453349375237, 1.0151315285859748,
+	 1.0157180609309646, 1.016304932168189, 1.0168921424934556,
+	 1.0174796921026863, 1.018067581191916, 1.0186558099572924,
+	 1.0192443785950769, 1.019833287301644, 1.0204225362734822,
+	 1.0210121257071934, 1.021602055799492, 1.0221923267472079,
+	 1.0227829387472833, 1.023373891996775, 1.0239651866928527,
+	 1.0245568230328015, 1.0251488012140191, 1.0257411214340177,
+	 1.0263337838904241, 1.0269267887809788, 1.0275201363035364,
+	 1.0281138266560665, 1.0287078600366524, 1.0293022366434921,
+	 1.0298969566748981, 1.0304920203292975, 1.0310874278052324,
+	 1.031683179301359, 1.0322792750164484, 1.032875715149387,
+	 1.0334724998991756, 1.0340696294649303, 1.0346671040458824,
+	 1.0352649238413776, 1.0358630890508773, 1.0364615998739584,
+	 1.0370604565103128, 1.0376596591597473, 1.0382592080221851,
+	 1.0388591032976644, 1.0394593451863388, 1.0400599338884777,
+	 1.0406608696044666, 1.0412621525348065, 1.0418637828801136,
+	 1.0424657608411214, 1.0430680866186781, 1.0436707604137487,
+	 1.0442737824274138, 1.0448771528608707, 1.0454808719154327,
+	 1.0460849397925291, 1.0466893566937063, 1.0472941228206267,
+	 1.0478992383750692, 1.048504703558929, 1.0491105185742187,
+	 1.0497166836230674, 1.0503231989077202, 1.0509300646305402,
+	 1.0515372809940069, 1.0521448482007163, 1.0527527664533824,
+	 1.0533610359548358, 1.0539696569080244, 1.0545786295160129,
+	 1.0551879539819844, 1.0557976305092382, 1.056407659301192,
+	 1.0570180405613803, 1.0576287744934558, 1.0582398613011887,
+	 1.0588513011884666, 1.0594630943592953, 1.0600752410177983,
+	 1.060687741368217, 1.0613005956149109, 1.0619138039623575,
+	 1.0625273666151527, 1.0631412837780103, 1.0637555556557625,
+	 1.0643701824533598, 1.0649851643758714, 1.0656005016284842,
+	 1.0662161944165047, 1.0668322429453576, 1.0674486474205858,
+	 1.0680654080478515, 1.0686825250329359, 1.0692999985817384,
+	 1.069917828900278, 1.0705360161946926, 1.0711545606712389,
+	 1.0717734625362931, 1.0723927219963505, 1.073012339258026,
+	 1.0736323145280531, 1.0742526480132857, 1.0748733399206964,
+	 1.0754943904573782, 1.0761157998305431, 1.0767375682475231,
+	 1.0773596959157699, 1.0779821830428551, 1.0786050298364704,
+	 1.0792282365044272, 1.0798518032546571, 1.0804757302952119,
+	 1.0811000178342638, 1.0817246660801048, 1.0823496752411474,
+	 1.0829750455259248, 1.0836007771430904, 1.0842268703014184,
+	 1.0848533252098034, 1.0854801420772606, 1.0861073211129266,
+	 1.086734862526058, 1.087362766526033, 1.0879910333223501,
+	 1.0886196631246297, 1.0892486561426122, 1.0898780125861605,
+	 1.0905077326652577, 1.0911378165900085, 1.0917682645706395,
+	 1.092399076817498, 1.0930302535410534, 1.0936617949518963,
+	 1.0942937012607394, 1.0949259726784171, 1.0955586094158851,
+	 1.0961916116842214, 1.0968249796946259, 1.0974587136584208,
+	 1.0980928137870498, 1.0987272802920793, 1.0993621133851976,
+	 1.0999973132782155, 1.1006328801830663, 1.1012688143118052,
+	 1.1019051158766107, 1.1025417850897834, 1.1031788221637464,
+	 1.1038162273110461, 1.1044540007443515, 1.1050921426764542,
+	 1.1057306533202689, 1.1063695328888334, 1.1070087815953085,
+	 1.1076483996529782, 1.10828838727525, 1.1089287446756544,
+	 1.1095694720678451, 1.1102105696655995, 1.1108520376828186,
+	 1.1114938763335267, 1.1121360858318723, 1.1127786663921269,
+	 1.1134216182286862, 1.1140649415560702, 1.1147086365889221,
+	 1.1153527035420092, 1.1159971426302233, 1.1166419540685801,
+	 1.11728713807222, 1.1179326948564068, 1.1185786246365295,
+	 1.119224927628101, 1.1198716040467591, 1.1205186541082661,
+	 1.1211660780285089, 1.121813876023499, 1.122462048309373,
+	 1.1231105951023923, 1.1237595166189429, 1.1244088130755365,
+	 1.1250584846888094, 1.1257085316755231, 1.1263589542525645,
+	 1.1270097526369458, 1.1276609270458045, 1.1283124776964033,
+	 1.1289644048061311, 1.1296167085925022, 1.1302693892731559,
+	 1.1309224470658581, 1.1315758821885002, 1.1322296948590993,
+	 1.1328838852957985, 1.1335384537168676, 1.1341934003407017,
+	 1.1348487253858224, 1.1355044290708773, 1.1361605116146412,
+	 1.1368169732360141, 1.1374738141540233, 1.1381310345878224,
+	 1.1387886347566916, 1.139446614880038, 1.1401049751773951,
+	 1.1407637158684236, 1.1414228371729109, 1.1420823393107715,
+	 1.1427422225020469, 1.1434024869669057, 1.1440631329256439,
+	 1.1447241605986846, 1.1453855702065785, 1.1460473619700031,
+	 1.1467095361097643, 1.147372092846795, 1.1480350324021558,
+	 1.1486983549970351, 1.1493620608527491, 1.1500261501907421,
+	 1.150690623232586, 1.1513554801999808, 1.1520207213147549,
+	 1.1526863467988642, 1.1533523568743937, 1.1540187517635561,
+	 1.1546855316886926, 1.1553526968722729, 1.1560202475368957,
+	 1.1566881839052874, 1.1573565062003039, 1.1580252146449295,
+	 1.1586943094622772, 1.1593637908755894, 1.160033659108237,
+	 1.1607039143837201, 1.1613745569256682, 1.1620455869578397,
+	 1.1627170047041222, 1.1633888103885333, 1.1640610042352191,
+	 1.1647335864684558, 1.1654065573126493, 1.1660799169923348,
+	 1.1667536657321773, 1.1674278037569719, 1.168102331291643,
+	 1.1687772485612455, 1.1694525557909643, 1.1701282532061141,
+	 1.1708043410321398, 1.1714808194946171, 1.1721576888192515,
+	 1.1728349492318788, 1.1735126009584658, 1.1741906442251095,
+	 1.1748690792580376, 1.1755479062836087, 1.1762271255283119,
+	 1.1769067372187674, 1.177586741581726, 1.1782671388440702,
+	 1.1789479292328127, 1.179629112975098, 1.1803106902982017,
+	 1.1809926614295303, 1.1816750265966227, 1.1823577860271481,
+	 1.1830409399489081, 1.1837244885898353, 1.1844084321779946,
+	 1.1850927709415822, 1.1857775051089261, 1.186462634908487,
+	 1.1871481605688565, 1.187834082318759, 1.1885204003870511,
+	 1.189207115002721, 1.18989422639489, 1.1905817347928112,
+	 1.1912696404258705, 1.1919579435235859, 1.1926466443156085,
+	 1.193335743031722, 1.1940252399018425, 1.1947151351560195,
+	 1.1954054290244347, 1.1960961217374038, 1.1967872135253748,
+	 1.1974787046189286, 1.1981705952487804, 1.1988628856457777,
+	 1.199555576040902, 1.2002486666652676, 1.2009421577501234,
+	 1.2016360495268508, 1.2023303422269653, 1.2030250360821166,
+	 1.2037201313240877, 1.2044156281847955, 1.2051115268962915,
+	 1.2058078276907604, 1.2065045308005218, 1.2072016364580294,
+	 1.2078991448958707, 1.2085970563467681, 1.2092953710435783,
+	 1.2099940892192926, 1.210693211107037, 1.2113927369400719,
+	 1.2120926669517926, 1.2127930013757293, 1.2134937404455475,
+	 1.214194884395047, 1.2148964334581629, 1.215598387868966,
+	 1.2163007478616616, 1.217003513670591, 1.2177066855302303,
+	 1.2184102636751912, 1.2191142483402215, 1.219818639760204,
+	 1.2205234381701575, 1.2212286438052364, 1.2219342569007314,
+	 1.2226402776920684, 1.2233467064148102, 1.2240535433046553,
+	 1.2247607885974379, 1.2254684425291293, 1.2261765053358369,
+	 1.226884977253804, 1.2275938585194111, 1.2283031493691747,
+	 1.2290128500397486, 1.2297229607679225, 1.230433481790624,
+	 1.2311444133449163, 1.2318557556680005, 1.2325675089972148,
+	 1.2332796735700338, 1.2339922496240701, 1.2347052373970728,
+	 1.2354186371269291, 1.2361324490516634, 1.2368466734094374,
+	 1.2375613104385508, 1.2382763603774405, 1.2389918234646813,
+	 1.2397076999389867, 1.2404239900392067, 1.2411406940043301,
+	 1.241857812073484, 1.2425753444859333, 1.243293291481081,
+	 1.2440116532984689, 1.2447304301777766, 1.2454496223588229,
+	 1.2461692300815645, 1.2468892535860971, 1.2476096931126552,
+	 1.2483305489016119, 1.2490518211934791, 1.249773510228908,
+	 1.2504956162486884, 1.2512181394937498, 1.2519410802051605,
+	 1.2526644386241279, 1.2533882149919993, 1.2541124095502612,
+	 1.2548370225405396, 1.2555620542046, 1.256287504784348,
+	 1.2570133745218284, 1.2577396636592262, 1.2584663724388663,
+	 1.2591935011032136, 1.2599210498948732, 1.26064901905659,
+	 1.2613774088312495, 1.2621062194618775, 1.2628354511916404,
+	 1.2635651042638443, 1.2642951789219368, 1.2650256754095059,
+	 1.26575659397028, 1.2664879348481286, 1.2672196982870623,
+	 1.2679518845312321, 1.2686844938249306, 1.2694175264125915,
+	 1.2701509825387896, 1.2708848624482409, 1.271619166385803,
+	 1.2723538945964745, 1.2730890473253966, 1.2738246248178513,
+	 1.2745606273192622, 1.2752970550751952, 1.2760339083313579,
+	 1.2767711873336001, 1.277508892327913, 1.2782470235604306,
+	 1.2789855812774287, 1.2797245657253258, 1.2804639771506823,
+	 1.2812038158002015, 1.2819440819207288, 1.2826847757592528,
+	 1.2834258975629043, 1.2841674475789568, 1.2849094260548273,
+	 1.2856518332380751, 1.2863946693764032, 1.287137934717657,
+	 1.2878816295098254, 1.2886257540010411, 1.2893703084395791,
+	 1.2901152930738589, 1.290860708152443, 1.2916065539240373,
+	 1.2923528306374923, 1.2930995385418012, 1.2938466778861015,
+	 1.2945942489196749, 1.2953422518919471, 1.2960906870524873,
+	 1.2968395546510096, 1.2975888549373724, 1.2983385881615777,
+	 1.2990887545737726, 1.2998393544242488, 1.3005903879634422,
+	 1.3013418554419336, 1.3020937571104485, 1.3028460932198576,
+	 1.303598864021176, 1.3043520697655642, 1.3051057107043278,
+	 1.3058597870889177, 1.3066142991709295, 1.307369247202105,
+	 1.3081246314343311, 1.3088804521196398, 1.3096367095102093,
+	 1.3103934038583633, 1.3111505354165713, 1.3119081044374488,
+	 1.312666111173757, 1.3134245558784035, 1.3141834388044413,
+	 1.3149427602050709, 1.3157025203336377, 1.3164627194436342,
+	 1.3172233577886994, 1.3179844356226187, 1.318745953199324,
+	 1.3195079107728942, 1.3202703085975549, 1.3210331469276786,
+	 1.3217964260177846, 1.3225601461225394, 1.3233243074967567,
+	 1.3240889103953972, 1.3248539550735694, 1.3256194417865286,
+	 1.3263853707896778, 1.3271517423385681, 1.3279185566888974,
+	 1.3286858140965117, 1.3294535148174049, 1.3302216591077187,
+	 1.3309902472237432, 1.331759279421916, 1.332528755958823,
+	 1.3332986770911985, 1.3340690430759254, 1.3348398541700344,
+	 1.3356111106307049, 1.3363828127152655, 1.3371549606811928,
+	 1.337927554786112, 1.3387005952877982, 1.3394740824441742,
+	 1.3402480165133126, 1.341022397753435, 1.3417972264229119,
+	 1.3425725027802635, 1.343348227084159, 1.3441243995934173,
+	 1.3449010205670067, 1.3456780902640453, 1.3464556089438005,
+	 1.3472335768656902, 1.3480119942892816, 1.3487908614742921,
+	 1.3495701786805889, 1.35034994616819, 1.3511301641972628,
+	 1.3519108330281258, 1.3526919529212473, 1.3534735241372464,
+	 1.3542555469368927, 1.3550380215811066, 1.3558209483309589,
+	 1.3566043274476718, 1.357388159192618, 1.3581724438273213,
+	 1.3589571816134567, 1.3597423728128504, 1.3605280176874797,
+	 1.3613141164994733, 1.3621006695111118, 1.3628876769848266,
+	 1.3636751391832014, 1.3644630563689712, 1.365251428805023,
+	 1.3660402567543954, 1.3668295404802797, 1.3676192802460183,
+	 1.3684094763151067, 1.3692001289511917, 1.3699912384180732,
+	 1.3707828049797035, 1.3715748289001866, 1.3723673104437799,
+	 1.3731602498748932, 1.3739536474580891, 1.3747475034580832,
+	 1.3755418181397439, 1.3763365917680923, 1.3771318246083033,
+	 1.3779275169257048, 1.3787236689857776, 1.3795202810541565,
+	 1.3803173533966291, 1.3811148862791374, 1.381912879967776,
+	 1.3827113347287945, 1.3835102508285952, 1.3843096285337351,
+	 1.3851094681109246, 1.3859097698270291, 1.3867105339490668,
+	 1.3875117607442118, 1.3883134504797912, 1.3891156034232874,
+	 1.389918219842337, 1.3907213000047314, 1.3915248441784165,
+	 1.392328852631493, 1.3931333256322171, 1.3939382634489994,
+	 1.3947436663504054, 1.3955495346051565, 1.3963558684821289,
+	 1.3971626682503542, 1.3979699341790195, 1.3987776665374674,
+	 1.3995858655951958, 1.4003945316218593, 1.4012036648872672,
+	 1.4020132656613853, 1.4028233342143352, 1.4036338708163945,
+	 1.4044448757379973, 1.4052563492497334, 1.4060682916223495,
+	 1.4068807031267483, 1.4076935840339895, 1.408506934615289,
+	 1.4093207551420195, 1.4101350458857105, 1.4109498071180484,
+	 1.4117650391108769, 1.4125807421361962, 1.4133969164661639,
+	 1.4142135623730951, 1.4150306801294619, 1.4158482700078938,
+	 1.4166663322811781, 1.4174848672222597, 1.4183038751042412,
+	 1.4191233562003824, 1.419943310784102, 1.4207637391289758,
+	 1.4215846415087381, 1.4224060181972815, 1.4232278694686562,
+	 1.4240501955970717, 1.4248729968568952, 1.4256962735226524,
+	 1.426520025869028, 1.4273442541708656, 1.428168958703167,
+	 1.428994139741093, 1.4298197975599638, 1.4306459324352585,
+	 1.4314725446426149, 1.4322996344578307, 1.4331272021568628,
+	 1.4339552480158273, 1.4347837723110002, 1.4356127753188166,
+	 1.4364422573158719, 1.4372722185789211, 1.4381026593848789,
+	 1.4389335800108201, 1.4397649807339798, 1.4405968618317528,
+	 1.4414292235816952, 1.4422620662615222, 1.4430953901491104,
+	 1.4439291955224962, 1.4447634826598772, 1.4455982518396118,
+	 1.4464335033402187, 1.4472692374403782, 1.4481054544189307,
+	 1.4489421545548788, 1.4497793381273858, 1.4506170054157757,
+	 1.4514551566995351, 1.452293792258311, 1.4531329123719126,
+	 1.4539725173203106, 1.4548126073836374, 1.4556531828421873,
+	 1.4564942439764168, 1.4573357910669438, 1.4581778243945491,
+	 1.4590203442401755, 1.4598633508849272, 1.4607068446100726,
+	 1.4615508256970413, 1.4623952944274257, 1.4632402510829809,
+	 1.4640856959456254, 1.4649316292974399, 1.4657780514206682,
+	 1.4666249625977175, 1.4674723631111579, 1.4683202532437227,
+	 1.4691686332783092, 1.4700175034979768, 1.4708668641859499,
+	 1.4717167156256157, 1.4725670581005257, 1.4734178918943945,
+	 1.4742692172911012, 1.4751210345746888, 1.4759733440293645,
+	 1.4768261459394993, 1.477679440589629, 1.4785332282644537,
+	 1.4793875092488373, 1.4802422838278098, 1.4810975522865641,
+	 1.4819533149104596, 1.4828095719850189, 1.4836663237959311,
+	 1.4845235706290492, 1.4853813127703919, 1.4862395505061434,
+	 1.4870982841226525, 1.4879575139064345, 1.4888172401441691,
+	 1.4896774631227023, 1.4905381831290458, 1.4913994004503772,
+	 1.4922611153740395, 1.4931233281875427, 1.4939860391785615,
+	 1.4948492486349383, 1.495712956844681, 1.4965771640959642,
+	 1.4974418706771284, 1.4983070768766815, 1.4991727829832977,
+	 1.5000389892858181, 1.5009056960732505, 1.5017729036347702,
+	 1.5026406122597187, 1.5035088222376056, 1.5043775338581071,
+	 1.5052467474110671, 1.5061164631864972, 1.5069866814745758,
+	 1.5078574025656499, 1.5087286267502333, 1.5096003543190084,
+	 1.5104725855628256, 1.5113453207727026, 1.5122185602398257,
+	 1.51309230425555, 1.5139665531113977, 1.5148413070990603,
+	 1.515716566510398, 1.5165923316374392, 1.5174686027723809,
+	 1.5183453802075892, 1.5192226642355993, 1.5201004551491148,
+	 1.5209787532410093, 1.5218575588043248, 1.5227368721322732,
+	 1.5236166935182354, 1.524497023255762, 1.5253778616385731,
+	 1.5262592089605591, 1.5271410655157793, 1.5280234315984633,
+	 1.5289063075030109, 1.5297896935239916, 1.5306735899561454,
+	 1.5315579970943829, 1.5324429152337842, 1.5333283446696007,
+	 1.5342142856972538, 1.5351007386123361, 1.5359877037106111,
+	 1.5368751812880124, 1.5377631716406452, 1.5386516750647856,
+	 1.5395406918568812, 1.5404302223135502, 1.5413202667315831,
+	 1.5422108254079407, 1.5431018986397569, 1.5439934867243359,
+	 1.544885589959154, 1.5457782086418603, 1.5466713430702748,
+	 1.5475649935423899, 1.5484591603563704, 1.549353843810553,
+	 1.5502490442034471, 1.5511447618337346, 1.5520409970002698,
+	 1.5529377500020793, 1.5538350211383636, 1.5547328107084948,
+	 1.5556311190120187, 1.5565299463486539, 1.5574292930182927,
+	 1.5583291593209998, 1.559229545557014, 1.5601304520267469,
+	 1.5610318790307847, 1.5619338268698864, 1.5628362958449848,
+	 1.5637392862571871, 1.5646427984077742, 1.5655468325982007,
+	 1.5664513891300962, 1.5673564683052639, 1.5682620704256816,
+	 1.5691681957935015, 1.5700748447110506, 1.5709820174808302,
+	 1.5718897144055171, 1.5727979357879622, 1.5737066819311916,
+	 1.5746159531384067, 1.575525749712984, 1.5764360719584751,
+	 1.5773469201786072, 1.5782582946772832, 1.5791701957585809,
+	 1.5800826237267545, 1.5809955788862333, 1.5819090615416234,
+	 1.5828230719977061, 1.5837376105594394, 1.5846526775319569,
+	 1.5855682732205689, 1.5864843979307621, 1.5874010519681994,
+	 1.5883182356387209, 1.5892359492483425, 1.5901541931032581,
+	 1.5910729675098374, 1.5919922727746276, 1.5929121092043532,
+	 1.5938324771059156, 1.5947533767863937, 1.5956748085530439,
+	 1.5965967727132999, 1.5975192695747729, 1.5984422994452523,
+	 1.5993658626327052, 1.6002899594452764, 1.6012145901912891,
+	 1.6021397551792442, 1.6030654547178211, 1.6039916891158776,
+	 1.6049184586824501, 1.6058457637267529, 1.6067736045581797,
+	 1.6077019814863029, 1.608630894820873, 1.6095603448718205,
+	 1.6104903319492543, 1.6114208563634627, 1.6123519184249131,
+	 1.6132835184442524, 1.6142156567323076, 1.615148333600084,
+	 1.6160815493587677, 1.6170153043197242, 1.6179495987944987,
+	 1.6188844330948169, 1.619819807532584, 1.6207557224198861,
+	 1.621692178068989, 1.6226291747923394, 1.6235667129025642,
+	 1.6245047927124709, 1.6254434145350483, 1.6263825786834654,
+	 1.6273222854710725, 1.6282625352114004, 1.6292033282181622,
+	 1.6301446648052507, 1.6310865452867416, 1.6320289699768911,
+	 1.6329719391901372, 1.6339154532411, 1.6348595124445804,
+	 1.6358041171155622, 1.6367492675692108, 1.6376949641208738,
+	 1.6386412070860805, 1.6395879967805433, 1.6405353335201562,
+	 1.6414832176209966, 1.6424316493993241, 1.6433806291715807,
+	 1.6443301572543914, 1.6452802339645647, 1.6462308596190915,
+	 1.6471820345351462, 1.6481337590300864, 1.6490860334214528,
+	 1.6500388580269698, 1.6509922331645457, 1.6519461591522715,
+	 1.6529006363084233, 1.6538556649514602, 1.6548112454000257,
+	 1.6557673779729467, 1.6567240629892352, 1.6576813007680873,
+	 1.6586390916288833, 1.6595974358911882, 1.6605563338747515,
+	 1.6615157858995075, 1.6624757922855755, 1.6634363533532597,
+	 1.664397469423049, 1.6653591408156181, 1.6663213678518267,
+	 1.6672841508527196, 1.6682474901395274, 1.6692113860336666,
+	 1.6701758388567387, 1.6711408489305315, 1.672106416577019,
+	 1.6730725421183601, 1.674039225876901, 1.675006468175174,
+	 1.6759742693358972, 1.6769426296819754, 1.6779115495365002,
+	 1.6788810292227496, 1.6798510690641884, 1.6808216693844686,
+	 1.681792830507429, 1.6827645527570956, 1.683736836457681,
+	 1.6847096819335861, 1.6856830895093986, 1.6866570595098942,
+	 1.6876315922600358, 1.6886066880849742, 1.689582347310048,
+	 1.6905585702607839, 1.6915353572628971, 1.69251270864229,
+	 1.6934906247250543, 1.6944691058374695, 1.6954481523060039,
+	 1.696427764457314, 1.6974079426182458, 1.6983886871158334,
+	 1.6993699982773005, 1.7003518764300594, 1.7013343219017114,
+	 1.7023173350200478, 1.7033009161130488, 1.7042850655088841,
+	 1.7052697835359134, 1.7062550705226855, 1.7072409267979396,
+	 1.7082273526906044, 1.709214348529799, 1.7102019146448326,
+	 1.7111900513652045, 1.7121787590206043, 1.7131680379409124,
+	 1.7141578884561999, 1.7151483108967283, 1.7161393055929497,
+	 1.7171308728755075, 1.7181230130752365, 1.7191157265231616,
+	 1.7201090135505002, 1.7211028744886601, 1.7220973096692411,
+	 1.7230923194240344, 1.7240879040850228, 1.7250840639843812,
+	 1.7260807994544765, 1.727078110827867, 1.728075998437304,
+	 1.7290744626157304, 1.7300735036962818, 1.7310731220122859,
+	 1.7320733178972638, 1.7330740916849285, 1.7340754437091863,
+	 1.7350773743041359, 1.7360798838040694, 1.7370829725434724,
+	 1.7380866408570232, 1.7390908890795937, 1.740095717546249,
+	 1.7411011265922482, 1.742107116553044, 1.743113687764283,
+	 1.7441208405618054, 1.7451285752816457, 1.7461368922600324,
+	 1.7471457918333886, 1.7481552743383313, 1.7491653401116725,
+	 1.7501759894904185, 1.7511872228117704, 1.752199040413124,
+	 1.7532114426320702, 1.7542244298063949, 1.7552380022740792,
+	 1.7562521603732995, 1.7572669044424274, 1.7582822348200304,
+	 1.7592981518448711, 1.7603146558559086, 1.7613317471922969,
+	 1.7623494261933865, 1.7633676931987241, 1.7643865485480521,
+	 1.7654059925813097, 1.7664260256386322, 1.7674466480603517,
+	 1.7684678601869965, 1.7694896623592922, 1.7705120549181605,
+	 1.771535038204721, 1.7725586125602901, 1.7735827783263809,
+	 1.7746075358447044, 1.7756328854571686, 1.7766588275058794,
+	 1.7776853623331403, 1.7787124902814526, 1.7797402116935153,
+	 1.7807685269122255, 1.7817974362806785, 1.7828269401421679,
+	 1.7838570388401853, 1.7848877327184212, 1.7859190221207644,
+	 1.7869509073913026, 1.787983388874322, 1.7890164669143078,
+	 1.7900501418559449, 1.7910844140441162, 1.7921192838239048,
+	 1.793154751540593, 1.7941908175396621, 1.7952274821667935,
+	 1.7962647457678684, 1.7973026086889676, 1.7983410712763717,
+	 1.7993801338765618, 1.800419796836219, 1.8014600605022246,
+	 1.8025009252216604, 1.8035423913418089, 1.8045844592101532,
+	 1.8056271291743768, 1.8066704015823645, 1.8077142767822019,
+	 1.8087587551221762, 1.809803836950775, 1.8108495226166879,
+	 1.8118958124688058, 1.8129427068562207, 1.8139902061282276,
+	 1.8150383106343217, 1.8160870207242013, 1.8171363367477662,
+	 1.8181862590551185, 1.8192367879965627, 1.8202879239226057,
+	 1.8213396671839568, 1.8223920181315278, 1.8234449771164336,
+	 1.8244985444899917, 1.8255527206037225, 1.8266075058093501,
+	 1.827662900458801, 1.8287189049042059, 1.829775519497898,
+	 1.8308327445924149, 1.8318905805404972, 1.8329490276950904,
+	 1.8340080864093424, 1.8350677570366065, 1.8361280399304396,
+	 1.8371889354446023, 1.8382504439330609, 1.8393125657499854,
+	 1.8403753012497501, 1.8414386507869351, 1.8425026147163244,
+	 1.8435671933929072, 1.8446323871718784, 1.8456981964086376,
+	 1.8467646214587898, 1.8478316626781455, 1.8488993204227206,
+	 1.8499675950487373, 1.851036486912623, 1.8521059963710111,
+	 1.8531761237807418, 1.8542468694988603, 1.8553182338826191,
+	 1.8563902172894762, 1.8574628200770971, 1.8585360426033535,
+	 1.8596098852263236, 1.8606843483042932, 1.8617594321957542,
+	 1.8628351372594065, 1.8639114638541565, 1.8649884123391189,
+	 1.8660659830736148, 1.8671441764171739, 1.8682229927295326,
+	 1.8693024323706362, 1.8703824957006374, 1.8714631830798971,
+	 1.8725444948689844, 1.873626431428677, 1.8747089931199601,
+	 1.8757921803040289, 1.8768759933422863, 1.8779604325963442,
+	 1.8790454984280236, 1.8801311911993546, 1.8812175112725757,
+	 1.8823044590101363, 1.883392034774694, 1.8844802389291158,
+	 1.885569071836479, 1.8866585338600705, 1.8877486253633868,
+	 1.8888393467101352, 1.8899306982642323, 1.8910226803898054,
+	 1.8921152934511918, 1.8932085378129397, 1.8943024138398081,
+	 1.8953969218967663, 1.8964920623489947, 1.8975878355618847,
+	 1.8986842419010386, 1.8997812817322699, 1.9008789554216041,
+	 1.9019772633352776, 1.9030762058397388, 1.9041757833016473,
+	 1.9052759960878749, 1.9063768445655052, 1.9074783291018342,
+	 1.9085804500643702, 1.9096832078208332, 1.910786602739156,
+	 1.9118906351874843, 1.9129953055341762, 1.9141006141478025,
+	 1.9152065613971474, 1.9163131476512076, 1.9174203732791937,
+	 1.9185282386505287, 1.9196367441348501, 1.9207458901020085,
+	 1.9218556769220678, 1.9229661049653062, 1.9240771746022158,
+	 1.9251888862035027, 1.9263012401400872, 1.9274142367831038,
+	 1.9285278765039016, 1.9296421596740441, 1.9307570866653094,
+	 1.931872657849691, 1.932988873599397, 1.93410573428685,
+	 1.9352232402846885, 1.9363413919657662, 1.9374601897031518,
+	 1.93857963387013, 1.939699724840201, 1.9408204629870811,
+	 1.941941848684702, 1.9430638823072117, 1.9441865642289746,
+	 1.9453098948245711, 1.9464338744687979, 1.9475585035366689,
+	 1.9486837824034142, 1.9498097114444806, 1.9509362910355319,
+	 1.9520635215524493, 1.9531914033713307, 1.9543199368684918,
+	 1.9554491224204655, 1.956578960404002, 1.9577094511960693,
+	 1.9588405951738537, 1.9599723927147588, 1.9611048441964067,
+	 1.9622379499966374, 1.9633717104935091, 1.9645061260652987,
+	 1.9656411970905021, 1.966776923947833, 1.9679133070162242,
+	 1.9690503466748279, 1.970188043303015, 1.9713263972803752,
+	 1.9724654089867184, 1.9736050788020734, 1.9747454071066886,
+	 1.9758863942810323, 1.9770280407057923, 1.9781703467618768,
+	 1.9793133128304137, 1.9804569392927516, 1.9816012265304588,
+	 1.9827461749253243, 1.9838917848593578, 1.9850380567147898,
+	 1.9861849908740719, 1.9873325877198755, 1.9884808476350948,
+	 1.9896297710028437, 1.9907793582064581, 1.9919296096294958,
+	 1.9930805256557356, 1.9942321066691784, 1.9953843530540467,
+	 1.996537265194785, 1.9976908434760603, 1.9988450882827615,
+};
+
+static const double period_fine_lut[128] = {
+	 1, 1.0000045126871389, 1.0000090253946421,
+	 1.0000135381225099, 1.0000180508707421, 1.0000225636393389,
+	 1.0000270764283006, 1.0000315892376268, 1.0000361020673181,
+	 1.0000406149173744, 1.0000451277877958, 1.0000496406785822,
+	 1.000054153589734, 1.000058666521251, 1.0000631794731336,
+	 1.0000676924453817, 1.0000722054379956, 1.0000767184509749,
+	 1.0000812314843202, 1.0000857445380313, 1.0000902576121087,
+	 1.0000947707065519, 1.0000992838213614, 1.0001037969565372,
+	 1.0001083101120791, 1.0001128232879877, 1.0001173364842628,
+	 1.0001218497009046, 1.0001263629379131, 1.0001308761952885,
+	 1.0001353894730307, 1.00013990277114, 1.0001444160896162,
+	 1.0001489294284598, 1.0001534427876706, 1.0001579561672489,
+	 1.0001624695671945, 1.0001669829875077, 1.0001714964281887,
+	 1.0001760098892374, 1.0001805233706538, 1.0001850368724381,
+	 1.0001895503945906, 1.0001940639371112, 1.0001985775,
+	 1.0002030910832569, 1.0002076046868824, 1.0002121183108763,
+	 1.0002166319552388, 1.0002211456199699, 1.0002256593050698,
+	 1.0002301730105385, 1.0002346867363763, 1.0002392004825831,
+	 1.0002437142491589, 1.0002482280361038, 1.0002527418434184,
+	 1.000257255671102, 1.0002617695191554, 1.0002662833875782,
+	 1.0002707972763707, 1.0002753111855329, 1.0002798251150651,
+	 1.0002843390649674, 1.0002888530352394, 1.0002933670258818,
+	 1.0002978810368943, 1.000302395068277, 1.0003069091200303,
+	 1.0003114231921542, 1.0003159372846484, 1.0003204513975135,
+	 1.0003249655307493, 1.000329479684356, 1.0003339938583335,
+	 1.0003385080526823, 1.0003430222674021, 1.0003475365024932,
+	 1.0003520507579557, 1.0003565650337896, 1.0003610793299949,
+	 1.0003655936465718, 1.0003701079835206, 1.000374622340841,
+	 1.0003791367185333, 1.0003836511165975, 1.000388165535034,
+	 1.0003926799738425, 1.0003971944330232, 1.0004017089125763,
+	 1.000406223412502, 1.0004107379328, 1.0004152524734706,
+	 1.0004197670345141, 1.0004242816159303, 1.0004287962177194,
+	 1.0004333108398815, 1.0004378254824167, 1.0004423401453251,
+	 1.0004468548286065, 1.0004513695322617, 1.0004558842562901,
+	 1.0004603990006919, 1.0004649137654675, 1.0004694285506168,
+	 1.0004739433561398, 1.0004784581820367, 1.0004829730283078,
+	 1.000487487894953, 1.0004920027819721, 1.0004965176893656,
+	 1.0005010326171335, 1.000505547565276, 1.0005100625337928,
+	 1.0005145775226845, 1.0005190925319507, 1.0005236075615918,
+	 1.0005281226116078, 1.000532637681999, 1.0005371527727651,
+	 1.0005416678839063, 1.000546183015423, 1.0005506981673149,
+	 1.0005552133395823, 1.0005597285322254, 1.000564243745244,
+	 1.0005687589786385, 1.0005732742324087,
+};
+
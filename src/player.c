@@ -28,9 +28,12 @@
 #include "virtual.h"
 #include "period.h"
 #include "effects.h"
+#include "envelope.h"
 #include "player.h"
 #include "synth.h"
 #include "mixer.h"
+#include "snapshot.h"
+#include "loaders/loader.h"
 
 /* Values for multi-retrig */
 static const struct retrig_control rval[] = {
@@ -68,8 +71,73 @@ static const int invloop_table[] = {
 	0, 5, 6, 7, 8, 10, 11, 13, 16, 19, 22, 26, 32, 43, 64, 128
 };
 
-static void update_invloop(struct module_data *m, struct channel_data *xc)
+/* Loaded sample data is never changed, since it can be shared with other
+ * players or mapped from the module file. The first time a sample is
+ * inverted, this player switches to a private copy of it.
+ */
+static struct xmp_sample *invloop_sample(struct context_data *ctx, int smp)
 {
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+	struct xmp_module *mod = &m->mod;
+	struct xmp_sample *xxs;
+	struct mixer_voice *vi;
+	uint8 *data;
+	int i;
+
+	if (p->invloop.xxs == NULL) {
+		/* Samples loaded later would only be in the private list */
+		load_lazy_samples(m);
+
+		xxs = malloc(mod->smp * sizeof (struct xmp_sample));
+		if (xxs == NULL)
+			return NULL;
+		memcpy(xxs, mod->xxs, mod->smp * sizeof (struct xmp_sample));
+		p->invloop.orig = mod->xxs;
+		p->invloop.xxs = mod->xxs = xxs;
+	}
+
+	xxs = &p->invloop.xxs[smp];
+
+	if (xxs->data == p->invloop.orig[smp].data) {
+		if ((data = copy_sample(xxs)) == NULL)
+			return NULL;
+
+		/* Voices already playing the sample follow the copy */
+		for (i = 0; i < p->virt.maxvoc; i++) {
+			vi = &p->virt.voice_array[i];
+			if (vi->sptr == xxs->data)
+				vi->sptr = data;
+		}
+
+		xxs->data = data;
+	}
+
+	return xxs;
+}
+
+static void release_invloop(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+	int i;
+
+	if (p->invloop.xxs == NULL)
+		return;
+
+	for (i = 0; i < m->mod.smp; i++) {
+		if (p->invloop.xxs[i].data != p->invloop.orig[i].data)
+			free_sample(p->invloop.xxs[i].data);
+	}
+
+	m->mod.xxs = p->invloop.orig;
+	free(p->invloop.xxs);
+	p->invloop.xxs = NULL;
+}
+
+static void update_invloop(struct context_data *ctx, struct channel_data *xc)
+{
+	struct module_data *m = &ctx->m;
 	struct xmp_sample *xxs = &m->mod.xxs[xc->smp];
 	int len;
 
@@ -87,6 +155,9 @@ static void update_invloop(struct module_data *m, struct channel_data *xc)
 			}
 
 			if (~xxs->flg & XMP_SAMPLE_16BIT) {
+				xxs = invloop_sample(ctx, xc->smp);
+				if (xxs == NULL)
+					return;
 				xxs->data[xxs->lps + xc->invloop.pos] ^= 0xff;
 			}
 		}
@@ -159,15 +230,26 @@ static inline void read_row(struct context_data *ctx, int pat, int row)
 	int count, chn;
 	struct module_data *m = &ctx->m;
 	struct xmp_module *mod = &m->mod;
+	struct xmp_track **track = PATTERN_TRACKS(pat);
 	struct xmp_event *event;
 	int control[XMP_MAX_CHANNELS];
+	uint64 row_events = ~(uint64)0;
+
+	if (m->row_events != NULL && row < mod->xxp[pat]->rows) {
+		row_events = m->row_events[m->row_index[pat] + row];
+	}
 
 	count = 0;
 	for (chn = 0; chn < mod->chn; chn++) {
 		control[chn] = 0;
 
-		if (row < mod->xxt[TRACK_NUM(pat, chn)]->rows) {
-			event = &EVENT(pat, chn, row);
+		if (~row_events & ((uint64)1 << chn)) {
+			read_empty_event(ctx, chn);
+			continue;
+		}
+
+		if (row < track[chn]->rows) {
+			event = &track[chn]->event[row];
 		} else {
 			event = (struct xmp_event *)&empty_event;
 		}
@@ -182,8 +264,8 @@ static inline void read_row(struct context_data *ctx, int pat, int row)
 
 	for (chn = 0; count > 0; chn++) {
 		if (control[chn]) {
-			if (row < mod->xxt[TRACK_NUM(pat, chn)]->rows) {
-				event = &EVENT(pat, chn, row);
+			if (row < track[chn]->rows) {
+				event = &track[chn]->event[row];
 			} else {
 				event = (struct xmp_event *)&empty_event;
 			}
@@ -199,12 +281,14 @@ static inline void read_row(struct context_data *ctx, int pat, int row)
  * Update channel data
  */
 
-static void process_volume(struct context_data *ctx, int chn, int t, int act)
+static void process_volume(struct context_data *ctx, int chn, int t, int act,
+			int advance)
 {
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
 	struct channel_data *xc = &p->xc_data[chn];
 	struct xmp_instrument *instrument = &m->mod.xxi[xc->ins];
+	struct instrument_envelopes *xxe = &m->xxe[xc->ins];
 	int finalvol;
 	uint16 vol_envelope;
 	int gvol;
@@ -220,8 +304,8 @@ static void process_volume(struct context_data *ctx, int chn, int t, int act)
 			xc->fadeout = 0;
 	}
 
-	if (TEST(FADEOUT | RELEASE) || act == VIRT_ACTION_FADE
-	    || act == VIRT_ACTION_OFF) {
+	if (advance && (TEST(FADEOUT | RELEASE) || act == VIRT_ACTION_FADE
+	    || act == VIRT_ACTION_OFF)) {
 		if (xc->fadeout > instrument->rls) {
 			xc->fadeout -= instrument->rls;
 		} else {
@@ -245,7 +329,7 @@ static void process_volume(struct context_data *ctx, int chn, int t, int act)
 		}
 	}
 
-	switch (check_envelope_fade(&instrument->aei, xc->v_idx)) {
+	switch (check_envelope_fade(&xxe->aei, xc->v_idx)) {
 	case -1:
 		virt_resetchannel(ctx, chn);
 		break;
@@ -257,8 +341,9 @@ static void process_volume(struct context_data *ctx, int chn, int t, int act)
 		}
 	}
 
-	vol_envelope = get_envelope(&instrument->aei, xc->v_idx, 64);
-	xc->v_idx = update_envelope(&instrument->aei, xc->v_idx, DOENV_RELEASE);
+	vol_envelope = get_envelope(&xxe->aei, xc->v_idx, 64, &xc->v_seg);
+	if (advance)
+		xc->v_idx = update_envelope(&xxe->aei, xc->v_idx, DOENV_RELEASE);
 
 	finalvol = xc->volume;
 
@@ -295,7 +380,7 @@ static void process_volume(struct context_data *ctx, int chn, int t, int act)
 		finalvol = (finalvol * instrument->vol * xc->gvl) >> 12;
 	}
 
-	if (xc->tremor.val) {
+	if (xc->tremor.val && advance) {
 		if (xc->tremor.count == 0) {
 			/* end of down cycle, set up counter for up  */
 			xc->tremor.count = MSN(xc->tremor.val) | 0x80;
@@ -305,10 +390,10 @@ static void process_volume(struct context_data *ctx, int chn, int t, int act)
 		}
 
 		xc->tremor.count--;
+	}
 
-		if (~xc->tremor.count & 0x80) {
-			finalvol = 0;
-		}
+	if (xc->tremor.val && (~xc->tremor.count & 0x80)) {
+		finalvol = 0;
 	}
 
 	xc->info_finalvol = finalvol;
@@ -316,23 +401,26 @@ static void process_volume(struct context_data *ctx, int chn, int t, int act)
 	virt_setvol(ctx, chn, finalvol);
 }
 
-static void process_frequency(struct context_data *ctx, int chn, int t, int act)
+static void process_frequency(struct context_data *ctx, int chn, int t, int act,
+			int advance)
 {
 	struct mixer_data *s = &ctx->s;
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
 	struct channel_data *xc = &p->xc_data[chn];
 	struct xmp_instrument *instrument = &m->mod.xxi[xc->ins];
+	struct instrument_envelopes *xxe = &m->xxe[xc->ins];
 	int linear_bend;
 	int frq_envelope;
 	int arp, vibrato, cutoff, resonance;
 
-	frq_envelope = get_envelope(&instrument->fei, xc->f_idx, 0);
-	xc->f_idx = update_envelope(&instrument->fei, xc->f_idx, DOENV_RELEASE);
+	frq_envelope = get_envelope(&xxe->fei, xc->f_idx, 0, &xc->f_seg);
+	if (advance)
+		xc->f_idx = update_envelope(&xxe->fei, xc->f_idx, DOENV_RELEASE);
 
 	/* Do note slide */
 
-	if (TEST(NOTE_SLIDE)) {
+	if (TEST(NOTE_SLIDE) && advance) {
 		xc->noteslide.count--;
 		if (xc->noteslide.count == 0) {
 			xc->note += xc->noteslide.slide;
@@ -398,18 +486,20 @@ static void process_frequency(struct context_data *ctx, int chn, int t, int act)
 	virt_seteffect(ctx, chn, DSP_EFFECT_CUTOFF, cutoff);
 }
 
-static void process_pan(struct context_data *ctx, int chn, int t, int act)
+static void process_pan(struct context_data *ctx, int chn, int t, int act,
+			int advance)
 {
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
 	struct mixer_data *s = &ctx->s;
 	struct channel_data *xc = &p->xc_data[chn];
-	struct xmp_instrument *instrument = &m->mod.xxi[xc->ins];
+	struct instrument_envelopes *xxe = &m->xxe[xc->ins];
 	int finalpan;
 	int pan_envelope;
 
-	pan_envelope = get_envelope(&instrument->pei, xc->p_idx, 32);
-	xc->p_idx = update_envelope(&instrument->pei, xc->p_idx, DOENV_RELEASE);
+	pan_envelope = get_envelope(&xxe->pei, xc->p_idx, 32, &xc->p_seg);
+	if (advance)
+		xc->p_idx = update_envelope(&xxe->pei, xc->p_idx, DOENV_RELEASE);
 
 	finalpan = xc->pan + (pan_envelope - 32) *
 				(128 - abs(xc->pan - 128)) / 32;
@@ -625,9 +715,9 @@ static void play_channel(struct context_data *ctx, int chn, int t)
 		}
         }
    
-	process_volume(ctx, chn, t, act);
-	process_frequency(ctx, chn, t, act);
-	process_pan(ctx, chn, t, act);
+	process_volume(ctx, chn, t, act, 1);
+	process_frequency(ctx, chn, t, act, 1);
+	process_pan(ctx, chn, t, act, 1);
 
 	update_volume(ctx, chn, t);
 	update_frequency(ctx, chn, t);
@@ -640,12 +730,32 @@ static void play_channel(struct context_data *ctx, int chn, int t)
 	}
 
 	if (HAS_QUIRK(QUIRK_INVLOOP)) {
-		update_invloop(m, xc);
+		update_invloop(ctx, xc);
 	}
 
 	xc->info_position = virt_getvoicepos(ctx, chn);
 }
 
+/* Send the channel state to the voice without advancing envelopes,
+ * counters and slides, which were already updated in this frame
+ */
+static void apply_channel(struct context_data *ctx, int chn)
+{
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+	struct xmp_module *mod = &m->mod;
+	struct channel_data *xc = &p->xc_data[chn];
+	int act;
+
+	act = virt_cstat(ctx, chn);
+	if (act == VIRT_INVALID || !IS_VALID_INSTRUMENT(xc->ins))
+		return;
+
+	process_volume(ctx, chn, p->frame, act, 0);
+	process_frequency(ctx, chn, p->frame, act, 0);
+	process_pan(ctx, chn, p->frame, act, 0);
+}
+
 /*
  * Event injection
  */
@@ -668,6 +778,79 @@ static void inject_event(struct context_data *ctx)
 	}
 }
 
+/* Add an event to be played offset samples after the start of the next
+ * frame. Events with the same offset are played in the order they were
+ * added.
+ */
+int queue_timed_event(struct context_data *ctx, int chn, struct xmp_event *e,
+		      int offset)
+{
+	struct player_data *p = &ctx->p;
+	struct timed_event *ev = p->timed.ev;
+	int i;
+
+	if (p->timed.num >= MAX_TIMED_EVENTS)
+		return -1;
+
+	for (i = p->timed.num; i > 0 && ev[i - 1].offset > offset; i--)
+		ev[i] = ev[i - 1];
+
+	ev[i].chn = chn;
+	ev[i].offset = offset;
+	memcpy(&ev[i].event, e, sizeof(struct xmp_event));
+	p->timed.num++;
+
+	return 0;
+}
+
+/* Mix the tick in parts, playing timed events between them. A new note
+ * is processed from the event position to the end of the tick as if it
+ * had been injected at the start of the tick. Other events only change
+ * the channel state, so envelopes and LFOs advance once per tick.
+ */
+static void mix_timed_events(struct context_data *ctx, int silent)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	struct module_data *m = &ctx->m;
+	struct timed_event *ev = p->timed.ev;
+	struct xmp_event *e;
+	int i, j, start;
+
+	mixer_prepare(ctx);
+
+	start = 0;
+	for (i = 0; i < p->timed.num && ev[i].offset < s->ticksize; i++) {
+		mixer_mix(ctx, start, ev[i].offset - start, silent);
+		start = ev[i].offset;
+
+		if (ev[i].chn >= m->mod.chn)
+			continue;
+
+		e = &ev[i].event;
+
+		if (read_event(ctx, e, ev[i].chn, 1) != 0) {
+			read_event(ctx, e, ev[i].chn, 0);
+		}
+
+		if ((uint32)e->note <= XMP_MAX_KEYS && e->note > 0 &&
+		    !IS_TONEPORTA(e->fxt) && !IS_TONEPORTA(e->f2t)) {
+			play_channel(ctx, ev[i].chn, p->frame);
+		} else {
+			apply_channel(ctx, ev[i].chn);
+		}
+	}
+
+	mixer_mix(ctx, start, s->ticksize - start, silent);
+
+	/* Later events move closer to the next frame */
+	for (j = 0; i < p->timed.num; i++, j++) {
+		ev[j] = ev[i];
+		ev[j].offset -= s->ticksize;
+	}
+	p->timed.num = j;
+}
+
 /*
  * Sequencing
  */
@@ -768,12 +951,25 @@ int xmp_start_player(xmp_context opaque, int rate, int format)
 	struct module_data *m = &ctx->m;
 	struct xmp_module *mod = &m->mod;
 	struct flow_control *f = &p->flow;
-	int i;
+	int i, width;
 	int ret = 0;
 
+	/* Only one sample width can be selected */
+	width = format & (XMP_FORMAT_8BIT | XMP_FORMAT_FLOAT |
+				XMP_FORMAT_32BIT | XMP_FORMAT_24BIT);
+	if (width & (width - 1))
+		return -XMP_ERROR_INVALID;
+
+	/* Modules loaded with XMP_SMPCTL_SKIP can't be played */
+	if (m->nodata)
+		return -XMP_ERROR_STATE;
+
 	if (mixer_on(ctx, rate, format, m->c4rate) < 0)
 		return -XMP_ERROR_INTERNAL;
 
+	if (p->virt.voices > 0)
+		s->numvoc = p->virt.voices;
+
 	p->gvol.slide = 0;
 	p->gvol.volume = m->volbase;
 	p->pos = p->ord = 0;
@@ -781,6 +977,9 @@ int xmp_start_player(xmp_context opaque, int rate, int format)
 	p->row = 0;
 	p->current_time = 0;
 	p->loop_count = 0;
+	p->buffer_data.consumed = p->buffer_data.in_size = 0;
+	p->buffer_data.skip = 0;
+	p->timed.num = 0;
 
 	/* Unmute all channels and set default volume */
 	for (i = 0; i < XMP_MAX_CHANNELS; i++) {
@@ -821,6 +1020,9 @@ int xmp_start_player(xmp_context opaque, int rate, int format)
 	f->jumpline = 0;
 	f->jump = -1;
 	f->pbreak = 0;
+	f->delay = 0;
+	f->skip_fetch = 0;
+	f->loop_chn = 0;
 
 	f->loop = calloc(p->virt.virt_channels, sizeof(struct pattern_loop));
 	if (f->loop == NULL) {
@@ -843,6 +1045,15 @@ int xmp_start_player(xmp_context opaque, int rate, int format)
 
 	reset_channel(ctx);
 
+	if (p->seek.interval > 0 && snapshot_build_index(ctx) < 0) {
+		snapshot_free_index(ctx);
+		m->synth->deinit(ctx);
+		ret = -XMP_ERROR_SYSTEM;
+		goto err2;
+	}
+
+	control_sync(ctx);
+
 	return 0;
 
     err2:
@@ -853,15 +1064,20 @@ int xmp_start_player(xmp_context opaque, int rate, int format)
 	return ret;
 }
 
-int xmp_play_frame(xmp_context opaque)
+/* Run the sequencer for one tick and mix it into the 32 bit buffer. The
+ * caller decides where the frame is downmixed to. Silent frames update
+ * the player and mixer state without rendering any sound.
+ */
+int next_frame(struct context_data *ctx, int silent)
 {
-	struct context_data *ctx = (struct context_data *)opaque;
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
 	struct xmp_module *mod = &m->mod;
 	struct flow_control *f = &p->flow;
 	int i;
 
+	scan_poll(ctx);
+
 	if (mod->len <= 0 || mod->xxo[p->ord] == 0xff) {
 		return -XMP_END;
 	}
@@ -947,7 +1163,122 @@ int xmp_play_frame(xmp_context opaque)
 	p->frame_time = m->time_factor * m->rrate / p->bpm;
 	p->current_time += p->frame_time;
 
-	mixer_softmixer(ctx);
+	if (p->timed.num > 0) {
+		mix_timed_events(ctx, silent);
+	} else {
+		mixer_softmixer(ctx, silent);
+	}
+
+	return 0;
+}
+
+int xmp_play_frame(xmp_context opaque)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	int ret;
+
+	/* Frames played here are not part of any pending buffer data */
+	p->buffer_data.consumed = p->buffer_data.in_size = 0;
+	p->buffer_data.skip = 0;
+
+	control_drain(ctx);
+
+	if ((ret = next_frame(ctx, 0)) < 0) {
+		return ret;
+	}
+
+	mixer_downmix(ctx, s->buffer);
+
+	return 0;
+}
+
+int xmp_skip_frames(xmp_context opaque, int num)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+	int i, ret;
+
+	p->buffer_data.consumed = p->buffer_data.in_size = 0;
+	p->buffer_data.skip = 0;
+
+	control_drain(ctx);
+
+	/* Same as playing frames, but voices are advanced without mixing */
+	for (i = 0; i < num; i++) {
+		if ((ret = next_frame(ctx, 1)) < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+int xmp_play_buffer(xmp_context opaque, void *buffer, int size, int loop)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	char *out = buffer;
+	int filled = 0;
+	int copy_size, frame_size, skip;
+
+	/* Reset internal state, next buffer starts at a frame boundary */
+	if (buffer == NULL) {
+		p->buffer_data.consumed = p->buffer_data.in_size = 0;
+		p->buffer_data.skip = 0;
+		p->loop_count = 0;
+		return 0;
+	}
+
+	while (filled < size) {
+		/* Drain what is left of the last partially consumed frame */
+		if (p->buffer_data.consumed < p->buffer_data.in_size) {
+			copy_size = p->buffer_data.in_size - p->buffer_data.consumed;
+			if (copy_size > size - filled) {
+				copy_size = size - filled;
+			}
+			memcpy(out + filled, s->buffer + p->buffer_data.consumed,
+								copy_size);
+			p->buffer_data.consumed += copy_size;
+			filled += copy_size;
+			continue;
+		}
+
+		control_drain(ctx);
+
+		if (next_frame(ctx, 0) < 0 ||
+				(loop > 0 && p->loop_count >= loop)) {
+			p->buffer_data.consumed = p->buffer_data.in_size = 0;
+			if (filled == 0) {
+				return -XMP_END;
+			}
+			memset(out + filled, 0, size - filled);
+			return 0;
+		}
+
+		frame_size = mixer_buffer_size(ctx);
+
+		/* Samples before a seek target are dropped */
+		skip = p->buffer_data.skip * (frame_size / s->ticksize);
+		if (skip > frame_size) {
+			skip = frame_size;
+		}
+		p->buffer_data.skip = 0;
+
+		/* Whole frames are rendered straight into the caller's
+		 * buffer, only a frame crossing the buffer end is kept
+		 */
+		if (skip == 0 && frame_size <= size - filled) {
+			mixer_downmix(ctx, out + filled);
+			filled += frame_size;
+		} else {
+			mixer_downmix(ctx, s->buffer);
+			p->buffer_data.consumed = skip;
+			p->buffer_data.in_size = frame_size;
+		}
+	}
 
 	return 0;
 }
@@ -959,8 +1290,10 @@ void xmp_end_player(xmp_context opaque)
 	struct module_data *m = &ctx->m;
 	struct flow_control *f = &p->flow;
 
+	snapshot_free_index(ctx);
 	virt_off(ctx);
 	m->synth->deinit(ctx);
+	release_invloop(ctx);
 
 	free(p->xc_data);
 	free(f->loop);
@@ -1020,13 +1353,7 @@ void xmp_get_frame_info(xmp_context opaque, struct xmp_frame_info *info)
 	info->buffer = s->buffer;
 
 	info->total_size = XMP_MAX_FRAMESIZE;
-	info->buffer_size = s->ticksize;
-	if (~s->format & XMP_FORMAT_MONO) {
-		info->buffer_size *= 2;
-	}
-	if (~s->format & XMP_FORMAT_8BIT) {
-		info->buffer_size *= 2;
-	}
+	info->buffer_size = mixer_buffer_size(ctx);
 
 	info->volume = p->gvol.volume;
 	info->loop_count = p->loop_count;
@@ -1041,7 +1368,6 @@ void xmp_get_frame_info(xmp_context opaque, struct xmp_frame_info *info)
 			struct xmp_channel_info *ci = &info->channel_info[i];
 			struct xmp_track *track;
 			struct xmp_event *event;
-			int trk;
 	
 			ci->note = c->key;
 			ci->pitchbend = c->info_pitchbend;
@@ -1055,8 +1381,7 @@ void xmp_get_frame_info(xmp_context opaque, struct xmp_frame_info *info)
 			memset(&ci->event, 0, sizeof(*event));
 	
 			if (info->pattern < mod->pat && info->row < info->num_rows) {
-				trk = mod->xxp[info->pattern]->index[i];
-				track = mod->xxt[trk];
+				track = PATTERN_TRACKS(info->pattern)[i];
 				if (info->row < track->rows) {
 					event = &track->event[info->row];
 					memcpy(&ci->event, event, sizeof(*event));
@@ -60,31 +60,34 @@ struct instrument_vibrato {
 };
 
 struct channel_data {
+	/* Per-tick state. Inactive channels only check the delay and
+	 * clear the final volume, so these come first.
+	 */
+	int delay;		/* Note delay in frames */
+	int info_finalvol;	/* Final volume including envelopes */
 	int flags;		/* Channel flags */
 	int per_flags;		/* Persistent effect channel flags */
+	int ins;		/* Instrument number */
+	int smp;		/* Sample number */
 	int note;		/* Note number */
 	int key;		/* Key number */
 	double period;		/* Amiga or linear period */
 	int finetune;		/* Guess what */
-	int ins;		/* Instrument number */
-	int ins_oinsvol;	/* Last instrument that did set a note */
-	int smp;		/* Sample number */
+	int volume;		/* Current volume */
+	int gvl;		/* Global volume for instrument for IT */
 	int pan;		/* Current pan */
 	int masterpan;		/* Master pan -- for S3M set pan effect */
 	int mastervol;		/* Master vol -- for IT track vol effect */
-	int delay;		/* Note delay in frames */
-	int keyoff;		/* Key off counter */
 	int fadeout;		/* Current fadeout (release) value */
+	int keyoff;		/* Key off counter */
 	int gliss;		/* Glissando active */
-	int volume;		/* Current volume */
-	int gvl;		/* Global volume for instrument for IT */
-	int p_val;		/* Current pan value */
-	int offset;		/* Sample offset memory */
-	int offset_val;		/* Sample offset */
 
 	uint16 v_idx;		/* Volume envelope index */
 	uint16 p_idx;		/* Pan envelope index */
 	uint16 f_idx;		/* Freq envelope index */
+	uint8 v_seg;		/* Volume envelope segment */
+	uint8 p_seg;		/* Pan envelope segment */
+	uint8 f_seg;		/* Freq envelope segment */
 
 	struct lfo vibrato;
 	struct lfo tremolo;
@@ -100,12 +103,6 @@ struct channel_data {
 		int sweep;
 	} insvib;
 
-	struct {
-		int val;	/* Retrig value */
-		int count;	/* Retrig counter */
-		int type;	/* Retrig type */
-	} retrig;
-
 	struct {
 		int val;	/* Tremor value */
 		int count;	/* Tremor counter */
@@ -119,10 +116,6 @@ struct channel_data {
 		int memory;	/* Volume slide effect memory */
 	} vol;
 
-	struct {
-		int memory;	/* Global volume memory is saved per channel */
-	} gvol;
-
 	struct {
 		int slide;	/* Track volume slide value */
 		int fslide;	/* Track fine volume slide value */
@@ -146,16 +139,40 @@ struct channel_data {
 		int count;	/* PTM note slide counter */
 	} noteslide;
 
+	struct {
+		int cutoff;	/* IT filter cutoff frequency */
+		int resonance;	/* IT filter resonance */
+	} filter;
+
+	int info_period;	/* Period */
+	int info_pitchbend;	/* Linear pitchbend */
+	int info_position;	/* Position before mixing */
+	int info_finalpan;	/* Final pan including envelopes */
+
+	/* State used by events and less common effects */
+	int ins_oinsvol;	/* Last instrument that did set a note */
+	int p_val;		/* Current pan value */
+	int offset;		/* Sample offset memory */
+	int offset_val;		/* Sample offset */
+
+	struct {
+		int val;	/* Retrig value */
+		int count;	/* Retrig counter */
+		int type;	/* Retrig type */
+	} retrig;
+
+	struct {
+		int memory;	/* Global volume memory is saved per channel */
+	} gvol;
+
 	struct {
 		int speed;
 		int count;
 		int pos;
 	} invloop;
 
-	struct {
-		int cutoff;	/* IT filter cutoff frequency */
-		int resonance;	/* IT filter resonance */
-	} filter;
+	struct xmp_event *delayed_event;
+	int delayed_ins;	/* IT save instrument emulation */
 
 	struct med_channel {
 		int vp;		/* MED synth volume sequence table pointer */
@@ -177,15 +194,6 @@ struct channel_data {
 		int vib_idx;	/* MED synth vibrato index */
 		int vib_wf;	/* MED synth vibrato waveform */
 	} med;
-
-	struct xmp_event *delayed_event;
-	int delayed_ins;	/* IT save instrument emulation */
-
-	int info_period;	/* Period */
-	int info_pitchbend;	/* Linear pitchbend */
-	int info_position;	/* Position before mixing */
-	int info_finalvol;	/* Final volume including envelopes */
-	int info_finalpan;	/* Final pan including envelopes */
 };
 
 
@@ -195,5 +203,7 @@ int get_med_arp(struct module_data *, struct channel_data *);
 int get_med_vibrato(struct channel_data *);
 void filter_setup(int, int, int, int*, int*, int *);
 int read_event(struct context_data *, struct xmp_event *, int, int);
+void read_empty_event(struct context_data *, int);
+int next_frame(struct context_data *, int);
 
 #endif /* XMP_PLAYER_H */
@@ -1,524 +1,515 @@
-static int16 cubic_spline_lut0[1024] = {
-	 0, -8, -16, -24, -32, -40, -47, -55,
-	 -63, -71, -78, -86, -94, -101, -109, -117,
-	 -124, -132, -139, -146, -154, -161, -169, -176,
-	 -183, -190, -198, -205, -212, -219, -226, -233,
-	 -240, -247, -254, -261, -268, -275, -282, -289,
-	 -295, -302, -309, -316, -322, -329, -336, -342,
-	 -349, -355, -362, -368, -375, -381, -388, -394,
-	 -400, -407, -413, -419, -425, -432, -438, -444,
-	 -450, -456, -462, -468, -474, -480, -486, -492,
-	 -498, -504, -510, -515, -521, -527, -533, -538,
-	 -544, -550, -555, -561, -566, -572, -577, -583,
-	 -588, -594, -599, -604, -610, -615, -620, -626,
-	 -631, -636, -641, -646, -651, -656, -662, -667,
-	 -672, -677, -682, -686, -691, -696, -701, -706,
-	 -711, -715, -720, -725, -730, -734, -739, -744,
-	 -748, -753, -757, -762, -766, -771, -775, -780,
-	 -784, -788, -793, -797, -801, -806, -810, -814,
-	 -818, -822, -826, -831, -835, -839, -843, -847,
-	 -851, -855, -859, -863, -866, -870, -874, -878,
-	 -882, -886, -889, -893, -897, -900, -904, -908,
-	 -911, -915, -918, -922, -925, -929, -932, -936,
-	 -939, -943, -946, -949, -953, -956, -959, -962,
-	 -966, -969, -972, -975, -978, -981, -984, -987,
-	 -991, -994, -997, -999, -1002, -1005, -1008, -1011,
-	 -1014, -1017, -1020, -1022, -1025, -1028, -1031, -1033,
-	 -1036, -1039, -1041, -1044, -1047, -1049, -1052, -1054,
-	 -1057, -1059, -1062, -1064, -1066, -1069, -1071, -1074,
-	 -1076, -1078, -1080, -1083, -1085, -1087, -1089, -1092,
-	 -1094, -1096, -1098, -1100, -1102, -1104, -1106, -1108,
-	 -1110, -1112, -1114, -1116, -1118, -1120, -1122, -1124,
-	 -1125, -1127, -1129, -1131, -1133, -1134, -1136, -1138,
-	 -1139, -1141, -1143, -1144, -1146, -1147, -1149, -1150,
-	 -1152, -1153, -1155, -1156, -1158, -1159, -1161, -1162,
-	 -1163, -1165, -1166, -1167, -1169, -1170, -1171, -1172,
-	 -1174, -1175, -1176, -1177, -1178, -1179, -1180, -1181,
-	 -1182, -1184, -1185, -1186, -1187, -1187, -1188, -1189,
-	 -1190, -1191, -1192, -1193, -1194, -1195, -1195, -1196,
-	 -1197, -1198, -1198, -1199, -1200, -1200, -1201, -1202,
-	 -1202, -1203, -1204, -1204, -1205, -1205, -1206, -1206,
-	 -1207, -1207, -1208, -1208, -1208, -1209, -1209, -1210,
-	 -1210, -1210, -1211, -1211, -1211, -1212, -1212, -1212,
-	 -1212, -1212, -1213, -1213, -1213, -1213, -1213, -1213,
-	 -1213, -1213, -1214, -1214, -1214, -1214, -1214, -1214,
-	 -1214, -1214, -1213, -1213, -1213, -1213, -1213, -1213,
-	 -1213, -1213, -1212, -1212, -1212, -1212, -1211, -1211,
-	 -1211, -1211, -1210, -1210, -1210, -1209, -1209, -1209,
-	 -1208, -1208, -1207, -1207, -1207, -1206, -1206, -1205,
-	 -1205, -1204, -1204, -1203, -1202, -1202, -1201, -1201,
-	 -1200, -1199, -1199, -1198, -1197, -1197, -1196, -1195,
-	 -1195, -1194, -1193, -1192, -1192, -1191, -1190, -1189,
-	 -1188, -1187, -1187, -1186, -1185, -1184, -1183, -1182,
-	 -1181, -1180, -1179, -1178, -1177, -1176, -1175, -1174,
-	 -1173, -1172, -1171, -1170, -1169, -1168, -1167, -1166,
-	 -1165, -1163, -1162, -1161, -1160, -1159, -1158, -1156,
-	 -1155, -1154, -1153, -1151, -1150, -1149, -1148, -1146,
-	 -1145, -1144, -1142, -1141, -1140, -1138, -1137, -1135,
-	 -1134, -1133, -1131, -1130, -1128, -1127, -1125, -1124,
-	 -1122, -1121, -1119, -1118, -1116, -1115, -1113, -1112,
-	 -1110, -1109, -1107, -1105, -1104, -1102, -1101, -1099,
-	 -1097, -1096, -1094, -1092, -1091, -1089, -1087, -1085,
-	 -1084, -1082, -1080, -1079, -1077, -1075, -1073, -1071,
-	 -1070, -1068, -1066, -1064, -1062, -1061, -1059, -1057,
-	 -1055, -1053, -1051, -1049, -1047, -1046, -1044, -1042,
-	 -1040, -1038, -1036, -1034, -1032, -1030, -1028, -1026,
-	 -1024, -1022, -1020, -1018, -1016, -1014, -1012, -1010,
-	 -1008, -1006, -1004, -1002, -999, -997, -995, -993,
-	 -991, -989, -987, -985, -982, -980, -978, -976,
-	 -974, -972, -969, -967, -965, -963, -961, -958,
-	 -956, -954, -952, -950, -947, -945, -943, -941,
-	 -938, -936, -934, -931, -929, -927, -924, -922,
-	 -920, -918, -915, -913, -911, -908, -906, -903,
-	 -901, -899, -896, -894, -892, -889, -887, -884,
-	 -882, -880, -877, -875, -872, -870, -867, -865,
-	 -863, -860, -858, -855, -853, -850, -848, -845,
-	 -843, -840, -838, -835, -833, -830, -828, -825,
-	 -823, -820, -818, -815, -813, -810, -808, -805,
-	 -803, -800, -798, -795, -793, -790, -787, -785,
-	 -782, -780, -777, -775, -772, -769, -767, -764,
-	 -762, -759, -757, -754, -751, -749, -746, -744,
-	 -741, -738, -736, -733, -730, -728, -725, -723,
-	 -720, -717, -715, -712, -709, -707, -704, -702,
-	 -699, -696, -694, -691, -688, -686, -683, -680,
-	 -678, -675, -672, -670, -667, -665, -662, -659,
-	 -657, -654, -651, -649, -646, -643, -641, -638,
-	 -635, -633, -630, -627, -625, -622, -619, -617,
-	 -614, -611, -609, -606, -603, -601, -598, -595,
-	 -593, -590, -587, -585, -582, -579, -577, -574,
-	 -571, -569, -566, -563, -561, -558, -555, -553,
-	 -550, -547, -545, -542, -539, -537, -534, -531,
-	 -529, -526, -523, -521, -518, -516, -513, -510,
-	 -508, -505, -502, -500, -497, -495, -492, -489,
-	 -487, -484, -481, -479, -476, -474, -471, -468,
-	 -466, -463, -461, -458, -455, -453, -450, -448,
-	 -445, -442, -440, -437, -435, -432, -430, -427,
-	 -424, -422, -419, -417, -414, -412, -409, -407,
-	 -404, -402, -399, -397, -394, -392, -389, -387,
-	 -384, -382, -379, -377, -374, -372, -369, -367,
-	 -364, -362, -359, -357, -354, -352, -349, -347,
-	 -345, -342, -340, -337, -335, -332, -330, -328,
-	 -325, -323, -320, -318, -316, -313, -311, -309,
-	 -306, -304, -302, -299, -297, -295, -292, -290,
-	 -288, -285, -283, -281, -278, -276, -274, -272,
-	 -269, -267, -265, -263, -260, -258, -256, -254,
-	 -251, -249, -247, -245, -243, -240, -238, -236,
-	 -234, -232, -230, -228, -225, -223, -221, -219,
-	 -217, -215, -213, -211, -209, -207, -205, -202,
-	 -200, -198, -196, -194, -192, -190, -188, -186,
-	 -184, -182, -180, -178, -176, -175, -173, -171,
-	 -169, -167, -165, -163, -161, -159, -157, -156,
-	 -154, -152, -150, -148, -146, -145, -143, -141,
-	 -139, -137, -136, -134, -132, -130, -129, -127,
-	 -125, -124, -122, -120, -119, -117, -115, -114,
-	 -112, -110, -109, -107, -106, -104, -102, -101,
-	 -99, -98, -96, -95, -93, -92, -90, -89,
-	 -87, -86, -84, -83, -82, -80, -79, -77,
-	 -76, -75, -73, -72, -70, -69, -68, -67,
-	 -65, -64, -63, -61, -60, -59, -58, -57,
-	 -55, -54, -53, -52, -51, -49, -48, -47,
-	 -46, -45, -44, -43, -42, -41, -40, -39,
-	 -38, -37, -36, -35, -34, -33, -32, -31,
-	 -30, -29, -28, -27, -26, -26, -25, -24,
-	 -23, -22, -22, -21, -20, -19, -19, -18,
-	 -17, -16, -16, -15, -14, -14, -13, -13,
-	 -12, -11, -11, -10, -10, -9, -9, -8,
-	 -8, -7, -7, -6, -6, -6, -5, -5,
-	 -4, -4, -4, -3, -3, -3, -2, -2,
-	 -2, -2, -2, -1, -1, -1, -1, -1,
-	 0, 0, 0, 0, 0, 0, 0, 0,
-};
-
-static int16 cubic_spline_lut1[1024] = {
-	 16384, 16384, 16384, 16384, 16384, 16383, 16382, 16381,
-	 16381, 16381, 16380, 16379, 16379, 16377, 16377, 16376,
-	 16374, 16373, 16371, 16370, 16369, 16366, 16366, 16364,
-	 16361, 16360, 16358, 16357, 16354, 16351, 16349, 16347,
-	 16345, 16342, 16340, 16337, 16335, 16331, 16329, 16326,
-	 16322, 16320, 16317, 16314, 16309, 16307, 16304, 16299,
-	 16297, 16293, 16290, 16285, 16282, 16278, 16274, 16269,
-	 16265, 16262, 16257, 16253, 16247, 16244, 16239, 16235,
-	 16230, 16225, 16220, 16216, 16211, 16206, 16201, 16196,
-	 16191, 16185, 16180, 16174, 16169, 16163, 16158, 16151,
-	 16146, 16140, 16133, 16128, 16122, 16116, 16109, 16104,
-	 16097, 16092, 16085, 16077, 16071, 16064, 16058, 16052,
-	 16044, 16038, 16030, 16023, 16015, 16009, 16002, 15995,
-	 15988, 15980, 15973, 15964, 15957, 15949, 15941, 15934,
-	 15926, 15918, 15910, 15903, 15894, 15886, 15877, 15870,
-	 15861, 15853, 15843, 15836, 15827, 15818, 15810, 15801,
-	 15792, 15783, 15774, 15765, 15756, 15747, 15738, 15729,
-	 15719, 15709, 15700, 15691, 15681, 15672, 15662, 15652,
-	 15642, 15633, 15623, 15613, 15602, 15592, 15582, 15572,
-	 15562, 15552, 15540, 15530, 15520, 15509, 15499, 15489,
-	 15478, 15467, 15456, 15446, 15433, 15423, 15412, 15401,
-	 15390, 15379, 15367, 15356, 15345, 15333, 15321, 15310,
-	 15299, 15287, 15276, 15264, 15252, 15240, 15228, 15216,
-	 15205, 15192, 15180, 15167, 15155, 15143, 15131, 15118,
-	 15106, 15094, 15081, 15067, 15056, 15043, 15031, 15017,
-	 15004, 14992, 14979, 14966, 14953, 14940, 14927, 14913,
-	 14900, 14887, 14874, 14860, 14846, 14833, 14819, 14806,
-	 14793, 14778, 14764, 14752, 14737, 14723, 14709, 14696,
-	 14681, 14668, 14653, 14638, 14625, 14610, 14595, 14582,
-	 14567, 14553, 14538, 14523, 14509, 14494, 14480, 14465,
-	 14450, 14435, 14420, 14406, 14391, 14376, 14361, 14346,
-	 14330, 14316, 14301, 14285, 14270, 14254, 14239, 14223,
-	 14208, 14192, 14177, 14161, 14146, 14130, 14115, 14099,
-	 14082, 14067, 14051, 14035, 14019, 14003, 13986, 13971,
-	 13955, 13939, 13923, 13906, 13890, 13873, 13857, 13840,
-	 13823, 13808, 13791, 13775, 13758, 13741, 13724, 13707,
-	 13691, 13673, 13657, 13641, 13623, 13607, 13589, 13572,
-	 13556, 13538, 13521, 13504, 13486, 13469, 13451, 13435,
-	 13417, 13399, 13383, 13365, 13347, 13330, 13312, 13294,
-	 13277, 13258, 13241, 13224, 13205, 13188, 13170, 13152,
-	 13134, 13116, 13098, 13080, 13062, 13044, 13026, 13008,
-	 12989, 12971, 12953, 12934, 12916, 12898, 12879, 12860,
-	 12842, 12823, 12806, 12787, 12768, 12750, 12731, 12712,
-	 12694, 12675, 12655, 12637, 12618, 12599, 12580, 12562,
-	 12542, 12524, 12504, 12485, 12466, 12448, 12427, 12408,
-	 12390, 12370, 12351, 12332, 12312, 12293, 12273, 12254,
-	 12235, 12215, 12195, 12176, 12157, 12137, 12118, 12097,
-	 12079, 12059, 12039, 12019, 11998, 11980, 11960, 11940,
-	 11920, 11900, 11880, 11860, 11839, 11821, 11801, 11780,
-	 11761, 11741, 11720, 11700, 11680, 11660, 11640, 11619,
-	 11599, 11578, 11559, 11538, 11518, 11498, 11477, 11457,
-	 11436, 11415, 11394, 11374, 11354, 11333, 11313, 11292,
-	 11272, 11251, 11231, 11209, 11189, 11168, 11148, 11127,
-	 11107, 11084, 11064, 11043, 11023, 11002, 10982, 10959,
-	 10939, 10918, 10898, 10876, 10856, 10834, 10814, 10792,
-	 10772, 10750, 10728, 10708, 10687, 10666, 10644, 10623,
-	 10602, 10581, 10560, 10538, 10517, 10496, 10474, 10453,
-	 10431, 10410, 10389, 10368, 10346, 10325, 10303, 10283,
-	 10260, 10239, 10217, 10196, 10175, 10152, 10132, 10110,
-	 10088, 10068, 10045, 10023, 10002, 9981, 9959, 9936,
-	 9915, 9893, 9872, 9851, 9829, 9806, 9784, 9763,
-	 9742, 9720, 9698, 9676, 9653, 9633, 9611, 9589,
-	 9567, 9545, 9523, 9501, 9479, 9458, 9436, 9414,
-	 9392, 9370, 9348, 9326, 9304, 9282, 9260, 9238,
-	 9216, 9194, 9172, 9150, 9128, 9106, 9084, 9062,
-	 9040, 9018, 8996, 8974, 8951, 8929, 8907, 8885,
-	 8863, 8841, 8819, 8797, 8775, 8752, 8730, 8708,
-	 8686, 8664, 8642, 8620, 8597, 8575, 8553, 8531,
-	 8509, 8487, 8464, 8442, 8420, 8398, 8376, 8353,
-	 8331, 8309, 8287, 8265, 8242, 8220, 8198, 8176,
-	 8154, 8131, 8109, 8087, 8065, 8042, 8020, 7998,
-	 7976, 7954, 7931, 7909, 7887, 7865, 7842, 7820,
-	 7798, 7776, 7754, 7731, 7709, 7687, 7665, 7643,
-	 7620, 7598, 7576, 7554, 7531, 7509, 7487, 7465,
-	 7443, 7421, 7398, 7376, 7354, 7332, 7310, 7288,
-	 7265, 7243, 7221, 7199, 7177, 7155, 7132, 7110,
-	 7088, 7066, 7044, 7022, 7000, 6978, 6956, 6934,
-	 6911, 6889, 6867, 6845, 6823, 6801, 6779, 6757,
-	 6735, 6713, 6691, 6669, 6647, 6625, 6603, 6581,
-	 6559, 6537, 6515, 6493, 6472, 6450, 6428, 6406,
-	 6384, 6362, 6340, 6318, 6297, 6275, 6253, 6231,
-	 6209, 6188, 6166, 6144, 6122, 6101, 6079, 6057,
-	 6035, 6014, 5992, 5970, 5949, 5927, 5905, 5884,
-	 5862, 5841, 5819, 5797, 5776, 5754, 5733, 5711,
-	 5690, 5668, 5647, 5625, 5604, 5582, 5561, 5540,
-	 5518, 5497, 5476, 5454, 5433, 5412, 5390, 5369,
-	 5348, 5327, 5305, 5284, 5263, 5242, 5221, 5199,
-	 5178, 5157, 5136, 5115, 5094, 5073, 5052, 5031,
-	 5010, 4989, 4968, 4947, 4926, 4905, 4885, 4864,
-	 4843, 4822, 4801, 4780, 4760, 4739, 4718, 4698,
-	 4677, 4656, 4636, 4615, 4595, 4574, 4553, 4533,
-	 4512, 4492, 4471, 4451, 4431, 4410, 4390, 4370,
-	 4349, 4329, 4309, 4288, 4268, 4248, 4228, 4208,
-	 4188, 4167, 4147, 4127, 4107, 4087, 4067, 4047,
-	 4027, 4007, 3988, 3968, 3948, 3928, 3908, 3889,
-	 3869, 3849, 3829, 3810, 3790, 3771, 3751, 3732,
-	 3712, 3693, 3673, 3654, 3634, 3615, 3595, 3576,
-	 3557, 3538, 3518, 3499, 3480, 3461, 3442, 3423,
-	 3404, 3385, 3366, 3347, 3328, 3309, 3290, 3271,
-	 3252, 3233, 3215, 3196, 3177, 3159, 3140, 3121,
-	 3103, 3084, 3066, 3047, 3029, 3010, 2992, 2974,
-	 2955, 2937, 2919, 2901, 2882, 2864, 2846, 2828,
-	 2810, 2792, 2774, 2756, 2738, 2720, 2702, 2685,
-	 2667, 2649, 2631, 2614, 2596, 2579, 2561, 2543,
-	 2526, 2509, 2491, 2474, 2456, 2439, 2422, 2405,
-	 2387, 2370, 2353, 2336, 2319, 2302, 2285, 2268,
-	 2251, 2234, 2218, 2201, 2184, 2167, 2151, 2134,
-	 2117, 2101, 2084, 2068, 2052, 2035, 2019, 2003,
-	 1986, 1970, 1954, 1938, 1922, 1906, 1890, 1874,
-	 1858, 1842, 1826, 1810, 1794, 1779, 1763, 1747,
-	 1732, 1716, 1701, 1685, 1670, 1654, 1639, 1624,
-	 1608, 1593, 1578, 1563, 1548, 1533, 1518, 1503,
-	 1488, 1473, 1458, 1444, 1429, 1414, 1400, 1385,
-	 1370, 1356, 1342, 1327, 1313, 1298, 1284, 1270,
-	 1256, 1242, 1228, 1214, 1200, 1186, 1172, 1158,
-	 1144, 1131, 1117, 1103, 1090, 1076, 1063, 1049,
-	 1036, 1022, 1009, 996, 983, 970, 956, 943,
-	 930, 917, 905, 892, 879, 866, 854, 841,
-	 828, 816, 803, 791, 778, 766, 754, 742,
-	 729, 717, 705, 693, 681, 669, 658, 646,
-	 634, 622, 611, 599, 588, 576, 565, 553,
-	 542, 531, 520, 508, 497, 486, 475, 464,
-	 453, 443, 432, 421, 411, 400, 389, 379,
-	 369, 358, 348, 338, 327, 317, 307, 297,
-	 287, 277, 268, 258, 248, 238, 229, 219,
-	 210, 200, 191, 182, 172, 163, 154, 145,
-	 136, 127, 118, 109, 100, 92, 83, 75,
-	 66, 58, 49, 41, 32, 24, 16, 8,
-};
-
-static int16 cubic_spline_lut2[1024] = {
-	 0, 8, 16, 24, 32, 41, 49, 58,
-	 66, 75, 83, 92, 100, 109, 118, 127,
-	 136, 145, 154, 163, 172, 182, 191, 200,
-	 210, 219, 229, 238, 248, 258, 268, 277,
-	 287, 297, 307, 317, 327, 338, 348, 358,
-	 369, 379, 389, 400, 411, 421, 432, 443,
-	 453, 464, 475, 486, 497, 508, 520, 531,
-	 542, 553, 565, 576, 588, 599, 611, 622,
-	 634, 646, 658, 669, 681, 693, 705, 717,
-	 729, 742, 754, 766, 778, 791, 803, 816,
-	 828, 841, 854, 866, 879, 892, 905, 917,
-	 930, 943, 956, 970, 983, 996, 1009, 1022,
-	 1036, 1049, 1063, 1076, 1090, 1103, 1117, 1131,
-	 1144, 1158, 1172, 1186, 1200, 1214, 1228, 1242,
-	 1256, 1270, 1284, 1298, 1313, 1327, 1342, 1356,
-	 1370, 1385, 1400, 1414, 1429, 1444, 1458, 1473,
-	 1488, 1503, 1518, 1533, 1548, 1563, 1578, 1593,
-	 1608, 1624, 1639, 1654, 1670, 1685, 1701, 1716,
-	 1732, 1747, 1763, 1779, 1794, 1810, 1826, 1842,
-	 1858, 1874, 1890, 1906, 1922, 1938, 1954, 1970,
-	 1986, 2003, 2019, 2035, 2052, 2068, 2084, 2101,
-	 2117, 2134, 2151, 2167, 2184, 2201, 2218, 2234,
-	 2251, 2268, 2285, 2302, 2319, 2336, 2353, 2370,
-	 2387, 2405, 2422, 2439, 2456, 2474, 2491, 2509,
-	 2526, 2543, 2561, 2579, 2596, 2614, 2631, 2649,
-	 2667, 2685, 2702, 2720, 2738, 2756, 2774, 2792,
-	 2810, 2828, 2846, 2864, 2882, 2901, 2919, 2937,
-	 2955, 2974, 2992, 3010, 3029, 3047, 3066, 3084,
-	 3103, 3121, 3140, 3159, 3177, 3196, 3215, 3233,
-	 3252, 3271, 3290, 3309, 3328, 3347, 3366, 3385,
-	 3404, 3423, 3442, 3461, 3480, 3499, 3518, 3538,
-	 3557, 3576, 3595, 3615, 3634, 3654, 3673, 3693,
-	 3712, 3732, 3751, 3771, 3790, 3810, 3829, 3849,
-	 3869, 3889, 3908, 3928, 3948, 3968, 3988, 4007,
-	 4027, 4047, 4067, 4087, 4107, 4127, 4147, 4167,
-	 4188, 4208, 4228, 4248, 4268, 4288, 4309, 4329,
-	 4349, 4370, 4390, 4410, 4431, 4451, 4471, 4492,
-	 4512, 4533, 4553, 4574, 4595, 4615, 4636, 4656,
-	 4677, 4698, 4718, 4739, 4760, 4780, 4801, 4822,
-	 4843, 4864, 4885, 4905, 4926, 4947, 4968, 4989,
-	 5010, 5031, 5052, 5073, 5094, 5115, 5136, 5157,
-	 5178, 5199, 5221, 5242, 5263, 5284, 5305, 5327,
-	 5348, 5369, 5390, 5412, 5433, 5454, 5476, 5497,
-	 5518, 5540, 5561, 5582, 5604, 5625, 5647, 5668,
-	 5690, 5711, 5733, 5754, 5776, 5797, 5819, 5841,
-	 5862, 5884, 5905, 5927, 5949, 5970, 5992, 6014,
-	 6035, 6057, 6079, 6101, 6122, 6144, 6166, 6188,
-	 6209, 6231, 6253, 6275, 6297, 6318, 6340, 6362,
-	 6384, 6406, 6428, 6450, 6472, 6493, 6515, 6537,
-	 6559, 6581, 6603, 6625, 6647, 6669, 6691, 6713,
-	 6735, 6757, 6779, 6801, 6823, 6845, 6867, 6889,
-	 6911, 6934, 6956, 6978, 7000, 7022, 7044, 7066,
-	 7088, 7110, 7132, 7155, 7177, 7199, 7221, 7243,
-	 7265, 7288, 7310, 7332, 7354, 7376, 7398, 7421,
-	 7443, 7465, 7487, 7509, 7531, 7554, 7576, 7598,
-	 7620, 7643, 7665, 7687, 7709, 7731, 7754, 7776,
-	 7798, 7820, 7842, 7865, 7887, 7909, 7931, 7954,
-	 7976, 7998, 8020, 8042, 8065, 8087, 8109, 8131,
-	 8154, 8176, 8198, 8220, 8242, 8265, 8287, 8309,
-	 8331, 8353, 8376, 8398, 8420, 8442, 8464, 8487,
-	 8509, 8531, 8553, 8575, 8597, 8620, 8642, 8664,
-	 8686, 8708, 8730, 8752, 8775, 8797, 8819, 8841,
-	 8863, 8885, 8907, 8929, 8951, 8974, 8996, 9018,
-	 9040, 9062, 9084, 9106, 9128, 9150, 9172, 9194,
-	 9216, 9238, 9260, 9282, 9304, 9326, 9348, 9370,
-	 9392, 9414, 9436, 9458, 9479, 9501, 9523, 9545,
-	 9567, 9589, 9611, 9633, 9653, 9676, 9698, 9720,
-	 9742, 9763, 9784, 9806, 9829, 9851, 9872, 9893,
-	 9915, 9936, 9959, 9981, 10002, 10023, 10045, 10068,
-	 10088, 10110, 10132, 10152, 10175, 10196, 10217, 10239,
-	 10260, 10283, 10303, 10325, 10346, 10368, 10389, 10410,
-	 10431, 10453, 10474, 10496, 10517, 10538, 10560, 10581,
-	 10602, 10623, 10644, 10666, 10687, 10708, 10728, 10750,
-	 10772, 10792, 10814, 10834, 10856, 10876, 10898, 10918,
-	 10939, 10959, 10982, 11002, 11023, 11043, 11064, 11084,
-	 11107, 11127, 11148, 11168, 11189, 11209, 11231, 11251,
-	 11272, 11292, 11313, 11333, 11354, 11374, 11394, 11415,
-	 11436, 11457, 11477, 11498, 11518, 11538, 11559, 11578,
-	 11599, 11619, 11640, 11660, 11680, 11700, 11720, 11741,
-	 11761, 11780, 11801, 11821, 11839, 11860, 11880, 11900,
-	 11920, 11940, 11960, 11980, 11998, 12019, 12039, 12059,
-	 12079, 12097, 12118, 12137, 12157, 12176, 12195, 12215,
-	 12235, 12254, 12273, 12293, 12312, 12332, 12351, 12370,
-	 12390, 12408, 12427, 12448, 12466, 12485, 12504, 12524,
-	 12542, 12562, 12580, 12599, 12618, 12637, 12655, 12675,
-	 12694, 12712, 12731, 12750, 12768, 12787, 12806, 12823,
-	 12842, 12860, 12879, 12898, 12916, 12934, 12953, 12971,
-	 12989, 13008, 13026, 13044, 13062, 13080, 13098, 13116,
-	 13134, 13152, 13170, 13188, 13205, 13224, 13241, 13258,
-	 13277, 13294, 13312, 13330, 13347, 13365, 13383, 13399,
-	 13417, 13435, 13451, 13469, 13486, 13504, 13521, 13538,
-	 13556, 13572, 13589, 13607, 13623, 13641, 13657, 13673,
-	 13691, 13707, 13724, 13741, 13758, 13775, 13791, 13808,
-	 13823, 13840, 13857, 13873, 13890, 13906, 13923, 13939,
-	 13955, 13971, 13986, 14003, 14019, 14035, 14051, 14067,
-	 14082, 14099, 14115, 14130, 14146, 14161, 14177, 14192,
-	 14208, 14223, 14239, 14254, 14270, 14285, 14301, 14316,
-	 14330, 14346, 14361, 14376, 14391, 14406, 14420, 14435,
-	 14450, 14465, 14480, 14494, 14509, 14523, 14538, 14553,
-	 14567, 14582, 14595, 14610, 14625, 14638, 14653, 14668,
-	 14681, 14696, 14709, 14723, 14737, 14752, 14764, 14778,
-	 14793, 14806, 14819, 14833, 14846, 14860, 14874, 14887,
-	 14900, 14913, 14927, 14940, 14953, 14966, 14979, 14992,
-	 15004, 15017, 15031, 15043, 15056, 15067, 15081, 15094,
-	 15106, 15118, 15131, 15143, 15155, 15167, 15180, 15192,
-	 15205, 15216, 15228, 15240, 15252, 15264, 15276, 15287,
-	 15299, 15310, 15321, 15333, 15345, 15356, 15367, 15379,
-	 15390, 15401, 15412, 15423, 15433, 15446, 15456, 15467,
-	 15478, 15489, 15499, 15509, 15520, 15530, 15540, 15552,
-	 15562, 15572, 15582, 15592, 15602, 15613, 15623, 15633,
-	 15642, 15652, 15662, 15672, 15681, 15691, 15700, 15709,
-	 15719, 15729, 15738, 15747, 15756, 15765, 15774, 15783,
-	 15792, 15801, 15810, 15818, 15827, 15836, 15843, 15853,
-	 15861, 15870, 15877, 15886, 15894, 15903, 15910, 15918,
-	 15926, 15934, 15941, 15949, 15957, 15964, 15973, 15980,
-	 15988, 15995, 16002, 16009, 16015, 16023, 16030, 16038,
-	 16044, 16052, 16058, 16064, 16071, 16077, 16085, 16092,
-	 16097, 16104, 16109, 16116, 16122, 16128, 16133, 16140,
-	 16146, 16151, 16158, 16163, 16169, 16174, 16180, 16185,
-	 16191, 16196, 16201, 16206, 16211, 16216, 16220, 16225,
-	 16230, 16235, 16239, 16244, 16247, 16253, 16257, 16262,
-	 16265, 16269, 16274, 16278, 16282, 16285, 16290, 16293,
-	 16297, 16299, 16304, 16307, 16309, 16314, 16317, 16320,
-	 16322, 16326, 16329, 16331, 16335, 16337, 16340, 16342,
-	 16345, 16347, 16349, 16351, 16354, 16357, 16358, 16360,
-	 16361, 16364, 16366, 16366, 16369, 16370, 16371, 16373,
-	 16374, 16376, 16377, 16377, 16379, 16379, 16380, 16381,
-	 16381, 16381, 16382, 16383, 16384, 16384, 16384, 16384,
-};
-
-static int16 cubic_spline_lut3[1024] = {
-	 0, 0, 0, 0, 0, 0, 0, 0,
-	 0, -1, -1, -1, -1, -1, -2, -2,
-	 -2, -2, -2, -3, -3, -3, -4, -4,
-	 -4, -5, -5, -6, -6, -6, -7, -7,
-	 -8, -8, -9, -9, -10, -10, -11, -11,
-	 -12, -13, -13, -14, -14, -15, -16, -16,
-	 -17, -18, -19, -19, -20, -21, -22, -22,
-	 -23, -24, -25, -26, -26, -27, -28, -29,
-	 -30, -31, -32, -33, -34, -35, -36, -37,
-	 -38, -39, -40, -41, -42, -43, -44, -45,
-	 -46, -47, -48, -49, -51, -52, -53, -54,
-	 -55, -57, -58, -59, -60, -61, -63, -64,
-	 -65, -67, -68, -69, -70, -72, -73, -75,
-	 -76, -77, -79, -80, -82, -83, -84, -86,
-	 -87, -89, -90, -92, -93, -95, -96, -98,
-	 -99, -101, -102, -104, -106, -107, -109, -110,
-	 -112, -114, -115, -117, -119, -120, -122, -124,
-	 -125, -127, -129, -130, -132, -134, -136, -137,
-	 -139, -141, -143, -145, -146, -148, -150, -152,
-	 -154, -156, -157, -159, -161, -163, -165, -167,
-	 -169, -171, -173, -175, -176, -178, -180, -182,
-	 -184, -186, -188, -190, -192, -194, -196, -198,
-	 -200, -202, -205, -207, -209, -211, -213, -215,
-	 -217, -219, -221, -223, -225, -228, -230, -232,
-	 -234, -236, -238, -240, -243, -245, -247, -249,
-	 -251, -254, -256, -258, -260, -263, -265, -267,
-	 -269, -272, -274, -276, -278, -281, -283, -285,
-	 -288, -290, -292, -295, -297, -299, -302, -304,
-	 -306, -309, -311, -313, -316, -318, -320, -323,
-	 -325, -328, -330, -332, -335, -337, -340, -342,
-	 -345, -347, -349, -352, -354, -357, -359, -362,
-	 -364, -367, -369, -372, -374, -377, -379, -382,
-	 -384, -387, -389, -392, -394, -397, -399, -402,
-	 -404, -407, -409, -412, -414, -417, -419, -422,
-	 -424, -427, -430, -432, -435, -437, -440, -442,
-	 -445, -448, -450, -453, -455, -458, -461, -463,
-	 -466, -468, -471, -474, -476, -479, -481, -484,
-	 -487, -489, -492, -495, -497, -500, -502, -505,
-	 -508, -510, -513, -516, -518, -521, -523, -526,
-	 -529, -531, -534, -537, -539, -542, -545, -547,
-	 -550, -553, -555, -558, -561, -563, -566, -569,
-	 -571, -574, -577, -579, -582, -585, -587, -590,
-	 -593, -595, -598, -601, -603, -606, -609, -611,
-	 -614, -617, -619, -622, -625, -627, -630, -633,
-	 -635, -638, -641, -643, -646, -649, -651, -654,
-	 -657, -659, -662, -665, -667, -670, -672, -675,
-	 -678, -680, -683, -686, -688, -691, -694, -696,
-	 -699, -702, -704, -707, -709, -712, -715, -717,
-	 -720, -723, -725, -728, -730, -733, -736, -738,
-	 -741, -744, -746, -749, -751, -754, -757, -759,
-	 -762, -764, -767, -769, -772, -775, -777, -780,
-	 -782, -785, -787, -790, -793, -795, -798, -800,
-	 -803, -805, -808, -810, -813, -815, -818, -820,
-	 -823, -825, -828, -830, -833, -835, -838, -840,
-	 -843, -845, -848, -850, -853, -855, -858, -860,
-	 -863, -865, -867, -870, -872, -875, -877, -880,
-	 -882, -884, -887, -889, -892, -894, -896, -899,
-	 -901, -903, -906, -908, -911, -913, -915, -918,
-	 -920, -922, -924, -927, -929, -931, -934, -936,
-	 -938, -941, -943, -945, -947, -950, -952, -954,
-	 -956, -958, -961, -963, -965, -967, -969, -972,
-	 -974, -976, -978, -980, -982, -985, -987, -989,
-	 -991, -993, -995, -997, -999, -1002, -1004, -1006,
-	 -1008, -1010, -1012, -1014, -1016, -1018, -1020, -1022,
-	 -1024, -1026, -1028, -1030, -1032, -1034, -1036, -1038,
-	 -1040, -1042, -1044, -1046, -1047, -1049, -1051, -1053,
-	 -1055, -1057, -1059, -1061, -1062, -1064, -1066, -1068,
-	 -1070, -1071, -1073, -1075, -1077, -1079, -1080, -1082,
-	 -1084, -1085, -1087, -1089, -1091, -1092, -1094, -1096,
-	 -1097, -1099, -1101, -1102, -1104, -1105, -1107, -1109,
-	 -1110, -1112, -1113, -1115, -1116, -1118, -1119, -1121,
-	 -1122, -1124, -1125, -1127, -1128, -1130, -1131, -1133,
-	 -1134, -1135, -1137, -1138, -1140, -1141, -1142, -1144,
-	 -1145, -1146, -1148, -1149, -1150, -1151, -1153, -1154,
-	 -1155, -1156, -1158, -1159, -1160, -1161, -1162, -1163,
-	 -1165, -1166, -1167, -1168, -1169, -1170, -1171, -1172,
-	 -1173, -1174, -1175, -1176, -1177, -1178, -1179, -1180,
-	 -1181, -1182, -1183, -1184, -1185, -1186, -1187, -1187,
-	 -1188, -1189, -1190, -1191, -1192, -1192, -1193, -1194,
-	 -1195, -1195, -1196, -1197, -1197, -1198, -1199, -1199,
-	 -1200, -1201, -1201, -1202, -1202, -1203, -1204, -1204,
-	 -1205, -1205, -1206, -1206, -1207, -1207, -1207, -1208,
-	 -1208, -1209, -1209, -1209, -1210, -1210, -1210, -1211,
-	 -1211, -1211, -1211, -1212, -1212, -1212, -1212, -1213,
-	 -1213, -1213, -1213, -1213, -1213, -1213, -1213, -1214,
-	 -1214, -1214, -1214, -1214, -1214, -1214, -1214, -1213,
-	 -1213, -1213, -1213, -1213, -1213, -1213, -1213, -1212,
-	 -1212, -1212, -1212, -1212, -1211, -1211, -1211, -1210,
-	 -1210, -1210, -1209, -1209, -1208, -1208, -1208, -1207,
-	 -1207, -1206, -1206, -1205, -1205, -1204, -1204, -1203,
-	 -1202, -1202, -1201, -1200, -1200, -1199, -1198, -1198,
-	 -1197, -1196, -1195, -1195, -1194, -1193, -1192, -1191,
-	 -1190, -1189, -1188, -1187, -1187, -1186, -1185, -1184,
-	 -1182, -1181, -1180, -1179, -1178, -1177, -1176, -1175,
-	 -1174, -1172, -1171, -1170, -1169, -1167, -1166, -1165,
-	 -1163, -1162, -1161, -1159, -1158, -1156, -1155, -1153,
-	 -1152, -1150, -1149, -1147, -1146, -1144, -1143, -1141,
-	 -1139, -1138, -1136, -1134, -1133, -1131, -1129, -1127,
-	 -1125, -1124, -1122, -1120, -1118, -1116, -1114, -1112,
-	 -1110, -1108, -1106, -1104, -1102, -1100, -1098, -1096,
-	 -1094, -1092, -1089, -1087, -1085, -1083, -1080, -1078,
-	 -1076, -1074, -1071, -1069, -1066, -1064, -1062, -1059,
-	 -1057, -1054, -1052, -1049, -1047, -1044, -1041, -1039,
-	 -1036, -1033, -1031, -1028, -1025, -1022, -1020, -1017,
-	 -1014, -1011, -1008, -1005, -1002, -999, -997, -994,
-	 -991, -987, -984, -981, -978, -975, -972, -969,
-	 -966, -962, -959, -956, -953, -949, -946, -943,
-	 -939, -936, -932, -929, -925, -922, -918, -915,
-	 -911, -908, -904, -900, -897, -893, -889, -886,
-	 -882, -878, -874, -870, -866, -863, -859, -855,
-	 -851, -847, -843, -839, -835, -831, -826, -822,
-	 -818, -814, -810, -806, -801, -797, -793, -788,
-	 -784, -780, -775, -771, -766, -762, -757, -753,
-	 -748, -744, -739, -734, -730, -725, -720, -715,
-	 -711, -706, -701, -696, -691, -686, -682, -677,
-	 -672, -667, -662, -656, -651, -646, -641, -636,
-	 -631, -626, -620, -615, -610, -604, -599, -594,
-	 -588, -583, -577, -572, -566, -561, -555, -550,
-	 -544, -538, -533, -527, -521, -515, -510, -504,
-	 -498, -492, -486, -480, -474, -468, -462, -456,
-	 -450, -444, -438, -432, -425, -419, -413, -407,
-	 -400, -394, -388, -381, -375, -368, -362, -355,
-	 -349, -342, -336, -329, -322, -316, -309, -302,
-	 -295, -289, -282, -275, -268, -261, -254, -247,
-	 -240, -233, -226, -219, -212, -205, -198, -190,
-	 -183, -176, -169, -161, -154, -146, -139, -132,
-	 -124, -117, -109, -101, -94, -86, -78, -71,
-	 -63, -55, -47, -40, -32, -24, -16, -8,
+const int16 cubic_spline_lut[4096] = {
+	 0, 16384, 0, 0, -8, 16384, 8, 0,
+	 -16, 16384, 16, 0, -24, 16384, 24, 0,
+	 -32, 16384, 32, 0, -40, 16383, 41, 0,
+	 -47, 16382, 49, 0, -55, 16381, 58, 0,
+	 -63, 16381, 66, 0, -71, 16381, 75, -1,
+	 -78, 16380, 83, -1, -86, 16379, 92, -1,
+	 -94, 16379, 100, -1, -101, 16377, 109, -1,
+	 -109, 16377, 118, -2, -117, 16376, 127, -2,
+	 -124, 16374, 136, -2, -132, 16373, 145, -2,
+	 -139, 16371, 154, -2, -146, 16370, 163, -3,
+	 -154, 16369, 172, -3, -161, 16366, 182, -3,
+	 -169, 16366, 191, -4, -176, 16364, 200, -4,
+	 -183, 16361, 210, -4, -190, 16360, 219, -5,
+	 -198, 16358, 229, -5, -205, 16357, 238, -6,
+	 -212, 16354, 248, -6, -219, 16351, 258, -6,
+	 -226, 16349, 268, -7, -233, 16347, 277, -7,
+	 -240, 16345, 287, -8, -247, 16342, 297, -8,
+	 -254, 16340, 307, -9, -261, 16337, 317, -9,
+	 -268, 16335, 327, -10, -275, 16331, 338, -10,
+	 -282, 16329, 348, -11, -289, 16326, 358, -11,
+	 -295, 16322, 369, -12, -302, 16320, 379, -13,
+	 -309, 16317, 389, -13, -316, 16314, 400, -14,
+	 -322, 16309, 411, -14, -329, 16307, 421, -15,
+	 -336, 16304, 432, -16, -342, 16299, 443, -16,
+	 -349, 16297, 453, -17, -355, 16293, 464, -18,
+	 -362, 16290, 475, -19, -368, 16285, 486, -19,
+	 -375, 16282, 497, -20, -381, 16278, 508, -21,
+	 -388, 16274, 520, -22, -394, 16269, 531, -22,
+	 -400, 16265, 542, -23, -407, 16262, 553, -24,
+	 -413, 16257, 565, -25, -419, 16253, 576, -26,
+	 -425, 16247, 588, -26, -432, 16244, 599, -27,
+	 -438, 16239, 611, -28, -444, 16235, 622, -29,
+	 -450, 16230, 634, -30, -456, 16225, 646, -31,
+	 -462, 16220, 658, -32, -468, 16216, 669, -33,
+	 -474, 16211, 681, -34, -480, 16206, 693, -35,
+	 -486, 16201, 705, -36, -492, 16196, 717, -37,
+	 -498, 16191, 729, -38, -504, 16185, 742, -39,
+	 -510, 16180, 754, -40, -515, 16174, 766, -41,
+	 -521, 16169, 778, -42, -527, 16163, 791, -43,
+	 -533, 16158, 803, -44, -538, 16151, 816, -45,
+	 -544, 16146, 828, -46, -550, 16140, 841, -47,
+	 -555, 16133, 854, -48, -561, 16128, 866, -49,
+	 -566, 16122, 879, -51, -572, 16116, 892, -52,
+	 -577, 16109, 905, -53, -583, 16104, 917, -54,
+	 -588, 16097, 930, -55, -594, 16092, 943, -57,
+	 -599, 16085, 956, -58, -604, 16077, 970, -59,
+	 -610, 16071, 983, -60, -615, 16064, 996, -61,
+	 -620, 16058, 1009, -63, -626, 16052, 1022, -64,
+	 -631, 16044, 1036, -65, -636, 16038, 1049, -67,
+	 -641, 16030, 1063, -68, -646, 16023, 1076, -69,
+	 -651, 16015, 1090, -70, -656, 16009, 1103, -72,
+	 -662, 16002, 1117, -73, -667, 15995, 1131, -75,
+	 -672, 15988, 1144, -76, -677, 15980, 1158, -77,
+	 -682, 15973, 1172, -79, -686, 15964, 1186, -80,
+	 -691, 15957, 1200, -82, -696, 15949, 1214, -83,
+	 -701, 15941, 1228, -84, -706, 15934, 1242, -86,
+	 -711, 15926, 1256, -87, -715, 15918, 1270, -89,
+	 -720, 15910, 1284, -90, -725, 15903, 1298, -92,
+	 -730, 15894, 1313, -93, -734, 15886, 1327, -95,
+	 -739, 15877, 1342, -96, -744, 15870, 1356, -98,
+	 -748, 15861, 1370, -99, -753, 15853, 1385, -101,
+	 -757, 15843, 1400, -102, -762, 15836, 1414, -104,
+	 -766, 15827, 1429, -106, -771, 15818, 1444, -107,
+	 -775, 15810, 1458, -109, -780, 15801, 1473, -110,
+	 -784, 15792, 1488, -112, -788, 15783, 1503, -114,
+	 -793, 15774, 1518, -115, -797, 15765, 1533, -117,
+	 -801, 15756, 1548, -119, -806, 15747, 1563, -120,
+	 -810, 15738, 1578, -122, -814, 15729, 1593, -124,
+	 -818, 15719, 1608, -125, -822, 15709, 1624, -127,
+	 -826, 15700, 1639, -129, -831, 15691, 1654, -130,
+	 -835, 15681, 1670, -132, -839, 15672, 1685, -134,
+	 -843, 15662, 1701, -136, -847, 15652, 1716, -137,
+	 -851, 15642, 1732, -139, -855, 15633, 1747, -141,
+	 -859, 15623, 1763, -143, -863, 15613, 1779, -145,
+	 -866, 15602, 1794, -146, -870, 15592, 1810, -148,
+	 -874, 15582, 1826, -150, -878, 15572, 1842, -152,
+	 -882, 15562, 1858, -154, -886, 15552, 1874, -156,
+	 -889, 15540, 1890, -157, -893, 15530, 1906, -159,
+	 -897, 15520, 1922, -161, -900, 15509, 1938, -163,
+	 -904, 15499, 1954, -165, -908, 15489, 1970, -167,
+	 -911, 15478, 1986, -169, -915, 15467, 2003, -171,
+	 -918, 15456, 2019, -173, -922, 15446, 2035, -175,
+	 -925, 15433, 2052, -176, -929, 15423, 2068, -178,
+	 -932, 15412, 2084, -180, -936, 15401, 2101, -182,
+	 -939, 15390, 2117, -184, -943, 15379, 2134, -186,
+	 -946, 15367, 2151, -188, -949, 15356, 2167, -190,
+	 -953, 15345, 2184, -192, -956, 15333, 2201, -194,
+	 -959, 15321, 2218, -196, -962, 15310, 2234, -198,
+	 -966, 15299, 2251, -200, -969, 15287, 2268, -202,
+	 -972, 15276, 2285, -205, -975, 15264, 2302, -207,
+	 -978, 15252, 2319, -209, -981, 15240, 2336, -211,
+	 -984, 15228, 2353, -213, -987, 15216, 2370, -215,
+	 -991, 15205, 2387, -217, -994, 15192, 2405, -219,
+	 -997, 15180, 2422, -221, -999, 15167, 2439, -223,
+	 -1002, 15155, 2456, -225, -1005, 15143, 2474, -228,
+	 -1008, 15131, 2491, -230, -1011, 15118, 2509, -232,
+	 -1014, 15106, 2526, -234, -1017, 15094, 2543, -236,
+	 -1020, 15081, 2561, -238, -1022, 15067, 2579, -240,
+	 -1025, 15056, 2596, -243, -1028, 15043, 2614, -245,
+	 -1031, 15031, 2631, -247, -1033, 15017, 2649, -249,
+	 -1036, 15004, 2667, -251, -1039, 14992, 2685, -254,
+	 -1041, 14979, 2702, -256, -1044, 14966, 2720, -258,
+	 -1047, 14953, 2738, -260, -1049, 14940, 2756, -263,
+	 -1052, 14927, 2774, -265, -1054, 14913, 2792, -267,
+	 -1057, 14900, 2810, -269, -1059, 14887, 2828, -272,
+	 -1062, 14874, 2846, -274, -1064, 14860, 2864, -276,
+	 -1066, 14846, 2882, -278, -1069, 14833, 2901, -281,
+	 -1071, 14819, 2919, -283, -1074, 14806, 2937, -285,
+	 -1076, 14793, 2955, -288, -1078, 14778, 2974, -290,
+	 -1080, 14764, 2992, -292, -1083, 14752, 3010, -295,
+	 -1085, 14737, 3029, -297, -1087, 14723, 3047, -299,
+	 -1089, 14709, 3066, -302, -1092, 14696, 3084, -304,
+	 -1094, 14681, 3103, -306, -1096, 14668, 3121, -309,
+	 -1098, 14653, 3140, -311, -1100, 14638, 3159, -313,
+	 -1102, 14625, 3177, -316, -1104, 14610, 3196, -318,
+	 -1106, 14595, 3215, -320, -1108, 14582, 3233, -323,
+	 -1110, 14567, 3252, -325, -1112, 14553, 3271, -328,
+	 -1114, 14538, 3290, -330, -1116, 14523, 3309, -332,
+	 -1118, 14509, 3328, -335, -1120, 14494, 3347, -337,
+	 -1122, 14480, 3366, -340, -1124, 14465, 3385, -342,
+	 -1125, 14450, 3404, -345, -1127, 14435, 3423, -347,
+	 -1129, 14420, 3442, -349, -1131, 14406, 3461, -352,
+	 -1133, 14391, 3480, -354, -1134, 14376, 3499, -357,
+	 -1136, 14361, 3518, -359, -1138, 14346, 3538, -362,
+	 -1139, 14330, 3557, -364, -1141, 14316, 3576, -367,
+	 -1143, 14301, 3595, -369, -1144, 14285, 3615, -372,
+	 -1146, 14270, 3634, -374, -1147, 14254, 3654, -377,
+	 -1149, 14239, 3673, -379, -1150, 14223, 3693, -382,
+	 -1152, 14208, 3712, -384, -1153, 14192, 3732, -387,
+	 -1155, 14177, 3751, -389, -1156, 14161, 3771, -392,
+	 -1158, 14146, 3790, -394, -1159, 14130, 3810, -397,
+	 -1161, 14115, 3829, -399, -1162, 14099, 3849, -402,
+	 -1163, 14082, 3869, -404, -1165, 14067, 3889, -407,
+	 -1166, 14051, 3908, -409, -1167, 14035, 3928, -412,
+	 -1169, 14019, 3948, -414, -1170, 14003, 3968, -417,
+	 -1171, 13986, 3988, -419, -1172, 13971, 4007, -422,
+	 -1174, 13955, 4027, -424, -1175, 13939, 4047, -427,
+	 -1176, 13923, 4067, -430, -1177, 13906, 4087, -432,
+	 -1178, 13890, 4107, -435, -1179, 13873, 4127, -437,
+	 -1180, 13857, 4147, -440, -1181, 13840, 4167, -442,
+	 -1182, 13823, 4188, -445, -1184, 13808, 4208, -448,
+	 -1185, 13791, 4228, -450, -1186, 13775, 4248, -453,
+	 -1187, 13758, 4268, -455, -1187, 13741, 4288, -458,
+	 -1188, 13724, 4309, -461, -1189, 13707, 4329, -463,
+	 -1190, 13691, 4349, -466, -1191, 13673, 4370, -468,
+	 -1192, 13657, 4390, -471, -1193, 13641, 4410, -474,
+	 -1194, 13623, 4431, -476, -1195, 13607, 4451, -479,
+	 -1195, 13589, 4471, -481, -1196, 13572, 4492, -484,
+	 -1197, 13556, 4512, -487, -1198, 13538, 4533, -489,
+	 -1198, 13521, 4553, -492, -1199, 13504, 4574, -495,
+	 -1200, 13486, 4595, -497, -1200, 13469, 4615, -500,
+	 -1201, 13451, 4636, -502, -1202, 13435, 4656, -505,
+	 -1202, 13417, 4677, -508, -1203, 13399, 4698, -510,
+	 -1204, 13383, 4718, -513, -1204, 13365, 4739, -516,
+	 -1205, 13347, 4760, -518, -1205, 13330, 4780, -521,
+	 -1206, 13312, 4801, -523, -1206, 13294, 4822, -526,
+	 -1207, 13277, 4843, -529, -1207, 13258, 4864, -531,
+	 -1208, 13241, 4885, -534, -1208, 13224, 4905, -537,
+	 -1208, 13205, 4926, -539, -1209, 13188, 4947, -542,
+	 -1209, 13170, 4968, -545, -1210, 13152, 4989, -547,
+	 -1210, 13134, 5010, -550, -1210, 13116, 5031, -553,
+	 -1211, 13098, 5052, -555, -1211, 13080, 5073, -558,
+	 -1211, 13062, 5094, -561, -1212, 13044, 5115, -563,
+	 -1212, 13026, 5136, -566, -1212, 13008, 5157, -569,
+	 -1212, 12989, 5178, -571, -1212, 12971, 5199, -574,
+	 -1213, 12953, 5221, -577, -1213, 12934, 5242, -579,
+	 -1213, 12916, 5263, -582, -1213, 12898, 5284, -585,
+	 -1213, 12879, 5305, -587, -1213, 12860, 5327, -590,
+	 -1213, 12842, 5348, -593, -1213, 12823, 5369, -595,
+	 -1214, 12806, 5390, -598, -1214, 12787, 5412, -601,
+	 -1214, 12768, 5433, -603, -1214, 12750, 5454, -606,
+	 -1214, 12731, 5476, -609, -1214, 12712, 5497, -611,
+	 -1214, 12694, 5518, -614, -1214, 12675, 5540, -617,
+	 -1213, 12655, 5561, -619, -1213, 12637, 5582, -622,
+	 -1213, 12618, 5604, -625, -1213, 12599, 5625, -627,
+	 -1213, 12580, 5647, -630, -1213, 12562, 5668, -633,
+	 -1213, 12542, 5690, -635, -1213, 12524, 5711, -638,
+	 -1212, 12504, 5733, -641, -1212, 12485, 5754, -643,
+	 -1212, 12466, 5776, -646, -1212, 12448, 5797, -649,
+	 -1211, 12427, 5819, -651, -1211, 12408, 5841, -654,
+	 -1211, 12390, 5862, -657, -1211, 12370, 5884, -659,
+	 -1210, 12351, 5905, -662, -1210, 12332, 5927, -665,
+	 -1210, 12312, 5949, -667, -1209, 12293, 5970, -670,
+	 -1209, 12273, 5992, -672, -1209, 12254, 6014, -675,
+	 -1208, 12235, 6035, -678, -1208, 12215, 6057, -680,
+	 -1207, 12195, 6079, -683, -1207, 12176, 6101, -686,
+	 -1207, 12157, 6122, -688, -1206, 12137, 6144, -691,
+	 -1206, 12118, 6166, -694, -1205, 12097, 6188, -696,
+	 -1205, 12079, 6209, -699, -1204, 12059, 6231, -702,
+	 -1204, 12039, 6253, -704, -1203, 12019, 6275, -707,
+	 -1202, 11998, 6297, -709, -1202, 11980, 6318, -712,
+	 -1201, 11960, 6340, -715, -1201, 11940, 6362, -717,
+	 -1200, 11920, 6384, -720, -1199, 11900, 6406, -723,
+	 -1199, 11880, 6428, -725, -1198, 11860, 6450, -728,
+	 -1197, 11839, 6472, -730, -1197, 11821, 6493, -733,
+	 -1196, 11801, 6515, -736, -1195, 11780, 6537, -738,
+	 -1195, 11761, 6559, -741, -1194, 11741, 6581, -744,
+	 -1193, 11720, 6603, -746, -1192, 11700, 6625, -749,
+	 -1192, 11680, 6647, -751, -1191, 11660, 6669, -754,
+	 -1190, 11640, 6691, -757, -1189, 11619, 6713, -759,
+	 -1188, 11599, 6735, -762, -1187, 11578, 6757, -764,
+	 -1187, 11559, 6779, -767, -1186, 11538, 6801, -769,
+	 -1185, 11518, 6823, -772, -1184, 11498, 6845, -775,
+	 -1183, 11477, 6867, -777, -1182, 11457, 6889, -780,
+	 -1181, 11436, 6911, -782, -1180, 11415, 6934, -785,
+	 -1179, 11394, 6956, -787, -1178, 11374, 6978, -790,
+	 -1177, 11354, 7000, -793, -1176, 11333, 7022, -795,
+	 -1175, 11313, 7044, -798, -1174, 11292, 7066, -800,
+	 -1173, 11272, 7088, -803, -1172, 11251, 7110, -805,
+	 -1171, 11231, 7132, -808, -1170, 11209, 7155, -810,
+	 -1169, 11189, 7177, -813, -1168, 11168, 7199, -815,
+	 -1167, 11148, 7221, -818, -1166, 11127, 7243, -820,
+	 -1165, 11107, 7265, -823, -1163, 11084, 7288, -825,
+	 -1162, 11064, 7310, -828, -1161, 11043, 7332, -830,
+	 -1160, 11023, 7354, -833, -1159, 11002, 7376, -835,
+	 -1158, 10982, 7398, -838, -1156, 10959, 7421, -840,
+	 -1155, 10939, 7443, -843, -1154, 10918, 7465, -845,
+	 -1153, 10898, 7487, -848, -1151, 10876, 7509, -850,
+	 -1150, 10856, 7531, -853, -1149, 10834, 7554, -855,
+	 -1148, 10814, 7576, -858, -1146, 10792, 7598, -860,
+	 -1145, 10772, 7620, -863, -1144, 10750, 7643, -865,
+	 -1142, 10728, 7665, -867, -1141, 10708, 7687, -870,
+	 -1140, 10687, 7709, -872, -1138, 10666, 7731, -875,
+	 -1137, 10644, 7754, -877, -1135, 10623, 7776, -880,
+	 -1134, 10602, 7798, -882, -1133, 10581, 7820, -884,
+	 -1131, 10560, 7842, -887, -1130, 10538, 7865, -889,
+	 -1128, 10517, 7887, -892, -1127, 10496, 7909, -894,
+	 -1125, 10474, 7931, -896, -1124, 10453, 7954, -899,
+	 -1122, 10431, 7976, -901, -1121, 10410, 7998, -903,
+	 -1119, 10389, 8020, -906, -1118, 10368, 8042, -908,
+	 -1116, 10346, 8065, -911, -1115, 10325, 8087, -913,
+	 -1113, 10303, 8109, -915, -1112, 10283, 8131, -918,
+	 -1110, 10260, 8154, -920, -1109, 10239, 8176, -922,
+	 -1107, 10217, 8198, -924, -1105, 10196, 8220, -927,
+	 -1104, 10175, 8242, -929, -1102, 10152, 8265, -931,
+	 -1101, 10132, 8287, -934, -1099, 10110, 8309, -936,
+	 -1097, 10088, 8331, -938, -1096, 10068, 8353, -941,
+	 -1094, 10045, 8376, -943, -1092, 10023, 8398, -945,
+	 -1091, 10002, 8420, -947, -1089, 9981, 8442, -950,
+	 -1087, 9959, 8464, -952, -1085, 9936, 8487, -954,
+	 -1084, 9915, 8509, -956, -1082, 9893, 8531, -958,
+	 -1080, 9872, 8553, -961, -1079, 9851, 8575, -963,
+	 -1077, 9829, 8597, -965, -1075, 9806, 8620, -967,
+	 -1073, 9784, 8642, -969, -1071, 9763, 8664, -972,
+	 -1070, 9742, 8686, -974, -1068, 9720, 8708, -976,
+	 -1066, 9698, 8730, -978, -1064, 9676, 8752, -980,
+	 -1062, 9653, 8775, -982, -1061, 9633, 8797, -985,
+	 -1059, 9611, 8819, -987, -1057, 9589, 8841, -989,
+	 -1055, 9567, 8863, -991, -1053, 9545, 8885, -993,
+	 -1051, 9523, 8907, -995, -1049, 9501, 8929, -997,
+	 -1047, 9479, 8951, -999, -1046, 9458, 8974, -1002,
+	 -1044, 9436, 8996, -1004, -1042, 9414, 9018, -1006,
+	 -1040, 9392, 9040, -1008, -1038, 9370, 9062, -1010,
+	 -1036, 9348, 9084, -1012, -1034, 9326, 9106, -1014,
+	 -1032, 9304, 9128, -1016, -1030, 9282, 9150, -1018,
+	 -1028, 9260, 9172, -1020, -1026, 9238, 9194, -1022,
+	 -1024, 9216, 9216, -1024, -1022, 9194, 9238, -1026,
+	 -1020, 9172, 9260, -1028, -1018, 9150, 9282, -1030,
+	 -1016, 9128, 9304, -1032, -1014, 9106, 9326, -1034,
+	 -1012, 9084, 9348, -1036, -1010, 9062, 9370, -1038,
+	 -1008, 9040, 9392, -1040, -1006, 9018, 9414, -1042,
+	 -1004, 8996, 9436, -1044, -1002, 8974, 9458, -1046,
+	 -999, 8951, 9479, -1047, -997, 8929, 9501, -1049,
+	 -995, 8907, 9523, -1051, -993, 8885, 9545, -1053,
+	 -991, 8863, 9567, -1055, -989, 8841, 9589, -1057,
+	 -987, 8819, 9611, -1059, -985, 8797, 9633, -1061,
+	 -982, 8775, 9653, -1062, -980, 8752, 9676, -1064,
+	 -978, 8730, 9698, -1066, -976, 8708, 9720, -1068,
+	 -974, 8686, 9742, -1070, -972, 8664, 9763, -1071,
+	 -969, 8642, 9784, -1073, -967, 8620, 9806, -1075,
+	 -965, 8597, 9829, -1077, -963, 8575, 9851, -1079,
+	 -961, 8553, 9872, -1080, -958, 8531, 9893, -1082,
+	 -956, 8509, 9915, -1084, -954, 8487, 9936, -1085,
+	 -952, 8464, 9959, -1087, -950, 8442, 9981, -1089,
+	 -947, 8420, 10002, -1091, -945, 8398, 10023, -1092,
+	 -943, 8376, 10045, -1094, -941, 8353, 10068, -1096,
+	 -938, 8331, 10088, -1097, -936, 8309, 10110, -1099,
+	 -934, 8287, 10132, -1101, -931, 8265, 10152, -1102,
+	 -929, 8242, 10175, -1104, -927, 8220, 10196, -1105,
+	 -924, 8198, 10217, -1107, -922, 8176, 10239, -1109,
+	 -920, 8154, 10260, -1110, -918, 8131, 10283, -1112,
+	 -915, 8109, 10303, -1113, -913, 8087, 10325, -1115,
+	 -911, 8065, 10346, -1116, -908, 8042, 10368, -1118,
+	 -906, 8020, 10389, -1119, -903, 7998, 10410, -1121,
+	 -901, 7976, 10431, -1122, -899, 7954, 10453, -1124,
+	 -896, 7931, 10474, -1125, -894, 7909, 10496, -1127,
+	 -892, 7887, 10517, -1128, -889, 7865, 10538, -1130,
+	 -887, 7842, 10560, -1131, -884, 7820, 10581, -1133,
+	 -882, 7798, 10602, -1134, -880, 7776, 10623, -1135,
+	 -877, 7754, 10644, -1137, -875, 7731, 10666, -1138,
+	 -872, 7709, 10687, -1140, -870, 7687, 10708, -1141,
+	 -867, 7665, 10728, -1142, -865, 7643, 10750, -1144,
+	 -863, 7620, 10772, -1145, -860, 7598, 10792, -1146,
+	 -858, 7576, 10814, -1148, -855, 7554, 10834, -1149,
+	 -853, 7531, 10856, -1150, -850, 7509, 10876, -1151,
+	 -848, 7487, 10898, -1153, -845, 7465, 10918, -1154,
+	 -843, 7443, 10939, -1155, -840, 7421, 10959, -1156,
+	 -838, 7398, 10982, -1158, -835, 7376, 11002, -1159,
+	 -833, 7354, 11023, -1160, -830, 7332, 11043, -1161,
+	 -828, 7310, 11064, -1162, -825, 7288, 11084, -1163,
+	 -823, 7265, 11107, -1165, -820, 7243, 11127, -1166,
+	 -818, 7221, 11148, -1167, -815, 7199, 11168, -1168,
+	 -813, 7177, 11189, -1169, -810, 7155, 11209, -1170,
+	 -808, 7132, 11231, -1171, -805, 7110, 11251, -1172,
+	 -803, 7088, 11272, -1173, -800, 7066, 11292, -1174,
+	 -798, 7044, 11313, -1175, -795, 7022, 11333, -1176,
+	 -793, 7000, 11354, -1177, -790, 6978, 11374, -1178,
+	 -787, 6956, 11394, -1179, -785, 6934, 11415, -1180,
+	 -782, 6911, 11436, -1181, -780, 6889, 11457, -1182,
+	 -777, 6867, 11477, -1183, -775, 6845, 11498, -1184,
+	 -772, 6823, 11518, -1185, -769, 6801, 11538, -1186,
+	 -767, 6779, 11559, -1187, -764, 6757, 11578, -1187,
+	 -762, 6735, 11599, -1188, -759, 6713, 11619, -1189,
+	 -757, 6691, 11640, -1190, -754, 6669, 11660, -1191,
+	 -751, 6647, 11680, -1192, -749, 6625, 11700, -1192,
+	 -746, 6603, 11720, -1193, -744, 6581, 11741, -1194,
+	 -741, 6559, 11761, -1195, -738, 6537, 11780, -1195,
+	 -736, 6515, 11801, -1196, -733, 6493, 11821, -1197,
+	 -730, 6472, 11839, -1197, -728, 6450, 11860, -1198,
+	 -725, 6428, 11880, -1199, -723, 6406, 11900, -1199,
+	 -720, 6384, 11920, -1200, -717, 6362, 11940, -1201,
+	 -715, 6340, 11960, -1201, -712, 6318, 11980, -1202,
+	 -709, 6297, 11998, -1202, -707, 6275, 12019, -1203,
+	 -704, 6253, 12039, -1204, -702, 6231, 12059, -1204,
+	 -699, 6209, 12079, -1205, -696, 6188, 12097, -1205,
+	 -694, 6166, 12118, -1206, -691, 6144, 12137, -1206,
+	 -688, 6122, 12157, -1207, -686, 6101, 12176, -1207,
+	 -683, 6079, 12195, -1207, -680, 6057, 12215, -1208,
+	 -678, 6035, 12235, -1208, -675, 6014, 12254, -1209,
+	 -672, 5992, 12273, -1209, -670, 5970, 12293, -1209,
+	 -667, 5949, 12312, -1210, -665, 5927, 12332, -1210,
+	 -662, 5905, 12351, -1210, -659, 5884, 12370, -1211,
+	 -657, 5862, 12390, -1211, -654, 5841, 12408, -1211,
+	 -651, 5819, 12427, -1211, -649, 5797, 12448, -1212,
+	 -646, 5776, 12466, -1212, -643, 5754, 12485, -1212,
+	 -641, 5733, 12504, -1212, -638, 5711, 12524, -1213,
+	 -635, 5690, 12542, -1213, -633, 5668, 12562, -1213,
+	 -630, 5647, 12580, -1213, -627, 5625, 12599, -1213,
+	 -625, 5604, 12618, -1213, -622, 5582, 12637, -1213,
+	 -619, 5561, 12655, -1213, -617, 5540, 12675, -1214,
+	 -614, 5518, 12694, -1214, -611, 5497, 12712, -1214,
+	 -609, 5476, 12731, -1214, -606, 5454, 12750, -1214,
+	 -603, 5433, 12768, -1214, -601, 5412, 12787, -1214,
+	 -598, 5390, 12806, -1214, -595, 5369, 12823, -1213,
+	 -593, 5348, 12842, -1213, -590, 5327, 12860, -1213,
+	 -587, 5305, 12879, -1213, -585, 5284, 12898, -1213,
+	 -582, 5263, 12916, -1213, -579, 5242, 12934, -1213,
+	 -577, 5221, 12953, -1213, -574, 5199, 12971, -1212,
+	 -571, 5178, 12989, -1212, -569, 5157, 13008, -1212,
+	 -566, 5136, 13026, -1212, -563, 5115, 13044, -1212,
+	 -561, 5094, 13062, -1211, -558, 5073, 13080, -1211,
+	 -555, 5052, 13098, -1211, -553, 5031, 13116, -1210,
+	 -550, 5010, 13134, -1210, -547, 4989, 13152, -1210,
+	 -545, 4968, 13170, -1209, -542, 4947, 13188, -1209,
+	 -539, 4926, 13205, -1208, -537, 4905, 13224, -1208,
+	 -534, 4885, 13241, -1208, -531, 4864, 13258, -1207,
+	 -529, 4843, 13277, -1207, -526, 4822, 13294, -1206,
+	 -523, 4801, 13312, -1206, -521, 4780, 13330, -1205,
+	 -518, 4760, 13347, -1205, -516, 4739, 13365, -1204,
+	 -513, 4718, 13383, -1204, -510, 4698, 13399, -1203,
+	 -508, 4677, 13417, -1202, -505, 4656, 13435, -1202,
+	 -502, 4636, 13451, -1201, -500, 4615, 13469, -1200,
+	 -497, 4595, 13486, -1200, -495, 4574, 13504, -1199,
+	 -492, 4553, 13521, -1198, -489, 4533, 13538, -1198,
+	 -487, 4512, 13556, -1197, -484, 4492, 13572, -1196,
+	 -481, 4471, 13589, -1195, -479, 4451, 13607, -1195,
+	 -476, 4431, 13623, -1194, -474, 4410, 13641, -1193,
+	 -471, 4390, 13657, -1192, -468, 4370, 13673, -1191,
+	 -466, 4349, 13691, -1190, -463, 4329, 13707, -1189,
+	 -461, 4309, 13724, -1188, -458, 4288, 13741, -1187,
+	 -455, 4268, 13758, -1187, -453, 4248, 13775, -1186,
+	 -450, 4228, 13791, -1185, -448, 4208, 13808, -1184,
+	 -445, 4188, 13823, -1182, -442, 4167, 13840, -1181,
+	 -440, 4147, 13857, -1180, -437, 4127, 13873, -1179,
+	 -435, 4107, 13890, -1178, -432, 4087, 13906, -1177,
+	 -430, 4067, 13923, -1176, -427, 4047, 13939, -1175,
+	 -424, 4027, 13955, -1174, -422, 4007, 13971, -1172,
+	 -419, 3988, 13986, -1171, -417, 3968, 14003, -1170,
+	 -414, 3948, 14019, -1169, -412, 3928, 14035, -1167,
+	 -409, 3908, 14051, -1166, -407, 3889, 14067, -1165,
+	 -404, 3869, 14082, -1163, -402, 3849, 14099, -1162,
+	 -399, 3829, 14115, -1161, -397, 3810, 14130, -1159,
+	 -394, 3790, 14146, -1158, -392, 3771, 14161, -1156,
+	 -389, 3751, 14177, -1155, -387, 3732, 14192, -1153,
+	 -384, 3712, 14208, -1152, -382, 3693, 14223, -1150,
+	 -379, 3673, 14239, -1149, -377, 3654, 14254, -1147,
+	 -374, 3634, 14270, -1146, -372, 3615, 14285, -1144,
+	 -369, 3595, 14301, -1143, -367, 3576, 14316, -1141,
+	 -364, 3557, 14330, -1139, -362, 3538, 14346, -1138,
+	 -359, 3518, 14361, -1136, -357, 3499, 14376, -1134,
+	 -354, 3480, 14391, -1133, -352, 3461, 14406, -1131,
+	 -349, 3442, 14420, -1129, -347, 3423, 14435, -1127,
+	 -345, 3404, 14450, -1125, -342, 3385, 14465, -1124,
+	 -340, 3366, 14480, -1122, -337, 3347, 14494, -1120,
+	 -335, 3328, 14509, -1118, -332, 3309, 14523, -1116,
+	 -330, 3290, 14538, -1114, -328, 3271, 14553, -1112,
+	 -325, 3252, 14567, -1110, -323, 3233, 14582, -1108,
+	 -320, 3215, 14595, -1106, -318, 3196, 14610, -1104,
+	 -316, 3177, 14625, -1102, -313, 3159, 14638, -1100,
+	 -311, 3140, 14653, -1098, -309, 3121, 14668, -1096,
+	 -306, 3103, 14681, -1094, -304, 3084, 14696, -1092,
+	 -302, 3066, 14709, -1089, -299, 3047, 14723, -1087,
+	 -297, 3029, 14737, -1085, -295, 3010, 14752, -1083,
+	 -292, 2992, 14764, -1080, -290, 2974, 14778, -1078,
+	 -288, 2955, 14793, -1076, -285, 2937, 14806, -1074,
+	 -283, 2919, 14819, -1071, -281, 2901, 14833, -1069,
+	 -278, 2882, 14846, -1066, -276, 2864, 14860, -1064,
+	 -274, 2846, 14874, -1062, -272, 2828, 14887, -1059,
+	 -269, 2810, 14900, -1057, -267, 2792, 14913, -1054,
+	 -265, 2774, 14927, -1052, -263, 2756, 14940, -1049,
+	 -260, 2738, 14953, -1047, -258, 2720, 14966, -1044,
+	 -256, 2702, 14979, -1041, -254, 2685, 14992, -1039,
+	 -251, 2667, 15004, -1036, -249, 2649, 15017, -1033,
+	 -247, 2631, 15031, -1031, -245, 2614, 15043, -1028,
+	 -243, 2596, 15056, -1025, -240, 2579, 15067, -1022,
+	 -238, 2561, 15081, -1020, -236, 2543, 15094, -1017,
+	 -234, 2526, 15106, -1014, -232, 2509, 15118, -1011,
+	 -230, 2491, 15131, -1008, -228, 2474, 15143, -1005,
+	 -225, 2456, 15155, -1002, -223, 2439, 15167, -999,
+	 -221, 2422, 15180, -997, -219, 2405, 15192, -994,
+	 -217, 2387, 15205, -991, -215, 2370, 15216, -987,
+	 -213, 2353, 15228, -984, -211, 2336, 15240, -981,
+	 -209, 2319, 15252, -978, -207, 2302, 15264, -975,
+	 -205, 2285, 15276, -972, -202, 2268, 15287, -969,
+	 -200, 2251, 15299, -966, -198, 2234, 15310, -962,
+	 -196, 2218, 15321, -959, -194, 2201, 15333, -956,
+	 -192, 2184, 15345, -953, -190, 2167, 15356, -949,
+	 -188, 2151, 15367, -946, -186, 2134, 15379, -943,
+	 -184, 2117, 15390, -939, -182, 2101, 15401, -936,
+	 -180, 2084, 15412, -932, -178, 2068, 15423, -929,
+	 -176, 2052, 15433, -925, -175, 2035, 15446, -922,
+	 -173, 2019, 15456, -918, -171, 2003, 15467, -915,
+	 -169, 1986, 15478, -911, -167, 1970, 15489, -908,
+	 -165, 1954, 15499, -904, -163, 1938, 15509, -900,
+	 -161, 1922, 15520, -897, -159, 1906, 15530, -893,
+	 -157, 1890, 15540, -889, -156, 1874, 15552, -886,
+	 -154, 1858, 15562, -882, -152, 1842, 15572, -878,
+	 -150, 1826, 15582, -874, -148, 1810, 15592, -870,
+	 -146, 1794, 15602, -866, -145, 1779, 15613, -863,
+	 -143, 1763, 15623, -859, -141, 1747, 15633, -855,
+	 -139, 1732, 15642, -851, -137, 1716, 15652, -847,
+	 -136, 1701, 15662, -843, -134, 1685, 15672, -839,
+	 -132, 1670, 15681, -835, -130, 1654, 15691, -831,
+	 -129, 1639, 15700, -826, -127, 1624, 15709, -822,
+	 -125, 1608, 15719, -818, -124, 1593, 15729, -814,
+	 -122, 1578, 15738, -810, -120, 1563, 15747, -806,
+	 -119, 1548, 15756, -801, -117, 1533, 15765, -797,
+	 -115, 1518, 15774, -793, -114, 1503, 15783, -788,
+	 -112, 1488, 15792, -784, -110, 1473, 15801, -780,
+	 -109, 1458, 15810, -775, -107, 1444, 15818, -771,
+	 -106, 1429, 15827, -766, -104, 1414, 15836, -762,
+	 -102, 1400, 15843, -757, -101, 1385, 15853, -753,
+	 -99, 1370, 15861, -748, -98, 1356, 15870, -744,
+	 -96, 1342, 15877, -739, -95, 1327, 15886, -734,
+	 -93, 1313, 15894, -730, -92, 1298, 15903, -725,
+	 -90, 1284, 15910, -720, -89, 1270, 15918, -715,
+	 -87, 1256, 15926, -711, -86, 1242, 15934, -706,
+	 -84, 1228, 15941, -701, -83, 1214, 15949, -696,
+	 -82, 1200, 15957, -691, -80, 1186, 15964, -686,
+	 -79, 1172, 15973, -682, -77, 1158, 15980, -677,
+	 -76, 1144, 15988, -672, -75, 1131, 15995, -667,
+	 -73, 1117, 16002, -662, -72, 1103, 16009, -656,
+	 -70, 1090, 16015, -651, -69, 1076, 16023, -646,
+	 -68, 1063, 16030, -641, -67, 1049, 16038, -636,
+	 -65, 1036, 16044, -631, -64, 1022, 16052, -626,
+	 -63, 1009, 16058, -620, -61, 996, 16064, -615,
+	 -60, 983, 16071, -610, -59, 970, 16077, -604,
+	 -58, 956, 16085, -599, -57, 943, 16092, -594,
+	 -55, 930, 16097, -588, -54, 917, 16104, -583,
+	 -53, 905, 16109, -577, -52, 892, 16116, -572,
+	 -51, 879, 16122, -566, -49, 866, 16128, -561,
+	 -48, 854, 16133, -555, -47, 841, 16140, -550,
+	 -46, 828, 16146, -544, -45, 816, 16151, -538,
+	 -44, 803, 16158, -533, -43, 791, 16163, -527,
+	 -42, 778, 16169, -521, -41, 766, 16174, -515,
+	 -40, 754, 16180, -510, -39, 742, 16185, -504,
+	 -38, 729, 16191, -498, -37, 717, 16196, -492,
+	 -36, 705, 16201, -486, -35, 693, 16206, -480,
+	 -34, 681, 16211, -474, -33, 669, 16216, -468,
+	 -32, 658, 16220, -462, -31, 646, 16225, -456,
+	 -30, 634, 16230, -450, -29, 622, 16235, -444,
+	 -28, 611, 16239, -438, -27, 599, 16244, -432,
+	 -26, 588, 16247, -425, -26, 576, 16253, -419,
+	 -25, 565, 16257, -413, -24, 553, 16262, -407,
+	 -23, 542, 16265, -400, -22, 531, 16269, -394,
+	 -22, 520, 16274, -388, -21, 508, 16278, -381,
+	 -20, 497, 16282, -375, -19, 486, 16285, -368,
+	 -19, 475, 16290, -362, -18, 464, 16293, -355,
+	 -17, 453, 16297, -349, -16, 443, 16299, -342,
+	 -16, 432, 16304, -336, -15, 421, 16307, -329,
+	 -14, 411, 16309, -322, -14, 400, 16314, -316,
+	 -13, 389, 16317, -309, -13, 379, 16320, -302,
+	 -12, 369, 16322, -295, -11, 358, 16326, -289,
+	 -11, 348, 16329, -282, -10, 338, 16331, -275,
+	 -10, 327, 16335, -268, -9, 317, 16337, -261,
+	 -9, 307, 16340, -254, -8, 297, 16342, -247,
+	 -8, 287, 16345, -240, -7, 277, 16347, -233,
+	 -7, 268, 16349, -226, -6, 258, 16351, -219,
+	 -6, 248, 16354, -212, -6, 238, 16357, -205,
+	 -5, 229, 16358, -198, -5, 219, 16360, -190,
+	 -4, 210, 16361, -183, -4, 200, 16364, -176,
+	 -4, 191, 16366, -169, -3, 182, 16366, -161,
+	 -3, 172, 16369, -154, -3, 163, 16370, -146,
+	 -2, 154, 16371, -139, -2, 145, 16373, -132,
+	 -2, 136, 16374, -124, -2, 127, 16376, -117,
+	 -2, 118, 16377, -109, -1, 109, 16377, -101,
+	 -1, 100, 16379, -94, -1, 92, 16379, -86,
+	 -1, 83, 16380, -78, -1, 75, 16381, -71,
+	 0, 66, 16381, -63, 0, 58, 16381, -55,
+	 0, 49, 16382, -47, 0, 41, 16383, -40,
+	 0, 32, 16384, -32, 0, 24, 16384, -24,
+	 0, 16, 16384, -16, 0, 8, 16384, -8,
 };
 
@@ -0,0 +1,201 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2013 Claudio Matsuoka and Hipolito Carraro Jr
+ *
+ * This file is part of the Extended Module Player and is distributed
+ * under the terms of the GNU Lesser General Public License. See COPYING.LIB
+ * for more information.
+ */
+
+/*
+ * Batch module probing. Each worker thread has its own context and takes
+ * the next module from the list until all modules are probed. Loaders
+ * and the sequence scan keep their state in the context and the file
+ * handle, so contexts can load modules in parallel.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include "common.h"
+
+struct probe_data {
+	struct xmp_probe *list;
+	int num;			/* number of modules */
+	int next;			/* next module to probe */
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_t lock;
+#endif
+};
+
+struct probe_worker {
+	xmp_context ctx;
+	struct probe_data *pd;
+#ifdef HAVE_PTHREAD_H
+	pthread_t thread;
+#endif
+};
+
+
+/* Each module is depacked and loaded once, the title and format are
+ * taken from the loaded module
+ */
+static void probe_module(xmp_context ctx, struct xmp_probe *pr)
+{
+	struct context_data *c = (struct context_data *)ctx;
+	struct xmp_module_info mi;
+	int ret;
+
+	memset(&pr->info, 0, sizeof(pr->info));
+	memset(pr->md5, 0, sizeof(pr->md5));
+	pr->num_sequences = 0;
+
+	if (pr->path != NULL) {
+		ret = xmp_load_module(ctx, pr->path);
+	} else {
+		ret = xmp_load_module_from_memory(ctx, pr->mem, pr->size);
+	}
+
+	pr->error = ret;
+	if (ret < 0)
+		return;
+
+	xmp_get_module_info(ctx, &mi);
+	snprintf(pr->info.name, XMP_NAME_SIZE, "%s", mi.mod->name);
+	snprintf(pr->info.type, XMP_NAME_SIZE, "%s", c->m.format);
+	memcpy(pr->md5, mi.md5, sizeof(pr->md5));
+	pr->num_sequences = mi.num_sequences;
+	memcpy(pr->seq_data, mi.seq_data,
+			mi.num_sequences * sizeof(struct xmp_sequence));
+
+	xmp_release_module(ctx);
+}
+
+static xmp_context create_worker(int smpctl)
+{
+	xmp_context ctx;
+
+	if ((ctx = xmp_create_context()) == NULL)
+		return NULL;
+
+	/* Sequences are scanned when each module is loaded */
+	xmp_set_player(ctx, XMP_PLAYER_SMPCTL, smpctl);
+	xmp_set_player(ctx, XMP_PLAYER_SCANCTL, 0);
+
+	return ctx;
+}
+
+#ifdef HAVE_PTHREAD_H
+
+static void *probe_thread(void *arg)
+{
+	struct probe_worker *w = arg;
+	struct probe_data *pd = w->pd;
+	int i;
+
+	for (;;) {
+		pthread_mutex_lock(&pd->lock);
+		i = pd->next < pd->num ? pd->next++ : -1;
+		pthread_mutex_unlock(&pd->lock);
+
+		if (i < 0)
+			break;
+
+		probe_module(w->ctx, &pd->list[i]);
+	}
+
+	return NULL;
+}
+
+static int probe_parallel(struct probe_worker *w, int num,
+			  struct probe_data *pd)
+{
+	int i, started;
+
+	pthread_mutex_init(&pd->lock, NULL);
+
+	for (started = 0; started < num; started++) {
+		if (pthread_create(&w[started].thread, NULL, probe_thread,
+							&w[started]) != 0) {
+			break;
+		}
+	}
+
+	/* Modules left by workers that failed to start are probed here */
+	if (started < num)
+		probe_thread(&w[started]);
+
+	for (i = 0; i < started; i++) {
+		pthread_join(w[i].thread, NULL);
+	}
+
+	pthread_mutex_destroy(&pd->lock);
+
+	return 0;
+}
+
+#else
+
+static int probe_parallel(struct probe_worker *w, int num,
+			  struct probe_data *pd)
+{
+	int i;
+
+	/* No thread support, probe modules in order */
+	for (i = 0; i < pd->num; i++) {
+		probe_module(w[0].ctx, &pd->list[i]);
+	}
+
+	return 0;
+}
+
+#endif
+
+int xmp_probe_modules(struct xmp_probe *list, int num, int threads,
+		      int smpctl)
+{
+	struct probe_data pd;
+	struct probe_worker *w;
+	int i, ret;
+
+	if (list == NULL || num < 0)
+		return -XMP_ERROR_INVALID;
+
+	if (num == 0)
+		return 0;
+
+	if (threads < 1)
+		threads = 1;
+	if (threads > num)
+		threads = num;
+
+	memset(&pd, 0, sizeof(struct probe_data));
+	pd.list = list;
+	pd.num = num;
+
+	w = calloc(threads, sizeof(struct probe_worker));
+	if (w == NULL)
+		return -XMP_ERROR_SYSTEM;
+
+	ret = -XMP_ERROR_SYSTEM;
+
+	for (i = 0; i < threads; i++) {
+		w[i].pd = &pd;
+		w[i].ctx = create_worker(smpctl);
+		if (w[i].ctx == NULL)
+			goto err;
+	}
+
+	if (probe_parallel(w, threads, &pd) == 0)
+		ret = 0;
+
+    err:
+	for (i = 0; i < threads; i++) {
+		if (w[i].ctx != NULL)
+			xmp_free_context(w[i].ctx);
+	}
+	free(w);
+
+	return ret;
+}
@@ -87,9 +87,6 @@ static void set_effect_defaults(struct context_data *ctx, int note,
 }
 
 
-#define IS_TONEPORTA(x) ((x) == FX_TONEPORTA || (x) == FX_TONE_VSLIDE \
-		|| (x) == FX_PER_TPORTA)
-
 #define set_patch(ctx,chn,ins,smp,note,cont_sample) \
 	virt_setpatch(ctx, chn, ins, smp, note, 0, 0, 0, 1, cont_sample)
 
@@ -840,3 +837,29 @@ int read_event(struct context_data *ctx, struct xmp_event *e, int chn, int ctl)
 		return read_event_mod(ctx, e, chn);
 	}
 }
+
+/* Same as read_event() with an event where all fields are zero. Nothing
+ * is triggered and no effects are set, so only the row state is reset.
+ */
+void read_empty_event(struct context_data *ctx, int chn)
+{
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+	struct channel_data *xc = &p->xc_data[chn];
+
+	xc->delay = 0;
+	xc->tremor.val = 0;
+
+	/* Reset arpeggio */
+	xc->arpeggio.val[0] = 0;
+	xc->arpeggio.count = 0;
+	xc->arpeggio.size = 1;
+
+	xc->flags &= 0xff000000;	/* keep persistent flags */
+
+	/* FT2 and IT: always reset sample offset */
+	if (m->read_event_type == READ_EVENT_FT2 ||
+	    m->read_event_type == READ_EVENT_IT) {
+		xc->offset_val = 0;
+	}
+}
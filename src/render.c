@@ -0,0 +1,382 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2012 Claudio Matsuoka and Hipolito Carraro Jr.
+ *
+ * This file is part of the Extended Module Player and is distributed
+ * under the terms of the GNU Lesser General Public License. See COPYING.LIB
+ * for more information.
+ */
+
+/*
+ * Offline rendering. The module is first played silently to record the
+ * complete player state at regular intervals, then the segments between
+ * these snapshots are rendered in parallel, each by its own player
+ * context sharing the module data. Since every segment starts from the
+ * exact state the serial player would have, the output is identical.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include "common.h"
+#include "player.h"
+#include "mixer.h"
+#include "synth.h"
+#include "snapshot.h"
+#include "loaders/loader.h"
+
+#define RENDER_SEGMENTS		4	/* segments per thread */
+#define RENDER_MIN_TICKS	50	/* minimum segment length in ticks */
+#define RENDER_WINDOW		2	/* segments ahead of output per thread */
+
+typedef void (*render_callback)(void *, int, void *);
+
+struct render_segment {
+	struct player_snapshot snap;	/* state at segment start */
+	int ticks;			/* number of ticks in the segment */
+	int size;			/* segment size in bytes */
+	char *buffer;
+	int done;			/* 1 if rendered, -1 on error */
+};
+
+struct render_data {
+	struct render_segment *seg;
+	int num;			/* number of segments */
+	int next;			/* next segment to render */
+	int written;			/* segments sent to the callback */
+	int window;			/* max segments rendered in advance */
+	int error;
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+#endif
+};
+
+struct render_worker {
+	struct context_data *ctx;
+	struct render_data *rd;
+#ifdef HAVE_PTHREAD_H
+	pthread_t thread;
+#endif
+};
+
+
+static int render_serial(struct context_data *ctx, int loop,
+			 render_callback callback, void *arg)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+
+	while (next_frame(ctx, 0) == 0 && p->loop_count < loop) {
+		mixer_downmix(ctx, s->buffer);
+		callback(s->buffer, mixer_buffer_size(ctx), arg);
+	}
+
+	return 0;
+}
+
+/* Play the module silently, splitting it into segments */
+static int render_scan(struct context_data *ctx, int loop, int interval,
+		       struct render_data *rd)
+{
+	struct player_data *p = &ctx->p;
+	struct render_segment *seg;
+	int max = 0;
+
+	rd->seg = NULL;
+	rd->num = 0;
+
+	for (;;) {
+		if (rd->num == 0 || rd->seg[rd->num - 1].ticks >= interval) {
+			if (rd->num >= max) {
+				max += 16;
+				seg = realloc(rd->seg,
+					max * sizeof(struct render_segment));
+				if (seg == NULL)
+					return -1;
+				rd->seg = seg;
+			}
+			seg = &rd->seg[rd->num];
+			memset(seg, 0, sizeof(struct render_segment));
+			if (snapshot_save(ctx, &seg->snap) < 0)
+				return -1;
+			rd->num++;
+		}
+
+		if (next_frame(ctx, 1) < 0 || p->loop_count >= loop)
+			break;
+
+		seg = &rd->seg[rd->num - 1];
+		seg->ticks++;
+		seg->size += mixer_buffer_size(ctx);
+	}
+
+	return 0;
+}
+
+static struct context_data *create_worker(struct context_data *ctx)
+{
+	struct mixer_data *s = &ctx->s;
+	struct context_data *w;
+
+	w = calloc(1, sizeof(struct context_data));
+	if (w == NULL)
+		return NULL;
+
+	/* Module data is shared, only the player and mixer are private */
+	memcpy(&w->m, &ctx->m, sizeof(struct module_data));
+	w->m.synth_chip = NULL;
+
+	if (xmp_start_player((xmp_context)w, s->freq, s->format) < 0) {
+		free(w);
+		return NULL;
+	}
+
+	w->s.amplify = s->amplify;
+	w->s.mix = s->mix;
+	w->s.interp = s->interp;
+	w->s.dsp = s->dsp;
+	w->s.simd = s->simd;
+
+	return w;
+}
+
+static void destroy_worker(struct context_data *w)
+{
+	if (w != NULL) {
+		xmp_end_player((xmp_context)w);
+		free(w);
+	}
+}
+
+static int render_segment(struct context_data *ctx, struct render_segment *seg)
+{
+	int i, size, pos = 0;
+
+	if (snapshot_restore(ctx, &seg->snap) < 0)
+		return -1;
+
+	seg->buffer = malloc(seg->size);
+	if (seg->buffer == NULL && seg->size > 0)
+		return -1;
+
+	for (i = 0; i < seg->ticks; i++) {
+		if (next_frame(ctx, 0) < 0)
+			return -1;
+		size = mixer_buffer_size(ctx);
+		if (pos + size > seg->size)
+			return -1;
+		mixer_downmix(ctx, seg->buffer + pos);
+		pos += size;
+	}
+
+	return pos == seg->size ? 0 : -1;
+}
+
+static void release_segment(struct render_segment *seg)
+{
+	free(seg->buffer);
+	seg->buffer = NULL;
+	snapshot_free(&seg->snap);
+}
+
+#ifdef HAVE_PTHREAD_H
+
+static void *render_thread(void *arg)
+{
+	struct render_worker *w = arg;
+	struct render_data *rd = w->rd;
+	int i, ret;
+
+	for (;;) {
+		pthread_mutex_lock(&rd->lock);
+		while (!rd->error && rd->next < rd->num &&
+				rd->next >= rd->written + rd->window) {
+			pthread_cond_wait(&rd->cond, &rd->lock);
+		}
+		if (rd->error || rd->next >= rd->num) {
+			pthread_mutex_unlock(&rd->lock);
+			break;
+		}
+		i = rd->next++;
+		pthread_mutex_unlock(&rd->lock);
+
+		ret = render_segment(w->ctx, &rd->seg[i]);
+
+		pthread_mutex_lock(&rd->lock);
+		rd->seg[i].done = ret < 0 ? -1 : 1;
+		pthread_cond_broadcast(&rd->cond);
+		pthread_mutex_unlock(&rd->lock);
+	}
+
+	return NULL;
+}
+
+static int render_parallel(struct render_worker *w, int num,
+			   struct render_data *rd,
+			   render_callback callback, void *arg)
+{
+	struct render_segment *seg;
+	int i, started, ret = 0;
+
+	pthread_mutex_init(&rd->lock, NULL);
+	pthread_cond_init(&rd->cond, NULL);
+
+	for (started = 0; started < num; started++) {
+		if (pthread_create(&w[started].thread, NULL, render_thread,
+							&w[started]) != 0) {
+			break;
+		}
+	}
+
+	if (started == 0) {
+		ret = -1;
+		goto end;
+	}
+
+	/* Segments are sent to the callback in order, from this thread */
+	for (i = 0; i < rd->num; i++) {
+		seg = &rd->seg[i];
+
+		pthread_mutex_lock(&rd->lock);
+		while (seg->done == 0) {
+			pthread_cond_wait(&rd->cond, &rd->lock);
+		}
+		pthread_mutex_unlock(&rd->lock);
+
+		if (seg->done < 0) {
+			ret = -1;
+			break;
+		}
+
+		if (seg->size > 0) {
+			callback(seg->buffer, seg->size, arg);
+		}
+		release_segment(seg);
+
+		pthread_mutex_lock(&rd->lock);
+		rd->written++;
+		pthread_cond_broadcast(&rd->cond);
+		pthread_mutex_unlock(&rd->lock);
+	}
+
+	if (ret < 0) {
+		pthread_mutex_lock(&rd->lock);
+		rd->error = 1;
+		pthread_cond_broadcast(&rd->cond);
+		pthread_mutex_unlock(&rd->lock);
+	}
+
+	for (i = 0; i < started; i++) {
+		pthread_join(w[i].thread, NULL);
+	}
+
+    end:
+	pthread_cond_destroy(&rd->cond);
+	pthread_mutex_destroy(&rd->lock);
+
+	return ret;
+}
+
+#else
+
+static int render_parallel(struct render_worker *w, int num,
+			   struct render_data *rd,
+			   render_callback callback, void *arg)
+{
+	struct render_segment *seg;
+	int i;
+
+	/* No thread support, render segments in order */
+	for (i = 0; i < rd->num; i++) {
+		seg = &rd->seg[i];
+		if (render_segment(w[0].ctx, seg) < 0)
+			return -1;
+		if (seg->size > 0) {
+			callback(seg->buffer, seg->size, arg);
+		}
+		release_segment(seg);
+	}
+
+	return 0;
+}
+
+#endif
+
+int xmp_render_module(xmp_context opaque, int threads, int loop,
+		      void (*callback)(void *, int, void *), void *arg)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+	struct render_data rd;
+	struct render_worker *w;
+	int i, num, interval, ret;
+
+	if (p->xc_data == NULL || callback == NULL)
+		return -XMP_ERROR_INVALID;
+
+	scan_wait(ctx);
+
+	if (loop < 1)
+		loop = 1;
+
+	/* Frames rendered here are not part of any pending buffer data */
+	p->buffer_data.consumed = p->buffer_data.in_size = 0;
+
+	control_drain(ctx);
+
+	/* Synth chips can't be snapshotted, and the invert loop effect
+	 * changes sample data while playing
+	 */
+	if (threads < 2 || m->synth != &synth_null ||
+					HAS_QUIRK(QUIRK_INVLOOP)) {
+		return render_serial(ctx, loop, callback, arg);
+	}
+
+	interval = p->scan[p->sequence].time * loop / p->frame_time /
+						(threads * RENDER_SEGMENTS);
+	if (interval < RENDER_MIN_TICKS)
+		interval = RENDER_MIN_TICKS;
+
+	memset(&rd, 0, sizeof(struct render_data));
+	rd.window = threads * RENDER_WINDOW;
+
+	/* Workers share the sample list and can't load samples */
+	load_lazy_samples(m);
+
+	ret = -XMP_ERROR_SYSTEM;
+
+	if (render_scan(ctx, loop, interval, &rd) < 0)
+		goto err;
+
+	num = threads < rd.num ? threads : rd.num;
+
+	w = calloc(num, sizeof(struct render_worker));
+	if (w == NULL)
+		goto err;
+
+	for (i = 0; i < num; i++) {
+		w[i].rd = &rd;
+		w[i].ctx = create_worker(ctx);
+		if (w[i].ctx == NULL)
+			goto err1;
+	}
+
+	if (render_parallel(w, num, &rd, callback, arg) == 0)
+		ret = 0;
+
+    err1:
+	for (i = 0; i < num; i++) {
+		destroy_worker(w[i].ctx);
+	}
+	free(w);
+    err:
+	for (i = 0; i < rd.num; i++) {
+		release_segment(&rd.seg[i]);
+	}
+	free(rd.seg);
+
+	return ret;
+}
@@ -26,6 +26,9 @@
 
 #include <stdlib.h>
 #include <string.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 #include "common.h"
 #include "effects.h"
 #include "mixer.h"
@@ -51,6 +54,7 @@ int scan_module(struct context_data *ctx, int ep, int chain)
     int* loop_row;
     char** tab_cnt;
     struct xmp_event* event;
+    struct xmp_track** track;
     int pat;
     struct ord_data *info;
 
@@ -156,6 +160,7 @@ int scan_module(struct context_data *ctx, int ep, int chain)
 	}
 
 	last_row = mod->xxp[pat]->rows;
+	track = PATTERN_TRACKS(pat);
 	for (row = break_row, break_row = 0; row < last_row; row++, cnt_row++) {
 	    /* Prevent crashes caused by large softmixer frames */
 	    if (bpm < XMP_MIN_BPM) {
@@ -187,10 +192,10 @@ int scan_module(struct context_data *ctx, int ep, int chain)
 	    pdelay = 0;
 
 	    for (chn = 0; chn < mod->chn; chn++) {
-		if (row >= mod->xxt[mod->xxp[pat]->index[chn]]->rows)
+		if (row >= track[chn]->rows)
 		    continue;
 
-		event = &EVENT(mod->xxo[ord], chn, row);
+		event = &track[chn]->event[row];
 
 		/* Pattern delay + pattern break cause target row events
 		 * to be ignored
@@ -407,3 +412,169 @@ int scan_sequences(struct context_data *ctx)
 
 	return 0;
 }
+
+/* Background scan. The sequences are scanned in another thread using a
+ * private copy of the context, and the results are copied back by the
+ * player once the scan is done. Until then the player uses estimates
+ * based on the module header: a single sequence with unknown duration.
+ */
+
+#ifdef HAVE_PTHREAD_H
+
+struct scan_job {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	int done;
+	struct context_data ctx;
+};
+
+static void scan_estimate(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+	struct xmp_module *mod = &m->mod;
+	int i;
+
+	memset(p->sequence_control, 0xff, XMP_MAX_MOD_LENGTH);
+	memset(p->sequence_control, 0, mod->len);
+	memset(p->scan, 0, sizeof(p->scan));
+	p->scan[0].ord = -1;		/* end not known yet */
+
+	for (i = 0; i < mod->len; i++) {
+		struct ord_data *info = &m->xxo_info[i];
+		info->gvl = mod->gvl;
+		info->bpm = mod->bpm;
+		info->speed = mod->spd;
+		info->time = 0;
+		info->start_row = 0;
+	}
+
+	m->num_sequences = 1;
+	m->seq_data[0].entry_point = 0;
+	m->seq_data[0].duration = 0;
+}
+
+static void scan_publish(struct context_data *ctx, struct context_data *res)
+{
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+
+	memcpy(p->sequence_control, res->p.sequence_control,
+						XMP_MAX_MOD_LENGTH);
+	memcpy(p->scan, res->p.scan, sizeof(p->scan));
+	memcpy(m->xxo_info, res->m.xxo_info, sizeof(m->xxo_info));
+	memcpy(m->seq_data, res->m.seq_data, sizeof(m->seq_data));
+	m->num_sequences = res->m.num_sequences;
+
+	/* The end of the module wasn't known while playing, count it as
+	 * passed if the player is already beyond it
+	 */
+	if (p->xc_data != NULL) {
+		int ord = p->scan[p->sequence].ord;
+		int row = p->scan[p->sequence].row;
+
+		p->flow.end_point = p->scan[p->sequence].num;
+		if (p->flow.end_point > 0 && p->frame >= 0 && (p->ord > ord ||
+				(p->ord == ord && p->row >= row))) {
+			p->flow.end_point--;
+		}
+	}
+}
+
+static void *scan_thread(void *arg)
+{
+	struct scan_job *job = arg;
+
+	scan_sequences(&job->ctx);
+
+	pthread_mutex_lock(&job->lock);
+	job->done = 1;
+	pthread_mutex_unlock(&job->lock);
+
+	return NULL;
+}
+
+/* Start scanning the sequences, in the background if the scan control
+ * flags ask for it
+ */
+int scan_start(struct context_data *ctx)
+{
+	struct module_data *m = &ctx->m;
+	struct scan_job *job;
+
+	scan_wait(ctx);
+
+	if (~m->scanctl & XMP_SCANCTL_BACKGROUND)
+		return scan_sequences(ctx);
+
+	job = calloc(1, sizeof(struct scan_job));
+	if (job == NULL)
+		return scan_sequences(ctx);
+
+	/* Module data is shared and isn't changed while scanning */
+	memcpy(&job->ctx.m, m, sizeof(struct module_data));
+	job->ctx.p.flags = ctx->p.flags;
+
+	pthread_mutex_init(&job->lock, NULL);
+	if (pthread_create(&job->thread, NULL, scan_thread, job) != 0) {
+		pthread_mutex_destroy(&job->lock);
+		free(job);
+		return scan_sequences(ctx);
+	}
+
+	m->scan_job = job;
+	scan_estimate(ctx);
+
+	return 0;
+}
+
+/* Wait for the background scan and use its results */
+void scan_wait(struct context_data *ctx)
+{
+	struct module_data *m = &ctx->m;
+	struct scan_job *job = m->scan_job;
+
+	if (job == NULL)
+		return;
+
+	pthread_join(job->thread, NULL);
+	pthread_mutex_destroy(&job->lock);
+	scan_publish(ctx, &job->ctx);
+	free(job);
+	m->scan_job = NULL;
+}
+
+/* Use the results of the background scan if it's done */
+void scan_poll(struct context_data *ctx)
+{
+	struct scan_job *job = ctx->m.scan_job;
+	int done;
+
+	if (job == NULL)
+		return;
+
+	pthread_mutex_lock(&job->lock);
+	done = job->done;
+	pthread_mutex_unlock(&job->lock);
+
+	if (done)
+		scan_wait(ctx);
+}
+
+#else
+
+/* No thread support, always scan before playing */
+int scan_start(struct context_data *ctx)
+{
+	return scan_sequences(ctx);
+}
+
+void scan_wait(struct context_data *ctx)
+{
+}
+
+void scan_poll(struct context_data *ctx)
+{
+}
+
+#endif
@@ -0,0 +1,450 @@
+/* Extended Module Player
+ * Copyright (C) 1996-2012 Claudio Matsuoka and Hipolito Carraro Jr.
+ *
+ * This file is part of the Extended Module Player and is distributed
+ * under the terms of the GNU Lesser General Public License. See COPYING.LIB
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "player.h"
+#include "mixer.h"
+#include "virtual.h"
+#include "synth.h"
+#include "snapshot.h"
+
+int snapshot_save(struct context_data *ctx, struct player_snapshot *snap)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	int chn = p->virt.virt_channels;
+	int voc = p->virt.maxvoc;
+
+	memset(snap, 0, sizeof(struct player_snapshot));
+
+	snap->xc_data = malloc(chn * sizeof(struct channel_data));
+	if (snap->xc_data == NULL)
+		goto err;
+
+	snap->loop = malloc(chn * sizeof(struct pattern_loop));
+	if (snap->loop == NULL)
+		goto err;
+
+	snap->virt_channel = malloc(chn * sizeof(struct virt_channel));
+	if (snap->virt_channel == NULL)
+		goto err;
+
+	snap->voice_array = malloc(voc * sizeof(struct mixer_voice));
+	if (snap->voice_array == NULL)
+		goto err;
+
+	memcpy(&snap->p, p, sizeof(struct player_data));
+	memcpy(snap->xc_data, p->xc_data, chn * sizeof(struct channel_data));
+	memcpy(snap->loop, p->flow.loop, chn * sizeof(struct pattern_loop));
+	memcpy(snap->virt_channel, p->virt.virt_channel,
+					chn * sizeof(struct virt_channel));
+	memcpy(snap->voice_array, p->virt.voice_array,
+					voc * sizeof(struct mixer_voice));
+	snap->dtright = s->dtright;
+	snap->dtleft = s->dtleft;
+
+	return 0;
+
+    err:
+	snapshot_free(snap);
+	return -1;
+}
+
+int snapshot_restore(struct context_data *ctx, struct player_snapshot *snap)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	struct channel_data *xc_data = p->xc_data;
+	struct pattern_loop *loop = p->flow.loop;
+	struct virt_channel *virt_channel = p->virt.virt_channel;
+	struct mixer_voice *voice_array = p->virt.voice_array;
+	int *free_voice = p->virt.free_voice;
+	struct xmp_sample *invloop_xxs = p->invloop.xxs;
+	struct xmp_sample *invloop_orig = p->invloop.orig;
+	struct control_queue *queue = p->queue;
+	int chn = snap->p.virt.virt_channels;
+	int voc = snap->p.virt.maxvoc;
+	int interval, sequence, num;
+	struct seek_point *point;
+
+	/* Arrays are restored in place, they must have the same size */
+	if (chn != p->virt.virt_channels || voc != p->virt.maxvoc)
+		return -1;
+
+	/* The seek index belongs to the context */
+	interval = p->seek.interval;
+	sequence = p->seek.sequence;
+	num = p->seek.num;
+	point = p->seek.point;
+
+	memcpy(p, &snap->p, sizeof(struct player_data));
+	p->xc_data = xc_data;
+	p->flow.loop = loop;
+	p->virt.virt_channel = virt_channel;
+	p->virt.voice_array = voice_array;
+	p->virt.free_voice = free_voice;
+	p->invloop.xxs = invloop_xxs;
+	p->invloop.orig = invloop_orig;
+	p->queue = queue;
+	p->seek.interval = interval;
+	p->seek.sequence = sequence;
+	p->seek.num = num;
+	p->seek.point = point;
+
+	memcpy(p->xc_data, snap->xc_data, chn * sizeof(struct channel_data));
+	memcpy(p->flow.loop, snap->loop, chn * sizeof(struct pattern_loop));
+	memcpy(p->virt.virt_channel, snap->virt_channel,
+					chn * sizeof(struct virt_channel));
+	memcpy(p->virt.voice_array, snap->voice_array,
+					voc * sizeof(struct mixer_voice));
+	virt_restore(ctx);
+	s->dtright = snap->dtright;
+	s->dtleft = snap->dtleft;
+
+	return 0;
+}
+
+void snapshot_free(struct player_snapshot *snap)
+{
+	free(snap->xc_data);
+	free(snap->loop);
+	free(snap->virt_channel);
+	free(snap->voice_array);
+
+	snap->xc_data = NULL;
+	snap->loop = NULL;
+	snap->virt_channel = NULL;
+	snap->voice_array = NULL;
+}
+
+
+/*
+ * Serialized snapshots for the seek index. Runs of zero bytes are stored
+ * as counts and only voices in use are stored, which makes snapshots
+ * compact enough to be taken every few hundred milliseconds.
+ */
+
+#define RUN_MAX		255
+
+/* Encode data as (zero count, literal count, literals) triplets */
+static uint8 *pack_data(uint8 *dst, void *src, int size)
+{
+	uint8 *s = src, *end = s + size;
+	int z, n;
+
+	while (s < end) {
+		for (z = 0; z < RUN_MAX && s + z < end && s[z] == 0; z++);
+		s += z;
+
+		/* Isolated zeros are cheaper as literals */
+		for (n = 0; n < RUN_MAX && s + n < end; n++) {
+			if (s[n] == 0 && (s + n + 1 >= end || s[n + 1] == 0))
+				break;
+		}
+
+		*dst++ = z;
+		*dst++ = n;
+		memcpy(dst, s, n);
+		dst += n;
+		s += n;
+	}
+
+	return dst;
+}
+
+static uint8 *unpack_data(uint8 *src, uint8 *end, void *dst, int size)
+{
+	uint8 *d = dst;
+	int z, n;
+
+	while (size > 0) {
+		if (src + 2 > end)
+			return NULL;
+
+		z = *src++;
+		n = *src++;
+		if (z + n == 0 || z + n > size || src + n > end)
+			return NULL;
+
+		memset(d, 0, z);
+		d += z;
+		memcpy(d, src, n);
+		d += n;
+		src += n;
+		size -= z + n;
+	}
+
+	return src;
+}
+
+static uint8 *pack_int(uint8 *dst, int val)
+{
+	memcpy(dst, &val, sizeof(int));
+	return dst + sizeof(int);
+}
+
+static uint8 *unpack_int(uint8 *src, uint8 *end, int *val)
+{
+	if (src == NULL || src + sizeof(int) > end)
+		return NULL;
+
+	memcpy(val, src, sizeof(int));
+	return src + sizeof(int);
+}
+
+static int snapshot_pack(struct context_data *ctx, struct seek_point *point)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	int chn = p->virt.virt_channels;
+	int voc = p->virt.maxvoc;
+	int i, num, size;
+	uint8 *data, *d;
+
+	size = sizeof(struct player_data) + chn * (sizeof(struct channel_data) +
+		sizeof(struct pattern_loop) + sizeof(struct virt_channel)) +
+		voc * (sizeof(int) + sizeof(struct mixer_voice)) +
+		5 * sizeof(int);
+
+	/* Worst case is two bytes of overhead per byte of data */
+	data = malloc(size * 3);
+	if (data == NULL)
+		return -1;
+
+	for (num = i = 0; i < voc; i++) {
+		if (p->virt.voice_array[i].chn >= 0)
+			num++;
+	}
+
+	d = pack_int(data, chn);
+	d = pack_int(d, voc);
+	d = pack_int(d, s->dtright);
+	d = pack_int(d, s->dtleft);
+	d = pack_data(d, p, sizeof(struct player_data));
+	d = pack_data(d, p->xc_data, chn * sizeof(struct channel_data));
+	d = pack_data(d, p->flow.loop, chn * sizeof(struct pattern_loop));
+	d = pack_data(d, p->virt.virt_channel,
+					chn * sizeof(struct virt_channel));
+	d = pack_int(d, num);
+
+	for (i = 0; i < voc; i++) {
+		struct mixer_voice *vi = &p->virt.voice_array[i];
+
+		if (vi->chn >= 0) {
+			d = pack_int(d, i);
+			d = pack_data(d, vi, sizeof(struct mixer_voice));
+		}
+	}
+
+	point->size = d - data;
+	point->data = realloc(data, point->size);
+	if (point->data == NULL)
+		point->data = data;
+
+	return 0;
+}
+
+/* Restore a serialized snapshot. Channel volumes, mute status, player
+ * flags and pending events are user settings and are kept.
+ */
+static int snapshot_unpack(struct context_data *ctx, struct seek_point *point)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	struct player_data tmp;
+	uint8 *d = point->data, *end = d + point->size;
+	int i, chn, voc, num, dtright, dtleft;
+
+	d = unpack_int(d, end, &chn);
+	d = unpack_int(d, end, &voc);
+	d = unpack_int(d, end, &dtright);
+	d = unpack_int(d, end, &dtleft);
+	if (d == NULL || chn != p->virt.virt_channels || voc != p->virt.maxvoc)
+		return -1;
+
+	d = unpack_data(d, end, &tmp, sizeof(struct player_data));
+	if (d == NULL)
+		return -1;
+
+	tmp.xc_data = p->xc_data;
+	tmp.flow.loop = p->flow.loop;
+	tmp.virt.virt_channel = p->virt.virt_channel;
+	tmp.virt.voice_array = p->virt.voice_array;
+	tmp.virt.free_voice = p->virt.free_voice;
+	tmp.flags = p->flags;
+	memcpy(tmp.channel_vol, p->channel_vol, sizeof(p->channel_vol));
+	memcpy(tmp.channel_mute, p->channel_mute, sizeof(p->channel_mute));
+	memcpy(tmp.inject_event, p->inject_event, sizeof(p->inject_event));
+	memcpy(&tmp.timed, &p->timed, sizeof(p->timed));
+	memset(&tmp.buffer_data, 0, sizeof(tmp.buffer_data));
+	tmp.seek = p->seek;
+	tmp.invloop = p->invloop;
+	tmp.queue = p->queue;
+
+	d = unpack_data(d, end, p->xc_data, chn * sizeof(struct channel_data));
+	if (d == NULL)
+		return -1;
+	d = unpack_data(d, end, p->flow.loop, chn * sizeof(struct pattern_loop));
+	if (d == NULL)
+		return -1;
+	d = unpack_data(d, end, p->virt.virt_channel,
+					chn * sizeof(struct virt_channel));
+	d = unpack_int(d, end, &num);
+	if (d == NULL)
+		return -1;
+
+	for (i = 0; i < voc; i++) {
+		struct mixer_voice *vi = &p->virt.voice_array[i];
+
+		memset(vi, 0, sizeof(struct mixer_voice));
+		vi->chn = vi->root = -1;
+	}
+
+	for (; num > 0; num--) {
+		d = unpack_int(d, end, &i);
+		if (d == NULL || i < 0 || i >= voc)
+			return -1;
+		d = unpack_data(d, end, &p->virt.voice_array[i],
+						sizeof(struct mixer_voice));
+		if (d == NULL)
+			return -1;
+	}
+
+	memcpy(p, &tmp, sizeof(struct player_data));
+	virt_restore(ctx);
+	s->dtright = dtright;
+	s->dtleft = dtleft;
+
+	return 0;
+}
+
+/* Play the current sequence silently from the current position to the
+ * end, storing a snapshot every seek interval. Snapshot times are the
+ * elapsed replay time, since the module time goes back with jumps.
+ */
+int snapshot_build_index(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	struct module_data *m = &ctx->m;
+	struct player_snapshot start;
+	struct seek_point *point;
+	double time = 0, next = 0;
+	int max = 0;
+	int ret = -1;
+
+	snapshot_free_index(ctx);
+
+	/* Synth chips can't be snapshotted, and the invert loop effect
+	 * changes sample data while playing. Seeks are done by playing.
+	 */
+	if (m->synth != &synth_null || HAS_QUIRK(QUIRK_INVLOOP))
+		return 0;
+
+	/* Snapshot times depend on the scanned sequences */
+	scan_wait(ctx);
+
+	if (snapshot_save(ctx, &start) < 0)
+		return -1;
+
+	p->seek.sequence = p->sequence;
+
+	for (;;) {
+		if (time >= next) {
+			if (p->seek.num >= max) {
+				max += 64;
+				point = realloc(p->seek.point,
+					max * sizeof(struct seek_point));
+				if (point == NULL)
+					goto err;
+				p->seek.point = point;
+			}
+
+			point = &p->seek.point[p->seek.num];
+			if (snapshot_pack(ctx, point) < 0)
+				goto err;
+			point->time = time;
+			p->seek.num++;
+
+			next = time + p->seek.interval;
+		}
+
+		if (next_frame(ctx, 1) < 0 || p->loop_count > 0)
+			break;
+
+		time += p->frame_time;
+	}
+
+	ret = 0;
+
+    err:
+	snapshot_restore(ctx, &start);
+	snapshot_free(&start);
+
+	return ret;
+}
+
+void snapshot_free_index(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	int i;
+
+	for (i = 0; i < p->seek.num; i++) {
+		free(p->seek.point[i].data);
+	}
+	free(p->seek.point);
+
+	p->seek.num = 0;
+	p->seek.point = NULL;
+}
+
+/* Restore the last snapshot before the given replay time and play
+ * silently up to the tick containing it. The remaining samples are
+ * skipped by xmp_play_buffer().
+ */
+int snapshot_seek(struct context_data *ctx, int time)
+{
+	struct player_data *p = &ctx->p;
+	struct mixer_data *s = &ctx->s;
+	double elapsed;
+	int i, loop;
+
+	if (p->seek.num <= 0 || p->sequence != p->seek.sequence)
+		return -1;
+
+	if (time < 0)
+		time = 0;
+
+	for (i = p->seek.num - 1; i > 0; i--) {
+		if (p->seek.point[i].time <= time)
+			break;
+	}
+
+	if (snapshot_unpack(ctx, &p->seek.point[i]) < 0)
+		return -1;
+
+	elapsed = p->seek.point[i].time;
+	loop = p->loop_count;
+
+	while (elapsed + p->frame_time <= time) {
+		if (next_frame(ctx, 1) < 0 || p->loop_count > loop)
+			return 0;
+		elapsed += p->frame_time;
+	}
+
+	/* The skip is measured with the current tempo. If the next tick
+	 * changes the tempo and gets shorter than the skip, the whole tick
+	 * is skipped and we land early, at the start of the following tick
+	 */
+	if (time > elapsed) {
+		p->buffer_data.skip = (time - elapsed) * s->freq / 1000;
+	}
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef XMP_SNAPSHOT_H
+#define XMP_SNAPSHOT_H
+
+#include "common.h"
+
+/* Player and mixer state at a tick boundary. Restoring a snapshot into a
+ * context playing the same module resumes playback at that tick. Synth
+ * chip state is not included.
+ */
+struct player_snapshot {
+	struct player_data p;
+	struct channel_data *xc_data;
+	struct pattern_loop *loop;
+	struct virt_channel *virt_channel;
+	struct mixer_voice *voice_array;
+	int dtright;
+	int dtleft;
+};
+
+int	snapshot_save		(struct context_data *,
+				 struct player_snapshot *);
+int	snapshot_restore	(struct context_data *,
+				 struct player_snapshot *);
+void	snapshot_free		(struct player_snapshot *);
+int	snapshot_build_index	(struct context_data *);
+void	snapshot_free_index	(struct context_data *);
+int	snapshot_seek		(struct context_data *, int);
+
+#endif /* XMP_SNAPSHOT_H */
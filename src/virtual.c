@@ -14,10 +14,76 @@
 #define	FREE	-1
 #define MAX_VOICES_CHANNEL 16
 
+/* Free voices are kept in a stack, and voices with the same root channel
+ * are linked in a list, so allocating a voice or finding the voices of a
+ * channel doesn't depend on the number of voices.
+ */
+
+static void link_voice(struct player_data *p, int voc, int root)
+{
+	struct mixer_voice *vi = &p->virt.voice_array[voc];
+	struct virt_channel *vc = &p->virt.virt_channel[root];
+
+	vi->root = root;
+	vi->prev = FREE;
+	vi->next = vc->first;
+	if (vc->first != FREE)
+		p->virt.voice_array[vc->first].prev = voc;
+	vc->first = voc;
+	vc->count++;
+}
+
+static void unlink_voice(struct player_data *p, int voc)
+{
+	struct mixer_voice *vi = &p->virt.voice_array[voc];
+	struct virt_channel *vc = &p->virt.virt_channel[vi->root];
+
+	if (vi->prev != FREE)
+		p->virt.voice_array[vi->prev].next = vi->next;
+	else
+		vc->first = vi->next;
+
+	if (vi->next != FREE)
+		p->virt.voice_array[vi->next].prev = vi->prev;
+
+	vc->count--;
+}
+
+static void free_voice(struct player_data *p, int voc)
+{
+	struct mixer_voice *vi = &p->virt.voice_array[voc];
+
+	p->virt.virt_used--;
+	unlink_voice(p, voc);
+	p->virt.virt_channel[vi->chn].map = FREE;
+	memset(vi, 0, sizeof(struct mixer_voice));
+	vi->chn = vi->root = FREE;
+	p->virt.free_voice[p->virt.num_free++] = voc;
+}
+
+static void reset_voices(struct player_data *p)
+{
+	int i;
+
+	for (i = 0; i < p->virt.maxvoc; i++) {
+		p->virt.voice_array[i].chn = FREE;
+		p->virt.voice_array[i].root = FREE;
+		p->virt.free_voice[i] = p->virt.maxvoc - 1 - i;
+	}
+	p->virt.num_free = p->virt.maxvoc;
+
+	for (i = 0; i < p->virt.virt_channels; i++) {
+		p->virt.virt_channel[i].map = FREE;
+		p->virt.virt_channel[i].count = 0;
+		p->virt.virt_channel[i].first = FREE;
+	}
+
+	p->virt.virt_used = p->virt.age = 0;
+}
+
 void virt_resetvoice(struct context_data *ctx, int voc, int mute)
 {
 	struct player_data *p = &ctx->p;
-	struct mixer_voice *vi = &p->virt.voice_array[voc];
 
 	if ((uint32)voc >= p->virt.maxvoc)
 		return;
@@ -26,11 +92,23 @@ void virt_resetvoice(struct context_data *ctx, int voc, int mute)
 		mixer_setvol(ctx, voc, 0);
 	}
 
-	p->virt.virt_used--;
-	p->virt.virt_channel[vi->root].count--;
-	p->virt.virt_channel[vi->chn].map = FREE;
-	memset(vi, 0, sizeof(struct mixer_voice));
-	vi->chn = vi->root = FREE;
+	if (p->virt.voice_array[voc].root == FREE)
+		return;
+
+	free_voice(p, voc);
+}
+
+/* Rebuild the free voice stack after voices were restored */
+void virt_restore(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	int i;
+
+	p->virt.num_free = 0;
+	for (i = p->virt.maxvoc; i--; ) {
+		if (p->virt.voice_array[i].chn == FREE)
+			p->virt.free_voice[p->virt.num_free++] = i;
+	}
 }
 
 /* virt_on (number of tracks) */
@@ -38,7 +116,6 @@ int virt_on(struct context_data *ctx, int num)
 {
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
-	int i;
 
 	p->virt.num_tracks = num;
 	num = mixer_numvoices(ctx, -1);
@@ -59,25 +136,21 @@ int virt_on(struct context_data *ctx, int num)
 	if (p->virt.voice_array == NULL)
 		goto err;
 
-	for (i = 0; i < p->virt.maxvoc; i++) {
-		p->virt.voice_array[i].chn = FREE;
-		p->virt.voice_array[i].root = FREE;
-	}
+	p->virt.free_voice = malloc(p->virt.maxvoc * sizeof(int));
+	if (p->virt.free_voice == NULL)
+		goto err1;
 
 	p->virt.virt_channel = malloc(p->virt.virt_channels *
 				sizeof(struct virt_channel));
 	if (p->virt.virt_channel == NULL)
-		goto err1;
+		goto err2;
 
-	for (i = 0; i < p->virt.virt_channels; i++) {
-		p->virt.virt_channel[i].map = FREE;
-		p->virt.virt_channel[i].count = 0;
-	}
-
-	p->virt.virt_used = p->virt.age = 0;
+	reset_voices(p);
 
 	return 0;
 
+      err2:
+	free(p->virt.free_voice);
       err1:
 	free(p->virt.voice_array);
       err:
@@ -95,13 +168,13 @@ void virt_off(struct context_data *ctx)
 	p->virt.virt_channels = 0;
 	p->virt.num_tracks = 0;
 	free(p->virt.voice_array);
+	free(p->virt.free_voice);
 	free(p->virt.virt_channel);
 }
 
 void virt_reset(struct context_data *ctx)
 {
 	struct player_data *p = &ctx->p;
-	int i;
 
 	if (p->virt.virt_channels < 1)
 		return;
@@ -110,52 +183,67 @@ void virt_reset(struct context_data *ctx)
 
 	memset(p->virt.voice_array, 0,
 	       p->virt.maxvoc * sizeof(struct mixer_voice));
+	reset_voices(p);
+}
+
+/* Voices are stolen by audibility: the quietest voice goes first, and
+ * the oldest one if volumes are the same
+ */
+static int is_quieter(struct mixer_voice *vi, struct mixer_voice *than)
+{
+	return vi->vol < than->vol || (vi->vol == than->vol &&
+					vi->age < than->age);
+}
+
+/* Free the quietest background voice when all voices are in use */
+static int steal_voice(struct context_data *ctx)
+{
+	struct player_data *p = &ctx->p;
+	int i, num = FREE;
+
 	for (i = 0; i < p->virt.maxvoc; i++) {
-		p->virt.voice_array[i].chn = FREE;
-		p->virt.voice_array[i].root = FREE;
-	}
+		struct mixer_voice *vi = &p->virt.voice_array[i];
 
-	for (i = 0; i < p->virt.virt_channels; i++) {
-		p->virt.virt_channel[i].map = FREE;
-		p->virt.virt_channel[i].count = 0;
+		if (vi->chn < p->virt.num_tracks)
+			continue;
+		if (num == FREE || is_quieter(vi, &p->virt.voice_array[num]))
+			num = i;
 	}
 
-	p->virt.virt_used = p->virt.age = 0;
+	if (num == FREE)
+		return -1;
+
+	virt_resetvoice(ctx, num, 1);
+
+	return 0;
 }
 
 static int alloc_voice(struct context_data *ctx, int chn)
 {
 	struct player_data *p = &ctx->p;
+	struct virt_channel *vc = &p->virt.virt_channel[chn];
 	int i, num;
-	uint32 age;
 
-	if (p->virt.virt_channel[chn].count < p->virt.chnvoc) {
-
-		/* Find free voice */
-		for (i = 0; i < p->virt.maxvoc; i++) {
-			if (p->virt.voice_array[i].chn == FREE)
-				break;
-		}
-
-		/* not found */
-		if (i == p->virt.maxvoc)
+	if (vc->count < p->virt.chnvoc) {
+		if (p->virt.num_free == 0 && steal_voice(ctx) < 0)
 			return -1;
 
-		p->virt.voice_array[i].age = p->virt.age;
-		p->virt.virt_channel[chn].count++;
+		num = p->virt.free_voice[--p->virt.num_free];
+		link_voice(p, num, chn);
+		p->virt.voice_array[num].age = p->virt.age;
 		p->virt.virt_used++;
 
-		return i;
+		return num;
 	}
 
-	/* Find oldest voice */
-	num = age = FREE;
-	for (i = 0; i < p->virt.maxvoc; i++) {
+	/* Find oldest voice of the channel, the first one on ties */
+	num = vc->first;
+	for (i = vc->first; i != FREE; i = p->virt.voice_array[i].next) {
 		struct mixer_voice *vi = &p->virt.voice_array[i];
-		if (vi->root == chn && vi->age < age) {
+		uint32 age = p->virt.voice_array[num].age;
+
+		if (vi->age < age || (vi->age == age && i < num))
 			num = i;
-			age = p->virt.voice_array[num].age;
-		}
 	}
 
 	/* Free oldest voice */
@@ -189,12 +277,7 @@ void virt_resetchannel(struct context_data *ctx, int chn)
 		return;
 
 	mixer_setvol(ctx, voc, 0);
-
-	p->virt.virt_used--;
-	p->virt.virt_channel[p->virt.voice_array[voc].root].count--;
-	p->virt.virt_channel[chn].map = FREE;
-	memset(&p->virt.voice_array[voc], 0, sizeof(struct mixer_voice));
-	p->virt.voice_array[voc].chn = p->virt.voice_array[voc].root = FREE;
+	free_voice(p, voc);
 }
 
 void virt_setvol(struct context_data *ctx, int chn, int vol)
@@ -273,7 +356,7 @@ int virt_setpatch(struct context_data *ctx, int chn, int ins, int smp,
 		    int cont_sample)
 {
 	struct player_data *p = &ctx->p;
-	int i, voc, vfree;
+	int i, next, voc, vfree;
 
 	if ((uint32)chn >= p->virt.virt_channels)
 		return -1;
@@ -285,9 +368,10 @@ int virt_setpatch(struct context_data *ctx, int chn, int ins, int smp,
 	voc = p->virt.virt_channel[chn].map;
 
 	if (dct) {
-		for (i = 0; i < p->virt.maxvoc; i++) {
+		for (i = p->virt.virt_channel[chn].first; i != FREE; i = next) {
 			struct mixer_voice *vi = &p->virt.voice_array[i];
-			if (vi->root == chn && vi->ins == ins) {
+			next = vi->next;
+			if (vi->ins == ins) {
 				int cond1 = (dct == XMP_INST_DCT_INST);
 				int cond2 = (dct == XMP_INST_DCT_SMP
 					     && vi->smp == smp);
@@ -313,7 +397,6 @@ int virt_setpatch(struct context_data *ctx, int chn, int ins, int smp,
 		if (p->virt.voice_array[voc].act && p->virt.chnvoc > 1) {
 			vfree = alloc_voice(ctx, chn);
 			if (vfree > FREE) {
-				p->virt.voice_array[vfree].root = chn;
 				p->virt.virt_channel[chn].map = vfree;
 				p->virt.voice_array[vfree].chn = chn;
 				for (chn = p->virt.num_tracks;
@@ -331,7 +414,6 @@ int virt_setpatch(struct context_data *ctx, int chn, int ins, int smp,
 			return -1;
 		p->virt.virt_channel[chn].map = voc;
 		p->virt.voice_array[voc].chn = chn;
-		p->virt.voice_array[voc].root = chn;
 	}
 
 	if (smp < 0) {
@@ -387,11 +469,14 @@ void virt_voicepos(struct context_data *ctx, int chn, int pos)
 void virt_pastnote(struct context_data *ctx, int chn, int act)
 {
 	struct player_data *p = &ctx->p;
-	int voc;
+	int voc, next;
+
+	if ((uint32)chn >= p->virt.virt_channels)
+		return;
 
-	for (voc = p->virt.maxvoc; voc--;) {
-		if (p->virt.voice_array[voc].root == chn
-		    && p->virt.voice_array[voc].chn >= p->virt.num_tracks) {
+	for (voc = p->virt.virt_channel[chn].first; voc != FREE; voc = next) {
+		next = p->virt.voice_array[voc].next;
+		if (p->virt.voice_array[voc].chn >= p->virt.num_tracks) {
 			if (act == VIRT_ACTION_CUT) {
 				virt_resetvoice(ctx, voc, 1);
 			} else {
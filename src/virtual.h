@@ -30,5 +30,6 @@ int	virt_cstat		(struct context_data *, int);
 void	virt_resetchannel	(struct context_data *, int);
 void	virt_resetvoice		(struct context_data *, int, int);
 void	virt_reset		(struct context_data *);
+void	virt_restore		(struct context_data *);
 
 #endif /* XMP_VIRTUAL_H */
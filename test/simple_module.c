@@ -2,9 +2,10 @@
 
 #include "../src/common.h"
 #include "../src/loaders/loader.h"
+#include "../src/envelope.h"
 
 void load_prologue(struct context_data *);
-void load_epilogue(struct context_data *);
+int load_epilogue(struct context_data *);
 
 void create_simple_module(struct context_data *ctx, int ins, int pat)
 {
@@ -37,7 +38,8 @@ void create_simple_module(struct context_data *ctx, int ins, int pat)
 
 	for (i = 0; i < mod->ins; i++) {
 		mod->xxi[i].nsm = 1;
-		mod->xxi[i].sub = calloc(sizeof (struct xmp_subinstrument), 1);
+		mod->xxi[i].sub = arena_calloc(&m->arena,
+				sizeof (struct xmp_subinstrument), 1);
 
 		mod->xxi[i].sub[0].pan = 0x80;
 		mod->xxi[i].sub[0].vol = 0x40;
@@ -47,7 +49,7 @@ void create_simple_module(struct context_data *ctx, int ins, int pat)
 		mod->xxs[i].lps = 0;
 		mod->xxs[i].lpe = 10000;
 		mod->xxs[i].flg = XMP_SAMPLE_LOOP;
-		mod->xxs[i].data = calloc(1, 10000);
+		mod->xxs[i].data = arena_calloc(&m->arena, 1, 10000);
 		mod->xxs[i].data += 4;
 	}
 
@@ -114,6 +116,8 @@ void set_instrument_envelope(struct context_data *ctx, int ins, int node,
 
 	mod->xxi[ins].aei.npt = node + 1;
 	mod->xxi[ins].aei.flg |= XMP_ENVELOPE_ON;
+
+	compile_envelopes(m);
 }
 
 void set_instrument_envelope_sus(struct context_data *ctx, int ins, int sus)
@@ -123,6 +127,8 @@ void set_instrument_envelope_sus(struct context_data *ctx, int ins, int sus)
 
 	mod->xxi[ins].aei.sus = sus;
 	mod->xxi[ins].aei.flg |= XMP_ENVELOPE_SUS;
+
+	compile_envelopes(m);
 }
 
 void set_instrument_fadeout(struct context_data *ctx, int ins, int fade)
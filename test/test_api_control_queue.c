@@ -0,0 +1,172 @@
+#include "test.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#define NUM_CMDS	5000
+
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int done;
+
+static int is_done(void)
+{
+	int ret;
+
+	pthread_mutex_lock(&lock);
+	ret = done;
+	pthread_mutex_unlock(&lock);
+
+	return ret;
+}
+
+static void *producer(void *arg)
+{
+	xmp_context opaque = arg;
+	int i;
+
+	for (i = 0; i < NUM_CMDS; i++) {
+		while (xmp_channel_vol(opaque, 1, i % 101) < 0)
+			;
+		while (xmp_channel_mute(opaque, 2, 2) < 0)
+			;
+	}
+
+	pthread_mutex_lock(&lock);
+	done = 1;
+	pthread_mutex_unlock(&lock);
+
+	return NULL;
+}
+#endif
+
+TEST(test_api_control_queue)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct xmp_frame_info info;
+	struct xmp_event e;
+	int i, ret;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+
+	ret = xmp_get_player(opaque, XMP_PLAYER_ASYNC);
+	fail_unless(ret == 0, "async mode set by default");
+
+	ret = xmp_load_module(opaque, "data/ode2ptk.mod");
+	fail_unless(ret == 0, "can't load module");
+
+	ret = xmp_set_player(opaque, XMP_PLAYER_ASYNC, 1);
+	fail_unless(ret == 0, "can't set async mode");
+
+	xmp_start_player(opaque, 44100, 0);
+
+	ret = xmp_set_player(opaque, XMP_PLAYER_ASYNC, 0);
+	fail_unless(ret == -XMP_ERROR_INVALID, "changed mode while playing");
+	fail_unless(xmp_get_player(opaque, XMP_PLAYER_ASYNC) == 1,
+						"async mode not set");
+
+	/* changes are seen by the caller but applied on the next frame */
+	ret = xmp_channel_mute(opaque, 0, 1);
+	fail_unless(ret == 0, "bad previous mute status");
+	ret = xmp_channel_mute(opaque, 0, -1);
+	fail_unless(ret == 1, "bad mute status");
+	ret = xmp_channel_vol(opaque, 0, 50);
+	fail_unless(ret == 100, "bad previous volume");
+	ret = xmp_set_player(opaque, XMP_PLAYER_AMP, 2);
+	fail_unless(ret == 0, "can't set amplification");
+	ret = xmp_set_player(opaque, XMP_PLAYER_AMP, 4);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid value accepted");
+	ret = xmp_get_player(opaque, XMP_PLAYER_AMP);
+	fail_unless(ret == 2, "bad amplification");
+	ret = xmp_set_position(opaque, 2);
+	fail_unless(ret == 0, "can't set position");
+
+	fail_unless(ctx->p.channel_mute[0] == 0, "mute applied early");
+	fail_unless(ctx->p.channel_vol[0] == 100, "volume applied early");
+	fail_unless(ctx->s.amplify != 2, "amplification applied early");
+
+	xmp_play_frame(opaque);
+	xmp_get_frame_info(opaque, &info);
+
+	fail_unless(ctx->p.channel_mute[0] == 1, "mute not applied");
+	fail_unless(ctx->p.channel_vol[0] == 50, "volume not applied");
+	fail_unless(ctx->s.amplify == 2, "amplification not applied");
+	fail_unless(info.pos == 2, "position not applied");
+
+	/* commands are refused when the queue is full */
+	for (i = 0; i < 1000; i++) {
+		if (xmp_channel_vol(opaque, 3, i % 101) < 0)
+			break;
+	}
+	fail_unless(i > 0 && i < 1000, "queue not limited");
+	ret = xmp_channel_vol(opaque, 3, -1);
+	fail_unless(ret == (i - 1) % 101, "bad volume");
+	xmp_play_frame(opaque);
+	fail_unless(ctx->p.channel_vol[3] == (i - 1) % 101,
+						"volume not applied");
+	ret = xmp_channel_vol(opaque, 3, 100);
+	fail_unless(ret >= 0, "queue not drained");
+
+	/* events are refused too, with an error */
+	memset(&e, 0, sizeof(struct xmp_event));
+	for (i = 0; i < 1000; i++) {
+		if ((ret = xmp_inject_event(opaque, 0, &e)) < 0)
+			break;
+	}
+	fail_unless(i > 0 && i < 1000, "event queue not limited");
+	fail_unless(ret == -XMP_ERROR_STATE, "bad error for full queue");
+
+	/* all queued calls report a full queue with the same error */
+	ret = xmp_inject_event_at(opaque, 0, &e, 0);
+	fail_unless(ret == -XMP_ERROR_STATE, "timed event error");
+	ret = xmp_channel_mute(opaque, 0, 1);
+	fail_unless(ret == -XMP_ERROR_STATE, "mute error");
+	ret = xmp_channel_vol(opaque, 0, 10);
+	fail_unless(ret == -XMP_ERROR_STATE, "volume error");
+	ret = xmp_set_player(opaque, XMP_PLAYER_AMP, 1);
+	fail_unless(ret == -XMP_ERROR_STATE, "player parameter error");
+	ret = xmp_set_position(opaque, 1);
+	fail_unless(ret == -XMP_ERROR_STATE, "position error");
+	ret = xmp_seek_time(opaque, 0);
+	fail_unless(ret == -XMP_ERROR_STATE, "seek error");
+	ret = xmp_stop_module(opaque);
+	fail_unless(ret == -XMP_ERROR_STATE, "stop error");
+	ret = xmp_restart_module(opaque);
+	fail_unless(ret == -XMP_ERROR_STATE, "restart error");
+
+	xmp_play_frame(opaque);
+	ret = xmp_inject_event(opaque, 0, &e);
+	fail_unless(ret == 0, "event queue not drained");
+
+#ifdef HAVE_PTHREAD_H
+	{
+		pthread_t thread;
+
+		done = 0;
+		ret = pthread_create(&thread, NULL, producer, opaque);
+		fail_unless(ret == 0, "can't create thread");
+
+		while (!is_done()) {
+			xmp_play_frame(opaque);
+		}
+		pthread_join(thread, NULL);
+		xmp_play_frame(opaque);
+
+		fail_unless(ctx->p.channel_vol[1] == (NUM_CMDS - 1) % 101,
+						"bad volume from thread");
+		fail_unless(ctx->p.channel_mute[2] == 0,
+						"bad mute from thread");
+	}
+#endif
+
+	xmp_end_player(opaque);
+
+	ret = xmp_set_player(opaque, XMP_PLAYER_ASYNC, 0);
+	fail_unless(ret == 0, "can't clear async mode");
+
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+END_TEST
@@ -0,0 +1,183 @@
+#include "test.h"
+
+/* Format detection checks the loaders whose magic numbers are found in the
+ * file and the loaders that have no magic numbers. The results must be the
+ * same as probing every loader in order, as recorded below.
+ */
+
+static const struct {
+	char *path;
+	char *type;
+} files[] = {
+	{ "data/adlibsp.rad.gz", "Reality Adlib Tracker (RAD)" },
+	{ "data/again.stc", "ZX Spectrum Sound Tracker (STC)" },
+	{ "data/beep.oxm", "Fast Tracker II (XM)" },
+	{ "data/compressdata", "Scream Tracker 3 (S3M)" },
+	{ "data/gzipdata", "Protracker (MOD)" },
+	{ "data/Inertiaload-1.med", "MED 2.10/OctaMED (MED)" },
+	{ "data/ode2ptk.mod", "Protracker (MOD)" },
+	{ "data/storlek_01.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_02.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_03.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_04.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_05.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_06.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_07.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_08.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_09.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_10.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_11.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_12.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_13.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_14.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_15.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_16.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_18.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_22.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_23.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_24.it", "Impulse Tracker (IT)" },
+	{ "data/storlek_25.it", "Impulse Tracker (IT)" },
+	{ "data/test.it", "Impulse Tracker (IT)" },
+	{ "data/test.xm", "Fast Tracker II (XM)" },
+	{ "data/storlek_01.data", NULL },
+	{ "data/beep.raw", NULL },
+	{ "data/adlib.data", NULL },
+	{ "data/periods.data", NULL },
+	{ "data/invloop.data", NULL },
+	{ "data/med_synth.data", NULL },
+	{ "data/spectrum.data", NULL },
+};
+
+/* Magic numbers of the format table, with the format detected when the
+ * magic number is alone in a buffer and when it is written over a MOD file
+ */
+static const struct {
+	int offset;
+	int size;
+	char *id;
+	char *type;
+	char *mod_type;
+} magic[] = {
+	{ 0, 17, "Extended Module: ", "Fast Tracker II (XM)",
+		"Fast Tracker II (XM)" },
+	{ 1080, 3, "FLT", NULL, NULL },
+	{ 1080, 3, "EXO", NULL, NULL },
+	{ 0, 4, "IMPM", "Impulse Tracker (IT)", "Protracker (MOD)" },
+	{ 44, 4, "SCRM", "Scream Tracker 3 (S3M)", "Scream Tracker 3 (S3M)" },
+	{ 20, 8, "!Scream!", NULL, "Protracker (MOD)" },
+	{ 20, 8, "BMOD2STM", NULL, "Protracker (MOD)" },
+	{ 60, 4, "SCRM", NULL, "Protracker (MOD)" },
+	{ 0, 4, "MTM\x10", "Multitracker (MTM)", "Protracker (MOD)" },
+	{ 1464, 4, "MTN\0", "Soundtracker 2.6/Ice Tracker (MTN)",
+		"Protracker (MOD)" },
+	{ 1464, 4, "IT10", "Soundtracker 2.6/Ice Tracker (MTN)",
+		"Protracker (MOD)" },
+	{ 60, 4, "IM10", "Imago Orpheus (IMF)", "Protracker (MOD)" },
+	{ 44, 4, "PTMF", "Poly Tracker (PTM)", "Poly Tracker (PTM)" },
+	{ 0, 4, "DMDL", "Digitrakker (MDL)", "Protracker (MOD)" },
+	{ 0, 14, "MAS_UTrack_V00", NULL, "Protracker (MOD)" },
+	{ 0, 14, "Liquid Module:", "Liquid Tracker (LIQ)", "Protracker (MOD)" },
+	{ 0, 4, "NO\0\0", "Liquid Tracker NO (LIQ)", "Protracker (MOD)" },
+	{ 0, 4, "PSM ", NULL, "Protracker (MOD)" },
+	{ 8, 8, "AM  INIT", NULL, "Protracker (MOD)" },
+	{ 8, 8, "AMFFMAIN", NULL, "Protracker (MOD)" },
+	{ 0, 4, "PSM\xfe", "Protracker Studio (PSM)", "Protracker (MOD)" },
+	{ 0, 3, "AMF", NULL, "Protracker (MOD)" },
+	{ 0, 24, "ASYLUM Music Format V1.0", "Asylum Music Format (AMF)",
+		"Protracker (MOD)" },
+	{ 0, 4, "GDM\xfe", NULL, "Protracker (MOD)" },
+	{ 0, 4, "MMD0", "MED 2.10/OctaMED (MED)", "Protracker (MOD)" },
+	{ 0, 4, "MMD1", "MED 2.10/OctaMED (MED)", "Protracker (MOD)" },
+	{ 0, 4, "MMD2", "OctaMED (MED)", "Protracker (MOD)" },
+	{ 0, 4, "MMD3", "OctaMED (MED)", "Protracker (MOD)" },
+	{ 0, 4, "MED\x02", "MED 1.12 MED2 (MED)", "Protracker (MOD)" },
+	{ 0, 4, "MED\x03", "MED 2.00 MED3 (MED)", "Protracker (MOD)" },
+	{ 0, 4, "MED\x04", "MED 2.10 MED4 (MED)", "Protracker (MOD)" },
+	{ 0, 4, "DDMF", "X-Tracker (DMF)", "Protracker (MOD)" },
+	{ 0, 4, "RTMM", NULL, "Protracker (MOD)" },
+	{ 8, 8, "MODLVERS", NULL, "Protracker (MOD)" },
+	{ 0, 7, "AN COOL", NULL, "Protracker (MOD)" },
+	{ 0, 4, "D.T.", "Digital Tracker (DTM)", "Protracker (MOD)" },
+	{ 0, 3, "GTK", "Graoumf Tracker (GTK)", "Protracker (MOD)" },
+	{ 0, 4, "DskT", "Desktop Tracker (DTT)", "Protracker (MOD)" },
+	{ 0, 3, "MGT", NULL, "Protracker (MOD)" },
+	{ 0, 4, "MUSX", "Archimedes Tracker", "Protracker (MOD)" },
+	{ 0, 19, "DIGI Booster module", "DIGI Booster", "Protracker (MOD)" },
+	{ 0, 4, "DBM0", "DigiBooster Pro (DBM)", "Protracker (MOD)" },
+	{ 8, 4, "EMOD", NULL, "Protracker (MOD)" },
+	{ 0, 8, "OKTASONG", "Oktalyzer", "Protracker (MOD)" },
+	{ 60, 4, "SONG", "SoundFX", "Protracker (MOD)" },
+	{ 124, 4, "SONG", "SoundFX", "Protracker (MOD)" },
+	{ 0, 4, "FAR\xfe", "Farandole Composer (FAR)", "Protracker (MOD)" },
+	{ 0, 4, "\xc1\x83\x2a\x9e", NULL, "Protracker (MOD)" },
+	{ 0, 4, "STIM", "Slamtilt", "Protracker (MOD)" },
+	{ 0, 1, "\x84", NULL, "Protracker (MOD)" },
+	{ 0, 1, "\x88", NULL, "Protracker (MOD)" },
+	{ 0, 6, "SONGOK", "Soundsmith/MegaTracker (MTP)", "Protracker (MOD)" },
+	{ 0, 6, "IAN92a", "Soundsmith/MegaTracker (MTP)", "Protracker (MOD)" },
+	{ 0, 2, "if", NULL, "Protracker (MOD)" },
+	{ 0, 2, "JN", NULL, "Protracker (MOD)" },
+	{ 0, 4, "Funk", NULL, "Protracker (MOD)" },
+	{ 1068, 3, "RoR", NULL, "Protracker (MOD)" },
+	{ 0, 16, "RAD by REALiTY!!", "Reality Adlib Tracker (RAD)",
+		"Protracker (MOD)" },
+	{ 0, 4, "ALEY", NULL, "Protracker (MOD)" },
+	{ 0, 1, "\xae", NULL, "Protracker (MOD)" },
+};
+
+#define NUM_FILES (sizeof(files) / sizeof(files[0]))
+#define NUM_MAGIC (sizeof(magic) / sizeof(magic[0]))
+
+static void check_type(int ret, struct xmp_test_info *ti, char *type)
+{
+	if (type == NULL) {
+		fail_unless(ret == -XMP_ERROR_FORMAT, "format detected");
+	} else {
+		fail_unless(ret == 0, "format not detected");
+		fail_unless(strcmp(ti->type, type) == 0, "format type error");
+	}
+}
+
+TEST(test_api_format_magic)
+{
+	struct xmp_test_info ti;
+	unsigned char buf[2048], *mod;
+	struct stat st;
+	FILE *f;
+	int i, ret;
+
+	for (i = 0; i < NUM_FILES; i++) {
+		ret = xmp_test_module(files[i].path, &ti);
+		check_type(ret, &ti, files[i].type);
+	}
+
+	stat("data/ode2ptk.mod", &st);
+	mod = malloc(st.st_size);
+	fail_unless(mod != NULL, "can't allocate module");
+	f = fopen("data/ode2ptk.mod", "rb");
+	fail_unless(f != NULL, "can't open module");
+	fail_unless(fread(mod, 1, st.st_size, f) == st.st_size,
+						"can't read module");
+	fclose(f);
+
+	for (i = 0; i < NUM_MAGIC; i++) {
+		memset(buf, 0, sizeof(buf));
+		memcpy(buf + magic[i].offset, magic[i].id, magic[i].size);
+		ret = xmp_test_module_from_memory(buf, sizeof(buf), &ti);
+		check_type(ret, &ti, magic[i].type);
+	}
+
+	for (i = 0; i < NUM_MAGIC; i++) {
+		unsigned char save[32];
+		int offset = magic[i].offset, size = magic[i].size;
+
+		memcpy(save, mod + offset, size);
+		memcpy(mod + offset, magic[i].id, size);
+		ret = xmp_test_module_from_memory(mod, st.st_size, &ti);
+		check_type(ret, &ti, magic[i].mod_type);
+		memcpy(mod + offset, save, size);
+	}
+
+	free(mod);
+}
+END_TEST
@@ -0,0 +1,109 @@
+#include "test.h"
+
+#define NUM_FRAMES	4
+#define OFFSET		100
+
+static xmp_context create_player(void)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct xmp_module *mod;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+	mod = &ctx->m.mod;
+
+	create_simple_module(ctx, 1, 1);
+	mod->xxs[0].len = mod->xxs[0].lpe = 1000;
+	memset(mod->xxs[0].data, 0x40, 1000);
+
+	xmp_start_player(opaque, 44100, XMP_FORMAT_MONO);
+	xmp_set_player(opaque, XMP_PLAYER_INTERP, XMP_INTERP_NEAREST);
+
+	return opaque;
+}
+
+static void play(xmp_context opaque, int32 *buf)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	int i;
+
+	for (i = 0; i < NUM_FRAMES; i++) {
+		xmp_play_frame(opaque);
+		memcpy(buf, ctx->s.buf32, ctx->s.ticksize * sizeof(int32));
+		buf += ctx->s.ticksize;
+	}
+}
+
+static void end_player(xmp_context opaque)
+{
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+
+TEST(test_api_inject_event_at)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct xmp_event e;
+	static int32 ref[NUM_FRAMES * XMP_MAX_FRAMESIZE];
+	static int32 buf[NUM_FRAMES * XMP_MAX_FRAMESIZE];
+	int i, ret, size;
+
+	memset(&e, 0, sizeof(e));
+	e.note = 61;
+	e.ins = 1;
+
+	/* injected at the tick boundary */
+	opaque = create_player();
+	ctx = (struct context_data *)opaque;
+	xmp_inject_event(opaque, 0, &e);
+	play(opaque, ref);
+	size = ctx->s.ticksize;
+	end_player(opaque);
+
+	/* offset 0 is the same as a regular injection */
+	opaque = create_player();
+	ret = xmp_inject_event_at(opaque, 0, &e, 0);
+	fail_unless(ret == 0, "can't inject event");
+	play(opaque, buf);
+	fail_unless(memcmp(ref, buf, NUM_FRAMES * size * sizeof(int32)) == 0,
+						"output mismatch");
+	end_player(opaque);
+
+	/* the note starts at the given sample */
+	opaque = create_player();
+	ret = xmp_inject_event_at(opaque, 0, &e, OFFSET);
+	fail_unless(ret == 0, "can't inject event");
+	play(opaque, buf);
+	for (i = 0; i < OFFSET; i++) {
+		fail_unless(buf[i] == 0, "note started early");
+	}
+	fail_unless(buf[OFFSET + 20] != 0, "note not started");
+	end_player(opaque);
+
+	/* offsets after the next frame are kept for later frames */
+	opaque = create_player();
+	ret = xmp_inject_event_at(opaque, 0, &e, size * 2 + OFFSET);
+	fail_unless(ret == 0, "can't inject event");
+	play(opaque, buf);
+	for (i = 0; i < size * 2 + OFFSET; i++) {
+		fail_unless(buf[i] == 0, "note started early");
+	}
+	fail_unless(buf[size * 2 + OFFSET + 20] != 0, "note not started");
+
+	/* invalid parameters and full queue */
+	ret = xmp_inject_event_at(opaque, 0, &e, -1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "accepted negative offset");
+	ret = xmp_inject_event_at(opaque, XMP_MAX_CHANNELS, &e, 0);
+	fail_unless(ret == -XMP_ERROR_INVALID, "accepted invalid channel");
+	for (i = 0; i < 1000; i++) {
+		if ((ret = xmp_inject_event_at(opaque, 1, &e, size * 10)) < 0)
+			break;
+	}
+	fail_unless(i > 0 && i < 1000, "queue not limited");
+	fail_unless(ret == -XMP_ERROR_STATE, "bad error for full queue");
+	end_player(opaque);
+}
+END_TEST
@@ -0,0 +1,64 @@
+#include "test.h"
+
+#define NUM_FRAMES	4
+#define OFFSET		100
+
+static xmp_context create_player(void)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+
+	create_simple_module(ctx, 1, 1);
+	set_instrument_envelope(ctx, 0, 0, 0, 64);
+	set_instrument_envelope(ctx, 0, 1, 8, 0);
+	new_event(ctx, 0, 0, 0, 60, 1, 0, 0, 0, 0, 0);
+
+	xmp_start_player(opaque, 44100, 0);
+
+	return opaque;
+}
+
+static int play(xmp_context opaque, int offset)
+{
+	struct xmp_frame_info fi;
+	struct xmp_event e;
+	int i;
+
+	/* a volume change without a note */
+	memset(&e, 0, sizeof(e));
+	e.vol = 0x31;
+
+	xmp_play_frame(opaque);
+	if (offset < 0) {
+		xmp_inject_event(opaque, 0, &e);
+	} else {
+		xmp_inject_event_at(opaque, 0, &e, offset);
+	}
+	for (i = 1; i < NUM_FRAMES; i++) {
+		xmp_play_frame(opaque);
+	}
+	xmp_get_frame_info(opaque, &fi);
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+
+	return fi.channel_info[0].volume;
+}
+
+TEST(test_api_inject_event_at_envelope)
+{
+	int ref, vol;
+
+	/* injected at the tick boundary */
+	ref = play(create_player(), -1);
+	fail_unless(ref > 0, "bad volume");
+
+	/* a timed event doesn't advance the envelope again */
+	vol = play(create_player(), OFFSET);
+	fail_unless(vol == ref, "envelope advanced twice");
+}
+END_TEST
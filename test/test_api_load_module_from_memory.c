@@ -0,0 +1,219 @@
+#include "test.h"
+
+#define NUM_FRAMES	100
+
+static void *read_file(char *path, long *size)
+{
+	struct stat st;
+	void *buf;
+	FILE *f;
+
+	if (stat(path, &st) < 0 || (f = fopen(path, "rb")) == NULL)
+		return NULL;
+
+	buf = malloc(st.st_size);
+	if (buf != NULL && fread(buf, 1, st.st_size, f) != st.st_size) {
+		free(buf);
+		buf = NULL;
+	}
+	fclose(f);
+	*size = st.st_size;
+
+	return buf;
+}
+
+/* A small gzip file depacking to more than the depack size limit: one
+ * zero byte and copies of 258 bytes in a fixed Huffman block
+ */
+#define BOMB_COPIES	650000
+#define BOMB_SIZE	(1 + 258L * BOMB_COPIES)
+
+struct bits {
+	uint8 *p;
+	uint32 buf;
+	int cnt;
+};
+
+static void put_bits(struct bits *b, uint32 val, int n)
+{
+	b->buf |= val << b->cnt;
+	b->cnt += n;
+	while (b->cnt >= 8) {
+		*b->p++ = b->buf;
+		b->buf >>= 8;
+		b->cnt -= 8;
+	}
+}
+
+/* Huffman codes are stored starting from the most significant bit */
+static void put_code(struct bits *b, uint32 code, int n)
+{
+	uint32 rev = 0;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		rev = (rev << 1) | ((code >> i) & 1);
+	}
+	put_bits(b, rev, n);
+}
+
+static uint32 zero_crc32(long len)
+{
+	uint32 table[256], c, crc = 0xffffffff;
+	int i, j;
+
+	for (i = 0; i < 256; i++) {
+		c = i;
+		for (j = 0; j < 8; j++) {
+			c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+		}
+		table[i] = c;
+	}
+
+	while (len--) {
+		crc = table[crc & 0xff] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+static uint8 *gzip_bomb(long *size)
+{
+	static const uint8 header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3 };
+	struct bits b;
+	uint8 *data;
+	uint32 crc;
+	long i;
+
+	data = malloc(10 + 13 * BOMB_COPIES / 8 + 16);
+	if (data == NULL)
+		return NULL;
+
+	memcpy(data, header, 10);
+	b.p = data + 10;
+	b.buf = b.cnt = 0;
+
+	put_bits(&b, 1, 1);		/* last block */
+	put_bits(&b, 1, 2);		/* fixed Huffman codes */
+	put_code(&b, 0x30, 8);		/* literal 0 */
+	for (i = 0; i < BOMB_COPIES; i++) {
+		put_code(&b, 0xc5, 8);	/* length 258 */
+		put_code(&b, 0, 5);	/* distance 1 */
+	}
+	put_code(&b, 0, 7);		/* end of block */
+	put_bits(&b, 0, 7);		/* flush */
+
+	crc = zero_crc32(BOMB_SIZE);
+	for (i = 0; i < 4; i++) {
+		*b.p++ = crc >> (i * 8);
+	}
+	for (i = 0; i < 4; i++) {
+		*b.p++ = BOMB_SIZE >> (i * 8);
+	}
+
+	*size = b.p - data;
+
+	return data;
+}
+
+/* Modules loaded from memory must be identical to modules loaded from file */
+static void compare_module(char *path)
+{
+	xmp_context c1, c2;
+	struct xmp_module_info mi1, mi2;
+	struct xmp_frame_info fi1, fi2;
+	void *buf;
+	long size;
+	int i, ret;
+
+	buf = read_file(path, &size);
+	fail_unless(buf != NULL, "can't read module");
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+
+	ret = xmp_load_module(c1, path);
+	fail_unless(ret == 0, "can't load module from file");
+	ret = xmp_load_module_from_memory(c2, buf, size);
+	fail_unless(ret == 0, "can't load module from memory");
+
+	/* the buffer is not needed after loading */
+	memset(buf, 0, size);
+	free(buf);
+
+	xmp_get_module_info(c1, &mi1);
+	xmp_get_module_info(c2, &mi2);
+	fail_unless(memcmp(mi1.md5, mi2.md5, 16) == 0, "md5 mismatch");
+	/* untitled modules are named after the file */
+	fail_unless(strcmp(mi1.mod->name, mi2.mod->name) == 0 ||
+			(*mi2.mod->name == 0 && strstr(path, mi1.mod->name)),
+			"name mismatch");
+	fail_unless(strcmp(mi1.mod->type, mi2.mod->type) == 0, "type mismatch");
+	fail_unless(mi1.mod->pat == mi2.mod->pat, "patterns mismatch");
+	fail_unless(mi1.mod->smp == mi2.mod->smp, "samples mismatch");
+
+	xmp_start_player(c1, 22050, 0);
+	xmp_start_player(c2, 22050, 0);
+	for (i = 0; i < NUM_FRAMES; i++) {
+		xmp_play_frame(c1);
+		xmp_play_frame(c2);
+		xmp_get_frame_info(c1, &fi1);
+		xmp_get_frame_info(c2, &fi2);
+		fail_unless(fi1.buffer_size == fi2.buffer_size, "size error");
+		fail_unless(memcmp(fi1.buffer, fi2.buffer, fi1.buffer_size)
+						== 0, "data error");
+	}
+	xmp_end_player(c1);
+	xmp_end_player(c2);
+
+	xmp_release_module(c1);
+	xmp_release_module(c2);
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+}
+
+TEST(test_api_load_module_from_memory)
+{
+	xmp_context ctx;
+	char buf[1024];
+	uint8 *bomb;
+	long size;
+	int ret;
+
+	compare_module("data/ode2ptk.mod");
+	compare_module("data/test.xm");
+	compare_module("data/storlek_10.it");
+
+	/* packed modules are depacked in memory */
+	compare_module("data/gzipdata");
+	compare_module("data/compressdata");
+
+	ctx = xmp_create_context();
+
+	/* samples may be used in place in the depacked data */
+	xmp_set_player(ctx, XMP_PLAYER_SMPCTL, XMP_SMPCTL_MAP);
+	ret = xmp_load_module(ctx, "data/gzipdata");
+	fail_unless(ret == 0, "can't load packed module");
+	xmp_start_player(ctx, 22050, 0);
+	xmp_play_frame(ctx);
+	xmp_end_player(ctx);
+	xmp_release_module(ctx);
+	xmp_set_player(ctx, XMP_PLAYER_SMPCTL, 0);
+
+	memset(buf, 0, 1024);
+	ret = xmp_load_module_from_memory(ctx, buf, 1024);
+	fail_unless(ret == -XMP_ERROR_FORMAT, "invalid module loaded");
+
+	ret = xmp_load_module_from_memory(ctx, buf, 100);
+	fail_unless(ret == -XMP_ERROR_FORMAT, "short module loaded");
+
+	/* depacked data is limited in size */
+	bomb = gzip_bomb(&size);
+	fail_unless(bomb != NULL, "can't create packed data");
+	ret = xmp_load_module_from_memory(ctx, bomb, size);
+	fail_unless(ret == -XMP_ERROR_DEPACK, "depack size not limited");
+	free(bomb);
+
+	xmp_free_context(ctx);
+}
+END_TEST
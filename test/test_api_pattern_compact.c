@@ -0,0 +1,97 @@
+#include "test.h"
+
+#define NUM_FRAMES	200
+
+static int count_unique(struct xmp_module *mod)
+{
+	int i, j, num = 0;
+
+	for (i = 0; i < mod->trk; i++) {
+		for (j = 0; j < i; j++) {
+			if (mod->xxt[j] == mod->xxt[i])
+				break;
+		}
+		if (j == i)
+			num++;
+	}
+
+	return num;
+}
+
+static void compare_module(char *path)
+{
+	xmp_context c1, c2;
+	struct context_data *ctx1, *ctx2;
+	struct xmp_module *mod1, *mod2;
+	struct xmp_frame_info fi1, fi2;
+	struct xmp_track *t1, *t2;
+	int i, j, ret;
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+	ctx1 = (struct context_data *)c1;
+	ctx2 = (struct context_data *)c2;
+
+	ret = xmp_set_player(c2, XMP_PLAYER_PATCTL, XMP_PATCTL_COMPACT);
+	fail_unless(ret == 0, "can't set pattern control flags");
+	fail_unless(xmp_get_player(c2, XMP_PLAYER_PATCTL) ==
+			XMP_PATCTL_COMPACT, "can't get pattern control flags");
+
+	ret = xmp_load_module(c1, path);
+	fail_unless(ret == 0, "can't load module");
+	ret = xmp_load_module(c2, path);
+	fail_unless(ret == 0, "can't load compact module");
+
+	mod1 = &ctx1->m.mod;
+	mod2 = &ctx2->m.mod;
+
+	/* same tracks, identical ones stored once */
+	fail_unless(mod1->trk == mod2->trk, "track count mismatch");
+	fail_unless(count_unique(mod1) == mod1->trk, "tracks shared");
+	fail_unless(count_unique(mod2) < mod2->trk, "tracks not merged");
+	fail_unless(ctx2->m.track_arena.block == NULL, "tracks not released");
+
+	for (i = 0; i < mod1->pat; i++) {
+		for (j = 0; j < mod1->chn; j++) {
+			t1 = mod1->xxt[mod1->xxp[i]->index[j]];
+			t2 = mod2->xxt[mod2->xxp[i]->index[j]];
+			fail_unless(t1->rows == t2->rows, "rows mismatch");
+			fail_unless(memcmp(t1->event, t2->event, t1->rows *
+				sizeof(struct xmp_event)) == 0, "event mismatch");
+		}
+	}
+
+	xmp_start_player(c1, 44100, 0);
+	xmp_start_player(c2, 44100, 0);
+
+	for (i = 0; i < NUM_FRAMES; i++) {
+		xmp_play_frame(c1);
+		xmp_play_frame(c2);
+		xmp_get_frame_info(c1, &fi1);
+		xmp_get_frame_info(c2, &fi2);
+		fail_unless(fi1.pos == fi2.pos, "position mismatch");
+		fail_unless(fi1.row == fi2.row, "row mismatch");
+		for (j = 0; j < mod1->chn; j++) {
+			fail_unless(memcmp(&fi1.channel_info[j].event,
+				&fi2.channel_info[j].event,
+				sizeof(struct xmp_event)) == 0, "event info mismatch");
+		}
+		fail_unless(memcmp(fi1.buffer, fi2.buffer,
+			fi1.buffer_size) == 0, "playback mismatch");
+	}
+
+	xmp_end_player(c1);
+	xmp_end_player(c2);
+	xmp_release_module(c1);
+	xmp_release_module(c2);
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+}
+
+TEST(test_api_pattern_compact)
+{
+	compare_module("data/ode2ptk.mod");
+	compare_module("data/test.xm");
+	compare_module("data/storlek_10.it");
+}
+END_TEST
@@ -0,0 +1,61 @@
+#include "test.h"
+
+static void compare_module(char *path, int patctl)
+{
+	xmp_context c1, c2;
+	struct context_data *ctx1, *ctx2;
+	struct xmp_frame_info fi1, fi2;
+	int ret;
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+	ctx1 = (struct context_data *)c1;
+	ctx2 = (struct context_data *)c2;
+
+	ret = xmp_set_player(c2, XMP_PLAYER_PATCTL, patctl);
+	fail_unless(ret == 0, "can't set pattern control flags");
+
+	ret = xmp_load_module(c1, path);
+	fail_unless(ret == 0, "can't load module");
+	ret = xmp_load_module(c2, path);
+	fail_unless(ret == 0, "can't load indexed module");
+
+	fail_unless(ctx1->m.row_events == NULL, "events indexed");
+	fail_unless(ctx2->m.row_events != NULL, "events not indexed");
+
+	xmp_start_player(c1, 22050, 0);
+	xmp_start_player(c2, 22050, 0);
+
+	/* empty events skipped by the index play the same */
+	do {
+		xmp_play_frame(c1);
+		xmp_play_frame(c2);
+		xmp_get_frame_info(c1, &fi1);
+		xmp_get_frame_info(c2, &fi2);
+		fail_unless(fi1.pos == fi2.pos, "position mismatch");
+		fail_unless(fi1.row == fi2.row, "row mismatch");
+		fail_unless(memcmp(fi1.buffer, fi2.buffer,
+			fi1.buffer_size) == 0, "playback mismatch");
+	} while (fi1.loop_count == 0);
+
+	xmp_end_player(c1);
+	xmp_end_player(c2);
+	xmp_release_module(c1);
+	xmp_release_module(c2);
+
+	fail_unless(ctx2->m.row_events == NULL, "index not released");
+
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+}
+
+TEST(test_api_pattern_index)
+{
+	compare_module("data/ode2ptk.mod", XMP_PATCTL_INDEX);
+	compare_module("data/test.xm", XMP_PATCTL_INDEX);
+	compare_module("data/test.it", XMP_PATCTL_INDEX);
+	compare_module("data/storlek_05.it", XMP_PATCTL_INDEX);
+	compare_module("data/storlek_10.it",
+				XMP_PATCTL_INDEX | XMP_PATCTL_COMPACT);
+}
+END_TEST
@@ -0,0 +1,60 @@
+#include "test.h"
+
+#define BUFFER_SIZE	(XMP_MAX_FRAMESIZE * 4)
+
+/* Render the module with xmp_play_frame() and compare with the data
+ * obtained from xmp_play_buffer() using odd-sized buffers
+ */
+TEST(test_api_play_buffer)
+{
+	xmp_context ctx;
+	struct xmp_frame_info fi;
+	char *ref, *buf;
+	int i, j, ret, size, total;
+
+	ref = malloc(BUFFER_SIZE);
+	fail_unless(ref != NULL, "can't allocate reference buffer");
+	buf = malloc(BUFFER_SIZE);
+	fail_unless(buf != NULL, "can't allocate buffer");
+
+	ctx = xmp_create_context();
+	xmp_load_module(ctx, "data/ode2ptk.mod");
+
+	/* Reference data */
+	xmp_start_player(ctx, 8000, 0);
+	for (total = 0; ; total += fi.buffer_size) {
+		xmp_play_frame(ctx);
+		xmp_get_frame_info(ctx, &fi);
+		if (total + fi.buffer_size > BUFFER_SIZE)
+			break;
+		memcpy(ref + total, fi.buffer, fi.buffer_size);
+	}
+	xmp_end_player(ctx);
+
+	/* Odd sizes smaller and larger than a frame */
+	for (size = 1; size < 1000; size += 333) {
+		xmp_start_player(ctx, 8000, 0);
+		for (i = 0; i + size <= total; i += size) {
+			ret = xmp_play_buffer(ctx, buf, size, 0);
+			fail_unless(ret == 0, "play buffer error");
+			for (j = 0; j < size; j++) {
+				fail_unless(buf[j] == ref[i + j], "data error");
+			}
+		}
+		xmp_end_player(ctx);
+	}
+
+	/* Loop count reached after the first replay */
+	xmp_start_player(ctx, 8000, 0);
+	while ((ret = xmp_play_buffer(ctx, buf, 4096, 1)) == 0);
+	fail_unless(ret == -XMP_END, "end of module not detected");
+	xmp_get_frame_info(ctx, &fi);
+	fail_unless(fi.loop_count == 1, "wrong loop count");
+	xmp_end_player(ctx);
+
+	xmp_release_module(ctx);
+	xmp_free_context(ctx);
+	free(buf);
+	free(ref);
+}
+END_TEST
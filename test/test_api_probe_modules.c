@@ -0,0 +1,122 @@
+#include "test.h"
+
+static char *files[] = {
+	"data/ode2ptk.mod",
+	"data/test.xm",
+	"data/test.it",
+	"data/storlek_01.it",
+	"data/storlek_05.it",
+	"data/Inertiaload-1.med",
+	"data/xzdata",
+	"data/gzipdata",
+	"data/compressdata",
+	"data/storlek_01.data",
+	"foo--bar",
+	"data/PRU1.intro-electro",
+	"data/again.stc",
+	"data/adlibsp.rad.gz",
+};
+
+#define NUM_FILES (sizeof(files) / sizeof(files[0]))
+
+static void *read_file(char *path, long *size)
+{
+	struct stat st;
+	void *buf;
+	FILE *f;
+
+	if (stat(path, &st) < 0 || (f = fopen(path, "rb")) == NULL)
+		return NULL;
+
+	buf = malloc(st.st_size);
+	if (buf != NULL && fread(buf, 1, st.st_size, f) != st.st_size) {
+		free(buf);
+		buf = NULL;
+	}
+	fclose(f);
+	*size = st.st_size;
+
+	return buf;
+}
+
+/* Probe results must be the same as loading each module */
+static void check_probe(struct xmp_probe *pr, char *path)
+{
+	struct xmp_test_info ti;
+	struct xmp_module_info mi;
+	xmp_context c;
+	int ret;
+
+	c = xmp_create_context();
+
+	ret = xmp_load_module(c, path);
+	fail_unless(pr->error == ret, "error code mismatch");
+
+	if (ret == 0) {
+		xmp_get_module_info(c, &mi);
+		xmp_test_module(path, &ti);
+		fail_unless(strcmp(pr->info.name, mi.mod->name) == 0,
+							"name error");
+		fail_unless(strcmp(pr->info.type, ti.type) == 0, "type error");
+		fail_unless(memcmp(pr->md5, mi.md5, 16) == 0, "md5 error");
+		fail_unless(pr->num_sequences == mi.num_sequences,
+						"sequences error");
+		fail_unless(memcmp(pr->seq_data, mi.seq_data,
+			mi.num_sequences * sizeof(struct xmp_sequence)) == 0,
+						"sequence data error");
+		xmp_release_module(c);
+	}
+
+	xmp_free_context(c);
+}
+
+TEST(test_api_probe_modules)
+{
+	struct xmp_probe list[2 * NUM_FILES];
+	void *mem[NUM_FILES];
+	int i, ret;
+
+	memset(list, 0, sizeof(list));
+
+	for (i = 0; i < NUM_FILES; i++) {
+		list[i].path = files[i];
+		mem[i] = read_file(files[i], &list[NUM_FILES + i].size);
+		list[NUM_FILES + i].mem = mem[i];
+	}
+
+	ret = xmp_probe_modules(list, 2 * NUM_FILES, 4, 0);
+	fail_unless(ret == 0, "probe fail");
+
+	for (i = 0; i < NUM_FILES; i++) {
+		check_probe(&list[i], files[i]);
+		if (mem[i] == NULL) {
+			fail_unless(list[NUM_FILES + i].error ==
+				-XMP_ERROR_INVALID, "invalid buffer error");
+			continue;
+		}
+		/* Loaded from memory, modules with external files differ */
+		fail_unless(list[NUM_FILES + i].error == list[i].error,
+						"memory error code mismatch");
+		if (list[i].error == 0) {
+			fail_unless(memcmp(list[NUM_FILES + i].md5,
+				list[i].md5, 16) == 0, "memory md5 error");
+			fail_unless(list[NUM_FILES + i].seq_data[0].duration ==
+				list[i].seq_data[0].duration,
+				"memory duration error");
+		}
+		free(mem[i]);
+	}
+
+	/* Single thread and invalid parameters */
+	ret = xmp_probe_modules(list, 1, 0, XMP_SMPCTL_SKIP);
+	fail_unless(ret == 0, "single thread probe fail");
+	fail_unless(list[0].error == 0, "single thread error");
+	fail_unless(list[0].seq_data[0].duration ==
+			list[NUM_FILES].seq_data[0].duration, "duration error");
+
+	ret = xmp_probe_modules(NULL, 1, 1, 0);
+	fail_unless(ret == -XMP_ERROR_INVALID, "invalid list");
+	ret = xmp_probe_modules(list, 0, 1, 0);
+	fail_unless(ret == 0, "empty list");
+}
+END_TEST
@@ -0,0 +1,76 @@
+#include "test.h"
+
+struct render_buffer {
+	char *data;
+	int size;
+};
+
+static void render_callback(void *buffer, int size, void *arg)
+{
+	struct render_buffer *rb = arg;
+
+	rb->data = realloc(rb->data, rb->size + size);
+	memcpy(rb->data + rb->size, buffer, size);
+	rb->size += size;
+}
+
+/* Render the module with xmp_play_frame() and compare with the data
+ * obtained from xmp_render_module() using several threads
+ */
+static void compare_render(xmp_context ctx, int format, int interp)
+{
+	struct xmp_frame_info fi;
+	struct render_buffer ref, rb;
+	int threads, ret;
+
+	memset(&ref, 0, sizeof(struct render_buffer));
+
+	xmp_start_player(ctx, 22050, format);
+	xmp_set_player(ctx, XMP_PLAYER_INTERP, interp);
+	for (;;) {
+		xmp_play_frame(ctx);
+		xmp_get_frame_info(ctx, &fi);
+		if (fi.loop_count > 0)
+			break;
+		render_callback(fi.buffer, fi.buffer_size, &ref);
+	}
+	xmp_end_player(ctx);
+
+	for (threads = 1; threads <= 4; threads += 3) {
+		memset(&rb, 0, sizeof(struct render_buffer));
+		xmp_start_player(ctx, 22050, format);
+		xmp_set_player(ctx, XMP_PLAYER_INTERP, interp);
+		ret = xmp_render_module(ctx, threads, 1, render_callback, &rb);
+		fail_unless(ret == 0, "render error");
+		fail_unless(rb.size == ref.size, "size error");
+		fail_unless(memcmp(rb.data, ref.data, ref.size) == 0,
+							"data error");
+		xmp_get_frame_info(ctx, &fi);
+		fail_unless(fi.loop_count == 1, "wrong loop count");
+		xmp_end_player(ctx);
+		free(rb.data);
+	}
+
+	free(ref.data);
+}
+
+TEST(test_api_render_module)
+{
+	xmp_context ctx;
+
+	ctx = xmp_create_context();
+
+	xmp_load_module(ctx, "data/ode2ptk.mod");
+	compare_render(ctx, 0, XMP_INTERP_LINEAR);
+	compare_render(ctx, XMP_FORMAT_MONO, XMP_INTERP_SPLINE);
+	compare_render(ctx, 0, XMP_INTERP_NEAREST);
+	xmp_release_module(ctx);
+
+	/* Filters and new note actions */
+	xmp_load_module(ctx, "data/storlek_10.it");
+	compare_render(ctx, 0, XMP_INTERP_LINEAR);
+	xmp_release_module(ctx);
+
+	xmp_free_context(ctx);
+}
+END_TEST
@@ -0,0 +1,107 @@
+#include "test.h"
+
+#define NUM_FRAMES	300
+
+static const int interp[] = {
+	XMP_INTERP_NEAREST, XMP_INTERP_LINEAR, XMP_INTERP_SPLINE
+};
+
+static void compare_play(xmp_context c1, xmp_context c2, int frames)
+{
+	struct xmp_frame_info fi1, fi2;
+	int i, j, k;
+
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < 2; j++) {
+			int format = j ? XMP_FORMAT_MONO : 0;
+			xmp_start_player(c1, 22050, format);
+			xmp_start_player(c2, 22050, format);
+			xmp_set_player(c1, XMP_PLAYER_INTERP, interp[i]);
+			xmp_set_player(c2, XMP_PLAYER_INTERP, interp[i]);
+			for (k = 0; k < frames; k++) {
+				xmp_play_frame(c1);
+				xmp_play_frame(c2);
+				xmp_get_frame_info(c1, &fi1);
+				xmp_get_frame_info(c2, &fi2);
+				fail_unless(memcmp(fi1.buffer, fi2.buffer,
+					fi1.buffer_size) == 0, "data error");
+			}
+			xmp_end_player(c1);
+			xmp_end_player(c2);
+		}
+	}
+}
+
+/* Modules with samples loaded when played must play like modules with
+ * all samples loaded, and sharing the module loads the rest
+ */
+static void compare_module(char *path, int smpctl)
+{
+	xmp_context c1, c2, c3;
+	struct xmp_module_info mi1, mi2;
+	int i, ret, lazy;
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+	c3 = xmp_create_context();
+
+	ret = xmp_set_player(c2, XMP_PLAYER_SMPCTL, smpctl);
+	fail_unless(ret == 0, "can't set sample control");
+
+	ret = xmp_load_module(c1, path);
+	fail_unless(ret == 0, "can't load module");
+	ret = xmp_load_module(c2, path);
+	fail_unless(ret == 0, "can't load module with lazy samples");
+
+	xmp_get_module_info(c1, &mi1);
+	xmp_get_module_info(c2, &mi2);
+
+	fail_unless(memcmp(mi1.md5, mi2.md5, 16) == 0, "md5 error");
+
+	lazy = 0;
+	for (i = 0; i < mi1.mod->smp; i++) {
+		struct xmp_sample *s1 = &mi1.mod->xxs[i];
+		struct xmp_sample *s2 = &mi2.mod->xxs[i];
+
+		fail_unless(s1->len == s2->len, "sample length error");
+		fail_unless(s1->lps == s2->lps, "sample loop start error");
+		fail_unless(s1->lpe == s2->lpe, "sample loop end error");
+		fail_unless(s1->flg == s2->flg, "sample flags error");
+		if (s1->data != NULL && s2->data == NULL)
+			lazy++;
+	}
+	fail_unless(lazy > 0, "no samples left to load");
+
+	compare_play(c1, c2, NUM_FRAMES);
+
+	ret = xmp_share_module(c3, c2);
+	fail_unless(ret == 0, "can't share module");
+
+	for (i = 0; i < mi1.mod->smp; i++) {
+		struct xmp_sample *s1 = &mi1.mod->xxs[i];
+		struct xmp_sample *s2 = &mi2.mod->xxs[i];
+
+		fail_unless((s1->data == NULL) == (s2->data == NULL),
+						"shared sample not loaded");
+		fail_unless(s1->len == s2->len, "shared sample length error");
+	}
+
+	compare_play(c1, c3, NUM_FRAMES);
+
+	xmp_release_module(c1);
+	xmp_release_module(c2);
+	xmp_release_module(c3);
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+	xmp_free_context(c3);
+}
+
+TEST(test_api_sample_lazy)
+{
+	compare_module("data/ode2ptk.mod", XMP_SMPCTL_LAZY);
+	compare_module("data/test.xm", XMP_SMPCTL_LAZY);
+	compare_module("data/storlek_07.it", XMP_SMPCTL_LAZY);
+	compare_module("data/Inertiaload-1.med", XMP_SMPCTL_LAZY);
+	compare_module("data/test.xm", XMP_SMPCTL_LAZY | XMP_SMPCTL_MAP);
+}
+END_TEST
@@ -0,0 +1,155 @@
+#include "test.h"
+#include "../src/hio.h"
+#include "../src/loaders/loader.h"
+
+#define NUM_FRAMES	300
+
+static const int interp[] = {
+	XMP_INTERP_NEAREST, XMP_INTERP_LINEAR, XMP_INTERP_SPLINE
+};
+
+static void compare_play(xmp_context c1, xmp_context c2, int frames)
+{
+	struct xmp_frame_info fi1, fi2;
+	int i, j, k;
+
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < 2; j++) {
+			int format = j ? XMP_FORMAT_MONO : 0;
+			xmp_start_player(c1, 22050, format);
+			xmp_start_player(c2, 22050, format);
+			xmp_set_player(c1, XMP_PLAYER_INTERP, interp[i]);
+			xmp_set_player(c2, XMP_PLAYER_INTERP, interp[i]);
+			for (k = 0; k < frames; k++) {
+				xmp_play_frame(c1);
+				xmp_play_frame(c2);
+				xmp_get_frame_info(c1, &fi1);
+				xmp_get_frame_info(c2, &fi2);
+				fail_unless(memcmp(fi1.buffer, fi2.buffer,
+					fi1.buffer_size) == 0, "data error");
+			}
+			xmp_end_player(c1);
+			xmp_end_player(c2);
+		}
+	}
+}
+
+/* Modules with mapped samples must play like modules with copied samples */
+static void compare_module(char *path)
+{
+	xmp_context c1, c2;
+	struct context_data *ctx;
+	int ret;
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+
+	ret = xmp_set_player(c2, XMP_PLAYER_SMPCTL, XMP_SMPCTL_MAP);
+	fail_unless(ret == 0, "can't set sample control");
+	fail_unless(xmp_get_player(c2, XMP_PLAYER_SMPCTL) == XMP_SMPCTL_MAP,
+						"can't get sample control");
+
+	ret = xmp_load_module(c1, path);
+	fail_unless(ret == 0, "can't load module");
+	ret = xmp_load_module(c2, path);
+	fail_unless(ret == 0, "can't load module with mapped samples");
+
+	ctx = (struct context_data *)c2;
+	fail_unless(ctx->m.map != NULL, "samples not mapped");
+
+	compare_play(c1, c2, NUM_FRAMES);
+
+	xmp_release_module(c1);
+	xmp_release_module(c2);
+	fail_unless(ctx->m.map == NULL, "mapping not released");
+
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+}
+
+/* Short 8 and 16 bit samples, looped and not looped, at several pitches.
+ * The data is allocated with its exact size, so that reads before the
+ * first sample or after the last one can be detected.
+ */
+static void compare_raw(int bits)
+{
+	xmp_context c[2];
+	struct context_data *ctx;
+	struct xmp_sample *xxs;
+	HIO_HANDLE *h;
+	uint8 *data;
+	int i, j, size;
+
+	size = 100 * bits / 8;
+	data = malloc(size);
+	fail_unless(data != NULL, "can't allocate sample data");
+
+	for (i = 0; i < 100; i++) {
+		int x = (i * 7919 % 65536) - 32768;
+		if (bits == 16) {
+			((int16 *)data)[i] = x;
+		} else {
+			data[i] = x >> 8;
+		}
+	}
+
+	for (i = 0; i < 2; i++) {
+		c[i] = xmp_create_context();
+		ctx = (struct context_data *)c[i];
+		create_simple_module(ctx, 2, 2);
+
+		h = hio_open_mem(data, size);
+		fail_unless(h != NULL, "can't open memory stream");
+		if (i == 1) {
+			h->flags |= HIO_FLAG_SHARE;
+		}
+
+		for (j = 0; j < 2; j++) {
+			xxs = &ctx->m.mod.xxs[j];
+			xxs->len = 50;
+			xxs->lps = j ? 0 : 13;
+			xxs->lpe = j ? 0 : 37;
+			xxs->flg = j ? 0 : XMP_SAMPLE_LOOP;
+			if (bits == 16) {
+				xxs->flg |= XMP_SAMPLE_16BIT;
+			}
+			hio_seek(h, j * size / 2, SEEK_SET);
+			load_sample(&ctx->m, h, 0, xxs, NULL);
+		}
+
+		if (i == 1) {
+			fail_unless(hio_mapped(h, ctx->m.mod.xxs[0].data),
+							"sample not mapped");
+			ctx->m.map = h;
+		} else {
+			hio_close(h);
+		}
+
+		new_event(ctx, 0, 0, 0, 49, 1, 0, 0, 0, 0, 0);
+		new_event(ctx, 0, 0, 1, 97, 1, 0, 0x01, 0x08, 0, 0);
+		new_event(ctx, 0, 0, 2, 13, 1, 0, 0x02, 0x04, 0, 0);
+		new_event(ctx, 0, 16, 3, 61, 2, 0, 0, 0, 0, 0);
+		new_event(ctx, 0, 32, 3, 109, 2, 0, 0, 0, 0, 0);
+	}
+
+	compare_play(c[0], c[1], 100);
+
+	for (i = 0; i < 2; i++) {
+		xmp_release_module(c[i]);
+		xmp_free_context(c[i]);
+	}
+
+	free(data);
+}
+
+TEST(test_api_sample_map)
+{
+	compare_module("data/storlek_07.it");
+	compare_module("data/storlek_09.it");
+	compare_module("data/test.it");
+	compare_module("data/ode2ptk.mod");
+	compare_module("data/Inertiaload-1.med");
+	compare_raw(8);
+	compare_raw(16);
+}
+END_TEST
@@ -0,0 +1,68 @@
+#include "test.h"
+
+/* Modules loaded without sample data must have the same metadata and
+ * durations as fully loaded modules.
+ */
+static void compare_module(char *path)
+{
+	xmp_context c1, c2;
+	struct xmp_module_info mi1, mi2;
+	int i, ret;
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+
+	ret = xmp_set_player(c2, XMP_PLAYER_SMPCTL, XMP_SMPCTL_SKIP);
+	fail_unless(ret == 0, "can't set sample control");
+
+	ret = xmp_load_module(c1, path);
+	fail_unless(ret == 0, "can't load module");
+	ret = xmp_load_module(c2, path);
+	fail_unless(ret == 0, "can't load module without samples");
+
+	xmp_get_module_info(c1, &mi1);
+	xmp_get_module_info(c2, &mi2);
+
+	fail_unless(strcmp(mi1.mod->name, mi2.mod->name) == 0, "name error");
+	fail_unless(strcmp(mi1.mod->type, mi2.mod->type) == 0, "type error");
+	fail_unless(mi1.mod->chn == mi2.mod->chn, "channels error");
+	fail_unless(mi1.mod->ins == mi2.mod->ins, "instruments error");
+	fail_unless(mi1.mod->smp == mi2.mod->smp, "samples error");
+	fail_unless(mi1.mod->pat == mi2.mod->pat, "patterns error");
+	fail_unless(mi1.mod->len == mi2.mod->len, "length error");
+
+	for (i = 0; i < mi1.mod->smp; i++) {
+		struct xmp_sample *s1 = &mi1.mod->xxs[i];
+		struct xmp_sample *s2 = &mi2.mod->xxs[i];
+
+		fail_unless(s1->len == s2->len, "sample length error");
+		fail_unless(s1->lps == s2->lps, "sample loop start error");
+		fail_unless(s1->lpe == s2->lpe, "sample loop end error");
+		fail_unless(s1->flg == s2->flg, "sample flags error");
+		fail_unless(s2->data == NULL, "sample data loaded");
+	}
+
+	fail_unless(mi1.num_sequences == mi2.num_sequences, "sequences error");
+	for (i = 0; i < mi1.num_sequences; i++) {
+		fail_unless(mi1.seq_data[i].duration ==
+			mi2.seq_data[i].duration, "duration error");
+	}
+
+	ret = xmp_start_player(c2, 44100, 0);
+	fail_unless(ret == -XMP_ERROR_STATE, "module without samples played");
+
+	xmp_release_module(c1);
+	xmp_release_module(c2);
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+}
+
+TEST(test_api_sample_skip)
+{
+	compare_module("data/ode2ptk.mod");
+	compare_module("data/test.xm");
+	compare_module("data/test.it");
+	compare_module("data/storlek_05.it");
+	compare_module("data/Inertiaload-1.med");
+}
+END_TEST
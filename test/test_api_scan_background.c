@@ -0,0 +1,101 @@
+#include "test.h"
+
+static int play_to_end(xmp_context opaque, xmp_context ref)
+{
+	struct xmp_frame_info fi1, fi2;
+	int num = 0;
+
+	do {
+		xmp_play_frame(opaque);
+		xmp_get_frame_info(opaque, &fi1);
+		if (ref != NULL) {
+			xmp_play_frame(ref);
+			xmp_get_frame_info(ref, &fi2);
+			fail_unless(fi1.buffer_size == fi2.buffer_size,
+						"size mismatch");
+			fail_unless(memcmp(fi1.buffer, fi2.buffer,
+					fi1.buffer_size) == 0,
+						"playback mismatch");
+		}
+		num++;
+	} while (fi1.loop_count == 0);
+
+	return num;
+}
+
+static void compare_scan(char *path, int pos)
+{
+	xmp_context c1, c2;
+	struct xmp_module_info mi1, mi2;
+	struct xmp_frame_info fi1, fi2;
+	int i, ret, ret1;
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+
+	ret = xmp_set_player(c2, XMP_PLAYER_SCANCTL, XMP_SCANCTL_BACKGROUND);
+	fail_unless(ret == 0, "can't set scan control flags");
+	fail_unless(xmp_get_player(c2, XMP_PLAYER_SCANCTL) ==
+			XMP_SCANCTL_BACKGROUND, "can't get scan control flags");
+
+	ret = xmp_load_module(c1, path);
+	fail_unless(ret == 0, "can't load module");
+	ret = xmp_load_module(c2, path);
+	fail_unless(ret == 0, "can't load module with background scan");
+
+	/* playback doesn't depend on the scan, and the end of the module
+	 * is detected once the scan is done
+	 */
+	xmp_start_player(c1, 8000, 0);
+	xmp_start_player(c2, 8000, 0);
+	play_to_end(c2, c1);
+
+	/* results are published by the player */
+	xmp_get_frame_info(c1, &fi1);
+	xmp_get_frame_info(c2, &fi2);
+	fail_unless(fi1.total_time == fi2.total_time, "total time mismatch");
+
+	xmp_get_module_info(c1, &mi1);
+	xmp_get_module_info(c2, &mi2);
+	fail_unless(mi1.num_sequences == mi2.num_sequences,
+					"number of sequences mismatch");
+	for (i = 0; i < mi1.num_sequences; i++) {
+		fail_unless(mi1.seq_data[i].entry_point ==
+			mi2.seq_data[i].entry_point, "entry point mismatch");
+		fail_unless(mi1.seq_data[i].duration ==
+			mi2.seq_data[i].duration, "duration mismatch");
+	}
+
+	xmp_end_player(c1);
+	xmp_end_player(c2);
+	xmp_release_module(c2);
+
+	/* positions wait for the scan */
+	ret = xmp_load_module(c2, path);
+	fail_unless(ret == 0, "can't load module with background scan");
+	xmp_start_player(c2, 8000, 0);
+	xmp_start_player(c1, 8000, 0);
+	ret1 = xmp_set_position(c1, pos);
+	ret = xmp_set_position(c2, pos);
+	fail_unless(ret == ret1, "can't set position");
+	play_to_end(c2, c1);
+	xmp_end_player(c1);
+	xmp_end_player(c2);
+
+	/* releasing doesn't leave the scan running */
+	xmp_release_module(c2);
+	ret = xmp_load_module(c2, path);
+	fail_unless(ret == 0, "can't load module with background scan");
+	xmp_release_module(c2);
+
+	xmp_release_module(c1);
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+}
+
+TEST(test_api_scan_background)
+{
+	compare_scan("data/ode2ptk.mod", 1);
+	compare_scan("data/storlek_05.it", 0);
+}
+END_TEST
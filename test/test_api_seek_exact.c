@@ -0,0 +1,72 @@
+#include "test.h"
+
+#define BUFFER_SIZE	(1024 * 1024)
+#define CHUNK_SIZE	8192
+
+/* ode2ptk.mod has a constant tempo of 125 bpm in the first 17 seconds,
+ * so time maps exactly to a position in the 8000 Hz output stream.
+ */
+static int seek_time[] = { 0, 20, 1234, 4999, 9876, 16999, -1 };
+
+TEST(test_api_seek_exact)
+{
+	xmp_context ctx;
+	char *ref, *buf, *buf2;
+	int i, t, ret;
+
+	ref = malloc(BUFFER_SIZE);
+	fail_unless(ref != NULL, "can't allocate reference buffer");
+	buf = malloc(CHUNK_SIZE);
+	fail_unless(buf != NULL, "can't allocate buffer");
+	buf2 = malloc(CHUNK_SIZE);
+	fail_unless(buf2 != NULL, "can't allocate buffer");
+
+	ctx = xmp_create_context();
+	xmp_load_module(ctx, "data/ode2ptk.mod");
+
+	/* Reference data, 32 bytes per millisecond */
+	xmp_start_player(ctx, 8000, 0);
+	for (i = 0; i < BUFFER_SIZE; i += CHUNK_SIZE) {
+		xmp_play_buffer(ctx, ref + i, CHUNK_SIZE, 0);
+	}
+	xmp_end_player(ctx);
+
+	ret = xmp_set_player(ctx, XMP_PLAYER_SNAPSHOT, 1000);
+	fail_unless(ret == 0, "can't set snapshot interval");
+	fail_unless(xmp_get_player(ctx, XMP_PLAYER_SNAPSHOT) == 1000,
+						"wrong snapshot interval");
+
+	xmp_start_player(ctx, 8000, 0);
+	for (i = 0; (t = seek_time[i]) >= 0; i++) {
+		xmp_seek_time(ctx, t);
+		xmp_play_buffer(ctx, buf, CHUNK_SIZE, 0);
+		fail_unless(memcmp(buf, ref + t * 32, CHUNK_SIZE) == 0,
+							"seek data error");
+	}
+
+	/* Tempo changes: compare with fast forward from the start */
+	for (t = 17000; t < 30000; t += 1111) {
+		xmp_set_player(ctx, XMP_PLAYER_SNAPSHOT, 1000);
+		xmp_end_player(ctx);
+		xmp_start_player(ctx, 8000, 0);
+		xmp_seek_time(ctx, t);
+		xmp_play_buffer(ctx, buf, CHUNK_SIZE, 0);
+
+		xmp_set_player(ctx, XMP_PLAYER_SNAPSHOT, 1000000);
+		xmp_end_player(ctx);
+		xmp_start_player(ctx, 8000, 0);
+		xmp_seek_time(ctx, t);
+		xmp_play_buffer(ctx, buf2, CHUNK_SIZE, 0);
+
+		fail_unless(memcmp(buf, buf2, CHUNK_SIZE) == 0,
+							"seek data error");
+	}
+	xmp_end_player(ctx);
+
+	xmp_release_module(ctx);
+	xmp_free_context(ctx);
+	free(buf2);
+	free(buf);
+	free(ref);
+}
+END_TEST
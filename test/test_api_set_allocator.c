@@ -0,0 +1,101 @@
+#include "test.h"
+
+struct pool {
+	int live;
+	int total;
+};
+
+static void *pool_alloc(size_t size, void *arg)
+{
+	struct pool *p = arg;
+
+	p->live++;
+	p->total++;
+
+	return malloc(size);
+}
+
+static void pool_free(void *ptr, void *arg)
+{
+	struct pool *p = arg;
+
+	p->live--;
+	free(ptr);
+}
+
+TEST(test_api_set_allocator)
+{
+	xmp_context c1, c2;
+	struct context_data *ctx;
+	struct xmp_module_info mi1, mi2;
+	struct xmp_frame_info fi1, fi2;
+	struct pool pool;
+	char junk[1024];
+	int i, ret;
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+	ctx = (struct context_data *)c2;
+	memset(&pool, 0, sizeof(pool));
+
+	/* allocator and deallocator must be set together */
+	ret = xmp_set_allocator(c2, pool_alloc, NULL, &pool);
+	fail_unless(ret == -XMP_ERROR_INVALID, "accepted missing free");
+	ret = xmp_set_allocator(c2, pool_alloc, pool_free, &pool);
+	fail_unless(ret == 0, "can't set allocator");
+
+	ret = xmp_load_module(c1, "data/storlek_09.it");
+	fail_unless(ret == 0, "can't load module");
+	ret = xmp_load_module(c2, "data/storlek_09.it");
+	fail_unless(ret == 0, "can't load module with allocator");
+	fail_unless(pool.live > 0, "allocator not used");
+
+	/* module data is allocated in a few large blocks */
+	fail_unless(pool.live < ctx->m.mod.pat + ctx->m.mod.smp,
+					"too many allocations");
+
+	ret = xmp_set_allocator(c2, NULL, NULL, NULL);
+	fail_unless(ret == -XMP_ERROR_INVALID, "changed allocator in use");
+
+	xmp_get_module_info(c1, &mi1);
+	xmp_get_module_info(c2, &mi2);
+	fail_unless(memcmp(mi1.md5, mi2.md5, 16) == 0, "md5 mismatch");
+
+	xmp_start_player(c1, 44100, 0);
+	xmp_start_player(c2, 44100, 0);
+	for (i = 0; i < 100; i++) {
+		xmp_play_frame(c1);
+		xmp_play_frame(c2);
+		xmp_get_frame_info(c1, &fi1);
+		xmp_get_frame_info(c2, &fi2);
+		fail_unless(fi1.buffer_size == fi2.buffer_size, "size mismatch");
+		fail_unless(memcmp(fi1.buffer, fi2.buffer,
+				fi1.buffer_size) == 0, "playback mismatch");
+	}
+	xmp_end_player(c1);
+	xmp_end_player(c2);
+
+	/* everything is returned on release */
+	xmp_release_module(c1);
+	xmp_release_module(c2);
+	fail_unless(pool.live == 0, "blocks not released");
+
+	/* and when loading fails */
+	memset(junk, 0, sizeof(junk));
+	ret = xmp_load_module_from_memory(c2, junk, sizeof(junk));
+	fail_unless(ret == -XMP_ERROR_FORMAT, "loaded invalid module");
+	fail_unless(pool.live == 0, "blocks not released after error");
+
+	/* default allocator can be restored */
+	ret = xmp_set_allocator(c2, NULL, NULL, NULL);
+	fail_unless(ret == 0, "can't restore default allocator");
+	pool.total = 0;
+	ret = xmp_load_module(c2, "data/storlek_09.it");
+	fail_unless(ret == 0, "can't load module");
+	fail_unless(pool.total == 0, "custom allocator still used");
+	xmp_release_module(c2);
+
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+}
+END_TEST
@@ -0,0 +1,155 @@
+#include "test.h"
+#include "../src/loaders/loader.h"
+
+#define NUM_FRAMES	100
+
+struct pool {
+	int live;
+};
+
+static void *pool_alloc(size_t size, void *arg)
+{
+	struct pool *p = arg;
+
+	p->live++;
+
+	return malloc(size);
+}
+
+static void pool_free(void *ptr, void *arg)
+{
+	struct pool *p = arg;
+
+	p->live--;
+	free(ptr);
+}
+
+static void check_invloop(xmp_context opaque, FILE *f)
+{
+	struct context_data *ctx = (struct context_data *)opaque;
+	struct xmp_frame_info info;
+	int i, j, val;
+
+	xmp_start_player(opaque, 16000, XMP_FORMAT_MONO);
+	xmp_set_player(opaque, XMP_PLAYER_INTERP, XMP_INTERP_NEAREST);
+
+	for (i = 0; i < 6; i++) {
+		xmp_play_frame(opaque);
+		xmp_get_frame_info(opaque, &info);
+		for (j = 0; j < info.buffer_size / 2; j++) {
+			fscanf(f, "%d", &val);
+			fail_unless(ctx->s.buf32[j] == val, "invloop error");
+		}
+	}
+
+	xmp_end_player(opaque);
+}
+
+TEST(test_api_share_module)
+{
+	xmp_context c1, c2, c3, c4;
+	struct context_data *ctx1, *ctx2;
+	struct xmp_frame_info fi2, fi3, fi4;
+	struct pool pool;
+	uint8 data[40];
+	HIO_HANDLE *h;
+	FILE *f;
+	int i, ret;
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+	c3 = xmp_create_context();
+	c4 = xmp_create_context();
+	ctx1 = (struct context_data *)c1;
+	ctx2 = (struct context_data *)c2;
+	memset(&pool, 0, sizeof(pool));
+
+	ret = xmp_share_module(c2, c1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "shared missing module");
+
+	xmp_set_allocator(c1, pool_alloc, pool_free, &pool);
+	ret = xmp_load_module(c1, "data/ode2ptk.mod");
+	fail_unless(ret == 0, "can't load module");
+	ret = xmp_load_module(c4, "data/ode2ptk.mod");
+	fail_unless(ret == 0, "can't load module");
+
+	ret = xmp_share_module(c2, c1);
+	fail_unless(ret == 0, "can't share module");
+	ret = xmp_share_module(c3, c2);
+	fail_unless(ret == 0, "can't share shared module");
+	ret = xmp_share_module(c4, c1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "replaced loaded module");
+	ret = xmp_share_module(c1, c1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "shared module with itself");
+
+	fail_unless(ctx2->m.mod.xxp == ctx1->m.mod.xxp, "patterns copied");
+	fail_unless(ctx2->m.mod.xxs == ctx1->m.mod.xxs, "samples copied");
+
+	/* the module outlives the context that loaded it */
+	xmp_release_module(c1);
+	fail_unless(pool.live > 0, "module released while shared");
+
+	xmp_start_player(c2, 44100, 0);
+	xmp_start_player(c3, 44100, 0);
+	xmp_start_player(c4, 44100, 0);
+
+	for (i = 0; i < NUM_FRAMES; i++) {
+		xmp_play_frame(c2);
+		xmp_play_frame(c3);
+		xmp_play_frame(c3);
+		xmp_play_frame(c4);
+		xmp_get_frame_info(c2, &fi2);
+		xmp_get_frame_info(c4, &fi4);
+		fail_unless(fi2.buffer_size == fi4.buffer_size, "size mismatch");
+		fail_unless(memcmp(fi2.buffer, fi4.buffer,
+				fi2.buffer_size) == 0, "playback mismatch");
+	}
+
+	/* each context has its own player */
+	xmp_get_frame_info(c3, &fi3);
+	fail_unless(fi3.frame != fi2.frame || fi3.row != fi2.row ||
+				fi3.pos != fi2.pos, "player state shared");
+
+	xmp_end_player(c2);
+	xmp_end_player(c3);
+	xmp_end_player(c4);
+
+	xmp_release_module(c2);
+	fail_unless(pool.live > 0, "module released while shared");
+	xmp_release_module(c3);
+	fail_unless(pool.live == 0, "module not released");
+	xmp_release_module(c4);
+
+	/* the invert loop effect doesn't change shared sample data */
+	create_simple_module(ctx1, 2, 2);
+	set_quirk(ctx1, QUIRK_INVLOOP, READ_EVENT_MOD);
+	h = hio_open("data/sample-square-8bit.raw", "rb");
+	fail_unless(h != NULL, "can't open sample file");
+	ctx1->m.mod.xxs[0].len = 40;
+	ctx1->m.mod.xxs[0].lps = 0;
+	ctx1->m.mod.xxs[0].lpe = 40;
+	load_sample(&ctx1->m, h, 0, &ctx1->m.mod.xxs[0], NULL);
+	hio_close(h);
+	new_event(ctx1, 0, 0, 0, 49, 1, 0, 0x0e, 0xfe, 0x0f, 1);
+	memcpy(data, ctx1->m.mod.xxs[0].data, 40);
+
+	ret = xmp_share_module(c2, c1);
+	fail_unless(ret == 0, "can't share module");
+
+	f = fopen("data/invloop.data", "r");
+	check_invloop(c1, f);
+	fail_unless(memcmp(data, ctx1->m.mod.xxs[0].data, 40) == 0,
+						"sample data changed");
+	rewind(f);
+	check_invloop(c2, f);
+	fclose(f);
+
+	xmp_release_module(c1);
+	xmp_release_module(c2);
+
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+	xmp_free_context(c3);
+	xmp_free_context(c4);
+}
+END_TEST
@@ -0,0 +1,48 @@
+#include "test.h"
+
+#define NUM_FRAMES	200
+
+/* Skip frames and compare the following frames with normal replay */
+TEST(test_api_skip_frames)
+{
+	xmp_context ctx;
+	struct xmp_frame_info fi;
+	static char ref[NUM_FRAMES][XMP_MAX_FRAMESIZE];
+	int i, skip, ret;
+
+	ctx = xmp_create_context();
+	xmp_load_module(ctx, "data/ode2ptk.mod");
+	xmp_start_player(ctx, 22050, 0);
+	xmp_set_player(ctx, XMP_PLAYER_INTERP, XMP_INTERP_SPLINE);
+
+	for (i = 0; i < NUM_FRAMES; i++) {
+		xmp_play_frame(ctx);
+		xmp_get_frame_info(ctx, &fi);
+		memcpy(ref[i], fi.buffer, fi.buffer_size);
+	}
+	xmp_end_player(ctx);
+
+	for (skip = 1; skip < NUM_FRAMES; skip += 37) {
+		xmp_start_player(ctx, 22050, 0);
+		xmp_set_player(ctx, XMP_PLAYER_INTERP, XMP_INTERP_SPLINE);
+		ret = xmp_skip_frames(ctx, skip);
+		fail_unless(ret == 0, "skip frames error");
+		for (i = skip; i < NUM_FRAMES; i++) {
+			xmp_play_frame(ctx);
+			xmp_get_frame_info(ctx, &fi);
+			fail_unless(memcmp(ref[i], fi.buffer, fi.buffer_size)
+						== 0, "data error");
+		}
+		xmp_end_player(ctx);
+	}
+
+	xmp_start_player(ctx, 22050, 0);
+	xmp_stop_module(ctx);
+	ret = xmp_skip_frames(ctx, 10);
+	fail_unless(ret == -XMP_END, "end of module not detected");
+	xmp_end_player(ctx);
+
+	xmp_release_module(ctx);
+	xmp_free_context(ctx);
+}
+END_TEST
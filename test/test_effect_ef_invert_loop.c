@@ -3,13 +3,14 @@
 
 TEST(test_effect_ef_invert_loop)
 {
-	xmp_context opaque;
+	xmp_context opaque, c2;
 	struct context_data *ctx;
 	struct mixer_data *s;
 	struct module_data *m;
 	struct xmp_frame_info info;
+	HIO_HANDLE *h;
 	FILE *f;
-	int i, j, val;
+	int i, j, k, val;
 
 	opaque = xmp_create_context();
 	ctx = (struct context_data *)opaque;
@@ -18,32 +19,60 @@ TEST(test_effect_ef_invert_loop)
 
 	create_simple_module(ctx, 2, 2);
 	set_quirk(ctx, QUIRK_INVLOOP, READ_EVENT_MOD);
-	f = fopen("data/sample-square-8bit.raw", "rb");
-	fail_unless(f != NULL, "can't open sample file");
+
+	/* The test binary has its own copy of synth_null, take the one
+	 * the player uses so the module isn't taken as a synth module
+	 */
+	c2 = xmp_create_context();
+	fail_unless(xmp_load_module(c2, "data/ode2ptk.mod") == 0,
+						"can't load module");
+	m->synth = ((struct context_data *)c2)->m.synth;
+	xmp_release_module(c2);
+	xmp_free_context(c2);
+
+	h = hio_open("data/sample-square-8bit.raw", "rb");
+	fail_unless(h != NULL, "can't open sample file");
 	
 	m->mod.xxs[0].len = 40;
 	m->mod.xxs[0].lps = 0;
 	m->mod.xxs[0].lpe = 40;
-	load_sample(f, 0, &m->mod.xxs[0], NULL);
-	fclose(f);
+	load_sample(m, h, 0, &m->mod.xxs[0], NULL);
+	hio_close(h);
 
 	new_event(ctx, 0, 0, 0, 49, 1, 0, 0x0e, 0xfe, 0x0f, 1);
 
 	f = fopen("data/invloop.data", "r");
 
-	xmp_start_player(opaque, 16000, XMP_FORMAT_MONO);
-	xmp_set_player(opaque, XMP_PLAYER_INTERP, XMP_INTERP_NEAREST);
+	/* Building the seek index must not invert the samples */
+	for (k = 0; k < 2; k++) {
+		xmp_set_player(opaque, XMP_PLAYER_SNAPSHOT, k ? 20 : 0);
+		xmp_start_player(opaque, 16000, XMP_FORMAT_MONO);
+		xmp_set_player(opaque, XMP_PLAYER_INTERP, XMP_INTERP_NEAREST);
 
-	for (i = 0; i < 6; i++) {
-		xmp_play_frame(opaque);
-		xmp_get_frame_info(opaque, &info);
-		for (j = 0; j < info.buffer_size / 2; j++) {
-			fscanf(f, "%d", &val);
-			fail_unless(s->buf32[j] == val, "invloop error");
+		rewind(f);
+		for (i = 0; i < 6; i++) {
+			xmp_play_frame(opaque);
+			xmp_get_frame_info(opaque, &info);
+			for (j = 0; j < info.buffer_size / 2; j++) {
+				fscanf(f, "%d", &val);
+				fail_unless(s->buf32[j] == val,
+							"invloop error");
+			}
 		}
-	}
 
-	xmp_end_player(opaque);
+		/* Inverted samples are not in the seek index, seeks play
+		 * up to the seek time
+		 */
+		if (k) {
+			fail_unless(ctx->p.seek.num == 0, "seek index built");
+			xmp_seek_time(opaque, 300);
+			for (i = 0; i < 10; i++) {
+				xmp_play_frame(opaque);
+			}
+		}
+
+		xmp_end_player(opaque);
+	}
 	xmp_release_module(opaque);
 	xmp_free_context(opaque);
 }
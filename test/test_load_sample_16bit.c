@@ -8,17 +8,19 @@
 
 TEST(test_load_sample_16bit)
 {
+	struct module_data m;
 	struct xmp_sample s;
-	FILE *f;
+	HIO_HANDLE *f;
 	short buffer[202];
 	int i;
 
-	f = fopen("data/sample-16bit.raw", "rb");
+	memset(&m, 0, sizeof(m));
+	f = hio_open("data/sample-16bit.raw", "rb");
 	fail_unless(f != NULL, "can't open sample file");
 
 	/* read little-endian sample to native-endian buffer */
 	for (i = 0; i < 101; i++) {
-		buffer[i] = read16l(f);
+		buffer[i] = hio_read16l(f);
 	}
 	for (i = 0; i < 101; i++) {
 		buffer[101 + i] = buffer[101 - i - 1];
@@ -26,12 +28,12 @@ TEST(test_load_sample_16bit)
 
 	/* load zero-length sample */
 	SET(0, 0, 101, XMP_SAMPLE_16BIT | XMP_SAMPLE_LOOP);
-	load_sample(NULL, 0, &s, NULL);
+	load_sample(&m, NULL, 0, &s, NULL);
 
 	/* load sample with invalid loop */
 	SET(101, 150, 180, XMP_SAMPLE_16BIT | XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
-	fseek(f, 0, SEEK_SET);
-	load_sample(f, 0, &s, NULL);
+	hio_seek(f, 0, SEEK_SET);
+	load_sample(&m, f, 0, &s, NULL);
 	fail_unless(s.data != NULL, "didn't allocate sample data");
 	fail_unless(s.lps == 0, "didn't fix invalid loop start");
 	fail_unless(s.lpe == 0, "didn't fix invalid loop end");
@@ -39,8 +41,8 @@ TEST(test_load_sample_16bit)
 
 	/* load sample with invalid loop */
 	SET(101, 50, 40, XMP_SAMPLE_16BIT | XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
-	fseek(f, 0, SEEK_SET);
-	load_sample(f, 0, &s, NULL);
+	hio_seek(f, 0, SEEK_SET);
+	load_sample(&m, f, 0, &s, NULL);
 	fail_unless(s.data != NULL, "didn't allocate sample data");
 	fail_unless(s.lps == 0, "didn't fix invalid loop start");
 	fail_unless(s.lpe == 0, "didn't fix invalid loop end");
@@ -48,8 +50,8 @@ TEST(test_load_sample_16bit)
 
 	/* load sample from file */
 	SET(101, 0, 102, XMP_SAMPLE_16BIT);
-	fseek(f, 0, SEEK_SET);
-	load_sample(f, 0, &s, NULL);
+	hio_seek(f, 0, SEEK_SET);
+	load_sample(&m, f, 0, &s, NULL);
 	fail_unless(s.data != NULL, "didn't allocate sample data");
 	fail_unless(s.lpe == 101, "didn't fix invalid loop end");
 	fail_unless(memcmp(s.data, buffer, 202) == 0, "sample data error");
@@ -60,8 +62,8 @@ TEST(test_load_sample_16bit)
 
 	/* load sample from file w/ loop */
 	SET(101, 20, 80, XMP_SAMPLE_16BIT | XMP_SAMPLE_LOOP);
-	fseek(f, 0, SEEK_SET);
-	load_sample(f, 0, &s, NULL);
+	hio_seek(f, 0, SEEK_SET);
+	load_sample(&m, f, 0, &s, NULL);
 	fail_unless(s.data != NULL, "didn't allocate sample data");
 	fail_unless(s.data[160] == s.data[158], "sample adjust error");
 	fail_unless(s.data[161] == s.data[159], "sample adjust error");
@@ -70,8 +72,8 @@ TEST(test_load_sample_16bit)
 
 	/* load sample from w/ bidirectional loop */
 	SET(101, 0, 102, XMP_SAMPLE_16BIT | XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
-	fseek(f, 0, SEEK_SET);
-	load_sample(f, 0, &s, NULL);
+	hio_seek(f, 0, SEEK_SET);
+	load_sample(&m, f, 0, &s, NULL);
 	fail_unless(s.data != NULL, "didn't allocate sample data");
 	fail_unless(s.lpe == 101, "didn't fix invalid loop end");
 	fail_unless(memcmp(s.data, buffer, 404) == 0, "sample unroll error");
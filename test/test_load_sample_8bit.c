@@ -8,14 +8,16 @@
 
 TEST(test_load_sample_8bit)
 {
+	struct module_data m;
 	struct xmp_sample s;
-	FILE *f;
+	HIO_HANDLE *f;
 	char buffer[202];
 	int i;
 
-	f = fopen("data/sample-8bit.raw", "rb");
+	memset(&m, 0, sizeof(m));
+	f = hio_open("data/sample-8bit.raw", "rb");
 	fail_unless(f != NULL, "can't open sample file");
-	fread(buffer, 1, 101, f);
+	hio_read(buffer, 1, 101, f);
 	for (i = 0; i < 101; i++) {
 		buffer[101 + i] = buffer[101 - i - 1];
 	}
@@ -23,12 +25,12 @@ TEST(test_load_sample_8bit)
 
 	/* load zero-length sample */
 	SET(0, 0, 101, XMP_SAMPLE_LOOP);
-	load_sample(NULL, 0, &s, NULL);
+	load_sample(&m, NULL, 0, &s, NULL);
 
 	/* load sample with invalid loop */
 	SET(101, 150, 180, XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
-	fseek(f, 0, SEEK_SET);
-	load_sample(f, 0, &s, NULL);
+	hio_seek(f, 0, SEEK_SET);
+	load_sample(&m, f, 0, &s, NULL);
 	fail_unless(s.data != NULL, "didn't allocate sample data");
 	fail_unless(s.lps == 0, "didn't fix invalid loop start");
 	fail_unless(s.lpe == 0, "didn't fix invalid loop end");
@@ -36,8 +38,8 @@ TEST(test_load_sample_8bit)
 
 	/* load sample with invalid loop */
 	SET(101, 50, 40, XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
-	fseek(f, 0, SEEK_SET);
-	load_sample(f, 0, &s, NULL);
+	hio_seek(f, 0, SEEK_SET);
+	load_sample(&m, f, 0, &s, NULL);
 	fail_unless(s.data != NULL, "didn't allocate sample data");
 	fail_unless(s.lps == 0, "didn't fix invalid loop start");
 	fail_unless(s.lpe == 0, "didn't fix invalid loop end");
@@ -45,8 +47,8 @@ TEST(test_load_sample_8bit)
 
 	/* load sample from file */
 	SET(101, 0, 102, 0);
-	fseek(f, 0, SEEK_SET);
-	load_sample(f, 0, &s, NULL);
+	hio_seek(f, 0, SEEK_SET);
+	load_sample(&m, f, 0, &s, NULL);
 	fail_unless(s.data != NULL, "didn't allocate sample data");
 	fail_unless(s.lpe == 101, "didn't fix invalid loop end");
 	fail_unless(memcmp(s.data, buffer, 101) == 0, "sample data error");
@@ -55,16 +57,16 @@ TEST(test_load_sample_8bit)
 
 	/* load sample from file w/ loop */
 	SET(101, 20, 80, XMP_SAMPLE_LOOP);
-	fseek(f, 0, SEEK_SET);
-	load_sample(f, 0, &s, NULL);
+	hio_seek(f, 0, SEEK_SET);
+	load_sample(&m, f, 0, &s, NULL);
 	fail_unless(s.data != NULL, "didn't allocate sample data");
 	fail_unless(s.data[80] == s.data[79], "sample adjust error");
 	fail_unless(s.data[81] == s.data[20], "sample adjust error");
 
 	/* load sample from w/ bidirectional loop */
 	SET(101, 0, 102, XMP_SAMPLE_LOOP | XMP_SAMPLE_LOOP_BIDIR);
-	fseek(f, 0, SEEK_SET);
-	load_sample(f, 0, &s, NULL);
+	hio_seek(f, 0, SEEK_SET);
+	load_sample(&m, f, 0, &s, NULL);
 	fail_unless(s.data != NULL, "didn't allocate sample data");
 	fail_unless(s.lpe == 101, "didn't fix invalid loop end");
 	fail_unless(memcmp(s.data, buffer, 202) == 0, "sample unroll error");
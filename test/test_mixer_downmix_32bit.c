@@ -0,0 +1,124 @@
+#include "test.h"
+#include "../src/mixer.h"
+
+#define FRAMES 100
+
+static xmp_context start(int format, int amp, int simd)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+
+	fail_unless(xmp_load_module(opaque, "data/test.xm") == 0,
+						"can't load module");
+	fail_unless(xmp_start_player(opaque, 44100, format) == 0,
+						"can't start player");
+	xmp_set_player(opaque, XMP_PLAYER_AMP, amp);
+	if (simd >= 0)
+		ctx->s.simd = simd;
+
+	return opaque;
+}
+
+static void stop(xmp_context opaque)
+{
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+
+/* Compare wide output against 16 bit output, and vectorized against
+ * scalar conversion
+ */
+static void compare_format(int format, int amp)
+{
+	xmp_context ref, c1, c2;
+	struct xmp_frame_info fi, fi1, fi2;
+	int i, j;
+
+	ref = start(XMP_FORMAT_MONO, amp, -1);
+	c1 = start(XMP_FORMAT_MONO | format, amp, -1);
+	c2 = start(XMP_FORMAT_MONO | format, amp, MIXER_SIMD_NONE);
+
+	for (i = 0; i < FRAMES; i++) {
+		int16 *b;
+		int32 *b1;
+		float *f1;
+
+		xmp_play_frame(ref);
+		xmp_play_frame(c1);
+		xmp_play_frame(c2);
+		xmp_get_frame_info(ref, &fi);
+		xmp_get_frame_info(c1, &fi1);
+		xmp_get_frame_info(c2, &fi2);
+
+		fail_unless(fi1.buffer_size == fi.buffer_size * 2, "bad size");
+		fail_unless(fi2.buffer_size == fi1.buffer_size, "size mismatch");
+		fail_unless(memcmp(fi1.buffer, fi2.buffer,
+				fi1.buffer_size) == 0, "simd mismatch");
+
+		b = fi.buffer;
+		b1 = fi1.buffer;
+		f1 = fi1.buffer;
+
+		for (j = 0; j < fi.buffer_size / 2; j++) {
+			if (format & XMP_FORMAT_FLOAT) {
+				/* not clipped, within one 16 bit step */
+				float x = f1[j] * 32768;
+				if (b[j] > -32768 && b[j] < 32767) {
+					fail_unless(x >= b[j] && x <= b[j] + 1,
+							"float downmix error");
+				} else if (b[j] == 32767) {
+					fail_unless(x >= 32767, "float clipped");
+				} else {
+					fail_unless(x < -32767, "float clipped");
+				}
+			} else if (format & XMP_FORMAT_32BIT) {
+				fail_unless(b1[j] >> 16 == b[j],
+							"32 bit downmix error");
+			} else if (format & XMP_FORMAT_UNSIGNED) {
+				fail_unless(b1[j] >= 0 && b1[j] <= 0xffffff,
+							"24 bit out of range");
+				fail_unless((b1[j] - 0x800000) >> 8 == b[j],
+							"24 bit downmix error");
+			} else {
+				fail_unless(b1[j] >= -0x800000 &&
+					    b1[j] <= 0x7fffff,
+							"24 bit out of range");
+				fail_unless(b1[j] >> 8 == b[j],
+							"24 bit downmix error");
+			}
+		}
+	}
+
+	stop(ref);
+	stop(c1);
+	stop(c2);
+}
+
+TEST(test_mixer_downmix_32bit)
+{
+	xmp_context opaque;
+	int amp;
+
+	/* only one sample width can be used */
+	opaque = xmp_create_context();
+	fail_unless(xmp_load_module(opaque, "data/test.xm") == 0,
+						"can't load module");
+	fail_unless(xmp_start_player(opaque, 44100,
+			XMP_FORMAT_8BIT | XMP_FORMAT_FLOAT) ==
+			-XMP_ERROR_INVALID, "accepted two sample widths");
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+
+	/* amplification 3 clips the 16 bit output */
+	for (amp = 1; amp <= 3; amp += 2) {
+		compare_format(XMP_FORMAT_FLOAT, amp);
+		compare_format(XMP_FORMAT_32BIT, amp);
+		compare_format(XMP_FORMAT_24BIT, amp);
+		compare_format(XMP_FORMAT_24BIT | XMP_FORMAT_UNSIGNED, amp);
+	}
+}
+END_TEST
@@ -0,0 +1,70 @@
+#include "test.h"
+#include "../src/mixer.h"
+
+#define FRAMES 10
+
+static int interp[] = {
+	XMP_INTERP_NEAREST, XMP_INTERP_LINEAR, XMP_INTERP_SPLINE
+};
+
+/* Mix with the scalar mixers and compare with each SIMD level supported
+ * by the processor, for all sample resolutions and output channels
+ */
+TEST(test_mixer_simd)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct mixer_data *s;
+	int *ref;
+	int i, j, k, n, size, level, max_level;
+
+	ref = malloc(FRAMES * XMP_MAX_FRAMESIZE * sizeof(int));
+	fail_unless(ref != NULL, "can't allocate buffer");
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+	s = &ctx->s;
+
+	xmp_load_module(opaque, "data/test.xm");
+
+	for (n = 0; n < 12; n++) {
+		int ins = 1 + (n & 1);
+		int format = n & 2 ? XMP_FORMAT_MONO : 0;
+
+		for (i = 0; i < 5; i++) {
+			new_event(ctx, 0, i, 0, 20 + i * 20, ins, 0, 0x0f, 2, 0, 0);
+		}
+
+		xmp_start_player(opaque, 8000, format);
+		xmp_set_player(opaque, XMP_PLAYER_INTERP, interp[n >> 2]);
+		max_level = s->simd;
+		s->simd = MIXER_SIMD_NONE;
+		for (k = i = 0; i < FRAMES; i++) {
+			xmp_play_frame(opaque);
+			size = format ? s->ticksize : s->ticksize * 2;
+			memcpy(ref + k, s->buf32, size * sizeof(int));
+			k += size;
+		}
+		xmp_end_player(opaque);
+
+		for (level = MIXER_SIMD_SSE2; level <= max_level; level++) {
+			xmp_start_player(opaque, 8000, format);
+			xmp_set_player(opaque, XMP_PLAYER_INTERP, interp[n >> 2]);
+			s->simd = level;
+			for (k = i = 0; i < FRAMES; i++) {
+				xmp_play_frame(opaque);
+				size = format ? s->ticksize : s->ticksize * 2;
+				for (j = 0; j < size; j++) {
+					fail_unless(s->buf32[j] == ref[k++],
+							"mixing error");
+				}
+			}
+			xmp_end_player(opaque);
+		}
+	}
+
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+	free(ref);
+}
+END_TEST
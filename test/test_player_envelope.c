@@ -0,0 +1,116 @@
+#include "test.h"
+#include "../src/envelope.h"
+
+/* Envelope evaluation searching the node list, as done before
+ * envelopes were compiled
+ */
+static int search_envelope(struct xmp_envelope *env, int x, int def)
+{
+	int x1, x2, y1, y2;
+	int16 *data = env->data;
+	int index;
+
+	if (~env->flg & XMP_ENVELOPE_ON)
+		return def;
+
+	index = (env->npt - 1) * 2;
+
+	x1 = data[index];
+	if (x >= x1 || index == 0)
+		return data[index + 1];
+
+	do {
+		index -= 2;
+		x1 = data[index];
+	} while (index > 0 && x1 > x);
+
+	y1 = data[index + 1];
+	x2 = data[index + 2];
+
+	if (env->flg & XMP_ENVELOPE_LOOP && index == (env->lpe << 1))
+		index = (env->lps - 1) * 2;
+
+	y2 = data[index + 3];
+
+	return ((y2 - y1) * (x - x1) / (x2 - x1)) + y1;
+}
+
+static void set_envelope(struct xmp_envelope *env, int flg, int npt,
+			 int lps, int lpe, int sus, int16 *data)
+{
+	env->flg = flg;
+	env->npt = npt;
+	env->lps = lps;
+	env->lpe = lpe;
+	env->sus = env->sue = sus;
+	memcpy(env->data, data, npt * 2 * sizeof(int16));
+}
+
+static void compare_envelope(struct module_data *m, int release)
+{
+	struct xmp_envelope *env = &m->mod.xxi[0].aei;
+	struct envelope_table *t;
+	uint8 cursor = 0;
+	int i, x = 0;
+
+	fail_unless(compile_envelopes(m) == 0, "can't compile envelopes");
+	t = &m->xxe[0].aei;
+
+	for (i = 0; i < 500; i++) {
+		fail_unless(get_envelope(t, x, 64, &cursor) ==
+				search_envelope(env, x, 64), "value mismatch");
+		x = update_envelope(t, x, release && i > 200);
+
+		/* retrigger */
+		if (i == 400)
+			x = 0;
+	}
+}
+
+TEST(test_player_envelope)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct module_data *m;
+	struct xmp_envelope *env;
+	int16 ramp[] = { 0, 0, 10, 64, 25, 20, 40, 50, 60, 0 };
+	int16 dup[] = { 0, 64, 10, 32, 10, 16, 30, 48 };
+	int16 unsorted[] = { 0, 10, 30, 60, 20, 0, 40, 30 };
+	int r;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+	m = &ctx->m;
+	create_simple_module(ctx, 1, 1);
+	env = &m->mod.xxi[0].aei;
+
+	for (r = 0; r < 2; r++) {
+		set_envelope(env, XMP_ENVELOPE_ON, 5, 0, 0, 0, ramp);
+		compare_envelope(m, r);
+
+		/* loops interpolate from the loop end to the loop start */
+		set_envelope(env, XMP_ENVELOPE_ON | XMP_ENVELOPE_LOOP,
+							5, 1, 3, 0, ramp);
+		compare_envelope(m, r);
+
+		set_envelope(env, XMP_ENVELOPE_ON | XMP_ENVELOPE_LOOP |
+				XMP_ENVELOPE_SUS, 5, 1, 3, 2, ramp);
+		compare_envelope(m, r);
+
+		set_envelope(env, XMP_ENVELOPE_ON | XMP_ENVELOPE_LOOP |
+				XMP_ENVELOPE_SUS | XMP_ENVELOPE_SLOOP,
+							5, 2, 4, 1, ramp);
+		compare_envelope(m, r);
+
+		set_envelope(env, XMP_ENVELOPE_ON | XMP_ENVELOPE_LOOP,
+							4, 0, 2, 0, dup);
+		compare_envelope(m, r);
+
+		set_envelope(env, XMP_ENVELOPE_ON, 4, 0, 0, 0, unsorted);
+		compare_envelope(m, r);
+	}
+
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+END_TEST
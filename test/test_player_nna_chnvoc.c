@@ -0,0 +1,57 @@
+#include "test.h"
+#include "../src/mixer.h"
+#include "../src/virtual.h"
+
+
+TEST(test_player_nna_chnvoc)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct player_data *p;
+	struct mixer_voice *vi;
+	int i, found;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+	p = &ctx->p;
+
+	create_simple_module(ctx, 2, 2);
+	set_instrument_nna(ctx, 0, 0, XMP_INST_NNA_CONT, XMP_INST_DCT_OFF,
+							XMP_INST_DCA_CUT);
+
+	/* The first note is the loudest, so it's not the quietest voice */
+	new_event(ctx, 0, 0, 0, 40, 1, 64, 0x0f, 1, 0, 0);
+	for (i = 1; i <= 16; i++) {
+		new_event(ctx, 0, i, 0, 40 + i, 1, 30, 0x00, 0, 0, 0);
+	}
+	set_quirk(ctx, QUIRKS_IT, READ_EVENT_IT);
+
+	xmp_start_player(opaque, 44100, 0);
+	fail_unless(p->virt.chnvoc == 16, "bad voices per channel");
+
+	/* Rows 0 to 15: each note continues in a new voice */
+	for (i = 0; i < 16; i++) {
+		xmp_play_frame(opaque);
+		fail_unless(p->virt.virt_used == i + 1, "voice not allocated");
+	}
+
+	/* Row 16: channel limit reached, the oldest voice is reused */
+	xmp_play_frame(opaque);
+	fail_unless(p->virt.virt_used == 16, "bad number of voices in use");
+
+	found = 0;
+	for (i = 0; i < p->virt.maxvoc; i++) {
+		vi = &p->virt.voice_array[i];
+		if (vi->chn < 0)
+			continue;
+		fail_unless(vi->note != 39, "oldest voice not reused");
+		if (vi->note == 40)
+			found = 1;
+	}
+	fail_unless(found, "wrong voice reused");
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+END_TEST
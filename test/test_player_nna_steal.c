@@ -0,0 +1,64 @@
+#include "test.h"
+#include "../src/mixer.h"
+#include "../src/virtual.h"
+
+
+TEST(test_player_nna_steal)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct player_data *p;
+	struct mixer_voice *vi;
+	int i, ret;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+	p = &ctx->p;
+
+	fail_unless(xmp_get_player(opaque, XMP_PLAYER_VOICES) == 64,
+						"bad default number of voices");
+	ret = xmp_set_player(opaque, XMP_PLAYER_VOICES, -1);
+	fail_unless(ret == -XMP_ERROR_INVALID, "accepted invalid value");
+	ret = xmp_set_player(opaque, XMP_PLAYER_VOICES, 4);
+	fail_unless(ret == 0, "can't set number of voices");
+	fail_unless(xmp_get_player(opaque, XMP_PLAYER_VOICES) == 4,
+						"bad number of voices");
+
+	create_simple_module(ctx, 2, 2);
+	set_instrument_nna(ctx, 0, 0, XMP_INST_NNA_CONT, XMP_INST_DCT_OFF,
+							XMP_INST_DCA_CUT);
+	new_event(ctx, 0, 0, 0, 60, 1, 10, 0x0f, 1, 0, 0);
+	new_event(ctx, 0, 1, 0, 61, 1, 50, 0x00, 0, 0, 0);
+	new_event(ctx, 0, 2, 0, 62, 1, 40, 0x00, 0, 0, 0);
+	new_event(ctx, 0, 3, 0, 63, 1, 60, 0x00, 0, 0, 0);
+	new_event(ctx, 0, 4, 0, 64, 1, 30, 0x00, 0, 0, 0);
+	set_quirk(ctx, QUIRKS_IT, READ_EVENT_IT);
+
+	xmp_start_player(opaque, 44100, 0);
+	fail_unless(p->virt.maxvoc == 4, "number of voices not set");
+
+	/* Rows 0 to 3: each note continues in a new voice */
+	for (i = 0; i < 4; i++) {
+		xmp_play_frame(opaque);
+		fail_unless(p->virt.virt_used == i + 1, "voice not allocated");
+	}
+
+	/* Row 4: all voices in use, the quietest note is stopped */
+	xmp_play_frame(opaque);
+	fail_unless(p->virt.virt_used == 4, "bad number of voices in use");
+
+	for (i = 0; i < p->virt.maxvoc; i++) {
+		vi = &p->virt.voice_array[i];
+		fail_unless(vi->chn >= 0, "voice not in use");
+		fail_unless(vi->note != 59, "quietest voice not stolen");
+		if (vi->chn == 0) {
+			fail_unless(vi->note == 63, "new note not played");
+			fail_unless(vi->vol == 29 * 16, "bad new note volume");
+		}
+	}
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+END_TEST
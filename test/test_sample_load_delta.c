@@ -2,6 +2,7 @@
 #include "../src/loaders/loader.h"
 
 struct xmp_sample xxs;
+static struct module_data m;
 
 TEST(test_sample_load_delta)
 {
@@ -15,12 +16,12 @@ TEST(test_sample_load_delta)
 	uint16 conv_r1[10] = { 0, 1, 3, 6, 10, 15, 21, 14, 22, 65529 };
 
 	xxs.len = 10;
-	load_sample(NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_DIFF, &xxs, buffer0);
+	load_sample(&m, NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_DIFF, &xxs, buffer0);
 	fail_unless(memcmp(xxs.data, conv_r0, 10) == 0,
 				"Invalid 8-bit conversion");
 
 	xxs.flg = XMP_SAMPLE_16BIT;
-	load_sample(NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_DIFF, &xxs, buffer1);
+	load_sample(&m, NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_DIFF, &xxs, buffer1);
 	fail_unless(memcmp(xxs.data, conv_r1, 20) == 0,
 				"Invalid 16-bit conversion");
 }
@@ -2,6 +2,7 @@
 #include "../src/loaders/loader.h"
 
 struct xmp_sample xxs;
+static struct module_data m;
 
 TEST(test_sample_load_endian)
 {
@@ -12,7 +13,7 @@ TEST(test_sample_load_endian)
 	xxs.flg = XMP_SAMPLE_16BIT;
 
 	/* Our input sample is big-endian */
-	load_sample(NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_BIGEND, &xxs, conv_r0);
+	load_sample(&m, NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_BIGEND, &xxs, conv_r0);
 
 	if (is_big_endian()) {
 		fail_unless(memcmp(xxs.data, conv_r0, 10) == 0,
@@ -23,7 +24,7 @@ TEST(test_sample_load_endian)
 	}
 
 	/* Now the sample is little-endian */
-	load_sample(NULL, SAMPLE_FLAG_NOLOAD, &xxs, conv_r0);
+	load_sample(&m, NULL, SAMPLE_FLAG_NOLOAD, &xxs, conv_r0);
 	if (is_big_endian()) {
 		fail_unless(memcmp(xxs.data, conv_r1, 10) == 0,
 					"Invalid conversion from little-endian");
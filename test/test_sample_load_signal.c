@@ -2,6 +2,7 @@
 #include "../src/loaders/loader.h"
 
 struct xmp_sample xxs;
+static struct module_data m;
 
 TEST(test_sample_load_signal)
 {
@@ -22,12 +23,12 @@ TEST(test_sample_load_signal)
 	};
 
 	xxs.len = 10;
-	load_sample(NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_UNS, &xxs, buffer0);
+	load_sample(&m, NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_UNS, &xxs, buffer0);
 	fail_unless(memcmp(xxs.data, conv_r0, 10) == 0,
 				"Invalid 8-bit conversion");
 
 	xxs.flg = XMP_SAMPLE_16BIT;
-	load_sample(NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_UNS, &xxs, buffer1);
+	load_sample(&m, NULL, SAMPLE_FLAG_NOLOAD | SAMPLE_FLAG_UNS, &xxs, buffer1);
 	fail_unless(memcmp(xxs.data, conv_r1, 20) == 0,
 				"Invalid 16-bit conversion");
 }
@@ -0,0 +1,95 @@
+#include "test.h"
+#include "../src/synth.h"
+
+#define CHUNK	1024
+#define CHUNKS	8
+
+static uint8 patch1[11] = {
+	0x01, 0x01, 0x10, 0x00, 0xf0, 0xf0, 0x77, 0x77, 0x00, 0x00, 0x00
+};
+
+static uint8 patch2[11] = {
+	0x21, 0x31, 0x4f, 0x00, 0xf2, 0xd2, 0x52, 0x73, 0x01, 0x00, 0x0e
+};
+
+static void note_on(struct context_data *ctx, uint8 *patch, int note)
+{
+	synth_adlib.setpatch(ctx, 0, patch);
+	synth_adlib.setnote(ctx, 0, note, 0);
+	synth_adlib.setvol(ctx, 0, 63);
+}
+
+static void mix(struct context_data *ctx, int32 *buf, int chunk)
+{
+	memset(buf + chunk * CHUNK * 2, 0, CHUNK * 2 * sizeof(int32));
+	synth_adlib.mixer(ctx, buf + chunk * CHUNK * 2, CHUNK, 1, 1, 1);
+}
+
+TEST(test_synth_adlib_context)
+{
+	xmp_context c1, c2, c3;
+	struct context_data *ctx1, *ctx2, *ctx3;
+	static int32 ref[CHUNKS * CHUNK * 2];
+	static int32 buf1[CHUNKS * CHUNK * 2];
+	static int32 buf2[CHUNKS * CHUNK * 2];
+	int i, ret;
+
+	c1 = xmp_create_context();
+	c2 = xmp_create_context();
+	c3 = xmp_create_context();
+	ctx1 = (struct context_data *)c1;
+	ctx2 = (struct context_data *)c2;
+	ctx3 = (struct context_data *)c3;
+
+	/* reference output from a single chip */
+	ret = synth_adlib.init(ctx1, 44100);
+	fail_unless(ret == 0, "can't create chip");
+	note_on(ctx1, patch1, 60);
+	for (i = 0; i < CHUNKS; i++)
+		mix(ctx1, ref, i);
+	synth_adlib.deinit(ctx1);
+	fail_unless(SYNTH_CHIP(ctx1) == NULL, "chip not released");
+
+	/* two chips playing different notes, mixed in turns */
+	ret = synth_adlib.init(ctx1, 44100);
+	fail_unless(ret == 0, "can't create chip");
+	ret = synth_adlib.init(ctx2, 44100);
+	fail_unless(ret == 0, "can't create second chip");
+	fail_unless(SYNTH_CHIP(ctx1) != SYNTH_CHIP(ctx2), "chip shared");
+
+	note_on(ctx2, patch2, 48);
+	note_on(ctx1, patch1, 60);
+
+	for (i = 0; i < CHUNKS / 2; i++) {
+		mix(ctx1, buf1, i);
+		mix(ctx2, buf2, i);
+	}
+
+	/* chips created and destroyed meanwhile don't affect the others */
+	ret = synth_adlib.init(ctx3, 44100);
+	fail_unless(ret == 0, "can't create third chip");
+	note_on(ctx3, patch2, 72);
+	synth_adlib.deinit(ctx3);
+
+	for (; i < CHUNKS; i++) {
+		mix(ctx2, buf2, i);
+		mix(ctx1, buf1, i);
+	}
+
+	fail_unless(memcmp(ref, buf1, sizeof(ref)) == 0, "output mismatch");
+	fail_unless(memcmp(ref, buf2, sizeof(ref)) != 0, "same output");
+
+	for (i = 0; i < CHUNKS * CHUNK * 2; i++) {
+		if (buf2[i] != 0)
+			break;
+	}
+	fail_unless(i < CHUNKS * CHUNK * 2, "no output");
+
+	synth_adlib.deinit(ctx1);
+	synth_adlib.deinit(ctx2);
+
+	xmp_free_context(c1);
+	xmp_free_context(c2);
+	xmp_free_context(c3);
+}
+END_TEST